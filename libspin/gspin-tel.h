@@ -603,6 +603,8 @@ extern gs_t gs_build_2(gs_tree_code_class_t code_class,
 #define GS_OMP_CLAUSE_SCHEDULE_CHUNK_EXPR  6
 
 #define GS_OMP_CLAUSE_COLLAPSE_LEVEL       GS_OMP_CLAUSE_DECL
+
+#define GS_OMP_CLAUSE_DEPEND_KIND          6
 #endif
 
 #ifdef FE_GNU_4_2_0
@@ -1365,6 +1367,14 @@ static inline gs_omp_clause_schedule_kind_t gs_omp_clause_schedule_kind (gs_t t)
 }
 
 GS_LOOKUP (gs_omp_clause_schedule_chunk_expr, GS_OMP_CLAUSE_SCHEDULE_CHUNK_EXPR)
+
+static inline gs_omp_clause_depend_kind_t gs_omp_clause_depend_kind (gs_t t)
+{
+  gs_t depend_kind = gs_operand(t, GS_OMP_CLAUSE_DEPEND_KIND);
+  return (depend_kind != (gs_t) NULL) ?
+          (gs_omp_clause_depend_kind_t) gs_n(depend_kind) :
+          GS_OMP_CLAUSE_DEPEND_UNSPECIFIED;
+}
 #endif
 
 static inline gs_t gs_classtype_size(gs_t t)
@@ -2477,7 +2477,8 @@ typedef enum gs_omp_clause_code {
   GS_OMP_CLAUSE_ORDERED,
   GS_OMP_CLAUSE_DEFAULT,
   GS_OMP_CLAUSE_UNTIED,
-  GS_OMP_CLAUSE_COLLAPSE
+  GS_OMP_CLAUSE_COLLAPSE,
+  GS_OMP_CLAUSE_DEPEND
 } gs_omp_clause_code_t;
 
 typedef enum gs_omp_clause_schedule_kind {
@@ -2493,6 +2494,13 @@ typedef enum gs_omp_clause_default_kind {
   GS_OMP_CLAUSE_DEFAULT_NONE,
   GS_OMP_CLAUSE_DEFAULT_PRIVATE
 } gs_omp_clause_default_kind_t;
+
+typedef enum gs_omp_clause_depend_kind {
+  GS_OMP_CLAUSE_DEPEND_UNSPECIFIED,
+  GS_OMP_CLAUSE_DEPEND_IN,
+  GS_OMP_CLAUSE_DEPEND_OUT,
+  GS_OMP_CLAUSE_DEPEND_INOUT
+} gs_omp_clause_depend_kind_t;
 #endif
 
 typedef enum gs_tls_model_kind {
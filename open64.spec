@@ -111,6 +111,7 @@ contributions of PathScale Inc. and Sun Chan at SimpLight Nanoelectronics.
 %{open64_lib_dir}/%{open64_version}/libopenmp-pcl.a
 %{open64_lib_dir}/%{open64_version}/libcaf-extra.a
 %{open64_lib_dir}/%{open64_version}/libcaf-armci.a
+%{open64_lib_dir}/%{open64_version}/libcaf-shm.a
 %{open64_lib_dir}/%{open64_version}/libcaf-gasnet.a
 %{open64_lib_dir}/%{open64_version}/libuhinstr.a
 %endif
@@ -148,6 +149,7 @@ contributions of PathScale Inc. and Sun Chan at SimpLight Nanoelectronics.
 %{open64_lib_dir}/%{open64_version}/32/libopenmp-pcl.a
 %{open64_lib_dir}/%{open64_version}/32/libcaf-extra.a
 %{open64_lib_dir}/%{open64_version}/32/libcaf-armci.a
+%{open64_lib_dir}/%{open64_version}/32/libcaf-shm.a
 %{open64_lib_dir}/%{open64_version}/32/libcaf-gasnet.a
 %{open64_lib_dir}/%{open64_version}/32/libuhinstr.a
 %endif
@@ -57,6 +57,7 @@ Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
 #include "vec.h"
 #include "target.h"
 #include "cgraph.h"
+#include "tree-iterator.h"
 
 
 /* Miscellaneous data and functions needed for the parser.  */
@@ -208,10 +209,14 @@ typedef enum pragma_omp_clause {
   PRAGMA_OMP_CLAUSE_COPYIN,
   PRAGMA_OMP_CLAUSE_COPYPRIVATE,
   PRAGMA_OMP_CLAUSE_DEFAULT,
+  PRAGMA_OMP_CLAUSE_DEPEND,
   PRAGMA_OMP_CLAUSE_FIRSTPRIVATE,
+  PRAGMA_OMP_CLAUSE_GRAINSIZE,
   PRAGMA_OMP_CLAUSE_IF,
   PRAGMA_OMP_CLAUSE_LASTPRIVATE,
+  PRAGMA_OMP_CLAUSE_NOGROUP,
   PRAGMA_OMP_CLAUSE_NOWAIT,
+  PRAGMA_OMP_CLAUSE_NUM_TASKS,
   PRAGMA_OMP_CLAUSE_NUM_THREADS,
   PRAGMA_OMP_CLAUSE_ORDERED,
   PRAGMA_OMP_CLAUSE_PRIVATE,
@@ -6745,17 +6750,29 @@ c_parser_omp_clause_name (c_parser *parser)
           else if (!strcmp ("copyprivate", p))
 	    result = PRAGMA_OMP_CLAUSE_COPYPRIVATE;
 	  break;
+	case 'd':
+	  if (!strcmp ("depend", p))
+	    result = PRAGMA_OMP_CLAUSE_DEPEND;
+	  break;
 	case 'f':
 	  if (!strcmp ("firstprivate", p))
 	    result = PRAGMA_OMP_CLAUSE_FIRSTPRIVATE;
 	  break;
+	case 'g':
+	  if (!strcmp ("grainsize", p))
+	    result = PRAGMA_OMP_CLAUSE_GRAINSIZE;
+	  break;
 	case 'l':
 	  if (!strcmp ("lastprivate", p))
 	    result = PRAGMA_OMP_CLAUSE_LASTPRIVATE;
 	  break;
 	case 'n':
-	  if (!strcmp ("nowait", p))
+	  if (!strcmp ("nogroup", p))
+	    result = PRAGMA_OMP_CLAUSE_NOGROUP;
+	  else if (!strcmp ("nowait", p))
 	    result = PRAGMA_OMP_CLAUSE_NOWAIT;
+	  else if (!strcmp ("num_tasks", p))
+	    result = PRAGMA_OMP_CLAUSE_NUM_TASKS;
 	  else if (!strcmp ("num_threads", p))
 	    result = PRAGMA_OMP_CLAUSE_NUM_THREADS;
 	  break;
@@ -7230,6 +7247,77 @@ c_parser_omp_clause_default (c_parser *parser, tree list)
   return c;
 }
 
+/* OpenMP 4.0:
+   depend ( depend-kind : expression-list )
+
+   depend-kind:
+     in | out | inout
+
+   Each list item must be an lvalue; the clause records its address,
+   which is what the runtime uses to match dependences between sibling
+   tasks.  */
+
+static tree
+c_parser_omp_clause_depend (c_parser *parser, tree list)
+{
+  enum omp_clause_depend_kind kind;
+
+  if (!c_parser_require (parser, CPP_OPEN_PAREN, "expected %<(%>"))
+    return list;
+
+  if (c_parser_next_token_is (parser, CPP_NAME))
+    {
+      const char *p = IDENTIFIER_POINTER (c_parser_peek_token (parser)->value);
+
+      if (!strcmp ("in", p))
+	kind = OMP_CLAUSE_DEPEND_IN;
+      else if (!strcmp ("out", p))
+	kind = OMP_CLAUSE_DEPEND_OUT;
+      else if (!strcmp ("inout", p))
+	kind = OMP_CLAUSE_DEPEND_INOUT;
+      else
+	goto invalid_kind;
+    }
+  else
+    goto invalid_kind;
+
+  c_parser_consume_token (parser);
+  if (!c_parser_require (parser, CPP_COLON, "expected %<:%>"))
+    goto resync_fail;
+
+  while (1)
+    {
+      tree c, t;
+
+      t = c_parser_expr_no_commas (parser, NULL).value;
+      if (t != error_mark_node)
+	{
+	  t = build_unary_op (ADDR_EXPR, t, 0);
+	  if (t != error_mark_node)
+	    {
+	      c = build_omp_clause (OMP_CLAUSE_DEPEND);
+	      OMP_CLAUSE_DECL (c) = t;
+	      OMP_CLAUSE_DEPEND_KIND (c) = kind;
+	      OMP_CLAUSE_CHAIN (c) = list;
+	      list = c;
+	    }
+	}
+
+      if (c_parser_next_token_is_not (parser, CPP_COMMA))
+	break;
+      c_parser_consume_token (parser);
+    }
+
+  c_parser_skip_until_found (parser, CPP_CLOSE_PAREN, "expected %<)%>");
+  return list;
+
+ invalid_kind:
+  c_parser_error (parser, "expected %<in%>, %<out%> or %<inout%>");
+ resync_fail:
+  c_parser_skip_until_found (parser, CPP_CLOSE_PAREN, "expected %<)%>");
+  return list;
+}
+
 /* OpenMP 2.5:
    firstprivate ( variable-list ) */
 
@@ -7239,6 +7327,44 @@ c_parser_omp_clause_firstprivate (c_parser *parser, tree list)
   return c_parser_omp_var_list_parens (parser, OMP_CLAUSE_FIRSTPRIVATE, list);
 }
 
+/* OpenMP 4.5:
+   grainsize ( expression ) */
+
+static tree
+c_parser_omp_clause_grainsize (c_parser *parser, tree list)
+{
+  if (c_parser_require (parser, CPP_OPEN_PAREN, "expected %<(%>"))
+    {
+      tree c, t = c_parser_expression (parser).value;
+
+      c_parser_skip_until_found (parser, CPP_CLOSE_PAREN, "expected %<)%>");
+
+      if (!INTEGRAL_TYPE_P (TREE_TYPE (t)))
+	{
+	  c_parser_error (parser, "expected integer expression");
+	  return list;
+	}
+
+      /* Attempt to statically determine when the number isn't positive.  */
+      c = fold_build2 (LE_EXPR, boolean_type_node, t,
+		       build_int_cst (TREE_TYPE (t), 0));
+      if (c == boolean_true_node)
+	{
+	  warning (0, "%<grainsize%> value must be positive");
+	  t = integer_one_node;
+	}
+
+      check_no_duplicate_clause (list, OMP_CLAUSE_GRAINSIZE, "grainsize");
+
+      c = build_omp_clause (OMP_CLAUSE_GRAINSIZE);
+      OMP_CLAUSE_GRAINSIZE_EXPR (c) = t;
+      OMP_CLAUSE_CHAIN (c) = list;
+      list = c;
+    }
+
+  return list;
+}
+
 /* OpenMP 2.5:
    if ( expression ) */
 
@@ -7272,6 +7398,21 @@ c_parser_omp_clause_lastprivate (c_parser *parser, tree list)
   return c_parser_omp_var_list_parens (parser, OMP_CLAUSE_LASTPRIVATE, list);
 }
 
+/* OpenMP 4.5:
+   nogroup */
+
+static tree
+c_parser_omp_clause_nogroup (c_parser *parser ATTRIBUTE_UNUSED, tree list)
+{
+  tree c;
+
+  check_no_duplicate_clause (list, OMP_CLAUSE_NOGROUP, "nogroup");
+
+  c = build_omp_clause (OMP_CLAUSE_NOGROUP);
+  OMP_CLAUSE_CHAIN (c) = list;
+  return c;
+}
+
 /* OpenMP 2.5:
    nowait */
 
@@ -7287,6 +7428,44 @@ c_parser_omp_clause_nowait (c_parser *parser ATTRIBUTE_UNUSED, tree list)
   return c;
 }
 
+/* OpenMP 4.5:
+   num_tasks ( expression ) */
+
+static tree
+c_parser_omp_clause_num_tasks (c_parser *parser, tree list)
+{
+  if (c_parser_require (parser, CPP_OPEN_PAREN, "expected %<(%>"))
+    {
+      tree c, t = c_parser_expression (parser).value;
+
+      c_parser_skip_until_found (parser, CPP_CLOSE_PAREN, "expected %<)%>");
+
+      if (!INTEGRAL_TYPE_P (TREE_TYPE (t)))
+	{
+	  c_parser_error (parser, "expected integer expression");
+	  return list;
+	}
+
+      /* Attempt to statically determine when the number isn't positive.  */
+      c = fold_build2 (LE_EXPR, boolean_type_node, t,
+		       build_int_cst (TREE_TYPE (t), 0));
+      if (c == boolean_true_node)
+	{
+	  warning (0, "%<num_tasks%> value must be positive");
+	  t = integer_one_node;
+	}
+
+      check_no_duplicate_clause (list, OMP_CLAUSE_NUM_TASKS, "num_tasks");
+
+      c = build_omp_clause (OMP_CLAUSE_NUM_TASKS);
+      OMP_CLAUSE_NUM_TASKS_EXPR (c) = t;
+      OMP_CLAUSE_CHAIN (c) = list;
+      list = c;
+    }
+
+  return list;
+}
+
 /* OpenMP 2.5:
    num_threads ( expression ) */
 
@@ -7558,10 +7737,18 @@ c_parser_omp_all_clauses (c_parser *parser, unsigned int mask,
 	  clauses = c_parser_omp_clause_default (parser, clauses);
 	  c_name = "default";
 	  break;
+	case PRAGMA_OMP_CLAUSE_DEPEND:
+	  clauses = c_parser_omp_clause_depend (parser, clauses);
+	  c_name = "depend";
+	  break;
 	case PRAGMA_OMP_CLAUSE_FIRSTPRIVATE:
 	  clauses = c_parser_omp_clause_firstprivate (parser, clauses);
 	  c_name = "firstprivate";
 	  break;
+	case PRAGMA_OMP_CLAUSE_GRAINSIZE:
+	  clauses = c_parser_omp_clause_grainsize (parser, clauses);
+	  c_name = "grainsize";
+	  break;
 	case PRAGMA_OMP_CLAUSE_IF:
 	  clauses = c_parser_omp_clause_if (parser, clauses);
 	  c_name = "if";
@@ -7570,10 +7757,18 @@ c_parser_omp_all_clauses (c_parser *parser, unsigned int mask,
 	  clauses = c_parser_omp_clause_lastprivate (parser, clauses);
 	  c_name = "lastprivate";
 	  break;
+	case PRAGMA_OMP_CLAUSE_NOGROUP:
+	  clauses = c_parser_omp_clause_nogroup (parser, clauses);
+	  c_name = "nogroup";
+	  break;
 	case PRAGMA_OMP_CLAUSE_NOWAIT:
 	  clauses = c_parser_omp_clause_nowait (parser, clauses);
 	  c_name = "nowait";
 	  break;
+	case PRAGMA_OMP_CLAUSE_NUM_TASKS:
+	  clauses = c_parser_omp_clause_num_tasks (parser, clauses);
+	  c_name = "num_tasks";
+	  break;
 	case PRAGMA_OMP_CLAUSE_NUM_THREADS:
 	  clauses = c_parser_omp_clause_num_threads (parser, clauses);
 	  c_name = "num_threads";
@@ -8321,7 +8516,8 @@ c_parser_omp_single (c_parser *parser)
 	| (1u << PRAGMA_OMP_CLAUSE_DEFAULT)		\
 	| (1u << PRAGMA_OMP_CLAUSE_PRIVATE)		\
 	| (1u << PRAGMA_OMP_CLAUSE_FIRSTPRIVATE)	\
-	| (1u << PRAGMA_OMP_CLAUSE_SHARED))
+	| (1u << PRAGMA_OMP_CLAUSE_SHARED)		\
+	| (1u << PRAGMA_OMP_CLAUSE_DEPEND))
 
 static tree
 c_parser_omp_task (c_parser *parser)
@@ -8336,6 +8532,308 @@ c_parser_omp_task (c_parser *parser)
   return c_finish_omp_task (clauses, block);
 }
 
+/* OpenMP 4.5:
+   # pragma omp taskloop taskloop-clause[optseq] new-line
+     for-loop
+
+   The loop is not lowered as a construct of its own.  It becomes a
+   single explicit task, which the runtime splits recursively into copies
+   of itself, one per chunk of the iteration space:
+
+     lb = init; ub = last value of the bound; step = incr;
+     __ompc_taskgroup_begin ();
+     __ompc_taskloop_begin (lb, ub, step, grainsize, num_tasks);
+     #pragma omp task firstprivate (lb, step) private (v, lo, hi) ...
+       while (__ompc_taskloop_next (&lo, &hi))
+	 for (; lo < hi; ++lo)
+	   { v = lb + lo * step; body; }
+     __ompc_taskgroup_end ();
+
+   where the taskgroup is left out with nogroup.  */
+
+#define OMP_TASKLOOP_CLAUSE_MASK			\
+	( (1u << PRAGMA_OMP_CLAUSE_IF)			\
+	| (1u << PRAGMA_OMP_CLAUSE_UNTIED)		\
+	| (1u << PRAGMA_OMP_CLAUSE_DEFAULT)		\
+	| (1u << PRAGMA_OMP_CLAUSE_PRIVATE)		\
+	| (1u << PRAGMA_OMP_CLAUSE_FIRSTPRIVATE)	\
+	| (1u << PRAGMA_OMP_CLAUSE_SHARED)		\
+	| (1u << PRAGMA_OMP_CLAUSE_GRAINSIZE)		\
+	| (1u << PRAGMA_OMP_CLAUSE_NUM_TASKS)		\
+	| (1u << PRAGMA_OMP_CLAUSE_NOGROUP))
+
+static GTY (()) tree c_parser_taskloop_begin_fn;
+static GTY (()) tree c_parser_taskloop_next_fn;
+static GTY (()) tree c_parser_taskgroup_begin_fn;
+static GTY (()) tree c_parser_taskgroup_end_fn;
+
+/* Declare the runtime function NAME of TYPE, unless *FN already is.  */
+
+static tree
+c_parser_omp_taskloop_fn (tree *fn, const char *name, tree type)
+{
+  if (*fn == NULL)
+    {
+      tree t = build_decl (FUNCTION_DECL, get_identifier (name), type);
+      DECL_EXTERNAL (t) = 1;
+      TREE_PUBLIC (t) = 1;
+      DECL_ARTIFICIAL (t) = 1;
+      TREE_NOTHROW (t) = 1;
+      *fn = t;
+    }
+  return *fn;
+}
+
+/* Declare a long temporary NAME in the current scope and set it to
+   INIT.  */
+
+static tree
+c_parser_omp_taskloop_temp (const char *name, tree init)
+{
+  tree decl;
+
+  decl = build_decl (VAR_DECL, get_identifier (name), long_integer_type_node);
+  TREE_USED (decl) = 1;
+  decl = pushdecl (decl);
+  add_stmt (build_modify_expr (decl, NOP_EXPR,
+			       fold_convert (long_integer_type_node, init)));
+  return decl;
+}
+
+static tree
+c_parser_omp_taskloop_firstprivate (tree decl, tree list)
+{
+  tree c = build_omp_clause (OMP_CLAUSE_FIRSTPRIVATE);
+  OMP_CLAUSE_DECL (c) = decl;
+  OMP_CLAUSE_CHAIN (c) = list;
+  return c;
+}
+
+static tree
+c_parser_omp_taskloop (c_parser *parser)
+{
+  tree clauses, task_clauses, *cp, c;
+  tree grainsize = NULL, num_tasks = NULL;
+  bool nogroup = false;
+  tree block, loop, omp_for, decl, init, cond, incr, body, bound, step;
+  tree lb, ub, lo, hi, gs, nt, args, t, fn, lptr, void_fn;
+  location_t loc;
+
+  loc = c_parser_peek_token (parser)->location;
+  clauses = c_parser_omp_all_clauses (parser, OMP_TASKLOOP_CLAUSE_MASK,
+				      "#pragma omp taskloop");
+
+  /* Whatever is not about the splitting goes to the generated tasks.  */
+  for (cp = &clauses; *cp; )
+    {
+      switch (OMP_CLAUSE_CODE (*cp))
+	{
+	case OMP_CLAUSE_GRAINSIZE:
+	  grainsize = OMP_CLAUSE_GRAINSIZE_EXPR (*cp);
+	  break;
+	case OMP_CLAUSE_NUM_TASKS:
+	  num_tasks = OMP_CLAUSE_NUM_TASKS_EXPR (*cp);
+	  break;
+	case OMP_CLAUSE_NOGROUP:
+	  nogroup = true;
+	  break;
+	default:
+	  cp = &OMP_CLAUSE_CHAIN (*cp);
+	  continue;
+	}
+      *cp = OMP_CLAUSE_CHAIN (*cp);
+    }
+  task_clauses = clauses;
+
+  if (grainsize && num_tasks)
+    {
+      error ("%H%<grainsize%> and %<num_tasks%> may not both be given", &loc);
+      num_tasks = NULL;
+    }
+
+  block = c_begin_compound_stmt (true);
+
+  /* Parse the loop as the worksharing loop it looks like, then take the
+     OMP_FOR apart again.  Anything else the parse emitted, such as the
+     declaration of the iteration variable, stays.  */
+  loop = push_stmt_list ();
+  omp_for = c_parser_omp_for_loop (parser, NULL, NULL);
+  loop = pop_stmt_list (loop);
+  if (omp_for == NULL)
+    {
+      add_stmt (loop);
+      goto done;
+    }
+  if (loop == omp_for)
+    loop = NULL;
+  else
+    {
+      tree_stmt_iterator i;
+
+      for (i = tsi_start (loop); !tsi_end_p (i); tsi_next (&i))
+	if (tsi_stmt (i) == omp_for)
+	  {
+	    tsi_delink (&i);
+	    break;
+	  }
+      add_stmt (loop);
+    }
+
+  decl = TREE_VEC_ELT (OMP_FOR_INIT (omp_for), 0);
+  decl = TREE_OPERAND (decl, 0);
+  init = TREE_OPERAND (TREE_VEC_ELT (OMP_FOR_INIT (omp_for), 0), 1);
+  cond = TREE_VEC_ELT (OMP_FOR_COND (omp_for), 0);
+  incr = TREE_VEC_ELT (OMP_FOR_INCR (omp_for), 0);
+  body = OMP_FOR_BODY (omp_for);
+
+  if (!INTEGRAL_TYPE_P (TREE_TYPE (decl)))
+    {
+      error ("%Hinvalid type for taskloop iteration variable %qE", &loc, decl);
+      goto done;
+    }
+
+  /* The iteration variable is private to every task.  */
+  for (cp = &task_clauses; *cp; )
+    if ((OMP_CLAUSE_CODE (*cp) == OMP_CLAUSE_PRIVATE
+	 || OMP_CLAUSE_CODE (*cp) == OMP_CLAUSE_FIRSTPRIVATE
+	 || OMP_CLAUSE_CODE (*cp) == OMP_CLAUSE_SHARED)
+	&& OMP_CLAUSE_DECL (*cp) == decl)
+      {
+	if (OMP_CLAUSE_CODE (*cp) != OMP_CLAUSE_PRIVATE)
+	  error ("%Hiteration variable %qD should be private", &loc, decl);
+	*cp = OMP_CLAUSE_CHAIN (*cp);
+      }
+    else
+      cp = &OMP_CLAUSE_CHAIN (*cp);
+
+  switch (TREE_CODE (incr))
+    {
+    case POSTINCREMENT_EXPR:
+    case PREINCREMENT_EXPR:
+      step = fold_convert (long_integer_type_node, TREE_OPERAND (incr, 1));
+      break;
+    case POSTDECREMENT_EXPR:
+    case PREDECREMENT_EXPR:
+      step = fold_convert (long_integer_type_node, TREE_OPERAND (incr, 1));
+      step = fold_build1 (NEGATE_EXPR, long_integer_type_node, step);
+      break;
+    default:
+      t = TREE_OPERAND (incr, 1);
+      if (TREE_CODE (t) == MINUS_EXPR)
+	{
+	  step = fold_convert (long_integer_type_node, TREE_OPERAND (t, 1));
+	  step = fold_build1 (NEGATE_EXPR, long_integer_type_node, step);
+	}
+      else if (TREE_OPERAND (t, 0) == decl)
+	step = fold_convert (long_integer_type_node, TREE_OPERAND (t, 1));
+      else
+	step = fold_convert (long_integer_type_node, TREE_OPERAND (t, 0));
+      break;
+    }
+
+  /* The runtime takes an inclusive upper bound.  */
+  bound = fold_convert (long_integer_type_node, TREE_OPERAND (cond, 1));
+  if (TREE_CODE (cond) == LT_EXPR)
+    bound = fold_build2 (MINUS_EXPR, long_integer_type_node, bound,
+			 build_int_cst (long_integer_type_node, 1));
+  else if (TREE_CODE (cond) == GT_EXPR)
+    bound = fold_build2 (PLUS_EXPR, long_integer_type_node, bound,
+			 build_int_cst (long_integer_type_node, 1));
+
+  lb = c_parser_omp_taskloop_temp ("__omp_tl_lb", init);
+  ub = c_parser_omp_taskloop_temp ("__omp_tl_ub", bound);
+  step = c_parser_omp_taskloop_temp ("__omp_tl_step", step);
+  gs = c_parser_omp_taskloop_temp ("__omp_tl_grainsize",
+				   grainsize ? grainsize : integer_zero_node);
+  nt = c_parser_omp_taskloop_temp ("__omp_tl_num_tasks",
+				   num_tasks ? num_tasks : integer_zero_node);
+  lo = c_parser_omp_taskloop_temp ("__omp_tl_lo", integer_zero_node);
+  hi = c_parser_omp_taskloop_temp ("__omp_tl_hi", integer_zero_node);
+
+  void_fn = build_function_type_list (void_type_node, NULL_TREE);
+  if (!nogroup)
+    {
+      fn = c_parser_omp_taskloop_fn (&c_parser_taskgroup_begin_fn,
+				     "__ompc_taskgroup_begin", void_fn);
+      add_stmt (build_function_call_expr (fn, NULL_TREE));
+    }
+
+  fn = c_parser_omp_taskloop_fn (&c_parser_taskloop_begin_fn,
+				 "__ompc_taskloop_begin",
+				 build_function_type_list
+				   (void_type_node,
+				    long_integer_type_node,
+				    long_integer_type_node,
+				    long_integer_type_node,
+				    long_integer_type_node,
+				    long_integer_type_node, NULL_TREE));
+  args = tree_cons (NULL, nt, NULL);
+  args = tree_cons (NULL, gs, args);
+  args = tree_cons (NULL, step, args);
+  args = tree_cons (NULL, ub, args);
+  args = tree_cons (NULL, lb, args);
+  add_stmt (build_function_call_expr (fn, args));
+
+  lptr = build_pointer_type (long_integer_type_node);
+  fn = c_parser_omp_taskloop_fn (&c_parser_taskloop_next_fn,
+				 "__ompc_taskloop_next",
+				 build_function_type_list (integer_type_node,
+							   lptr, lptr,
+							   NULL_TREE));
+  args = tree_cons (NULL, build_unary_op (ADDR_EXPR, hi, 0), NULL);
+  args = tree_cons (NULL, build_unary_op (ADDR_EXPR, lo, 0), args);
+  cond = build_function_call_expr (fn, args);
+  cond = build2 (NE_EXPR, boolean_type_node, cond, integer_zero_node);
+
+  task_clauses = c_parser_omp_taskloop_firstprivate (lb, task_clauses);
+  task_clauses = c_parser_omp_taskloop_firstprivate (step, task_clauses);
+  c = build_omp_clause (OMP_CLAUSE_PRIVATE);
+  OMP_CLAUSE_DECL (c) = lo;
+  OMP_CLAUSE_CHAIN (c) = task_clauses;
+  task_clauses = c;
+  c = build_omp_clause (OMP_CLAUSE_PRIVATE);
+  OMP_CLAUSE_DECL (c) = hi;
+  OMP_CLAUSE_CHAIN (c) = task_clauses;
+  task_clauses = c;
+  c = build_omp_clause (OMP_CLAUSE_PRIVATE);
+  OMP_CLAUSE_DECL (c) = decl;
+  OMP_CLAUSE_CHAIN (c) = task_clauses;
+  task_clauses = c;
+
+  /* One chunk.  */
+  t = push_stmt_list ();
+  add_stmt (build_modify_expr
+	    (decl, NOP_EXPR,
+	     fold_convert (TREE_TYPE (decl),
+			   fold_build2 (PLUS_EXPR, long_integer_type_node, lb,
+					fold_build2 (MULT_EXPR,
+						     long_integer_type_node,
+						     lo, step)))));
+  add_stmt (body);
+  t = pop_stmt_list (t);
+
+  /* The task, which runs the chunks the runtime leaves to it.  */
+  c = c_begin_omp_task ();
+  body = push_stmt_list ();
+  c_finish_loop (loc, build2 (LT_EXPR, boolean_type_node, lo, hi),
+		 build_unary_op (PREINCREMENT_EXPR, lo, 0), t,
+		 NULL_TREE, NULL_TREE, true);
+  body = pop_stmt_list (body);
+  c_finish_loop (loc, cond, NULL_TREE, body, NULL_TREE, NULL_TREE, true);
+  c_finish_omp_task (task_clauses, c);
+
+  if (!nogroup)
+    {
+      fn = c_parser_omp_taskloop_fn (&c_parser_taskgroup_end_fn,
+				     "__ompc_taskgroup_end", void_fn);
+      add_stmt (build_function_call_expr (fn, NULL_TREE));
+    }
+
+ done:
+  block = c_end_compound_stmt (block, true);
+  return add_stmt (block);
+}
+
 /* OpenMP 3.0:
    # pragma omp taskwait new-line
 */
@@ -8397,6 +8895,9 @@ c_parser_omp_construct (c_parser *parser)
     case PRAGMA_OMP_TASK:
       stmt = c_parser_omp_task (parser);
       break;
+    case PRAGMA_OMP_TASKLOOP:
+      stmt = c_parser_omp_taskloop (parser);
+      break;
      default:
       gcc_unreachable ();
     }
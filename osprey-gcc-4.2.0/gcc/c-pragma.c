@@ -861,6 +861,7 @@ init_pragma (void)
 	{ "sections", PRAGMA_OMP_SECTIONS },
 	{ "single", PRAGMA_OMP_SINGLE },
         { "task", PRAGMA_OMP_TASK },
+        { "taskloop", PRAGMA_OMP_TASKLOOP },
         { "taskwait", PRAGMA_OMP_TASKWAIT },
 	{ "threadprivate", PRAGMA_OMP_THREADPRIVATE }
       };
@@ -43,6 +43,7 @@ typedef enum pragma_kind {
   PRAGMA_OMP_SECTIONS,
   PRAGMA_OMP_SINGLE,
   PRAGMA_OMP_TASK,
+  PRAGMA_OMP_TASKLOOP,
   PRAGMA_OMP_TASKWAIT,
   PRAGMA_OMP_THREADPRIVATE,
   //Openacc pragma
@@ -1349,6 +1349,7 @@ scan_sharing_clauses (tree clauses, omp_context *ctx)
 	case OMP_CLAUSE_IF:
 	case OMP_CLAUSE_NUM_THREADS:
 	case OMP_CLAUSE_SCHEDULE:
+	case OMP_CLAUSE_DEPEND:
 	  if (ctx->outer)
 	    scan_omp (&OMP_CLAUSE_OPERAND (c, 0), ctx->outer);
 	  break;
@@ -1405,6 +1406,7 @@ scan_sharing_clauses (tree clauses, omp_context *ctx)
 	case OMP_CLAUSE_ORDERED:
 	case OMP_CLAUSE_COLLAPSE:
 	case OMP_CLAUSE_UNTIED:
+	case OMP_CLAUSE_DEPEND:
 	  break;
 
 	default:
@@ -208,7 +208,11 @@ unsigned const char omp_clause_num_ops[] =
   0, /* OMP_CLAUSE_ORDERED  */
   0, /* OMP_CLAUSE_DEFAULT  */
   3, /* OMP_CLAUSE_COLLAPSE  */
-  0  /* OMP_CLAUSE_UNTIED   */
+  0, /* OMP_CLAUSE_UNTIED   */
+  1, /* OMP_CLAUSE_DEPEND  */
+  1, /* OMP_CLAUSE_GRAINSIZE  */
+  1, /* OMP_CLAUSE_NUM_TASKS  */
+  0  /* OMP_CLAUSE_NOGROUP  */
 };
 
 const char * const omp_clause_code_name[] =
@@ -228,7 +232,11 @@ const char * const omp_clause_code_name[] =
   "ordered",
   "default",
   "collapse",
-  "untied"
+  "untied",
+  "depend",
+  "grainsize",
+  "num_tasks",
+  "nogroup"
 };
 
   
@@ -7801,6 +7809,9 @@ walk_tree (tree *tp, walk_tree_fn func, void *data, struct pointer_set_t *pset)
 	case OMP_CLAUSE_IF:
 	case OMP_CLAUSE_NUM_THREADS:
 	case OMP_CLAUSE_SCHEDULE:
+	case OMP_CLAUSE_DEPEND:
+	case OMP_CLAUSE_GRAINSIZE:
+	case OMP_CLAUSE_NUM_TASKS:
 	  WALK_SUBTREE (OMP_CLAUSE_OPERAND (*tp, 0));
 	  /* FALLTHRU */
 
@@ -7808,6 +7819,7 @@ walk_tree (tree *tp, walk_tree_fn func, void *data, struct pointer_set_t *pset)
 	case OMP_CLAUSE_ORDERED:
 	case OMP_CLAUSE_DEFAULT:
 	case OMP_CLAUSE_UNTIED:
+	case OMP_CLAUSE_NOGROUP:
 	  WALK_SUBTREE_TAIL (OMP_CLAUSE_CHAIN (*tp));
 
 	case OMP_CLAUSE_LASTPRIVATE:
@@ -9860,6 +9872,13 @@ gcc_omp_clause_code2gs_occ (enum omp_clause_code c)
     case OMP_CLAUSE_ORDERED: return GS_OMP_CLAUSE_ORDERED;
     case OMP_CLAUSE_DEFAULT: return GS_OMP_CLAUSE_DEFAULT;
     case OMP_CLAUSE_UNTIED: return GS_OMP_CLAUSE_UNTIED;
+    case OMP_CLAUSE_DEPEND: return GS_OMP_CLAUSE_DEPEND;
+    /* taskloop clauses are consumed by the C parser, see
+       c_parser_omp_taskloop.  */
+    case OMP_CLAUSE_GRAINSIZE:
+    case OMP_CLAUSE_NUM_TASKS:
+    case OMP_CLAUSE_NOGROUP:
+      break;
   }
   gcc_assert (0);
   return (gsbi_ts_t) 0;
@@ -9924,6 +9943,19 @@ gcc_omp_clause_default_kind2gs_ocdk (enum omp_clause_default_kind k)
   return (gsbi_ts_t) 0;
 }
 
+static inline gs_omp_clause_depend_kind_t
+gcc_omp_clause_depend_kind2gs_ocdk (enum omp_clause_depend_kind k)
+{
+  switch (k)
+  {
+    case OMP_CLAUSE_DEPEND_IN: return GS_OMP_CLAUSE_DEPEND_IN;
+    case OMP_CLAUSE_DEPEND_OUT: return GS_OMP_CLAUSE_DEPEND_OUT;
+    case OMP_CLAUSE_DEPEND_INOUT: return GS_OMP_CLAUSE_DEPEND_INOUT;
+  }
+  gcc_assert (0);
+  return (gsbi_ts_t) 0;
+}
+
 static inline gs_omp_clause_schedule_kind_t
 gcc_omp_clause_schedule_kind2gs_ocsk (enum omp_clause_schedule_kind k)
 {
@@ -12276,6 +12308,18 @@ gs_x_1 (tree t, HOST_WIDE_INT seq_num)
                                  gs_x_1(OMP_CLAUSE_COLLAPSE_EXPR(t), seq_num));
                 break;
 
+                case OMP_CLAUSE_DEPEND:
+                {
+                  gs_t depend_kind = __gs (IB_INT);
+                  _gs_n (depend_kind,
+          gcc_omp_clause_depend_kind2gs_ocdk(OMP_CLAUSE_DEPEND_KIND(t)));
+                  gs_set_operand((gs_t) GS_NODE(t), GS_OMP_CLAUSE_DEPEND_KIND,
+                                 depend_kind);
+                  gs_set_operand((gs_t) GS_NODE(t), GS_OMP_CLAUSE_DECL,
+                                 gs_x_1(OMP_CLAUSE_DECL(t), seq_num));
+                  break;
+                }
+
                 case OMP_CLAUSE_NOWAIT:
                 case OMP_CLAUSE_ORDERED:
                 case OMP_CLAUSE_UNTIED:
@@ -255,7 +255,11 @@ typedef enum {
 	ACCR_STACK_POP			= 45,
 	ACCR_STACK_PENDING_TO_CURRENT_STACK = 46,
 	ACCR_STACK_CLEAR_DEVICE_PTR_IN_CURRENT_STACK = 47,
-	ACCRUNTIME_LAST 		= ACCR_STACK_CLEAR_DEVICE_PTR_IN_CURRENT_STACK
+	ACCR_WAIT_STREAM_ASYNC	= 48,
+	ACCR_FUSED_REDUCTION_BUFF_MALLOC = 49,
+	ACCR_FUSED_REDUCTION_ADD	= 50,
+	ACCR_FINAL_FUSED_REDUCTION	= 51,
+	ACCRUNTIME_LAST 		= ACCR_FINAL_FUSED_REDUCTION
 } OACCRUNTIME;
 
 static const char *accr_names [ACCRUNTIME_LAST + 1] = {
@@ -306,7 +310,11 @@ static const char *accr_names [ACCRUNTIME_LAST + 1] = {
   "__acc_stack_push",
   "__acc_stack_pop",
   "__acc_stack_pending_to_current_stack",
-  "__acc_stack_clear_device_ptr_in_current_stack"
+  "__acc_stack_clear_device_ptr_in_current_stack",
+  "__accr_wait_stream_async",
+  "__accr_fused_reduction_buff_malloc",
+  "__accr_fused_reduction_add",
+  "__accr_final_fused_reduction"
 };
 
 
@@ -362,7 +370,11 @@ static ST_IDX accr_sts [ACCRUNTIME_LAST + 1] = {
   ST_IDX_ZERO,  /*ACCR_STACK_PUSH*/
   ST_IDX_ZERO,  /*ACCR_STACK_POP*/
   ST_IDX_ZERO,  /*ACCR_STACK_PENDING_TO_CURRENT_STACK*/
-  ST_IDX_ZERO   /*ACCR_STACK_CLEAR_DEVICE_PTR_IN_CURRENT_STACK*/
+  ST_IDX_ZERO,  /*ACCR_STACK_CLEAR_DEVICE_PTR_IN_CURRENT_STACK*/
+  ST_IDX_ZERO,  /*ACCR_WAIT_STREAM_ASYNC*/
+  ST_IDX_ZERO,  /*ACCR_FUSED_REDUCTION_BUFF_MALLOC*/
+  ST_IDX_ZERO,  /*ACCR_FUSED_REDUCTION_ADD*/
+  ST_IDX_ZERO   /*ACCR_FINAL_FUSED_REDUCTION*/
 };
 
 
@@ -643,6 +655,7 @@ typedef struct ACC_SCALAR_VAR_INFO
 	ST* st_device_in_klocal;
 	BOOL is_reduction; //reduction variable can also be one of ACC_SCALAR_TYPE.
 	BOOL is_across_gangs; //if this reduction is across gangs, it requires another reduction kernel launch.
+	BOOL is_fused_reduction; //the fused final reduction writes the host variable, no copyout is needed.
 	OPERATOR opr_reduction;
 	UINT32 isize; //size in bytes, transfer between host and device
 }ACC_SCALAR_VAR_INFO;
@@ -1720,6 +1733,15 @@ static TY_IDX ACC_GetArrayElemType(TY_IDX ty)
     return tyElement;
 }
 
+//the sizes and offsets of the runtime data API are size_t, so byte counts
+//are computed in 64 bits, 4GB or more overflows a 32-bit product.
+static WN* ACC_Widen_Size(WN* wn)
+{
+	if(MTYPE_byte_size(WN_rtype(wn)) < MTYPE_byte_size(MTYPE_U8))
+		return WN_Cvt(WN_rtype(wn), MTYPE_U8, wn);
+	return wn;
+}
+
 //WN node must have a kid which includes buffer region
 //wnArr is a pragma wn node which includes variable declaration
 //return the offset of the array buffer. It is in byte.
@@ -1746,7 +1768,7 @@ static WN* ACC_GetArrayStart(ACC_DREGION__ENTRY dEntry)
 		//Array		
 		//Is_True(kind == KIND_ARRAY, ("not array type in ACC_GetArrayStart."));
 		//UINT32 isize = TY_size(ty);
-		return WN_Intconst(MTYPE_U4, 0);
+		return WN_Intconst(MTYPE_U8, 0);
 	}
 	else
 	{
@@ -1758,7 +1780,7 @@ static WN* ACC_GetArrayStart(ACC_DREGION__ENTRY dEntry)
 			while(TY_kind(tyElement) == KIND_ARRAY)
                                 tyElement = TY_etype(tyElement);
 			INT32 elemSize = TY_size(tyElement);
-			wnElementsize = WN_Intconst(MTYPE_U4, elemSize);
+			wnElementsize = WN_Intconst(MTYPE_U8, elemSize);
 		}
 		else if(kind == KIND_POINTER)
 		{
@@ -1768,10 +1790,10 @@ static WN* ACC_GetArrayStart(ACC_DREGION__ENTRY dEntry)
 			if(TY_kind(tyPointed) != KIND_SCALAR)
 				Fail_FmtAssertion("Pointer %s is not scalar pointer.", ST_name(stArr));
 			INT32 elemSize = TY_size(tyPointed);
-			wnElementsize = WN_Intconst(MTYPE_U4, elemSize);
+			wnElementsize = WN_Intconst(MTYPE_U8, elemSize);
 		}
-		wnStart = WN_Binary(OPR_MPY, MTYPE_U4, 
-							wnElementsize, WN_COPY_Tree(wnLower));
+		wnStart = WN_Binary(OPR_MPY, MTYPE_U8, 
+							wnElementsize, ACC_Widen_Size(WN_COPY_Tree(wnLower)));
 		return wnStart;
 	}
 	return NULL;
@@ -1804,7 +1826,7 @@ static WN* ACC_GetArraySize(ACC_DREGION__ENTRY dEntry)
 		//Array		
 		Is_True(FALSE, ("Array size should be processed early."));
 		//process the multi dimensional array
-		UINT32 isize;
+		UINT64 isize;
 		if(TY_kind(TY_etype(ty)) != KIND_SCALAR 
 				&& TY_kind(TY_etype(ty)) == KIND_ARRAY)
 		{
@@ -1822,7 +1844,7 @@ static WN* ACC_GetArraySize(ACC_DREGION__ENTRY dEntry)
 		}
 		else
 			isize = TY_size(ty);
-		return WN_Intconst(MTYPE_U4, isize);
+		return WN_Intconst(MTYPE_U8, isize);
 	}
 	else
 	{
@@ -1835,7 +1857,7 @@ static WN* ACC_GetArraySize(ACC_DREGION__ENTRY dEntry)
 			while(TY_kind(tyElement) == KIND_ARRAY)
 				tyElement = TY_etype(tyElement);
 			INT32 elemSize = TY_size(tyElement);
-			wnElementsize = WN_Intconst(MTYPE_U4, elemSize);
+			wnElementsize = WN_Intconst(MTYPE_U8, elemSize);
 		}
 		else if(kind == KIND_POINTER)
 		{
@@ -1845,23 +1867,23 @@ static WN* ACC_GetArraySize(ACC_DREGION__ENTRY dEntry)
 			if(TY_kind(tyPointed) != KIND_SCALAR)
                                 Fail_FmtAssertion("Pointer %s is not scalar pointer.", ST_name(stArr));
 			INT32 elemSize = TY_size(tyPointed);
-			wnElementsize = WN_Intconst(MTYPE_U4, elemSize);
+			wnElementsize = WN_Intconst(MTYPE_U8, elemSize);
 		}
-		wnWholeSize = WN_Binary(OPR_MPY, MTYPE_U4, 
-							wnElementsize, wnBoundary);
+		wnWholeSize = WN_Binary(OPR_MPY, MTYPE_U8, 
+							wnElementsize, ACC_Widen_Size(wnBoundary));
 		return wnWholeSize;
 	}
 	return NULL;
 }
 
 
-/*device Malloc memory*/
+/*device Malloc memory, wnStart is the byte offset of the sub-array*/
 static WN *
-Gen_DeviceMalloc( ST* st_hmem, ST *st_dmem, WN* wnSize) 
+Gen_DeviceMalloc( ST* st_hmem, ST *st_dmem, WN* wnSize, WN* wnStart) 
 {
 	WN * wn;
 	WN* wnx;
-	wn = WN_Create(OPC_VCALL, 3);	
+	wn = WN_Create(OPC_VCALL, 4);	
 	WN_st_idx(wn) = GET_ACCRUNTIME_ST(ACCR_DEVICEMEMMALLOC);
   
 	WN_Set_Call_Non_Data_Mod(wn);
@@ -1885,8 +1907,11 @@ Gen_DeviceMalloc( ST* st_hmem, ST *st_dmem, WN* wnSize)
     WN_kid(wn, 1) = WN_CreateParm(Pointer_type, wnx, 
                        WN_ty(wnx), WN_PARM_BY_REFERENCE);
   	//
-	WN_kid(wn, 2) = WN_CreateParm(MTYPE_U4, wnSize, 
-		  Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+	WN_kid(wn, 2) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnSize), 
+		  Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
+
+	WN_kid(wn, 3) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnStart), 
+		  Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
 	
   	return wn;
 }
@@ -1929,11 +1954,11 @@ Gen_DataD2H (ST *Src, ST *Dst, WN* wnSize, WN* wnStart)
   WN_kid(wn, 1) = WN_CreateParm(Pointer_type, wnx, 
                        WN_ty(wnx), WN_PARM_BY_REFERENCE);
   
-  WN_kid(wn, 2) = WN_CreateParm(MTYPE_U4, wnSize, 
-		  Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 2) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnSize), 
+		  Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   
-  WN_kid(wn, 3) = WN_CreateParm(MTYPE_U4, wnStart, 
-		  Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 3) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnStart), 
+		  Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   
   if(acc_AsyncExpr)
   {
@@ -1983,11 +2008,11 @@ Gen_DataH2D (ST *Src, ST *Dst, WN* wnSize, WN* wnStart)
   WN_kid(wn, 1) = WN_CreateParm(Pointer_type, wnx, 
                        WN_ty(wnx), WN_PARM_BY_VALUE);
   
-  WN_kid(wn, 2) = WN_CreateParm(MTYPE_U4, wnSize, 
-		  Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 2) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnSize), 
+		  Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   
-  WN_kid(wn, 3) = WN_CreateParm(MTYPE_U4, wnStart, 
-  		  Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 3) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnStart), 
+  		  Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   
   if(acc_AsyncExpr)
   {
@@ -3499,6 +3524,131 @@ static WN* GenReductionMalloc(ST* st_device, WN* wnSize)
   	return wn;
 }
 
+//operator codes of __accr_fused_reduction_add, see ACC_REDUCTION_OPR in openacc_rtl.h
+typedef enum {
+	ACC_REDUCTION_ADD = 0,
+	ACC_REDUCTION_MPY,
+	ACC_REDUCTION_MAX,
+	ACC_REDUCTION_MIN,
+	ACC_REDUCTION_BAND,
+	ACC_REDUCTION_BIOR,
+	ACC_REDUCTION_BXOR,
+	ACC_REDUCTION_CAND,
+	ACC_REDUCTION_CIOR
+}ACC_REDUCTION_OPR;
+
+static INT32 ACC_Get_Runtime_Reduction_Opr(OPERATOR ReductionOpr)
+{
+	switch(ReductionOpr)
+	{
+	case OPR_ADD:
+		return ACC_REDUCTION_ADD;
+	case OPR_MPY:
+		return ACC_REDUCTION_MPY;
+	case OPR_MAX:
+		return ACC_REDUCTION_MAX;
+	case OPR_MIN:
+		return ACC_REDUCTION_MIN;
+	case OPR_BAND:
+		return ACC_REDUCTION_BAND;
+	case OPR_BIOR:
+		return ACC_REDUCTION_BIOR;
+	case OPR_BXOR:
+		return ACC_REDUCTION_BXOR;
+	case OPR_CAND:
+		return ACC_REDUCTION_CAND;
+	case OPR_CIOR:
+		return ACC_REDUCTION_CIOR;
+	default:
+		Fail_FmtAssertion("invalid reduction operator for OpenACC: ACC_Get_Runtime_Reduction_Opr");
+	}
+	return ACC_REDUCTION_ADD;
+}
+
+//the partial results of the top level reductions of a region are packed 
+//in one device buffer, so that they come back in one transfer
+static WN* GenFusedReductionMalloc(ST* st_device, WN* wnSize)
+{
+	WN * wn;
+	WN* wnx;
+	wn = WN_Create(OPC_VCALL, 2);	
+	WN_st_idx(wn) = GET_ACCRUNTIME_ST(ACCR_FUSED_REDUCTION_BUFF_MALLOC);
+  
+	WN_Set_Call_Non_Data_Mod(wn);
+	WN_Set_Call_Non_Data_Ref(wn);
+	WN_Set_Call_Non_Parm_Mod(wn);
+	WN_Set_Call_Non_Parm_Ref(wn);
+	WN_Set_Call_Parm_Ref(wn);
+		
+	wnx = WN_Lda( Pointer_type, 0, st_device);
+    WN_kid(wn, 0) = WN_CreateParm(Pointer_type, wnx, 
+                       WN_ty(wnx), WN_PARM_BY_REFERENCE);
+  
+	WN_kid(wn, 1) = WN_CreateParm(MTYPE_I4, wnSize, Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+	
+  	return wn;
+}
+
+//add one reduction variable to the fused final reduction of the region,
+//the result is written into the host variable st_host
+static WN* GenFusedReductionAdd(ST* st_dbuffer, ST* st_host, 
+				ST* st_reduction_kernel_name, ST* st_num_of_element, OPERATOR ReductionOpr)
+{
+	WN * wn;
+	WN* wnx;
+	wn = WN_Create(OPC_VCALL, 7);	
+	WN_st_idx(wn) = GET_ACCRUNTIME_ST(ACCR_FUSED_REDUCTION_ADD);
+  
+	WN_Set_Call_Non_Data_Mod(wn);
+	WN_Set_Call_Non_Data_Ref(wn);
+	WN_Set_Call_Non_Parm_Mod(wn);
+	WN_Set_Call_Non_Parm_Ref(wn);
+	WN_Set_Call_Parm_Ref(wn);
+		
+  	wnx = WN_Ldid(Pointer_type, 0, st_dbuffer, ST_type(st_dbuffer));	
+    WN_kid(wn, 0) = WN_CreateParm(Pointer_type, wnx, 
+                       WN_ty(wnx), WN_PARM_BY_VALUE);
+
+	wnx = WN_Lda( Pointer_type, 0, st_host);
+    WN_kid(wn, 1) = WN_CreateParm(Pointer_type, wnx, 
+                       WN_ty(wnx), WN_PARM_BY_REFERENCE);
+	
+	char* kernelname = ST_name(st_reduction_kernel_name);
+	WN* wn_kernelname = WN_LdaString(kernelname,0, strlen(kernelname)+1);
+	WN_kid(wn, 2) = WN_CreateParm(Pointer_type, wn_kernelname, 
+						 		WN_ty(wn_kernelname), WN_PARM_BY_VALUE);
+	
+  	wnx = WN_Ldid(TY_mtype(ST_type(st_num_of_element)), 0, st_num_of_element, ST_type(st_num_of_element));	
+    WN_kid(wn, 3) = WN_CreateParm(TY_mtype(ST_type(st_num_of_element)), wnx, 
+		  							ST_type(st_num_of_element), WN_PARM_BY_VALUE);
+	
+    WN_kid(wn, 4) = WN_CreateParm(MTYPE_U4, WN_Intconst(MTYPE_U4, TY_size(ST_type(st_host))), 
+		  							Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+	
+    WN_kid(wn, 5) = WN_CreateParm(MTYPE_I4, WN_Intconst(MTYPE_I4, ACC_Get_Runtime_Reduction_Opr(ReductionOpr)), 
+		  							Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+	
+    WN_kid(wn, 6) = WN_CreateParm(MTYPE_I4, WN_Intconst(MTYPE_I4, GetKernelParamType(st_host)), 
+		  							Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+	
+  	return wn;
+}
+
+static WN* GenFinalFusedReduction()
+{
+	WN * wn;
+	wn = WN_Create(OPC_VCALL, 0);	
+	WN_st_idx(wn) = GET_ACCRUNTIME_ST(ACCR_FINAL_FUSED_REDUCTION);
+  
+	WN_Set_Call_Non_Data_Mod(wn);
+	WN_Set_Call_Non_Data_Ref(wn);
+	WN_Set_Call_Non_Parm_Mod(wn);
+	WN_Set_Call_Non_Parm_Ref(wn);
+	WN_Set_Call_Parm_Ref(wn);
+	
+  	return wn;
+}
+
 /*static WN* ACC_Process_SingleReductionNode(WN* reductionode, WN* wn_replace_block) 
 {
 	//reductionmap	
@@ -7894,7 +8044,7 @@ static void ACC_ProcessReduction_Parallel(ParallelRegionInfo* pPRInfo, WN* wn_re
 				reductionmap.deviceName = st_device;
 				reductionmap.st_num_of_element = st_num_vectors;
 				//call the acc malloc
-				WN_INSERT_BlockLast( wn_replace_block, GenReductionMalloc(st_device, alloc_size));				
+				WN_INSERT_BlockLast( wn_replace_block, GenFusedReductionMalloc(st_device, alloc_size));				
 		
 				reductionmap.reduction_kenels = ACC_GenerateReduction_Kernels_TopLoop(&reductionmap);
 				if(reductionmap.acc_stmt_location == ACC_INNER_LOOP&&acc_reduction_mem == ACC_RD_SHARED_MEM)
@@ -8181,7 +8331,7 @@ static void ACC_ProcessReduction_Parallel(ParallelRegionInfo* pPRInfo, WN* wn_re
 				reductionmap.deviceName = st_device;
 				reductionmap.st_num_of_element = st_num_vectors;
 				//call the acc malloc
-				WN_INSERT_BlockLast( wn_replace_block, GenReductionMalloc(st_device, alloc_size));				
+				WN_INSERT_BlockLast( wn_replace_block, GenFusedReductionMalloc(st_device, alloc_size));				
 		
 				reductionmap.reduction_kenels = ACC_GenerateReduction_Kernels_TopLoop(&reductionmap);
 				//reductionmap.second_reduction_fun = ACC_GenerateWorkerVectorReduction_unrolling(&reductionmap)
@@ -8345,7 +8495,7 @@ static void ACC_ProcessReduction_Parallel(ParallelRegionInfo* pPRInfo, WN* wn_re
 				reductionmap.deviceName = st_device;
 				reductionmap.st_num_of_element = st_num_vectors;
 				//call the acc malloc
-				WN_INSERT_BlockLast( wn_replace_block, GenReductionMalloc(st_device, alloc_size));				
+				WN_INSERT_BlockLast( wn_replace_block, GenFusedReductionMalloc(st_device, alloc_size));				
 				reductionmap.looptype = acc_loopinfo.acc_forloop[0].looptype;
 				reductionmap.reduction_kenels = ACC_GenerateReduction_Kernels_TopLoop(&reductionmap);
 				if(acc_reduction_mem == ACC_RD_SHARED_MEM)
@@ -8769,7 +8919,9 @@ Transform_ACC_Parallel_Block ( WN * tree, ParallelRegionInfo* pPRInfo, WN* wn_re
 	//launch kernels
 	LaunchKernel(0, wn_replace_block, TRUE);
 	//launch reduction
-	
+	//All the top level reductions of the region are finished by one fused
+	//final reduction, which brings the results back in one transfer.
+	BOOL hasFusedReduction = FALSE;
 	
 	i=0;
 	while(i < acc_parallel_loop_info.loopnum)
@@ -8798,12 +8950,14 @@ Transform_ACC_Parallel_Block ( WN * tree, ParallelRegionInfo* pPRInfo, WN* wn_re
 				Fail_FmtAssertion("Scalar reduction variable %s has no respective device variable in host side.\n", 
 							ST_name(st_old));
 			ST* st_device_onhost = scalar_var_info->st_device_in_host;
-			WN* wn_reduction_final_stmt = GenFinalReductionAlgorithm(st_device, st_device_onhost,
-				st_reductionKernel, reductionmap.st_num_of_element, TY_size(ST_type(st_old)));
-
-			//WN* wn_reduction_final_stmt = GenFinalReductionAlgorithm(st_device, st_old,
+			//WN* wn_reduction_final_stmt = GenFinalReductionAlgorithm(st_device, st_device_onhost,
 			//	st_reductionKernel, reductionmap.st_num_of_element, TY_size(ST_type(st_old)));
+			WN* wn_reduction_final_stmt = GenFusedReductionAdd(st_device, st_old,
+				st_reductionKernel, reductionmap.st_num_of_element, reductionmap.ReductionOpr);
 			WN_INSERT_BlockLast(wn_replace_block, wn_reduction_final_stmt);
+			//the result goes to the host variable directly
+			scalar_var_info->is_fused_reduction = TRUE;
+			hasFusedReduction = TRUE;
 			iRdIdx ++;
 		}
 		/***************************************************************************/
@@ -8811,6 +8965,8 @@ Transform_ACC_Parallel_Block ( WN * tree, ParallelRegionInfo* pPRInfo, WN* wn_re
 		/***************************************************************************/
 		i++;
 	}
+	if(hasFusedReduction)
+		WN_INSERT_BlockLast(wn_replace_block, GenFinalFusedReduction());
 }
 
 
@@ -10627,6 +10783,7 @@ static void ACC_Process_scalar_variable_for_offload_region()
 		pVarInfo->st_var = st_var;
 		pVarInfo->is_reduction = FALSE;
 		pVarInfo->is_across_gangs = FALSE;
+		pVarInfo->is_fused_reduction = FALSE;
 	}
 	for(vindex=0; vindex<acc_dregion_lprivate.size(); vindex++)
 	{
@@ -10643,6 +10800,7 @@ static void ACC_Process_scalar_variable_for_offload_region()
 		pVarInfo->st_var = st_var;
 		pVarInfo->is_reduction = FALSE;
 		pVarInfo->is_across_gangs = FALSE;
+		pVarInfo->is_fused_reduction = FALSE;
 	}
 	for(vindex=0; vindex<acc_dregion_fprivate.size(); vindex++)
 	{
@@ -10659,6 +10817,7 @@ static void ACC_Process_scalar_variable_for_offload_region()
 		pVarInfo->st_var = st_var;
 		pVarInfo->is_reduction = FALSE;
 		pVarInfo->is_across_gangs = FALSE;
+		pVarInfo->is_fused_reduction = FALSE;
 	}
 	for(vindex=0; vindex<acc_dregion_private.size(); vindex++)
 	{
@@ -10675,6 +10834,7 @@ static void ACC_Process_scalar_variable_for_offload_region()
 		pVarInfo->st_var = st_var;
 		pVarInfo->is_reduction = FALSE;
 		pVarInfo->is_across_gangs = FALSE;
+		pVarInfo->is_fused_reduction = FALSE;
 	}
 	//acc_dregion_private;		
 	//acc_dregion_fprivate;	
@@ -10727,7 +10887,7 @@ static ST* ACC_GenSingleCreateAndMallocDeviceMem(ACC_DREGION__ENTRY dEntry,
 		pSTMap->wnSize = wnSize;
 		pSTMap->wnStart = wnStart;
 		pDMap->push_back(pSTMap);
-		WN* WN_mallocall = Gen_DeviceMalloc(old_st, karg, WN_COPY_Tree(wnSize));
+		WN* WN_mallocall = Gen_DeviceMalloc(old_st, karg, WN_COPY_Tree(wnSize), WN_COPY_Tree(wnStart));
 		WN_INSERT_BlockLast(ReplacementBlock, WN_mallocall);
 		return karg;
 	}
@@ -10763,11 +10923,11 @@ static WN* ACC_GenIsPCreate(ACC_DREGION__ENTRY dEntry)
 	//wnx = WN_Lda( Pointer_type, 0, Src);
 	WN_kid(wn, 0) = WN_CreateParm(Pointer_type, wnAddr, WN_ty(wnAddr), WN_PARM_BY_VALUE);  
 	
-	WN_kid(wn, 1) = WN_CreateParm(MTYPE_U4, wnStart, Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+	WN_kid(wn, 1) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnStart), Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
 
-	WN_kid(wn, 2) = WN_CreateParm(MTYPE_U4, wnSizeInUnit, Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+	WN_kid(wn, 2) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnSizeInUnit), Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
 	
-	WN_kid(wn, 3) = WN_CreateParm(MTYPE_U4, wnSize, Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+	WN_kid(wn, 3) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnSize), Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
 	
 	return wn;
 }
@@ -10857,9 +11017,9 @@ static WN* ACC_Gen_GetDeviceAddr(ACC_DREGION__ENTRY dentry, ST* st_device)
 	wnx = WN_Lda( Pointer_type, 0, st_device);
     WN_kid(wn, 1) = WN_CreateParm(Pointer_type, wnx, WN_ty(wnx), WN_PARM_BY_REFERENCE);
 	
-	WN_kid(wn, 2) = WN_CreateParm(MTYPE_U4, wnStart, Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+	WN_kid(wn, 2) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnStart), Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
 
-	WN_kid(wn, 3) = WN_CreateParm(MTYPE_U4, wnSize, Be_Type_Tbl(MTYPE_U4), WN_PARM_BY_VALUE);
+	WN_kid(wn, 3) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wnSize), Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
 	
 	return wn;
 }
@@ -11066,11 +11226,11 @@ static WN* ACC_GenUpdateHostVar(ST* st_Var, WN* wn_start, WN* wn_length)
                        WN_ty(wnx), WN_PARM_BY_VALUE);
 
   //wnx = WN_Lda( Pointer_type, 0, Dst);
-  WN_kid(wn, 1) = WN_CreateParm(MTYPE_I4, wn_start, 
-                       Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 1) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wn_start), 
+                       Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   
-  WN_kid(wn, 2) = WN_CreateParm(MTYPE_I4, wn_length, 
-		  			   Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 2) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wn_length), 
+		  			   Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   if(acc_AsyncExpr)
   {
   	WN_kid(wn, 3) = WN_CreateParm(MTYPE_I4, WN_COPY_Tree(acc_AsyncExpr), 
@@ -11108,11 +11268,11 @@ static WN* ACC_GenUpdateDeviceVar(ST* st_Var, WN* wn_start, WN* wn_length)
                        WN_ty(wnx), WN_PARM_BY_VALUE);
 
   //wnx = WN_Lda( Pointer_type, 0, Dst);
-  WN_kid(wn, 1) = WN_CreateParm(MTYPE_I4, wn_start, 
-                       Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 1) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wn_start), 
+                       Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   
-  WN_kid(wn, 2) = WN_CreateParm(MTYPE_I4, wn_length, 
-		  			   Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 2) = WN_CreateParm(MTYPE_U8, ACC_Widen_Size(wn_length), 
+		  			   Be_Type_Tbl(MTYPE_U8), WN_PARM_BY_VALUE);
   if(acc_AsyncExpr)
   {
   	WN_kid(wn, 3) = WN_CreateParm(MTYPE_I4, WN_COPY_Tree(acc_AsyncExpr), 
@@ -11147,6 +11307,30 @@ static WN* ACC_GenWaitStream(WN* wn_int_expr)
   return wn;
 }
 
+/*wait(wn_int_expr) async(wn_async_expr): the async queue waits for the 
+given stream (all streams if wn_int_expr is "0") on the device, the host
+does not block.*/
+static WN* ACC_GenWaitStreamAsync(WN* wn_int_expr, WN* wn_async_expr)
+{	
+  WN * wn;
+  wn = WN_Create(OPC_VCALL, 2 );
+  WN_st_idx(wn) = GET_ACCRUNTIME_ST(ACCR_WAIT_STREAM_ASYNC);
+
+  WN_Set_Call_Non_Data_Mod(wn);
+  WN_Set_Call_Non_Data_Ref(wn);
+  WN_Set_Call_Non_Parm_Mod(wn);
+  WN_Set_Call_Non_Parm_Ref(wn);
+  WN_Set_Call_Parm_Ref(wn);
+  WN_linenum(wn) = acc_line_number;
+  
+  WN_kid(wn, 0) = WN_CreateParm(MTYPE_I4, WN_COPY_Tree(wn_int_expr), 
+  		  Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+  WN_kid(wn, 1) = WN_CreateParm(MTYPE_I4, WN_COPY_Tree(wn_async_expr), 
+  		  Be_Type_Tbl(MTYPE_I4), WN_PARM_BY_VALUE);
+
+  return wn;
+}
+
 
 static void ACC_Process_Clause_Pragma(WN * tree)
 {
@@ -12096,7 +12280,7 @@ static void ACC_Scalar_Variable_CreateAndCopyInOut(WN* wn_replace_block)
 			ACC_Create_Single_Scalar_Variable(st_host, pInfo);
 			pInfo->isize = ty_size;
 			//acc_map_scalar_inout[st_host] = pSTMap;
-			WN* wn_H2D = Gen_DeviceMalloc(st_host, pInfo->st_device_in_host, WN_COPY_Tree(wn_size));
+			WN* wn_H2D = Gen_DeviceMalloc(st_host, pInfo->st_device_in_host, WN_COPY_Tree(wn_size), WN_COPY_Tree(wn_start));
 			WN_INSERT_BlockLast(wn_replace_block, wn_H2D);
 			wn_H2D = Gen_DataH2D(st_host, pInfo->st_device_in_host, wn_size, wn_start);
 			WN_INSERT_BlockLast(wn_replace_block, wn_H2D);
@@ -12115,7 +12299,7 @@ static void ACC_Scalar_Variable_CreateAndCopyInOut(WN* wn_replace_block)
 			//if(acc_map_scalar_inout[st_host])
 			//	delete acc_map_scalar_inout[st_host];
 			//acc_map_scalar_inout[st_host] = pSTMap;
-			WN* wn_H2D = Gen_DeviceMalloc(st_host, pInfo->st_device_in_host, WN_COPY_Tree(wn_size));
+			WN* wn_H2D = Gen_DeviceMalloc(st_host, pInfo->st_device_in_host, WN_COPY_Tree(wn_size), WN_COPY_Tree(wn_start));
 			WN_INSERT_BlockLast(wn_replace_block, wn_H2D);
 		}
 	}
@@ -12133,7 +12317,7 @@ static void ACC_Scalar_Variable_CreateAndCopyInOut(WN* wn_replace_block)
 		if(acc_map_scalar_inout[st_host])
 			delete acc_map_scalar_inout[st_host];
 		acc_map_scalar_inout[st_host] = pSTMap;
-		WN* wn_H2D = Gen_DeviceMalloc(st_host, pSTMap->st_device_ptr_on_host, WN_COPY_Tree(wn_size));
+		WN* wn_H2D = Gen_DeviceMalloc(st_host, pSTMap->st_device_ptr_on_host, WN_COPY_Tree(wn_size), WN_COPY_Tree(wn_start));
 		WN_INSERT_BlockLast(wn_replace_block, wn_H2D);
 		//WN* wn_H2D = Gen_DataH2D(st_host, pSTMap->st_device_ptr_on_host, wn_size, wn_start);
 		//WN_INSERT_BlockLast(wn_replace_block, wn_H2D);		
@@ -12159,8 +12343,13 @@ static void ACC_Scalar_Variable_Copyout(WN* wn_replace_block)
 			UINT32 ty_size = TY_size(ty_host);
 			wn_start = WN_Intconst(MTYPE_U4, 0);
 			wn_size = WN_Intconst(MTYPE_U4, ty_size);
-			WN* wn_D2H = Gen_DataD2H(st_device, st_host, wn_size, wn_start);
-			WN_INSERT_BlockLast(wn_replace_block, wn_D2H);
+			WN* wn_D2H;
+			//the fused final reduction has written the host variable already
+			if(!pInfo->is_fused_reduction)
+			{
+				wn_D2H = Gen_DataD2H(st_device, st_host, wn_size, wn_start);
+				WN_INSERT_BlockLast(wn_replace_block, wn_D2H);
+			}
 			//free buffer
 			wn_D2H = ACC_GenFreeDeviceMemory(st_device);
 			WN_INSERT_BlockLast(wn_replace_block, wn_D2H);
@@ -12798,7 +12987,17 @@ static WN* ACC_Process_WaitRegion( WN * tree )
 	
 	WN* wn_waitBlock = WN_CreateBlock();
 
-	WN_INSERT_BlockLast(wn_waitBlock, ACC_GenWaitStream(acc_int_expr));
+	if(acc_async_nodes)
+	{
+		//wait(n) async(m) does not block the host
+		WN* acc_AsyncExpr = WN_COPY_Tree(WN_kid0(acc_async_nodes));
+		WN_Delete(acc_async_nodes); 
+		acc_async_nodes = NULL;
+		WN_INSERT_BlockLast(wn_waitBlock, ACC_GenWaitStreamAsync(acc_int_expr, acc_AsyncExpr));
+		WN_Delete(acc_AsyncExpr);
+	}
+	else
+		WN_INSERT_BlockLast(wn_waitBlock, ACC_GenWaitStream(acc_int_expr));
 	
 		
 	WN_Delete(acc_int_expr);
@@ -353,7 +353,10 @@ typedef enum {
 
   MPR_OMP_WORKSHARE             = 85,
   MPR_OMP_END_WORKSHARE         = 86,
-  MPRUNTIME_LAST = MPR_OMP_END_WORKSHARE
+
+  MPR_OMP_REDUCE                = 87,
+  MPR_OMP_TASK_CREATE_DEPS      = 88,
+  MPRUNTIME_LAST = MPR_OMP_TASK_CREATE_DEPS
 } MPRUNTIME;
 
 
@@ -574,6 +577,8 @@ static vector <ST *> copyin_sources;  /* STs for temps that hold the copyin valu
 static WN *copyin_nodes_end;	/* Points to (optional) copyin nodes end */
 static WN *if_node;		/* Points to (optional) if node */
 static BOOL untied;             /* untied flag */
+static WN *depend_nodes;        /* Points to (optional) depend in/out nodes */
+static INT32 depend_count;      /* Count of depend list items */
 static UINT32 collapse_count;   /* collapse count */
 static WN *lastlocal_nodes;	/* Points to (optional) lastlocal nodes */
 static WN *lastthread_node;	/* Points to (optional) lastthread node */
@@ -778,6 +783,8 @@ static const char *mpr_names [MPRUNTIME_LAST + 1] = {
   "__ompc_task_will_defer",    /* MPR_OMP_TASK_WILL_DEFER */
   "__ompc_workshare",           /* MPR_OMP_WORKSHARE */
   "__ompc_end_workshare",       /* MPR_OMP_END_WORKSHARE */
+  "__ompc_reduce",              /* MPR_OMP_REDUCE */
+  "__ompc_task_create_deps",    /* MPR_OMP_TASK_CREATE_DEPS */
 };
 
 
@@ -878,6 +885,9 @@ static ST_IDX mpr_sts [MPRUNTIME_LAST + 1] = {
 
   ST_IDX_ZERO,   /* MPR_OMP_WORKSHARE */
   ST_IDX_ZERO,   /* MPR_OMP_END_WORKSHARE */
+
+  ST_IDX_ZERO,   /* MPR_OMP_REDUCE */
+  ST_IDX_ZERO,   /* MPR_OMP_TASK_CREATE_DEPS */
 };
 
 #define MPSP_STATUS_PREG_NAME "mpsp_status"
@@ -1287,15 +1297,62 @@ Gen_Task_Firstprivates_Free (ST *alloc_st)
 }
 
 /*
-Generate RT calls to create task.
+Dependence kinds understood by __ompc_task_create_deps, must match
+omp_task_dep_kind_t in libopenmp/omp_task.h.
+*/
+enum {
+  OMP_TASK_DEP_IN  = 1,
+  OMP_TASK_DEP_OUT = 2
+};
+
+/*
+Generate RT calls to create task.  A task with depend clauses goes through
+__ompc_task_create_deps, which takes an extra (address, kind) array built
+in a local temp; the result is then a block holding the stores and the call.
 */
 static WN *
 Gen_Task_Create (ST *proc, BOOL is_blocking = FALSE)
 {
+  static INT count = 0;
   WN * wn;
   WN * wnx;
-  wn = WN_Create(OPC_VCALL, 6 );
-  WN_st_idx(wn) = GET_MPRUNTIME_ST(MPR_OMP_TASK_CREATE);
+  WN * block = NULL;
+  ST * deps = NULL;
+
+  if (depend_count > 0) {
+    INT64 psize = MTYPE_byte_size(Pointer_type);
+    TY_IDX pty = Be_Type_Tbl(Pointer_type);
+    INT slot = 0;
+
+    block = WN_CreateBlock ( );
+    deps = New_ST (CURRENT_SYMTAB);
+    ST_Init (deps,
+             Save_Str2i ( "__ompv_task_deps", "", count++ ),
+             CLASS_VAR,
+             SCLASS_AUTO,
+             EXPORT_LOCAL,
+             Make_Array_Type(Pointer_type, 1, 2 * depend_count));
+    Set_ST_addr_passed(deps);
+
+    for (wnx = depend_nodes; wnx; wnx = WN_next(wnx), slot += 2) {
+      INT kind = (WN_pragma(wnx) == WN_PRAGMA_IN) ? OMP_TASK_DEP_IN
+                                                  : OMP_TASK_DEP_OUT;
+      wn = WN_Stid(Pointer_type, slot * psize, deps, pty,
+                   WN_COPY_Tree(WN_kid0(wnx)));
+      WN_linenum(wn) = line_number;
+      WN_INSERT_BlockLast(block, wn);
+      wn = WN_Stid(Pointer_type, (slot + 1) * psize, deps, pty,
+                   WN_Intconst(Pointer_type, kind));
+      WN_linenum(wn) = line_number;
+      WN_INSERT_BlockLast(block, wn);
+    }
+
+    wn = WN_Create(OPC_VCALL, 8 );
+    WN_st_idx(wn) = GET_MPRUNTIME_ST(MPR_OMP_TASK_CREATE_DEPS);
+  } else {
+    wn = WN_Create(OPC_VCALL, 6 );
+    WN_st_idx(wn) = GET_MPRUNTIME_ST(MPR_OMP_TASK_CREATE);
+  }
 
   WN_Set_Call_Non_Data_Mod(wn);
   WN_Set_Call_Non_Data_Ref(wn);
@@ -1333,7 +1390,16 @@ Gen_Task_Create (ST *proc, BOOL is_blocking = FALSE)
   WN_kid(wn, 5) = WN_CreateParm(MTYPE_I4, WN_Intconst(MTYPE_I4, is_blocking),
       MTYPE_To_TY(MTYPE_I4), WN_PARM_BY_VALUE);
 
-  return wn;
+  if (deps == NULL)
+    return wn;
+
+  WN_kid(wn, 6) = WN_CreateParm(Pointer_type, WN_Lda(Pointer_type, 0, deps),
+      Be_Type_Tbl(Pointer_type), WN_PARM_BY_REFERENCE);
+  WN_kid(wn, 7) = WN_CreateParm(MTYPE_I4, WN_Intconst(MTYPE_I4, depend_count),
+      MTYPE_To_TY(MTYPE_I4), WN_PARM_BY_VALUE);
+
+  WN_INSERT_BlockLast(block, wn);
+  return block;
 }
 
 /*
@@ -7308,6 +7374,155 @@ MP_Reduction_Combine_Cycles(REDUCTION_LIST *rlist, BOOL *using_critical)
 }
 
 
+/*
+Reduction kinds understood by __ompc_reduce, must match omp_reduction_op_t
+and omp_reduction_type_t in libopenmp/omp_rtl.h.
+*/
+#define OMP_REDUCTION_TYPE_SHIFT 8
+
+enum {
+  OMP_REDUCTION_ADD = 0,
+  OMP_REDUCTION_MPY,
+  OMP_REDUCTION_MAX,
+  OMP_REDUCTION_MIN,
+  OMP_REDUCTION_BAND,
+  OMP_REDUCTION_BIOR,
+  OMP_REDUCTION_BXOR,
+  OMP_REDUCTION_LAND,
+  OMP_REDUCTION_LIOR,
+  OMP_REDUCTION_EQV,
+  OMP_REDUCTION_NEQV
+};
+
+enum {
+  OMP_REDUCTION_I4 = 0,
+  OMP_REDUCTION_I8,
+  OMP_REDUCTION_U4,
+  OMP_REDUCTION_U8,
+  OMP_REDUCTION_F4,
+  OMP_REDUCTION_F8
+};
+
+/*
+Return the __ompc_reduce kind of reduction variable v, or -1 if its final
+combine has to be generated inline under the reduction lock.
+*/
+static INT64
+Reduction_Runtime_Kind(VAR_TABLE *v)
+{
+  INT64 type, op;
+
+  if (v->vtype != VAR_REDUCTION_SCALAR ||
+      ST_class(v->orig_st) == CLASS_PREG ||
+      ST_class(v->new_st) == CLASS_PREG)
+    return -1;
+
+  switch (v->mtype) {
+  case MTYPE_I4: type = OMP_REDUCTION_I4; break;
+  case MTYPE_I8: type = OMP_REDUCTION_I8; break;
+  case MTYPE_U4: type = OMP_REDUCTION_U4; break;
+  case MTYPE_U8: type = OMP_REDUCTION_U8; break;
+  case MTYPE_F4: type = OMP_REDUCTION_F4; break;
+  case MTYPE_F8: type = OMP_REDUCTION_F8; break;
+  default: return -1;
+  }
+
+  switch (v->reduction_opr) {
+  case OPR_ADD:
+  case OPR_SUB:  op = OMP_REDUCTION_ADD; break;
+  case OPR_MPY:  op = OMP_REDUCTION_MPY; break;
+  case OPR_MAX:  op = OMP_REDUCTION_MAX; break;
+  case OPR_MIN:  op = OMP_REDUCTION_MIN; break;
+  case OPR_BAND: op = OMP_REDUCTION_BAND; break;
+  case OPR_BIOR: op = OMP_REDUCTION_BIOR; break;
+  case OPR_BXOR: op = OMP_REDUCTION_BXOR; break;
+  case OPR_LAND:
+  case OPR_CAND: op = OMP_REDUCTION_LAND; break;
+  case OPR_LIOR:
+  case OPR_CIOR: op = OMP_REDUCTION_LIOR; break;
+  case OPR_EQ:   op = OMP_REDUCTION_EQV; break;
+  case OPR_NE:   op = OMP_REDUCTION_NEQV; break;
+  default: return -1;
+  }
+
+  if (type >= OMP_REDUCTION_F4 &&
+      (op == OMP_REDUCTION_BAND || op == OMP_REDUCTION_BIOR ||
+       op == OMP_REDUCTION_BXOR))
+    return -1;
+
+  return (type << OMP_REDUCTION_TYPE_SHIFT) | op;
+}
+
+/*
+Generate the final combine of reductions whose variables all have a
+Reduction_Runtime_Kind: an array of {private address, shared address,
+kind} triples on the stack and a call to __ompc_reduce, which combines
+the partial results along a tree and ends with a barrier.
+*/
+static WN *
+Gen_Tree_Reduction(VAR_TABLE *var_table, INT num_vars, INT num_redns)
+{
+  static INT count = 0;
+  INT i, slot;
+  VAR_TABLE *v;
+  WN *block = WN_CreateBlock ( );
+  WN *wn;
+  INT64 psize = MTYPE_byte_size(Pointer_type);
+  TY_IDX pty = Be_Type_Tbl(Pointer_type);
+
+  ST *vars = New_ST (CURRENT_SYMTAB);
+  ST_Init (vars,
+           Save_Str2i ( "__ompv_reduction_vars", "", count++ ),
+           CLASS_VAR,
+           SCLASS_AUTO,
+           EXPORT_LOCAL,
+           Make_Array_Type(Pointer_type, 1, 3 * num_redns));
+  Set_ST_addr_passed(vars);
+
+  for (i = 0, slot = 0, v = var_table; i < num_vars; i++, v++) {
+    if (v->vtype != VAR_REDUCTION_SCALAR)
+      continue;
+
+    Set_ST_addr_passed(v->new_st);
+    Set_ST_addr_passed(v->orig_st);
+
+    wn = WN_Stid(Pointer_type, slot * psize, vars, pty,
+                 WN_Lda(Pointer_type, v->new_offset, v->new_st));
+    WN_linenum(wn) = line_number;
+    WN_INSERT_BlockLast(block, wn);
+    wn = WN_Stid(Pointer_type, (slot + 1) * psize, vars, pty,
+                 WN_Lda(Pointer_type, v->orig_offset, v->orig_st));
+    WN_linenum(wn) = line_number;
+    WN_INSERT_BlockLast(block, wn);
+    wn = WN_Stid(Pointer_type, (slot + 2) * psize, vars, pty,
+                 WN_Intconst(Pointer_type, Reduction_Runtime_Kind(v)));
+    WN_linenum(wn) = line_number;
+    WN_INSERT_BlockLast(block, wn);
+    slot += 3;
+  }
+
+  wn = WN_Create(OPC_VCALL, 3);
+  WN_st_idx(wn) = GET_MPRUNTIME_ST(MPR_OMP_REDUCE);
+
+  WN_Set_Call_Non_Data_Mod(wn);
+  WN_Set_Call_Non_Data_Ref(wn);
+  WN_Set_Call_Parm_Ref(wn);
+  WN_Set_Call_Parm_Mod(wn);
+  WN_linenum(wn) = line_number;
+
+  WN_kid(wn, 0) = WN_CreateParm( MTYPE_I4, Get_Gtid( local_gtid ),
+                     Be_Type_Tbl( MTYPE_I4 ), WN_PARM_BY_VALUE );
+  WN_kid(wn, 1) = WN_CreateParm( Pointer_type,
+                     WN_Lda( Pointer_type, 0, vars ),
+                     Be_Type_Tbl( Pointer_type ), WN_PARM_BY_REFERENCE );
+  WN_kid(wn, 2) = WN_CreateParm( MTYPE_I4,
+                     WN_Intconst( MTYPE_I4, num_redns ),
+                     Be_Type_Tbl( MTYPE_I4 ), WN_PARM_BY_VALUE );
+
+  WN_INSERT_BlockLast(block, wn);
+  return block;
+}
+
 /*
 Generate code blocks for initialization and final combine-and-store for all
 reductions in a parallel construct.  Should only be called if var_table
@@ -7321,6 +7536,10 @@ by using ATOMIC primitives. This is the case for SGI's origin/challenge,
 but for Itanium2, the cost of atomic is larger than critical section,
 so we always use critical section instead of atomic.
 csc.
+
+If every reduction is a scalar of a type and operator __ompc_reduce
+knows, the critical section is replaced by the runtime's combining tree,
+see Gen_Tree_Reduction.
 */
 static void
 Gen_MP_Reduction(VAR_TABLE *var_table, INT num_vars, WN **init_block,
@@ -7454,6 +7673,20 @@ Gen_MP_Reduction(VAR_TABLE *var_table, INT num_vars, WN **init_block,
 
   Is_True(num_redns > 0, ("no reductions!"));
 
+  BOOL use_tree = TRUE;
+  for (i = 0, v = var_table; i < num_vars && use_tree; i++, v++)
+    if ((v->vtype == VAR_REDUCTION_SCALAR ||
+         v->vtype == VAR_REDUCTION_ARRAY  ||
+         v->vtype == VAR_REDUCTION_ARRAY_OMP) &&
+        Reduction_Runtime_Kind(v) < 0)
+      use_tree = FALSE;
+
+  if (use_tree) {
+    WN_INSERT_BlockLast(*store_block,
+                        Gen_Tree_Reduction(var_table, num_vars, num_redns));
+    return;
+  }
+
   // count number of reductions we can do atomically
   BOOL lower_using_critical = FALSE;
   for (i = 0, v = var_table; i < num_vars; i++, v++)
@@ -12965,6 +13198,8 @@ lower_mp ( WN * block, WN * node, INT32 actions )
   copyin_nodes       = NULL;
   copyin_nodes_end   = NULL;
   if_node            = NULL;
+  depend_nodes       = NULL;
+  depend_count       = 0;
   lastlocal_nodes    = NULL;
   lastthread_node    = NULL;
   local_nodes        = NULL;
@@ -13500,6 +13735,13 @@ lower_mp ( WN * block, WN * node, INT32 actions )
           untied = TRUE;
           break;
 
+        case WN_PRAGMA_IN:
+        case WN_PRAGMA_OUT:
+          WN_next(cur_node) = depend_nodes;
+          depend_nodes = cur_node;
+          ++depend_count;
+          break;
+
         case WN_PRAGMA_COLLAPSE:
           collapse_count = WN_pragma_arg1(cur_node);
           break;
@@ -14242,6 +14484,12 @@ finish_processing:
   if (if_node)
     WN_DELETE_Tree ( if_node );
 
+  while (depend_nodes) {
+    next_node = WN_next(depend_nodes);
+    WN_DELETE_Tree ( depend_nodes );
+    depend_nodes = next_node;
+  }
+
   while (lastlocal_nodes) {
     next_node = WN_next(lastlocal_nodes);
     WN_Delete ( lastlocal_nodes );
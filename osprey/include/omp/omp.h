@@ -41,6 +41,14 @@
 typedef int omp_int_t;
 typedef double omp_wtime_t;
 
+typedef enum omp_proc_bind_t {
+  omp_proc_bind_false = 0,
+  omp_proc_bind_true = 1,
+  omp_proc_bind_master = 2,
+  omp_proc_bind_close = 3,
+  omp_proc_bind_spread = 4
+} omp_proc_bind_t;
+
 typedef void *omp_lock_t;
 typedef void *omp_nest_lock_t;
 
@@ -65,6 +73,17 @@ extern omp_int_t omp_get_dynamic(void);
 extern void omp_set_nested(omp_int_t nested);
 extern omp_int_t omp_get_nested(void);
 
+/*
+ * Thread Affinity Functions
+ */
+extern omp_proc_bind_t omp_get_proc_bind(void);
+extern omp_int_t omp_get_num_places(void);
+extern omp_int_t omp_get_place_num_procs(omp_int_t place_num);
+extern void omp_get_place_proc_ids(omp_int_t place_num, omp_int_t *ids);
+extern omp_int_t omp_get_place_num(void);
+extern omp_int_t omp_get_partition_num_places(void);
+extern void omp_get_partition_place_nums(omp_int_t *place_nums);
+
 /*
  * Lock Functions
  */
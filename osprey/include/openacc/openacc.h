@@ -1,3 +1,5 @@
+#include <stddef.h>
+
 
 typedef enum
 {
@@ -39,20 +41,20 @@ extern void __accr_setup(void);
 
 extern void __accr_cleanup(void);
 
-extern void __accr_malloc_on_device(void* pHost, void** pDevice, unsigned int size);
+extern void __accr_malloc_on_device(void* pHost, void** pDevice, size_t size, size_t offset);
 
 extern void __accr_free_on_device(void* pDevice);
 
 extern void __accr_memin_h2d(void* pHost, 
 							 void* pDevice, 
-							 unsigned int size, 
-							 unsigned int offset,
+							 size_t size, 
+							 size_t offset,
 							 int async_expr);
 
 extern void __accr_memout_d2h(void* pDevice, 
 							  void* pHost, 
-							  unsigned int size, 
-							  unsigned int offset,
+							  size_t size, 
+							  size_t offset,
 							  int async_expr);
 
 extern void __accr_init_param_list();
@@ -71,31 +73,31 @@ extern void __accr_clean_param_list();
 
 extern int __accr_get_device_addr(void* pHostAddr, 
 								   void** pDeviceAddr, 
-								   unsigned int istart, 
-								   unsigned int isize);
+								   size_t istart, 
+								   size_t isize);
 
 extern int __accr_present_create(void* pBuffer, 
-								 unsigned int start, 
-								 int length, 
-								 unsigned int size);
+								 size_t start, 
+								 size_t length, 
+								 size_t size);
 
 extern int __accr_device_addr_present(void* pDevice);
 
 extern void __accr_reduction_buff_malloc(void** pDevice, int type);
 
 extern void __accr_update_device_variable(void* pHost, 
-										  unsigned int offset, 
-										  unsigned int size,
+										  size_t offset, 
+										  size_t size,
 										  int async_expr);
 
 extern void __accr_update_host_variable(void* pHost, 
-										unsigned int offset, 
-										unsigned int size,
+										size_t offset, 
+										size_t size,
 										int async_expr);
 
-extern void __accr_update_device_variable_async(void* pHost, unsigned int offset, unsigned int size, int scalar_expr);
+extern void __accr_update_device_variable_async(void* pHost, size_t offset, size_t size, int scalar_expr);
 
-extern void __accr_update_host_variable_async(void* pHost, unsigned int offset, unsigned int size, int scalar_expr);
+extern void __accr_update_host_variable_async(void* pHost, size_t offset, size_t size, int scalar_expr);
 
 extern void __accr_wait_stream(int async_expr);
 
@@ -109,6 +111,10 @@ extern void acc_async_wait(int);
 
 extern void acc_async_wait_all(void);
 
+extern void acc_wait_async(int, int);
+
+extern void acc_wait_all_async(int);
+
 extern void __accr_set_gangs(int x, int y, int z);
 
 extern void __accr_set_vectors(int x, int y, int z);
@@ -152,7 +158,7 @@ extern void acc_init(acc_device_t);
 
 extern void acc_shutdown(acc_device_t);
 
-extern void* acc_malloc(unsigned int);
+extern void* acc_malloc(size_t);
 
 extern void acc_free(void*);
 
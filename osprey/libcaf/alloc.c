@@ -50,11 +50,35 @@ mem_usage_info_t *mem_info;
  * asymmetric data. It is the only handle to access the link-list.*/
 shared_memory_slot_t *common_slot;
 
+/* Empty slots other than the common slot are kept in free lists by size
+ * class, one set for the allocatable heap (above the common slot) and
+ * one for the asymmetric heap (below it). Size class c holds slots of
+ * 2^c to 2^(c+1)-1 bytes, and bit c of nonempty is set if its list is
+ * not empty. */
+#define NUM_SIZE_CLASSES    (8 * sizeof(unsigned long))
+
+/* only this many slots of the class of a request are tried before a
+ * larger class or the common slot is used */
+#define SIZE_CLASS_FIT_TRIES    8
+
+/* sizes are rounded up to keep every slot aligned to this */
+#define SLOT_ALIGNMENT      8
+
+typedef struct {
+    shared_memory_slot_t *free_list[NUM_SIZE_CLASSES];
+    unsigned long nonempty;
+} size_classes_t;
+
+static size_classes_t allocatable_free_slots;
+static size_classes_t asymmetric_free_slots;
+
+/* full slots by address, to find them in deallocation */
+static shared_memory_slot_t *allocatable_full_slots;
+static shared_memory_slot_t *asymmetric_full_slots;
+
 /* LOCAL FUNCTION DECLARATIONIS */
-static struct shared_memory_slot *find_empty_shared_memory_slot_above
-    (struct shared_memory_slot *slot, unsigned long var_size);
-static struct shared_memory_slot *find_empty_shared_memory_slot_below
-    (struct shared_memory_slot *slot, unsigned long var_size);
+static struct shared_memory_slot *find_empty_shared_memory_slot
+    (size_classes_t * classes, unsigned long var_size);
 static void *split_empty_shared_memory_slot_from_top
     (struct shared_memory_slot *slot, unsigned long var_size);
 static void *split_empty_shared_memory_slot_from_bottom
@@ -62,20 +86,10 @@ static void *split_empty_shared_memory_slot_from_bottom
 
 static void print_slots_below(struct shared_memory_slot *slot);
 
-static struct shared_memory_slot *find_shared_memory_slot_above
-    (struct shared_memory_slot *slot, void *address);
-static struct shared_memory_slot *find_shared_memory_slot_below
-    (struct shared_memory_slot *slot, void *address);
-
-static void join_3_shared_memory_slots(struct shared_memory_slot *slot);
-static void join_with_prev_shared_memory_slot
-    (struct shared_memory_slot *slot);
 static void join_with_next_shared_memory_slot
     (struct shared_memory_slot *slot);
 
 static void empty_shared_memory_slot(struct shared_memory_slot *slot);
-static void free_prev_slots_recursively(struct shared_memory_slot *slot);
-static void free_next_slots_recursively(struct shared_memory_slot *slot);
 
 
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -125,65 +139,179 @@ static void free_next_slots_recursively(struct shared_memory_slot *slot);
  * when a slot bordering common-slot is deallocated, the common-slot
  * grows.
  *
- * If there is no more space left in common slot, empty slots are used
- * from above for allocable coarrays or from below for asymmetric data.
+ * The other empty slots are kept in segregated free lists by size class,
+ * separately for each heap, and are reused before the common slot is
+ * consumed. Full slots are found by address in a hash table, so that
+ * deallocation takes constant time however many coarrays are allocated.
+ * So does allocation while a slot of a larger size class or the common
+ * slot fits; only when neither does, with the heap nearly full, are all
+ * the slots of the size class of the request searched. Since the
+ * allocatable heap only changes in collective allocations and
+ * deallocations, and its free lists are searched before the common slot,
+ * whose top does not move with asymmetric allocations, allocatable
+ * coarrays get the same address on every image.
  *
  * During exit, the function coarray_free_all_shared_memory_slots()
  * is used to free all nodes in the shared memory list.
  */
 
-/* Static function used to find empty memory slots while reserving
- * memory for allocatable coarrays */
-static struct shared_memory_slot *find_empty_shared_memory_slot_above
-    (struct shared_memory_slot *slot, unsigned long var_size) {
+static inline int size_class(unsigned long size)
+{
+    int c = 0;
+    while (size >>= 1)
+        c++;
+    return c;
+}
+
+/* the heap that an empty slot other than the common slot belongs to */
+static inline size_classes_t *slot_size_classes(struct shared_memory_slot
+                                                *slot)
+{
+    if (slot->addr < common_slot->addr)
+        return &allocatable_free_slots;
+    else
+        return &asymmetric_free_slots;
+}
+
+static void insert_free_shared_memory_slot(struct shared_memory_slot *slot)
+{
+    size_classes_t *classes = slot_size_classes(slot);
+    int c = size_class(slot->size);
+
+    slot->prev_free = 0;
+    slot->next_free = classes->free_list[c];
+    if (slot->next_free)
+        slot->next_free->prev_free = slot;
+    classes->free_list[c] = slot;
+    classes->nonempty |= 1UL << c;
+
+    if (mem_info) {
+        mem_info->free_slots++;
+        mem_info->free_slots_size += slot->size;
+    }
+}
+
+static void remove_free_shared_memory_slot(struct shared_memory_slot *slot)
+{
+    size_classes_t *classes = slot_size_classes(slot);
+    int c = size_class(slot->size);
+
+    if (slot->prev_free)
+        slot->prev_free->next_free = slot->next_free;
+    else
+        classes->free_list[c] = slot->next_free;
+    if (slot->next_free)
+        slot->next_free->prev_free = slot->prev_free;
+    if (classes->free_list[c] == 0)
+        classes->nonempty &= ~(1UL << c);
+
+    if (mem_info) {
+        mem_info->free_slots--;
+        mem_info->free_slots_size -= slot->size;
+    }
+}
+
+/* Static function used to find an empty memory slot of at least var_size
+ * bytes in the free lists of a heap. The first few slots of the size
+ * class of var_size are tried, then the first slot of the next larger
+ * non-empty class, which always fits. Returns 0 if none was found. */
+static struct shared_memory_slot *find_empty_shared_memory_slot
+    (size_classes_t * classes, unsigned long var_size) {
+    struct shared_memory_slot *slot;
+    unsigned long larger;
+    int c, tries;
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
-    while (slot) {
-        if (slot->feb == 0 && slot->size >= var_size) {
+
+    c = size_class(var_size);
+    slot = classes->free_list[c];
+    for (tries = 0; slot && tries < SIZE_CLASS_FIT_TRIES; tries++) {
+        if (slot->size >= var_size) {
             LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
             return slot;
         }
-        slot = slot->prev;
+        slot = slot->next_free;
+    }
+
+    larger = c + 1 < NUM_SIZE_CLASSES ? classes->nonempty >> (c + 1) : 0;
+    if (larger) {
+        c++;
+        while (!(larger & 1)) {
+            larger >>= 1;
+            c++;
+        }
+        LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+        return classes->free_list[c];
     }
 
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
     return 0;
 }
 
-/* Static function used to find empty memory slots while reserving
- * memory for assymetric coarrays */
-static struct shared_memory_slot *find_empty_shared_memory_slot_below
-    (struct shared_memory_slot *slot, unsigned long var_size) {
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
-    while (slot) {
-        if (slot->feb == 0 && slot->size >= var_size) {
-            LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+/* Finds the empty slot to allocate var_size bytes from in a heap: a
+ * free slot, else the common slot, else any free slot of the size class
+ * of var_size that is large enough. The last step is linear in the
+ * length of that class's list. Returns 0 if there is none. */
+static struct shared_memory_slot *find_empty_shared_memory_slot_in_heap
+    (size_classes_t * classes, unsigned long var_size) {
+    struct shared_memory_slot *slot;
+
+    slot = find_empty_shared_memory_slot(classes, var_size);
+    if (slot)
+        return slot;
+
+    if (common_slot->size >= var_size)
+        return common_slot;
+
+    for (slot = classes->free_list[size_class(var_size)]; slot;
+         slot = slot->next_free) {
+        if (slot->size >= var_size)
             return slot;
-        }
-        slot = slot->next;
     }
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
     return 0;
 }
 
-
 /* Static function used to reserve top part of an empty memory slot
  * for allocatable coarrays. Returns the memory address allocated */
 static void *split_empty_shared_memory_slot_from_top
     (struct shared_memory_slot *slot, unsigned long var_size) {
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
     struct shared_memory_slot *new_empty_slot;
-    new_empty_slot = (struct shared_memory_slot *) malloc
-        (sizeof(struct shared_memory_slot));
-    new_empty_slot->addr = slot->addr + var_size;
-    new_empty_slot->size = slot->size - var_size;
-    new_empty_slot->feb = 0;
-    new_empty_slot->next = slot->next;
-    new_empty_slot->prev = slot;
-    slot->size = var_size;
-    slot->feb = 1;
-    slot->next = new_empty_slot;
-    if (common_slot == slot)
+
+    if (slot != common_slot)
+        remove_free_shared_memory_slot(slot);
+
+    if (slot->size > var_size) {
+        new_empty_slot = (struct shared_memory_slot *) malloc
+            (sizeof(struct shared_memory_slot));
+        new_empty_slot->addr = slot->addr + var_size;
+        new_empty_slot->size = slot->size - var_size;
+        new_empty_slot->feb = 0;
+        new_empty_slot->next = slot->next;
+        new_empty_slot->prev = slot;
+        if (slot->next)
+            slot->next->prev = new_empty_slot;
+        slot->size = var_size;
+        slot->next = new_empty_slot;
+        if (common_slot == slot)
+            common_slot = new_empty_slot;
+        else
+            insert_free_shared_memory_slot(new_empty_slot);
+    } else if (common_slot == slot) {
+        /* the common slot is used up; it stays in the list empty */
+        new_empty_slot = (struct shared_memory_slot *) malloc
+            (sizeof(struct shared_memory_slot));
+        new_empty_slot->addr = slot->addr + var_size;
+        new_empty_slot->size = 0;
+        new_empty_slot->feb = 0;
+        new_empty_slot->next = slot->next;
+        new_empty_slot->prev = slot;
+        if (slot->next)
+            slot->next->prev = new_empty_slot;
+        slot->next = new_empty_slot;
         common_slot = new_empty_slot;
+    }
+    slot->feb = 1;
+    HASH_ADD_PTR(allocatable_full_slots, addr, slot);
 
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
     return slot->addr;
@@ -195,6 +323,17 @@ static void *split_empty_shared_memory_slot_from_bottom
     (struct shared_memory_slot *slot, unsigned long var_size) {
     struct shared_memory_slot *new_full_slot;
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
+
+    if (slot != common_slot) {
+        remove_free_shared_memory_slot(slot);
+        if (slot->size == var_size) {
+            slot->feb = 1;
+            HASH_ADD_PTR(asymmetric_full_slots, addr, slot);
+            LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+            return slot->addr;
+        }
+    }
+
     new_full_slot = (struct shared_memory_slot *) malloc
         (sizeof(struct shared_memory_slot));
     new_full_slot->addr = slot->addr + slot->size - var_size;
@@ -209,44 +348,56 @@ static void *split_empty_shared_memory_slot_from_bottom
 
     slot->next = new_full_slot;
 
+    if (slot != common_slot)
+        insert_free_shared_memory_slot(slot);
+    HASH_ADD_PTR(asymmetric_full_slots, addr, new_full_slot);
+
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
     return new_full_slot->addr;
 }
 
+static inline unsigned long aligned_slot_size(unsigned long var_size)
+{
+    if (var_size == 0)
+        return SLOT_ALIGNMENT;
+    return (var_size + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1UL);
+}
+
+static inline void add_heap_usage(unsigned long var_size)
+{
+    if (mem_info) {
+        size_t current_size = mem_info->current_heap_usage + var_size;
+        mem_info->current_heap_usage = current_size;
+        if (mem_info->max_heap_usage < current_size)
+            mem_info->max_heap_usage = current_size;
+    }
+}
+
 /* Memory allocation function for allocatable coarrays. It is invoked
  * from fortran allocation function _ALLOCATE in
  * osprey/libf/fort/allocation.c
- * It finds empty slot from the shared memory list (common_slot & above)
- * and then splits the slot from top
+ * It finds an empty slot in the free lists of the allocatable heap or
+ * the common slot, and then splits the slot from top
  * Note: there is barrier as it is a collective operation*/
 void *coarray_allocatable_allocate_(unsigned long var_size)
 {
     struct shared_memory_slot *empty_slot;
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
 
-    empty_slot = find_empty_shared_memory_slot_above(common_slot,
-                                                     var_size);
+    var_size = aligned_slot_size(var_size);
+    empty_slot = find_empty_shared_memory_slot_in_heap
+        (&allocatable_free_slots, var_size);
     if (empty_slot == 0)
         Error
             ("No more shared memory space available for allocatable coarray. "
              "Set environment variable %s or cafrun option for more space.",
              ENV_IMAGE_HEAP_SIZE);
 
-    if (mem_info) {
-        size_t current_size = mem_info->current_heap_usage + var_size;
-        mem_info->current_heap_usage = current_size;
-        if (mem_info->max_heap_usage < current_size)
-            mem_info->max_heap_usage = current_size;
-    }
+    add_heap_usage(var_size);
+
     // implicit barrier in case of allocatable.
     CALLSITE_TIMED_TRACE(SYNC, SYNC, comm_barrier_all);
 
-    if (empty_slot != common_slot && empty_slot->size == var_size) {
-        empty_slot->feb = 1;
-        LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
-        return empty_slot->addr;
-    }
-
     void *retval =
         split_empty_shared_memory_slot_from_top(empty_slot, var_size);
 
@@ -257,34 +408,24 @@ void *coarray_allocatable_allocate_(unsigned long var_size)
 /* Memory allocation function for asymmetric data. It is invoked
  * from fortran allocation function _ALLOCATE in
  * osprey/libf/fort/allocation.c
- * It finds empty slot from the shared memory list (common_slot & below)
- * and then splits the slot from bottom */
+ * It finds an empty slot in the free lists of the asymmetric heap or
+ * the common slot, and then splits the slot from bottom */
 void *coarray_asymmetric_allocate_(unsigned long var_size)
 {
     struct shared_memory_slot *empty_slot;
 
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
 
-
-    empty_slot = find_empty_shared_memory_slot_below(common_slot,
-                                                     var_size);
+    var_size = aligned_slot_size(var_size);
+    empty_slot = find_empty_shared_memory_slot_in_heap
+        (&asymmetric_free_slots, var_size);
     if (empty_slot == 0)
         Error("No more shared memory space available for asymmetric data. "
               "Set environment variable %s or cafrun option for more space.",
               ENV_IMAGE_HEAP_SIZE);
 
-
     /* update heap usage info */
-    size_t current_size = mem_info->current_heap_usage + var_size;
-    mem_info->current_heap_usage = current_size;
-    if (mem_info->max_heap_usage < current_size)
-        mem_info->max_heap_usage = current_size;
-
-    if (empty_slot != common_slot && empty_slot->size == var_size) {
-        empty_slot->feb = 1;
-        LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
-        return empty_slot->addr;
-    }
+    add_heap_usage(var_size);
 
     void *retval = split_empty_shared_memory_slot_from_bottom(empty_slot,
                                                               var_size);
@@ -297,32 +438,24 @@ void *coarray_asymmetric_allocate_(unsigned long var_size)
 /* Memory allocation function for asymmetric data. It is invoked
  * from fortran allocation function _ALLOCATE in
  * osprey/libf/fort/allocation.c
- * It finds empty slot from the shared memory list (common_slot & below)
- * and then splits the slot from bottom */
+ * Same as coarray_asymmetric_allocate_, but returns 0 if there is no
+ * space left */
 void *coarray_asymmetric_allocate_if_possible_(unsigned long var_size)
 {
     struct shared_memory_slot *empty_slot;
 
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
 
-
-    empty_slot = find_empty_shared_memory_slot_below(common_slot,
-                                                     var_size);
+    var_size = aligned_slot_size(var_size);
+    empty_slot = find_empty_shared_memory_slot_in_heap
+        (&asymmetric_free_slots, var_size);
     if (empty_slot == 0) {
         LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "Couldn't find empty slot.");
         return 0;
     }
 
     /* update heap usage info */
-    size_t current_size = mem_info->current_heap_usage + var_size;
-    mem_info->current_heap_usage = current_size;
-    if (mem_info->max_heap_usage < current_size)
-        mem_info->max_heap_usage = current_size;
-
-    if (empty_slot != common_slot && empty_slot->size == var_size) {
-        empty_slot->feb = 1;
-        return empty_slot->addr;
-    }
+    add_heap_usage(var_size);
 
     void *retval = split_empty_shared_memory_slot_from_bottom(empty_slot,
                                                               var_size);
@@ -332,80 +465,6 @@ void *coarray_asymmetric_allocate_if_possible_(unsigned long var_size)
     return retval;
 }
 
-/* Static function called from coarray_deallocate.
- * It finds the slot with the address (passed in param) by searching
- * the shared memory link-list starting from the slot(passed in param)
- * and above it. Used for finding slots containing allocatable coarrays*/
-static struct shared_memory_slot *find_shared_memory_slot_above
-    (struct shared_memory_slot *slot, void *address) {
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
-
-    while (slot) {
-        if (slot->feb == 1 && slot->addr == address)
-            return slot;
-        slot = slot->prev;
-    }
-
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
-    return 0;
-}
-
-/* Static function called from coarray_deallocate.
- * It finds the slot with the address (passed in param) by searching
- * the shared memory link-list starting from the slot(passed in param)
- * and below it. Used for finding slots containing asymmetric data*/
-static struct shared_memory_slot *find_shared_memory_slot_below
-    (struct shared_memory_slot *slot, void *address) {
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
-
-    while (slot) {
-        if (slot->feb == 1 && slot->addr == address)
-            return slot;
-        slot = slot->next;
-    }
-
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
-    return 0;
-}
-
-/* Static function called from empty_shared_memory_slot (used in dealloc).
- * Merge slot with the slot above & below it. If any of these slots is the
- * common-slot, the common-slot points to the merged slot */
-static void join_3_shared_memory_slots(struct shared_memory_slot *slot)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
-
-    slot->prev->size = slot->prev->size + slot->size + slot->next->size;
-    slot->prev->next = slot->next->next;
-    if (slot->next->next)
-        slot->next->next->prev = slot->prev;
-    if (common_slot == slot || common_slot == slot->next)
-        common_slot = slot->prev;
-    comm_free(slot->next);
-    comm_free(slot);
-
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
-}
-
-/* Static function called from empty_shared_memory_slot (used in dealloc).
- * Merge slot with the slot above it. If any of these slots is the
- * common-slot, the common-slot points to the merged slot */
-static void join_with_prev_shared_memory_slot(struct shared_memory_slot
-                                              *slot)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
-
-    slot->prev->size += slot->size;
-    slot->prev->next = slot->next;
-    if (slot->next)
-        slot->next->prev = slot->prev;
-    if (common_slot == slot)
-        common_slot = slot->prev;
-    comm_free(slot);
-
-    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
-}
-
 /* Static function called from empty_shared_memory_slot (used in dealloc).
  * Merge slot with the slot below it. If any of these slots is the
  * common-slot, the common-slot points to the merged slot */
@@ -430,19 +489,27 @@ static void join_with_next_shared_memory_slot(struct shared_memory_slot
 /* Static function called from coarray_deallocate.
  * Empties the slot passed in parameter:
  * 1) set full-empty-bit to 0
- * 2) merge the slot with neighboring empty slots (if found) */
+ * 2) merge the slot with neighboring empty slots (if found), taking them
+ *    out of their free lists
+ * 3) put the result in the free lists, unless it is the common slot */
 static void empty_shared_memory_slot(struct shared_memory_slot *slot)
 {
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
 
     slot->feb = 0;
-    if (slot->prev && (slot->prev->feb == 0) && slot->next
-        && (slot->next->feb == 0))
-        join_3_shared_memory_slots(slot);
-    else if (slot->prev && (slot->prev->feb == 0))
-        join_with_prev_shared_memory_slot(slot);
-    else if (slot->next && (slot->next->feb == 0))
+    if (slot->prev && slot->prev->feb == 0) {
+        if (slot->prev != common_slot)
+            remove_free_shared_memory_slot(slot->prev);
+        slot = slot->prev;
+        join_with_next_shared_memory_slot(slot);
+    }
+    if (slot->next && slot->next->feb == 0) {
+        if (slot->next != common_slot)
+            remove_free_shared_memory_slot(slot->next);
         join_with_next_shared_memory_slot(slot);
+    }
+    if (slot != common_slot)
+        insert_free_shared_memory_slot(slot);
 
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
 }
@@ -450,7 +517,7 @@ static void empty_shared_memory_slot(struct shared_memory_slot *slot)
 /* Memory deallocation function for allocatable coarrays and asymmetric
  * data. It is invoked from fortran allocation function _DEALLOCATE in
  * osprey/libf/fort/allocation.c
- * It finds the slot from the shared memory list, set full-empty-bit to 0,
+ * It finds the slot by its address, set full-empty-bit to 0,
  * and then merge the slot with neighboring empty slots (if found)
  * Note: there is implicit barrier for allocatable coarrays*/
 void coarray_deallocate_(void *var_address)
@@ -459,12 +526,16 @@ void coarray_deallocate_(void *var_address)
 
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
 
-    slot = find_shared_memory_slot_above(common_slot, var_address);
+    HASH_FIND_PTR(allocatable_full_slots, &var_address, slot);
     if (slot) {
+        HASH_DEL(allocatable_full_slots, slot);
         // implicit barrier for allocatable
         CALLSITE_TIMED_TRACE(SYNC, SYNC, comm_barrier_all);
-    } else
-        slot = find_shared_memory_slot_below(common_slot, var_address);
+    } else {
+        HASH_FIND_PTR(asymmetric_full_slots, &var_address, slot);
+        if (slot)
+            HASH_DEL(asymmetric_full_slots, slot);
+    }
     if (slot == 0) {
         LIBCAF_TRACE(LIBCAF_LOG_NOTICE, "Address%p not coarray.",
                      var_address);
@@ -485,12 +556,13 @@ void coarray_asymmetric_deallocate_(void *var_address)
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
 
 
-    slot = find_shared_memory_slot_below(common_slot, var_address);
+    HASH_FIND_PTR(asymmetric_full_slots, &var_address, slot);
     if (slot == 0) {
         LIBCAF_TRACE(LIBCAF_LOG_NOTICE, "Address%p not coarray.",
                      var_address);
         return;
     }
+    HASH_DEL(asymmetric_full_slots, slot);
 
     /* update heap usage info if MEMORY_SUMMARY trace is enabled */
     mem_info->current_heap_usage -= slot->size;
@@ -500,43 +572,34 @@ void coarray_asymmetric_deallocate_(void *var_address)
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
 }
 
-/* Static function called from coarray_free_all_shared_memory_slots()
- * during exit from program.
- * It recursively frees slots in the shared memory link-list starting
- * from slot passed in param and all slots above(previous) it. */
-static void free_prev_slots_recursively(struct shared_memory_slot *slot)
-{
-    if (slot) {
-        free_prev_slots_recursively(slot->prev);
-        comm_free(slot);
-    }
-}
-
-/* Static function called from coarray_free_all_shared_memory_slots()
- * during exit from program.
- * It recursively frees slots in the shared memory link-list starting
- * from slot passed in param and all slots below(next) it. */
-static void free_next_slots_recursively(struct shared_memory_slot *slot)
-{
-    if (slot) {
-        free_next_slots_recursively(slot->next);
-        comm_free(slot);
-    }
-}
-
 /* Function to delete the shared memory link-list.
  * Called during exit from comm_exit in armci_comm_layer.c or
  * gasnet_comm_layer.c.
  */
 void coarray_free_all_shared_memory_slots()
 {
+    struct shared_memory_slot *slot, *next;
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
 
-    free_prev_slots_recursively(common_slot->prev);
-    free_next_slots_recursively(common_slot);
+    HASH_CLEAR(hh, allocatable_full_slots);
+    HASH_CLEAR(hh, asymmetric_full_slots);
+    memset(&allocatable_free_slots, 0, sizeof(allocatable_free_slots));
+    memset(&asymmetric_free_slots, 0, sizeof(asymmetric_free_slots));
+
+    slot = common_slot;
+    while (slot->prev)
+        slot = slot->prev;
+    while (slot) {
+        next = slot->next;
+        comm_free(slot);
+        slot = next;
+    }
+    common_slot = 0;
 
     /* update heap usage info */
     mem_info->current_heap_usage = 0;
+    mem_info->free_slots = 0;
+    mem_info->free_slots_size = 0;
 
     LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
 }
@@ -33,6 +33,7 @@
 #include <ctype.h>
 #include "lock.h"
 #include "dopevec.h"
+#include "uthash.h"
 
 /* SHARED MEMORY MANAGEMENT */
 struct shared_memory_slot {
@@ -41,6 +42,11 @@ struct shared_memory_slot {
     unsigned short feb;         //full empty bit. 1=full
     struct shared_memory_slot *next;
     struct shared_memory_slot *prev;
+    /* free list of the size class of an empty slot */
+    struct shared_memory_slot *next_free;
+    struct shared_memory_slot *prev_free;
+    /* table of full slots by address */
+    UT_hash_handle hh;
 };
 typedef struct shared_memory_slot shared_memory_slot_t;
 
@@ -49,6 +55,9 @@ typedef struct {
     size_t current_heap_usage;
     size_t max_heap_usage;
     size_t reserved_heap_usage;
+    /* empty slots outside the common slot, i.e. fragmentation */
+    size_t free_slots;
+    size_t free_slots_size;
 } mem_usage_info_t;
 
 /* SHARED MEMORY MANAGEMENT */
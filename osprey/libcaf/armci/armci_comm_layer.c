@@ -498,6 +498,8 @@ void comm_init()
     mem_info->max_heap_usage = sizeof(*mem_info);
     mem_info->reserved_heap_usage =
         caf_shared_memory_size - static_symm_data_total_size;
+    mem_info->free_slots = 0;
+    mem_info->free_slots_size = 0;
 
     /* allocate space for recording image termination */
     stopped_image_exists =
@@ -0,0 +1,14 @@
+#!/bin/sh
+#
+# Runs the allocator benchmark with more and more live blocks, e.g.
+#   ./run.sh 4 100000
+# for 4 images and 100000 operations per run.
+# alloc_bench has to be built first (see README).
+
+images=${1:-4}
+nops=${2:-100000}
+
+for live in 100 1000 10000 100000
+do
+  cafrun -n $images ./alloc_bench $live $nops
+done
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Checks the collectives on 1, 3 and 6 images, then runs the benchmark on
+# 1, 2, 3, 4, 6, 8, 12, ... images, e.g.
+#   ./run.sh 16 100
+# for up to 16 images and 100 repetitions per collective.
+# coll_check and coll_bench have to be built first (see README).
+
+images=${1:-8}
+reps=${2:-100}
+
+# once as configured, once with reduce-scatter for every array
+for n in 1 3 6
+do
+  cafrun -n $n ./coll_check || exit 1
+  UHCAF_CO_REDUCE_SCATTER_MIN=1 cafrun -n $n ./coll_check || exit 1
+done
+
+n=1
+while [ $n -le $images ]
+do
+  cafrun -n $n ./coll_bench $reps
+  m=`expr $n \* 3 / 2`
+  if [ $n -ge 2 -a $m -le $images ]; then
+    cafrun -n $m ./coll_bench $reps
+  fi
+  n=`expr $n \* 2`
+done
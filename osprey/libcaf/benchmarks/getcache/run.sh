@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Runs the get-cache benchmark without the cache, with a single line per
+# image as the cache used to have, with the default 4 ways, and with
+# prefetching, e.g.
+#   ./run.sh 2 65536 10
+# for 2 images, 65536 doubles and 10 repetitions.
+# getcache_bench has to be built first (see README).
+
+images=${1:-2}
+n=${2:-65536}
+reps=${3:-10}
+
+export UHCAF_GETCACHE_STATS=1
+
+echo "no get-cache"
+UHCAF_GETCACHE=0 cafrun -n $images ./getcache_bench $n $reps
+
+echo "1 set, 1 way"
+UHCAF_GETCACHE=1 UHCAF_GETCACHE_SETS=1 UHCAF_GETCACHE_WAYS=1 \
+  cafrun -n $images ./getcache_bench $n $reps
+
+echo "1 set, 4 ways"
+UHCAF_GETCACHE=1 cafrun -n $images ./getcache_bench $n $reps
+
+echo "1 set, 4 ways, prefetch"
+UHCAF_GETCACHE=1 UHCAF_GETCACHE_PREFETCH=1 \
+  cafrun -n $images ./getcache_bench $n $reps
@@ -0,0 +1,22 @@
+#!/bin/sh
+#
+# Runs the halo exchange benchmark with every put sent on its own, and
+# with small puts combined per image at the default and at a larger
+# buffer size, e.g.
+#   ./run.sh 4 1024 100
+# for 4 images, 1024 x 1024 doubles and 100 iterations.
+# halo_bench has to be built first (see README).
+
+images=${1:-4}
+n=${2:-1024}
+iters=${3:-100}
+
+echo "no put combining"
+UHCAF_PUT_COMBINE=0 cafrun -n $images ./halo_bench $n $iters
+
+echo "put combining, 4KB buffer"
+UHCAF_PUT_COMBINE=1 cafrun -n $images ./halo_bench $n $iters
+
+echo "put combining, 16KB buffer"
+UHCAF_PUT_COMBINE=1 UHCAF_PUT_COMBINE_BUFFER_SIZE=16384 \
+  cafrun -n $images ./halo_bench $n $iters
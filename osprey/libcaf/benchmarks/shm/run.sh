@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# Runs the shm smoke test on 1 image and on the given number of images,
+# e.g.
+#   ./run.sh 4
+# then has one image do error stop 7 on as many images, which must end
+# the whole run with exit status 7. shm_smoke has to be built first (see
+# README).
+
+images=${1:-4}
+status=0
+
+for n in 1 $images
+do
+  cafrun -n $n ./shm_smoke || status=1
+done
+
+for n in 1 $images
+do
+  timeout 60 cafrun -n $n ./shm_smoke error_stop
+  code=$?
+  if [ $code -ne 7 ]; then
+    echo "error stop on $n images: exit status $code, expected 7"
+    status=1
+  else
+    echo "error stop on $n images: exit status 7"
+  fi
+done
+
+exit $status
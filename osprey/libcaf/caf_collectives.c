@@ -28,9 +28,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
 #include <string.h>
-#include <assert.h>
 
 #include "dopevec.h"
 
@@ -39,6 +37,7 @@
 
 #include "comm.h"
 #include "alloc.h"
+#include "env.h"
 #include "util.h"
 #include "trace.h"
 
@@ -46,1036 +45,621 @@
 extern unsigned long _this_image;
 extern unsigned long _num_images;
 
-#define WORD_SIZE 4
-
-#define USE_CAF_IMPLEMENTATION
-
-#define CAF_CO_(op, type, ndim) \
-    switch (ndim) { \
-        case 0: co_##op##_##type##_##0__(source,result);break;\
-        case 1: co_##op##_##type##_##1__(source,result);break;\
-        case 2: co_##op##_##type##_##2__(source,result);break;\
-        case 3: co_##op##_##type##_##3__(source,result);break;\
-        case 4: co_##op##_##type##_##4__(source,result);break;\
-        case 5: co_##op##_##type##_##5__(source,result);break;\
-        case 6: co_##op##_##type##_##6__(source,result);break;\
-        case 7: co_##op##_##type##_##7__(source,result);break;\
-        default: Error("rank > 7 not supported");\
-    }
+/*
+ * The collectives run on a work buffer in the symmetric heap, so that
+ * every image can read the partial results of the others. Images pair up
+ * in log2(num_images) steps; in each step both partners sync, read what
+ * they need from each other and sync again, so that neither one changes
+ * its buffer while the other is still reading it.
+ *
+ * Reductions are done by recursive doubling, or for large arrays by a
+ * reduce-scatter (recursive halving) followed by an allgather (recursive
+ * doubling). Either way, every image combines the same partial results
+ * in the same grouping, so that all images end up with the same
+ * results. Images beyond the largest power of two first fold their
+ * contribution into a partner and get the result from it at the end.
+ *
+ * Broadcasts and reductions to a single image use a binomial tree.
+ */
+
+/* layout of a (possibly strided) array as count/strides arguments for
+ * __coarray_strided_read: count[0] is the number of contiguous bytes */
+typedef struct {
+    char *base;
+    size_t elem_size;
+    size_t nelem;
+    int stride_levels;
+    size_t count[MAXDIM + 1];
+    size_t strides[MAXDIM];
+} co_array_t;
 
-/* CO_BCAST */
+/* symmetric work buffer, only ever grows */
+static char *co_work = NULL;
+static size_t co_work_size = 0;
 
-void _CO_BCAST_I1(DopeVectorType * source, INTEGER1 * src_img_p)
-{
-    INTEGER8 s_image = *src_img_p;
-    INTEGER8 *s_image_p = &s_image;
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "calling _CO_BCAST_I8");
-    _CO_BCAST_I8(source, s_image_p);
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "completed _CO_BCAST_I8");
-}
+/* arrays of at least this many bytes are reduced with reduce-scatter and
+ * allgather */
+static long co_reduce_scatter_min = -1;
 
-void _CO_BCAST_I2(DopeVectorType * source, INTEGER2 * src_img_p)
-{
-    INTEGER8 s_image = *src_img_p;
-    INTEGER8 *s_image_p = &s_image;
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "calling _CO_BCAST_I8");
-    _CO_BCAST_I8(source, s_image_p);
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "completed _CO_BCAST_I8");
-}
+static void co_array_from_dv(co_array_t * a, DopeVectorType * dv);
+static void co_array_from_scalar(co_array_t * a, void *addr,
+                                 size_t elem_size);
+static void co_pack(const co_array_t * a, char *buf);
+static void co_unpack(const char *buf, const co_array_t * a);
+static void co_sync_with(int image);
+static void co_get_work_buffer(size_t nbytes);
+static void co_bcast(co_array_t * source, int root);
+static void co_reduce(co_array_t * source, co_array_t * result,
+                      int result_image, co_reduce_op_t op);
 
-void _CO_BCAST_I4(DopeVectorType * source, INTEGER4 * src_img_p)
+/* largest power of two <= n */
+static inline int co_pof2(int n)
 {
-    INTEGER8 s_image = *src_img_p;
-    INTEGER8 *s_image_p = &s_image;
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "calling _CO_BCAST_I8");
-    _CO_BCAST_I8(source, s_image_p);
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "completed _CO_BCAST_I8");
+    int p = 1;
+    while (2 * p <= n)
+        p *= 2;
+    return p;
 }
 
-/* currently using a naive linear broadcast algorithm */
-void _CO_BCAST_I8(DopeVectorType * source, INTEGER8 * src_img_p)
-{
-    void *dest, *src;
-    size_t dest_strides[7], src_strides[7], count[8];
-    int stride_levels;
-    long int n_dim = source->n_dim;
-    long int elem_size;
-    INTEGER8 source_image = *src_img_p;
 
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE,
-                 "source = %p, *src_img_p = %lu", source, *src_img_p);
+/**************************************************************
+ *                  Array layout and packing
+ **************************************************************/
 
-    if (source->type_lens.type == DVTYPE_ASCII) {
-        elem_size = source->base_addr.charptr.byte_len;
+static void co_array_from_dv(co_array_t * a, DopeVectorType * dv)
+{
+    int i;
+    size_t scale;
+    int n_dim = dv->n_dim;
+
+    if (dv->type_lens.type == DVTYPE_ASCII) {
+        a->elem_size = dv->base_addr.charptr.byte_len;
     } else {
-        elem_size = source->base_addr.a.el_len >> 3;
+        a->elem_size = dv->base_addr.a.el_len >> 3;
     }
 
-    if (_this_image == source_image) {
-        int i;
-        int k = 0;
-        /* is source */
-        dest = src = source->base_addr.a.ptr;
-
-        /* check if first dimension is strided */
-        if (n_dim > 0) {
-            int first_stride = 1;
-            if (source->type_lens.type == DVTYPE_ASCII ||
-                source->type_lens.type == DVTYPE_DERIVEDBYTE) {
-                /* first dim is strided if the first stride multipler /
-                 * elem_size is greater than 1 */
-                first_stride =
-                    source->dimension[0].stride_mult / elem_size;
-            } else if (elem_size > WORD_SIZE) {
-                first_stride = source->dimension[0].stride_mult /
-                    (elem_size / WORD_SIZE);
-            } else {
-                first_stride = source->dimension[0].stride_mult;
-            }
-
-            if (first_stride > 1) {
-                k = 1;
-                count[0] = elem_size;
-                count[1] = source->dimension[0].extent;
-                src_strides[0] = elem_size * first_stride;
-                dest_strides[0] = elem_size * first_stride;
-            } else {
-                k = 0;
-                count[0] = elem_size * source->dimension[0].extent;
-            }
-        } else {
-            count[0] = elem_size;
-        }
-
-        stride_levels = n_dim - 1 + k;
-        for (i = 0; i < stride_levels; i++) {
-            count[i + 1 + k] = source->dimension[i + 1].extent;
-            src_strides[i + k] = source->dimension[i + k].stride_mult;
-            dest_strides[i + k] = source->dimension[i + k].stride_mult;
-        }
-        for (i = 1; i <= _num_images; i++) {
-            if (_this_image != i) {
-                /* non-blocking would make sense here */
-                if (stride_levels > 0) {
-                    __coarray_strided_write(i, dest, dest_strides,
-                                            src, src_strides, count,
-                                            stride_levels, 0, NULL);
-                } else {
-                    __coarray_write(i, dest, src, count[0], 0, NULL);
-                }
-
-            }
-        }
-        _SYNC_IMAGES_ALL(NULL, 0, NULL, 0);
+    /* stride_mult counts bytes for characters and byte-sized derived
+     * types, and SMSCALE units for everything else */
+    if (dv->type_lens.type == DVTYPE_ASCII ||
+        dv->type_lens.type == DVTYPE_DERIVEDBYTE) {
+        scale = 1;
     } else {
-        /* is destination */
-
-        if (source_image < 1 || source_image > _num_images) {
-            LIBCAF_TRACE(LIBCAF_LOG_FATAL,
-                         "CO_BCAST called with invalid source_image.");
+        scale = SMSCALE(dv);
+    }
+    a->base = dv->base_addr.a.ptr;
+
+    a->nelem = 1;
+    a->stride_levels = 0;
+    a->count[0] = a->elem_size;
+    for (i = 0; i < n_dim; i++) {
+        size_t extent = dv->dimension[i].extent;
+        size_t stride = dv->dimension[i].stride_mult * scale;
+        int l = a->stride_levels;
+
+        a->nelem *= extent;
+
+        /* merge the dimension into the one below when it continues it */
+        if (l == 0 && stride == a->count[0]) {
+            a->count[0] *= extent;
+        } else if (l > 0 && stride == a->strides[l - 1] * a->count[l]) {
+            a->count[l] *= extent;
+        } else {
+            a->strides[l] = stride;
+            a->count[l + 1] = extent;
+            a->stride_levels++;
         }
-
-        _SYNC_IMAGES((int *) &source_image, 1, NULL, 0, NULL, 0);
     }
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    if (a->nelem == 0)
+        a->stride_levels = 0;
 }
 
-
-/* CO_MAXVAL */
-
-void _CO_MAXVAL_INT1_0(DopeVectorType * source, DopeVectorType * result)
+static void co_array_from_scalar(co_array_t * a, void *addr,
+                                 size_t elem_size)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_maxval_int1_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_MAXVAL_INT1(DopeVectorType * source, DopeVectorType * result)
-{
-    int n_dim = source->n_dim;
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(maxval, int1, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_MAXVAL_INT2_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_maxval_int2_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_MAXVAL_INT2(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(maxval, int2, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_MAXVAL_INT4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_maxval_int4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_MAXVAL_INT4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(maxval, int4, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_MAXVAL_INT8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_maxval_int8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    a->base = addr;
+    a->elem_size = elem_size;
+    a->nelem = 1;
+    a->stride_levels = 0;
+    a->count[0] = elem_size;
 }
 
-void _CO_MAXVAL_INT8(DopeVectorType * source, DopeVectorType * result)
+/* copies the array into / out of a contiguous buffer */
+static void co_pack(const co_array_t * a, char *buf)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(maxval, int8, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    size_t idx[MAXDIM + 1];
+    int l, levels = a->stride_levels;
+    char *p = a->base;
 
-void _CO_MAXVAL_REAL4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_maxval_real4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (a->nelem == 0)
+        return;
+    if (levels == 0) {
+        memcpy(buf, p, a->count[0]);
+        return;
+    }
 
-void _CO_MAXVAL_REAL4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(maxval, real4, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    memset(idx, 0, sizeof(idx));
+    for (;;) {
+        memcpy(buf, p, a->count[0]);
+        buf += a->count[0];
+        for (l = 1; l <= levels; l++) {
+            p += a->strides[l - 1];
+            if (++idx[l] < a->count[l])
+                break;
+            p -= a->count[l] * a->strides[l - 1];
+            idx[l] = 0;
+        }
+        if (l > levels)
+            return;
+    }
 }
 
-void _CO_MAXVAL_REAL8_0(DopeVectorType * source, DopeVectorType * result)
+static void co_unpack(const char *buf, const co_array_t * a)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_maxval_real8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    size_t idx[MAXDIM + 1];
+    int l, levels = a->stride_levels;
+    char *p = a->base;
 
-void _CO_MAXVAL_REAL8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(maxval, real8, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (a->nelem == 0)
+        return;
+    if (levels == 0) {
+        memcpy(p, buf, a->count[0]);
+        return;
+    }
 
-void _CO_MAXVAL_REAL16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_maxval_real16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    memset(idx, 0, sizeof(idx));
+    for (;;) {
+        memcpy(p, buf, a->count[0]);
+        buf += a->count[0];
+        for (l = 1; l <= levels; l++) {
+            p += a->strides[l - 1];
+            if (++idx[l] < a->count[l])
+                break;
+            p -= a->count[l] * a->strides[l - 1];
+            idx[l] = 0;
+        }
+        if (l > levels)
+            return;
+    }
 }
 
-void _CO_MAXVAL_REAL16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(maxval, real16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
 
-void _CO_MAXVAL_C4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    Error("CO_MAXVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_maxval_c4_0__(source, result);
-#else
-#endif
-}
+/**************************************************************
+ *                      Collective engine
+ **************************************************************/
 
-void _CO_MAXVAL_C4(DopeVectorType * source, DopeVectorType * result)
+/* image is 0-based */
+static void co_sync_with(int image)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-    Error("CO_MAXVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(maxval, c4, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    int img = image + 1;
+    _SYNC_IMAGES(&img, 1, NULL, 0, NULL, 0);
 }
 
-void _CO_MAXVAL_C8_0(DopeVectorType * source, DopeVectorType * result)
+/* Makes co_work at least nbytes large. All images ask for the same size,
+ * so they all reallocate together. */
+static void co_get_work_buffer(size_t nbytes)
 {
-    Error("CO_MAXVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_maxval_c8_0__(source, result);
-#else
-#endif
-}
+    size_t size;
 
-void _CO_MAXVAL_C8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-    Error("CO_MAXVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(maxval, c8, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (nbytes <= co_work_size)
+        return;
 
-void _CO_MAXVAL_C16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_maxval_c16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_MAXVAL_C16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(maxval, c16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    size = co_work_size ? co_work_size : 4096;
+    while (size < nbytes)
+        size *= 2;
 
-/* CO_MINVAL */
+    if (co_work)
+        coarray_deallocate_(co_work);
+    co_work = coarray_allocatable_allocate_(size);
+    co_work_size = size;
 
-void _CO_MINVAL_INT1_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_minval_int1_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "work buffer is now %lu bytes",
+                 (unsigned long) size);
 }
 
-void _CO_MINVAL_INT1(DopeVectorType * source, DopeVectorType * result)
+/* binomial tree rooted at root (0-based). Each image reads the data from
+ * its parent straight into its own source coarray, then lets its children
+ * read from it in turn. */
+static void co_bcast(co_array_t * source, int root)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(minval, int1, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    int me = _this_image - 1;
+    int n = _num_images;
+    int vme = (me - root + n) % n;
+    int mask;
+    int nchildren = 0;
+    int children[32];
 
-void _CO_MINVAL_INT2_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_minval_int2_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (n == 1)
+        return;
 
-void _CO_MINVAL_INT2(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(minval, int2, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (vme != 0) {
+        int parent = ((vme - (vme & -vme)) + root) % n;
 
-void _CO_MINVAL_INT4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_minval_int4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+        /* parent has the data */
+        co_sync_with(parent);
+        if (source->nelem > 0) {
+            __coarray_strided_read(parent + 1, source->base,
+                                   source->strides, source->base,
+                                   source->strides, source->count,
+                                   source->stride_levels);
+        }
+        /* parent may change it again */
+        co_sync_with(parent);
+        mask = (vme & -vme) >> 1;
+    } else {
+        mask = co_pof2(n - 1);
+    }
 
-void _CO_MINVAL_INT4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(minval, int4, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    for (; mask > 0; mask >>= 1) {
+        if (vme + mask < n)
+            children[nchildren++] = (vme + mask + root) % n + 1;
+    }
+    if (nchildren > 0) {
+        _SYNC_IMAGES(children, nchildren, NULL, 0, NULL, 0);
+        _SYNC_IMAGES(children, nchildren, NULL, 0, NULL, 0);
+    }
 }
 
-void _CO_MINVAL_INT8_0(DopeVectorType * source, DopeVectorType * result)
+/* reads nelem elements at offset elem of partner's work buffer into buf */
+static inline void co_get(int partner, size_t elem, size_t nelem,
+                          size_t elem_size, void *buf)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_minval_int8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    if (nelem > 0) {
+        __coarray_read(partner + 1, co_work + elem * elem_size, buf,
+                       nelem * elem_size);
+    }
 }
 
-void _CO_MINVAL_INT8(DopeVectorType * source, DopeVectorType * result)
+/* Reduces source over all images into result, on result_image (1-based)
+ * or on all images if result_image is 0. op must be commutative, as
+ * Fortran requires. */
+static void co_reduce(co_array_t * source, co_array_t * result,
+                      int result_image, co_reduce_op_t op)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(minval, int8, n_dim)        /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    int me = _this_image - 1;
+    int n = _num_images;
+    size_t es = source->elem_size;
+    size_t nelem = source->nelem;
+    size_t nbytes = nelem * es;
+    char *acc;
+    char *tmp;
+    int mask;
 
-void _CO_MINVAL_REAL4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_minval_real4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (result->nelem != nelem || result->elem_size != es) {
+        Error("collective result does not match the shape of source");
+    }
 
-void _CO_MINVAL_REAL4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(minval, real4, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (n == 1) {
+        tmp = comm_malloc(nbytes > 0 ? nbytes : 1);
+        co_pack(source, tmp);
+        co_unpack(tmp, result);
+        comm_free(tmp);
+        return;
+    }
 
-void _CO_MINVAL_REAL8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_minval_real8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (co_reduce_scatter_min < 0) {
+        co_reduce_scatter_min = get_env_size(ENV_CO_REDUCE_SCATTER_MIN,
+                                             DEFAULT_CO_REDUCE_SCATTER_MIN);
+    }
 
-void _CO_MINVAL_REAL8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(minval, real8, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    co_get_work_buffer(nbytes > 0 ? nbytes : 1);
+    acc = co_work;
+    tmp = comm_malloc(nbytes > 0 ? nbytes : 1);
+    co_pack(source, acc);
+
+    if (result_image != 0) {
+        /* binomial tree towards result_image */
+        int root = result_image - 1;
+        int vme = (me - root + n) % n;
+
+        for (mask = 1; mask < n; mask <<= 1) {
+            if (vme & mask) {
+                int parent = (vme - mask + root) % n;
+                /* acc is ready, wait for the parent to read it */
+                co_sync_with(parent);
+                co_sync_with(parent);
+                break;
+            } else if (vme + mask < n) {
+                int child = (vme + mask + root) % n;
+                co_sync_with(child);
+                co_get(child, 0, nelem, es, tmp);
+                co_sync_with(child);
+                op(acc, tmp, nelem);
+            }
+        }
+        if (vme == 0)
+            co_unpack(acc, result);
+    } else {
+        int p2 = co_pof2(n);
+        int rem = n - p2;
+
+        if (me >= p2) {
+            /* fold into me - p2, then read the result back from it */
+            int partner = me - p2;
+            co_sync_with(partner);
+            co_sync_with(partner);
+            co_sync_with(partner);
+            co_get(partner, 0, nelem, es, acc);
+            co_sync_with(partner);
+        } else {
+            if (me < rem) {
+                int partner = me + p2;
+                co_sync_with(partner);
+                co_get(partner, 0, nelem, es, tmp);
+                co_sync_with(partner);
+                op(acc, tmp, nelem);
+            }
 
-void _CO_MINVAL_REAL16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_minval_real16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+            if (nbytes < co_reduce_scatter_min || nelem < p2) {
+                /* recursive doubling */
+                for (mask = 1; mask < p2; mask <<= 1) {
+                    int partner = me ^ mask;
+                    co_sync_with(partner);
+                    co_get(partner, 0, nelem, es, tmp);
+                    co_sync_with(partner);
+                    op(acc, tmp, nelem);
+                }
+            } else {
+                /* reduce-scatter by recursive halving; lo[k]/hi[k] is the
+                 * range this image owns after the step with mask 2^k */
+                size_t lo[32], hi[32];
+                size_t cur_lo = 0, cur_hi = nelem;
+                int k, log2_p2 = 0;
+
+                while ((1 << log2_p2) < p2)
+                    log2_p2++;
+
+                for (k = log2_p2 - 1; k >= 0; k--) {
+                    int partner = me ^ (1 << k);
+                    size_t mid = cur_lo + (cur_hi - cur_lo) / 2;
+
+                    if (me & (1 << k))
+                        cur_lo = mid;
+                    else
+                        cur_hi = mid;
+                    lo[k] = cur_lo;
+                    hi[k] = cur_hi;
+
+                    co_sync_with(partner);
+                    co_get(partner, cur_lo, cur_hi - cur_lo, es, tmp);
+                    co_sync_with(partner);
+                    op(acc + cur_lo * es, tmp, cur_hi - cur_lo);
+                }
 
-void _CO_MINVAL_REAL16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(minval, real16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+                /* allgather by recursive doubling: get the other half of
+                 * the range split in the matching halving step, which the
+                 * partner owns by now */
+                for (k = 0; k < log2_p2; k++) {
+                    int partner = me ^ (1 << k);
+                    size_t plo, phi;
+
+                    if (me & (1 << k)) {
+                        plo = k + 1 < log2_p2 ? lo[k + 1] : 0;
+                        phi = lo[k];
+                    } else {
+                        plo = hi[k];
+                        phi = k + 1 < log2_p2 ? hi[k + 1] : nelem;
+                    }
+
+                    co_sync_with(partner);
+                    co_get(partner, plo, phi - plo, es, acc + plo * es);
+                    co_sync_with(partner);
+                }
+            }
 
-void _CO_MINVAL_C4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    Error("CO_MINVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_minval_c4_0__(source, result);
-#else
-#endif
-}
+            if (me < rem) {
+                int partner = me + p2;
+                /* result is ready, wait for the partner to read it */
+                co_sync_with(partner);
+                co_sync_with(partner);
+            }
+        }
+        co_unpack(acc, result);
+    }
 
-void _CO_MINVAL_C4(DopeVectorType * source, DopeVectorType * result)
-{
-    int n_dim = source->n_dim;
-    Error("CO_MINVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(minval, c4, n_dim) /* see macro definition at top */
-#else
-#endif
+    comm_free(tmp);
 }
 
-void _CO_MINVAL_C8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    Error("CO_MINVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_minval_c8_0__(source, result);
-#else
-#endif
-}
 
-void _CO_MINVAL_C8(DopeVectorType * source, DopeVectorType * result)
-{
-    int n_dim = source->n_dim;
-    Error("CO_MINVAL not supported for complex types");
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(minval, c8, n_dim) /* see macro definition at top */
-#else
-#endif
-}
+/**************************************************************
+ *                     Reduction operators
+ **************************************************************/
 
-void _CO_MINVAL_C16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_minval_c16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+#define CO_OP_(name, ctype, expr) \
+    static void co_##name(void *inout, const void *in, size_t n) \
+    { \
+        ctype *a = inout; \
+        const ctype *b = in; \
+        size_t i; \
+        for (i = 0; i < n; i++) \
+            a[i] = (expr); \
+    }
 
-void _CO_MINVAL_C16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(minval, c16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+#define CO_ARITH_OPS_(type, ctype) \
+    CO_OP_(sum_##type, ctype, a[i] + b[i]) \
+    CO_OP_(product_##type, ctype, a[i] * b[i])
+
+#define CO_ORDER_OPS_(type, ctype) \
+    CO_OP_(maxval_##type, ctype, b[i] > a[i] ? b[i] : a[i]) \
+    CO_OP_(minval_##type, ctype, b[i] < a[i] ? b[i] : a[i])
+
+CO_ARITH_OPS_(int1, signed char)
+CO_ARITH_OPS_(int2, INTEGER2)
+CO_ARITH_OPS_(int4, INTEGER4)
+CO_ARITH_OPS_(int8, long long)
+CO_ARITH_OPS_(real4, float)
+CO_ARITH_OPS_(real8, double)
+CO_ARITH_OPS_(real16, long double)
+CO_ARITH_OPS_(c4, float _Complex)
+CO_ARITH_OPS_(c8, double _Complex)
+CO_ARITH_OPS_(c16, long double _Complex)
+
+CO_ORDER_OPS_(int1, signed char)
+CO_ORDER_OPS_(int2, INTEGER2)
+CO_ORDER_OPS_(int4, INTEGER4)
+CO_ORDER_OPS_(int8, long long)
+CO_ORDER_OPS_(real4, float)
+CO_ORDER_OPS_(real8, double)
+CO_ORDER_OPS_(real16, long double)
+
+
+/**************************************************************
+ *                  COMPILER BACK-END INTERFACE
+ **************************************************************/
 
-/* CO_SUM */
+/* CO_BCAST */
 
-void _CO_SUM_INT1_0(DopeVectorType * source, DopeVectorType * result)
+void _CO_BCAST_I1(DopeVectorType * source, INTEGER1 * src_img_p)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_int1_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    INTEGER8 s_image = *src_img_p;
+    INTEGER8 *s_image_p = &s_image;
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "calling _CO_BCAST_I8");
+    _CO_BCAST_I8(source, s_image_p);
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "completed _CO_BCAST_I8");
 }
 
-void _CO_SUM_INT1(DopeVectorType * source, DopeVectorType * result)
+void _CO_BCAST_I2(DopeVectorType * source, INTEGER2 * src_img_p)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, int1, n_dim)   /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    INTEGER8 s_image = *src_img_p;
+    INTEGER8 *s_image_p = &s_image;
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "calling _CO_BCAST_I8");
+    _CO_BCAST_I8(source, s_image_p);
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "completed _CO_BCAST_I8");
 }
 
-void _CO_SUM_INT2_0(DopeVectorType * source, DopeVectorType * result)
+void _CO_BCAST_I4(DopeVectorType * source, INTEGER4 * src_img_p)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_int2_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+    INTEGER8 s_image = *src_img_p;
+    INTEGER8 *s_image_p = &s_image;
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "calling _CO_BCAST_I8");
+    _CO_BCAST_I8(source, s_image_p);
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "completed _CO_BCAST_I8");
 }
 
-void _CO_SUM_INT2(DopeVectorType * source, DopeVectorType * result)
+void _CO_BCAST_I8(DopeVectorType * source, INTEGER8 * src_img_p)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, int2, n_dim)   /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    co_array_t a;
+    INTEGER8 source_image = *src_img_p;
 
-void _CO_SUM_INT4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_int4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE,
+                 "source = %p, *src_img_p = %lu", source, *src_img_p);
 
-void _CO_SUM_INT4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, int4, n_dim)   /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (source_image < 1 || source_image > _num_images) {
+        LIBCAF_TRACE(LIBCAF_LOG_FATAL,
+                     "CO_BCAST called with invalid source_image.");
+    }
 
-void _CO_SUM_INT8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_int8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    co_array_from_dv(&a, source);
+    co_bcast(&a, source_image - 1);
 
-void _CO_SUM_INT8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, int8, n_dim)   /* see macro definition at top */
-#else
-#endif
     LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
 }
 
-void _CO_SUM_REAL4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_real4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+/* CO_REDUCE */
 
-void _CO_SUM_REAL4(DopeVectorType * source, DopeVectorType * result)
+void _CO_REDUCE(DopeVectorType * source, DopeVectorType * result,
+                co_reduce_op_t op, int *result_image)
 {
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, real4, n_dim)  /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    co_array_t src, res;
+    int img = result_image ? *result_image : 0;
 
-void _CO_SUM_REAL8_0(DopeVectorType * source, DopeVectorType * result)
-{
     LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_real8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
 
-void _CO_SUM_REAL8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, real8, n_dim)  /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    if (img < 0 || img > _num_images) {
+        LIBCAF_TRACE(LIBCAF_LOG_FATAL,
+                     "CO_REDUCE called with invalid result_image.");
+    }
 
-void _CO_SUM_REAL16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_sum_real16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+    co_array_from_dv(&src, source);
+    co_array_from_dv(&res, result);
+    co_reduce(&src, &res, img, op);
+
+    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
+}
+
+/* The scalar (_0) versions get the addresses of source and result, the
+ * others get dope vectors. Result is defined on all images. */
+
+#define CO_REDUCE_ENTRY_(OP, TYPE, op, ctype) \
+    void _CO_##OP##_##TYPE##_0(DopeVectorType *source, \
+                               DopeVectorType *result) \
+    { \
+        co_array_t src, res; \
+        LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start"); \
+        co_array_from_scalar(&src, source, sizeof(ctype)); \
+        co_array_from_scalar(&res, result, sizeof(ctype)); \
+        co_reduce(&src, &res, 0, co_##op); \
+        LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end"); \
+    } \
+    void _CO_##OP##_##TYPE(DopeVectorType *source, DopeVectorType *result) \
+    { \
+        co_array_t src, res; \
+        LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start"); \
+        co_array_from_dv(&src, source); \
+        co_array_from_dv(&res, result); \
+        co_reduce(&src, &res, 0, co_##op); \
+        LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end"); \
+    }
 
-void _CO_SUM_REAL16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(sum, real16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+/* complex numbers have no order */
+#define CO_REDUCE_NO_ORDER_(OP, TYPE) \
+    void _CO_##OP##_##TYPE##_0(DopeVectorType *source, \
+                               DopeVectorType *result) \
+    { \
+        Error("CO_" #OP " is not defined for complex arguments"); \
+    } \
+    void _CO_##OP##_##TYPE(DopeVectorType *source, DopeVectorType *result) \
+    { \
+        Error("CO_" #OP " is not defined for complex arguments"); \
+    }
 
-void _CO_SUM_C4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_c4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+/* CO_MAXVAL */
 
-void _CO_SUM_C4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, c4, n_dim)     /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+CO_REDUCE_ENTRY_(MAXVAL, INT1, maxval_int1, signed char)
+CO_REDUCE_ENTRY_(MAXVAL, INT2, maxval_int2, INTEGER2)
+CO_REDUCE_ENTRY_(MAXVAL, INT4, maxval_int4, INTEGER4)
+CO_REDUCE_ENTRY_(MAXVAL, INT8, maxval_int8, long long)
+CO_REDUCE_ENTRY_(MAXVAL, REAL4, maxval_real4, float)
+CO_REDUCE_ENTRY_(MAXVAL, REAL8, maxval_real8, double)
+CO_REDUCE_ENTRY_(MAXVAL, REAL16, maxval_real16, long double)
+CO_REDUCE_NO_ORDER_(MAXVAL, C4)
+CO_REDUCE_NO_ORDER_(MAXVAL, C8)
+CO_REDUCE_NO_ORDER_(MAXVAL, C16)
 
-void _CO_SUM_C8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_sum_c8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+/* CO_MINVAL */
 
-void _CO_SUM_C8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(sum, c8, n_dim)     /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+CO_REDUCE_ENTRY_(MINVAL, INT1, minval_int1, signed char)
+CO_REDUCE_ENTRY_(MINVAL, INT2, minval_int2, INTEGER2)
+CO_REDUCE_ENTRY_(MINVAL, INT4, minval_int4, INTEGER4)
+CO_REDUCE_ENTRY_(MINVAL, INT8, minval_int8, long long)
+CO_REDUCE_ENTRY_(MINVAL, REAL4, minval_real4, float)
+CO_REDUCE_ENTRY_(MINVAL, REAL8, minval_real8, double)
+CO_REDUCE_ENTRY_(MINVAL, REAL16, minval_real16, long double)
+CO_REDUCE_NO_ORDER_(MINVAL, C4)
+CO_REDUCE_NO_ORDER_(MINVAL, C8)
+CO_REDUCE_NO_ORDER_(MINVAL, C16)
 
-void _CO_SUM_C16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_sum_c16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+/* CO_SUM */
 
-void _CO_SUM_C16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(sum, c16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
+CO_REDUCE_ENTRY_(SUM, INT1, sum_int1, signed char)
+CO_REDUCE_ENTRY_(SUM, INT2, sum_int2, INTEGER2)
+CO_REDUCE_ENTRY_(SUM, INT4, sum_int4, INTEGER4)
+CO_REDUCE_ENTRY_(SUM, INT8, sum_int8, long long)
+CO_REDUCE_ENTRY_(SUM, REAL4, sum_real4, float)
+CO_REDUCE_ENTRY_(SUM, REAL8, sum_real8, double)
+CO_REDUCE_ENTRY_(SUM, REAL16, sum_real16, long double)
+CO_REDUCE_ENTRY_(SUM, C4, sum_c4, float _Complex)
+CO_REDUCE_ENTRY_(SUM, C8, sum_c8, double _Complex)
+CO_REDUCE_ENTRY_(SUM, C16, sum_c16, long double _Complex)
 
 /* CO_PRODUCT */
 
-void _CO_PRODUCT_INT1_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_int1_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_INT1(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, int1, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_INT2_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_int2_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_INT2(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, int2, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_INT4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_int4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_INT4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, int4, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_INT8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_int8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_INT8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, int8, n_dim)       /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_REAL4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_real4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_REAL4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, real4, n_dim)      /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_REAL8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_real8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_REAL8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, real8, n_dim)      /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_REAL16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_product_real16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_REAL16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(product, real16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_C4_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_c4_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_C4(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, c4, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_C8_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    co_product_c8_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_C8(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    CAF_CO_(product, c8, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_C16_0(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-#ifdef USE_CAF_IMPLEMENTATION
-    // co_product_c16_0__(source, result);
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-void _CO_PRODUCT_C16(DopeVectorType * source, DopeVectorType * result)
-{
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "start");
-    int n_dim = source->n_dim;
-#ifdef USE_CAF_IMPLEMENTATION
-    // CAF_CO_(product, c16, n_dim) /* see macro definition at top */
-#else
-#endif
-    LIBCAF_TRACE(LIBCAF_LOG_COLLECTIVE, "end");
-}
-
-#if 0
-/* COSUM  (modified Joon's armci_comaxval function) */
-/* Accumulates the value of src_dv on all images and stores it into sum_dv
- * of root */
-void comm_cosum(DopeVectorType * src_dv, DopeVectorType * sum_dv, int root)
-{
-    int i, iter;
-    int total_iter = (int) myceillog2(_num_images);
-    unsigned int el_len;
-    unsigned int target;
-    void *local_buf;
-    int total_bytes = 1;
-
-    // initialization
-    el_len = src_dv->base_addr.a.el_len >> 3;   // convert bits to bytes
-    for (i = 0; i < src_dv->n_dim; i++)
-        total_bytes *= src_dv->dimension[i].extent;
-    local_buf = malloc(total_bytes);
-    memset(local_buf, 0, total_bytes);
-    total_bytes *= el_len;
-    // copy content of dopevector from src to sum locally
-    memcpy(sum_dv->base_addr.a.ptr, src_dv->base_addr.a.ptr, total_bytes);
-
-    // swap processed ID between 0 and root (non zero process ID)
-    int vPID = (_this_image == root) ?
-        0 : (_this_image == 0) ? root : _this_image;
-
-    // do reduction
-    for (iter = 0; iter < total_iter; iter++) {
-        if ((vPID % my_pow2(iter + 1)) == 0) {
-            if ((vPID + my_pow2(iter)) < _num_images) {
-                // compute target process IDs for data transfer
-                target = vPID + my_pow2(iter);
-
-                //swap back for process Id 0 and root process(non-zero)
-                if (target == root)
-                    target = 0;
-
-                comm_read(target, src_dv->base_addr.a.ptr, local_buf,
-                          total_bytes);
-
-                dope_add(local_buf, sum_dv, total_bytes);
-            }
-        }
-        comm_barrier_all();
-    }
-
-    free(local_buf);
-    //Broadcast for all to all
-}
-
-#endif
+CO_REDUCE_ENTRY_(PRODUCT, INT1, product_int1, signed char)
+CO_REDUCE_ENTRY_(PRODUCT, INT2, product_int2, INTEGER2)
+CO_REDUCE_ENTRY_(PRODUCT, INT4, product_int4, INTEGER4)
+CO_REDUCE_ENTRY_(PRODUCT, INT8, product_int8, long long)
+CO_REDUCE_ENTRY_(PRODUCT, REAL4, product_real4, float)
+CO_REDUCE_ENTRY_(PRODUCT, REAL8, product_real8, double)
+CO_REDUCE_ENTRY_(PRODUCT, REAL16, product_real16, long double)
+CO_REDUCE_ENTRY_(PRODUCT, C4, product_c4, float _Complex)
+CO_REDUCE_ENTRY_(PRODUCT, C8, product_c8, double _Complex)
+CO_REDUCE_ENTRY_(PRODUCT, C16, product_c16, long double _Complex)
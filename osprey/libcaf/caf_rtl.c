@@ -600,7 +600,7 @@ void _COARRAY_UNLOCK(lock_t * lock, const int *image, int *status,
     else
         img = *image;
 
-#if defined(GASNET)
+#if defined(GASNET) || defined(SHM)
     if (status == NULL) {
         CALLSITE_TIMED_TRACE(SYNC, SYNC, comm_unlock, lock, img, errmsg,
                              errmsg_len);
@@ -39,16 +39,32 @@
 #define ENV_PROGRESS_THREAD           "UHCAF_PROGRESS_THREAD"
 #define ENV_PROGRESS_THREAD_INTERVAL  "UHCAF_PROGRESS_THREAD_INTERVAL"
 #define ENV_GETCACHE_LINE_SIZE        "UHCAF_GETCACHE_LINE_SIZE"
+#define ENV_GETCACHE_SETS             "UHCAF_GETCACHE_SETS"
+#define ENV_GETCACHE_WAYS             "UHCAF_GETCACHE_WAYS"
+#define ENV_GETCACHE_PREFETCH         "UHCAF_GETCACHE_PREFETCH"
+#define ENV_GETCACHE_STATS            "UHCAF_GETCACHE_STATS"
 #define ENV_IMAGE_HEAP_SIZE           "UHCAF_IMAGE_HEAP_SIZE"
 #define ENV_NB_XFER_LIMIT             "UHCAF_NB_XFER_LIMIT"
+#define ENV_PUT_COMBINE               "UHCAF_PUT_COMBINE"
+#define ENV_PUT_COMBINE_BUFFER_SIZE   "UHCAF_PUT_COMBINE_BUFFER_SIZE"
+#define ENV_NUM_IMAGES                "UHCAF_NUM_IMAGES"
+#define ENV_CO_REDUCE_SCATTER_MIN     "UHCAF_CO_REDUCE_SCATTER_MIN"
 
 #define DEFAULT_ENABLE_GETCACHE           0
+#define DEFAULT_ENABLE_GETCACHE_PREFETCH  0
+#define DEFAULT_ENABLE_GETCACHE_STATS     0
 #define DEFAULT_ENABLE_PROGRESS_THREAD    0
+#define DEFAULT_ENABLE_PUT_COMBINE        0
 #define DEFAULT_PROGRESS_THREAD_INTERVAL  1000L /* ns */
 /* these will be overridden by the defaults in cafrun script */
 #define DEFAULT_GETCACHE_LINE_SIZE        65536L
+#define DEFAULT_GETCACHE_SETS             1
+#define DEFAULT_GETCACHE_WAYS             4
 #define DEFAULT_IMAGE_HEAP_SIZE           31457280L
 #define DEFAULT_NB_XFER_LIMIT             16
+#define DEFAULT_PUT_COMBINE_BUFFER_SIZE   4096L
+#define DEFAULT_NUM_IMAGES                1
+#define DEFAULT_CO_REDUCE_SCATTER_MIN     65536L
 
 #define MAX_NUM_IMAGES                    0x100000
 #define MAX_SHARED_MEMORY_SIZE            0x1000000000
@@ -95,6 +95,9 @@ const size_t LARGE_COMM_BUF_SIZE = 120 * 1024;
 const size_t SMALL_XFER_SIZE = 200;     /* size for which local mem copy would be
                                            advantageous */
 
+const size_t PUT_COMBINE_MAX_XFER_SIZE = 256;   /* larger puts are not
+                                                   combined */
+
 
 extern unsigned long _this_image;
 extern unsigned long _num_images;
@@ -158,12 +161,17 @@ static struct nb_handle_manager nb_mgr[2];
 static size_t nb_xfer_limit;
 
 
+/* write combining */
+static int enable_put_combine;  /* set by env variable */
+static size_t put_combine_buffer_size;  /* set by env var. */
+static struct put_combine_buffer *put_combine;
+
 /* get cache */
 static int enable_get_cache;    /* set by env variable */
 static size_t getCache_line_size;       /* set by env var. */
-/* Instead of making the cache_all_image an array of struct cache, I
- * make it an array of pointer to struct cache. This will make it easy
- * to add more cache lines in the future by making it 2D array */
+static size_t getCache_sets;    /* set by env var. */
+static size_t getCache_ways;    /* set by env var. */
+static int getCache_prefetch;   /* set by env var. */
 static struct cache **cache_all_images;
 static size_t shared_memory_size;
 
@@ -193,6 +201,11 @@ static void handler_get_reply(gasnet_token_t token, void *buf,
 
 static void handler_sync_request(gasnet_token_t token, int imageIndex);
 
+static void handler_put_combined_request(gasnet_token_t token, void *buf,
+                                         size_t bufsiz);
+
+static void handler_put_combined_reply(gasnet_token_t token);
+
 static void
 handler_swap_request(gasnet_token_t token,
                      void *buf, size_t bufsiz, gasnet_handlerarg_t unused);
@@ -218,6 +231,11 @@ handler_fadd_reply(gasnet_token_t token,
                    void *buf, size_t bufsiz, gasnet_handlerarg_t unused);
 
 static void *get_remote_address(void *src, size_t img);
+static void wait_on_all_combined_puts();
+static void wait_on_combined_puts_to_proc(size_t proc);
+static inline void wait_on_conflicting_combined_puts(size_t proc,
+                                                     void *remote_address,
+                                                     size_t size);
 static int address_in_nb_address_block(void *remote_addr,
                                        size_t proc, size_t size,
                                        access_type_t access_type);
@@ -244,8 +262,8 @@ static void wait_on_pending_accesses(unsigned long proc,
 static void wait_on_all_pending_accesses_to_proc(unsigned long proc);
 static inline void wait_on_all_pending_accesses();
 
-static void clear_all_cache();
-static void clear_cache(unsigned long node);
+static void invalidate_all_cache();
+static void invalidate_cache(size_t node);
 static void cache_check_and_get(size_t node, void *remote_address,
                                 size_t nbytes, void *local_address);
 static void update_cache(size_t node, void *remote_address,
@@ -412,7 +430,9 @@ static gasnet_handlerentry_t handlers[] = {
     {GASNET_HANDLER_PUT_REQUEST, handler_put_request},
     {GASNET_HANDLER_PUT_REPLY, handler_put_reply},
     {GASNET_HANDLER_GET_REQUEST, handler_get_request},
-    {GASNET_HANDLER_GET_REPLY, handler_get_reply}
+    {GASNET_HANDLER_GET_REPLY, handler_get_reply},
+    {GASNET_HANDLER_PUT_COMBINED_REQUEST, handler_put_combined_request},
+    {GASNET_HANDLER_PUT_COMBINED_REPLY, handler_put_combined_reply}
 };
 
 static const int nhandlers = sizeof(handlers) / sizeof(handlers[0]);
@@ -425,6 +445,33 @@ static void handler_sync_request(gasnet_token_t token, int imageIndex)
     gasnet_hsl_unlock(&sync_lock);
 }
 
+/* applies the puts combined by the sending image, in the order it made
+ * them */
+static void handler_put_combined_request(gasnet_token_t token, void *buf,
+                                         size_t bufsiz)
+{
+    void *record = buf;
+
+    while (record < buf + bufsiz) {
+        put_combine_record_t *r = (put_combine_record_t *) record;
+        void *data = record + sizeof(*r);
+
+        memmove(r->target, data, r->nbytes);
+        record = data + ((r->nbytes + 7) & ~(size_t) 7);
+    }
+    LOAD_STORE_FENCE();
+
+    gasnet_AMReplyShort0(token, GASNET_HANDLER_PUT_COMBINED_REPLY);
+}
+
+static void handler_put_combined_reply(gasnet_token_t token)
+{
+    gasnet_node_t proc;
+
+    gasnet_AMGetMsgSource(token, &proc);
+    put_combine[proc].in_flight = 0;
+}
+
 typedef struct {
     size_t nbytes;              /* size of read/write */
     void *target;               /* where to read/write */
@@ -696,6 +743,10 @@ comm_swap_request(void *target, void *value, size_t nbytes,
     const gasnet_nodeinfo_t *node_info = &nodeinfo_table[proc];
     check_remote_address(proc + 1, target);
 
+    /* locks and events order the puts made before them */
+    if (enable_put_combine)
+        wait_on_all_combined_puts();
+
     if (proc == my_proc) {
 
         if (nbytes == sizeof(INT4)) {
@@ -794,6 +845,10 @@ comm_cswap_request(void *target, void *cond, void *value,
     const gasnet_nodeinfo_t *node_info = &nodeinfo_table[proc];
     check_remote_address(proc + 1, target);
 
+    /* locks and events order the puts made before them */
+    if (enable_put_combine)
+        wait_on_all_combined_puts();
+
     if (proc == my_proc) {
 
         if (nbytes == sizeof(INT4)) {
@@ -903,6 +958,10 @@ comm_fadd_request(void *target, void *value, size_t nbytes, int proc,
     const gasnet_nodeinfo_t *node_info = &nodeinfo_table[proc];
     check_remote_address(proc + 1, target);
 
+    /* locks and events order the puts made before them */
+    if (enable_put_combine)
+        wait_on_all_combined_puts();
+
     if (proc == my_proc) {
 
         if (nbytes == sizeof(INT4)) {
@@ -1133,9 +1192,23 @@ void comm_init()
     enable_get_cache = get_env_flag(ENV_GETCACHE, DEFAULT_ENABLE_GETCACHE);
     getCache_line_size = get_env_size(ENV_GETCACHE_LINE_SIZE,
                                       DEFAULT_GETCACHE_LINE_SIZE);
+    getCache_sets = get_env_size(ENV_GETCACHE_SETS, DEFAULT_GETCACHE_SETS);
+    getCache_ways = get_env_size(ENV_GETCACHE_WAYS, DEFAULT_GETCACHE_WAYS);
+    getCache_prefetch = get_env_flag(ENV_GETCACHE_PREFETCH,
+                                     DEFAULT_ENABLE_GETCACHE_PREFETCH);
+    if (getCache_line_size == 0)
+        getCache_line_size = DEFAULT_GETCACHE_LINE_SIZE;
+    if (getCache_sets == 0)
+        getCache_sets = 1;
+    if (getCache_ways == 0)
+        getCache_ways = 1;
 
     nb_xfer_limit = get_env_size(ENV_NB_XFER_LIMIT, DEFAULT_NB_XFER_LIMIT);
 
+    enable_put_combine = get_env_flag(ENV_PUT_COMBINE,
+                                      DEFAULT_ENABLE_PUT_COMBINE);
+    put_combine_buffer_size = get_env_size(ENV_PUT_COMBINE_BUFFER_SIZE,
+                                           DEFAULT_PUT_COMBINE_BUFFER_SIZE);
     /* malloc data structures for sync_images, nb-put, get-cache */
     sync_images_flag = (unsigned short *) malloc
         (num_procs * sizeof(unsigned short));
@@ -1156,6 +1229,12 @@ void comm_init()
             (struct cache **) malloc(num_procs * sizeof(struct cache *));
     }
 
+    if (enable_put_combine) {
+        /* the buffers are allocated on the first put to each image */
+        put_combine = (struct put_combine_buffer *) calloc
+            (num_procs, sizeof(struct put_combine_buffer));
+    }
+
 
     /* initialize data structures to 0 */
     for (i = 0; i < num_procs; i++) {
@@ -1169,12 +1248,13 @@ void comm_init()
         nb_mgr[GETS].max_nb_address[i] = 0;
 
         if (enable_get_cache) {
+            /* the lines are allocated on the first access to image i */
             cache_all_images[i] =
                 (struct cache *) malloc(sizeof(struct cache));
-            cache_all_images[i]->remote_address = 0;
-            cache_all_images[i]->handle = 0;
-            cache_all_images[i]->cache_line_address =
-                malloc(getCache_line_size);
+            cache_all_images[i]->lines = NULL;
+            cache_all_images[i]->use_clock = 0;
+            cache_all_images[i]->last_miss_tag = 0;
+            cache_all_images[i]->stride = 0;
         }
     }
 
@@ -1288,6 +1368,8 @@ void comm_init()
     mem_info->max_heap_usage = sizeof(*mem_info);
     mem_info->reserved_heap_usage =
         caf_shared_memory_size - static_symm_data_total_size;
+    mem_info->free_slots = 0;
+    mem_info->free_slots_size = 0;
 
     /* create a symmetric lock variable for guarding critical sections.
      * What's really needed is a distinct lock variable created for each
@@ -1324,74 +1406,269 @@ void comm_init()
  *                      GET CACHE Support
  *****************************************************************/
 
-static void refetch_all_cache()
+/* The remote segment of each image is cached in lines of
+ * getCache_line_size bytes, aligned to the start of the segment. Line
+ * number (tag) t lives in set t % getCache_sets, which holds
+ * getCache_ways lines replaced in LRU order. Lines are written through
+ * by local puts and invalidated at sync points. With prefetching, a miss
+ * that continues a constant stride of line numbers fetches the next line
+ * in that stride in the background. */
+
+static inline void *cache_segment_start(size_t node)
 {
-    int i;
+    return coarray_start_all_images[node].addr;
+}
+
+static inline void *cache_segment_end(size_t node)
+{
+    return coarray_start_all_images[node].addr + shared_memory_size;
+}
+
+static inline size_t cache_tag(size_t node, void *remote_address)
+{
+    return (remote_address - cache_segment_start(node)) /
+        getCache_line_size;
+}
+
+/* complete an outstanding prefetch into line */
+static inline void cache_line_sync(struct cache_line *line)
+{
+    if (line->handle != GASNET_INVALID_HANDLE) {
+        gasnet_wait_syncnb(line->handle);
+        line->handle = GASNET_INVALID_HANDLE;
+    }
+}
+
+static struct cache_line *cache_set(size_t node, size_t tag)
+{
+    struct cache *c = cache_all_images[node];
+
+    /* lines are allocated on the first access to the image */
+    if (c->lines == NULL) {
+        c->lines = (struct cache_line *) comm_malloc
+            (getCache_sets * getCache_ways * sizeof(struct cache_line));
+        if (c->lines == NULL)
+            Error("could not allocate get-cache for image %lu", node + 1);
+        memset(c->lines, 0,
+               getCache_sets * getCache_ways * sizeof(struct cache_line));
+    }
+
+    return &c->lines[(tag % getCache_sets) * getCache_ways];
+}
+
+static struct cache_line *cache_lookup(size_t node, size_t tag)
+{
+    struct cache_line *set = cache_set(node, tag);
+    int w;
+
+    for (w = 0; w < getCache_ways; w++) {
+        if (set[w].remote_address && set[w].tag == tag)
+            return &set[w];
+    }
+    return NULL;
+}
+
+/* Lines overlapping line numbers first..last are found by looking up each
+ * of them, or by scanning the cache when the range is larger than it. The
+ * i-th candidate, for i below cache_overlap_count, is returned by
+ * cache_overlap_line, or NULL if it is not cached. */
+static inline size_t cache_overlap_count(size_t first, size_t last)
+{
+    if (last - first + 1 <= getCache_sets * getCache_ways)
+        return last - first + 1;
+    return getCache_sets * getCache_ways;
+}
+
+static struct cache_line *cache_overlap_line(size_t node, size_t first,
+                                             size_t last, size_t i)
+{
+    struct cache_line *line;
+
+    if (last - first + 1 <= getCache_sets * getCache_ways)
+        return cache_lookup(node, first + i);
+
+    line = &cache_all_images[node]->lines[i];
+    if (line->remote_address && line->tag >= first && line->tag <= last)
+        return line;
+    return NULL;
+}
+
+/* Fetches line tag into the least recently used line of its set. The
+ * fetch is non-blocking for prefetches, and completes with
+ * cache_line_sync. */
+static struct cache_line *cache_fill(size_t node, size_t tag, int prefetch)
+{
+    struct cache *c = cache_all_images[node];
+    struct cache_line *set = cache_set(node, tag);
+    struct cache_line *line = &set[0];
+    void *remote_address;
+    size_t nbytes;
+    int w;
+
+    for (w = 0; w < getCache_ways; w++) {
+        if (!set[w].remote_address) {
+            line = &set[w];
+            break;
+        }
+        if (set[w].last_use < line->last_use)
+            line = &set[w];
+    }
+
+    cache_line_sync(line);
+    if (line->cache_line_address == NULL) {
+        line->cache_line_address = comm_malloc(getCache_line_size);
+        if (line->cache_line_address == NULL)
+            Error("could not allocate get-cache line for image %lu",
+                  node + 1);
+    }
+
+    remote_address = cache_segment_start(node) + tag * getCache_line_size;
+    nbytes = cache_segment_end(node) - remote_address;
+    if (nbytes > getCache_line_size)
+        nbytes = getCache_line_size;
+
+    /* the line must not miss our own outstanding puts into it */
+    if (nb_mgr[PUTS].handles[node])
+        wait_on_pending_accesses(node, remote_address, nbytes, PUTS);
+    wait_on_conflicting_combined_puts(node, remote_address, nbytes);
+
+    if (prefetch) {
+        line->handle = gasnet_get_nb_bulk(line->cache_line_address, node,
+                                          remote_address, nbytes);
+    } else {
+        gasnet_get_bulk(line->cache_line_address, node, remote_address,
+                        nbytes);
+        line->handle = GASNET_INVALID_HANDLE;
+    }
+
+    line->remote_address = remote_address;
+    line->nbytes = nbytes;
+    line->tag = tag;
+    line->prefetched = prefetch;
+    line->last_use = ++c->use_clock;
+
+    LIBCAF_TRACE(LIBCAF_LOG_CACHE, "%s line %lu (%p, %lu bytes) of"
+                 " image %lu", prefetch ? "Prefetching" : "Fetching",
+                 tag, remote_address, nbytes, node + 1);
+
+    return line;
+}
+
+static void cache_prefetch(size_t node, size_t tag)
+{
+    struct cache *c = cache_all_images[node];
+    long next = (long) tag + c->stride;
+
+    if (next < 0 || cache_segment_start(node) + next * getCache_line_size
+        >= cache_segment_end(node))
+        return;
+    if (cache_lookup(node, next))
+        return;
+    /* a single way would evict the line being read */
+    if (getCache_ways == 1 && next % getCache_sets == tag % getCache_sets)
+        return;
+
+    cache_fill(node, next, 1);
+    PROFILE_GETCACHE(prefetches);
+}
+
+/* Returns the cached line tag of image node, fetching it on a miss. */
+static struct cache_line *cache_get_line(size_t node, size_t tag)
+{
+    struct cache *c = cache_all_images[node];
+    struct cache_line *line = cache_lookup(node, tag);
+
+    if (line) {
+        PROFILE_GETCACHE(hits);
+        cache_line_sync(line);
+        line->last_use = ++c->use_clock;
+        if (line->prefetched) {
+            /* keep the stream ahead of the reads */
+            PROFILE_GETCACHE(prefetch_hits);
+            line->prefetched = 0;
+            c->last_miss_tag = tag;
+            cache_prefetch(node, tag);
+        }
+        return line;
+    }
+
+    PROFILE_GETCACHE(misses);
+    line = cache_fill(node, tag, 0);
+
+    if (getCache_prefetch) {
+        long stride = (long) tag - (long) c->last_miss_tag;
+        if (stride != 0 && stride == c->stride)
+            cache_prefetch(node, tag);
+        c->stride = stride;
+        c->last_miss_tag = tag;
+    }
+
+    return line;
+}
+
+static void invalidate_cache(size_t node)
+{
+    struct cache *c = cache_all_images[node];
+    int l;
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "entry");
 
-    for (i = 0; i < num_procs; i++) {
-        if (cache_all_images[i]->remote_address) {
-            cache_all_images[i]->handle =
-                gasnet_get_nb_bulk(cache_all_images[i]->cache_line_address,
-                                   i, cache_all_images[i]->remote_address,
-                                   getCache_line_size);
+    if (c->lines) {
+        for (l = 0; l < getCache_sets * getCache_ways; l++) {
+            if (c->lines[l].remote_address) {
+                cache_line_sync(&c->lines[l]);
+                c->lines[l].remote_address = 0;
+                PROFILE_GETCACHE(invalidations);
+            }
         }
     }
+
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
 }
 
-static void refetch_cache(size_t node)
+static void invalidate_all_cache()
 {
+    int i;
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "entry");
 
-    if (cache_all_images[node]->remote_address) {
-        cache_all_images[node]->handle =
-            gasnet_get_nb_bulk(cache_all_images[node]->cache_line_address,
-                               node,
-                               cache_all_images[node]->remote_address,
-                               getCache_line_size);
-    }
+    for (i = 0; i < num_procs; i++)
+        invalidate_cache(i);
 
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
 }
 
+/* Reads nbytes at remote_address through the cache, where the range is
+ * no larger than a line and so spans at most two of them. */
+static void cache_read(size_t node, void *remote_address, size_t nbytes,
+                       void *local_address)
+{
+    while (nbytes > 0) {
+        size_t tag = cache_tag(node, remote_address);
+        struct cache_line *line = cache_get_line(node, tag);
+        size_t start_offset = remote_address - line->remote_address;
+        size_t n = line->nbytes - start_offset;
+
+        if (n > nbytes)
+            n = nbytes;
+        memcpy(local_address, line->cache_line_address + start_offset, n);
+        remote_address += n;
+        local_address += n;
+        nbytes -= n;
+    }
+}
+
 static void cache_check_and_get(size_t node, void *remote_address,
                                 size_t nbytes, void *local_address)
 {
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "entry");
 
-    void *cache_address = cache_all_images[node]->remote_address;
-    size_t start_offset;
-    void *cache_line_address = cache_all_images[node]->cache_line_address;
-    /* data in cache */
-    if (cache_address > 0 && remote_address >= cache_address &&
-        remote_address + nbytes <= cache_address + getCache_line_size) {
-        start_offset = remote_address - cache_address;
-        if (cache_all_images[node]->handle) {
-            gasnet_wait_syncnb(cache_all_images[node]->handle);
-            cache_all_images[node]->handle = 0;
-        }
-        memcpy(local_address, cache_line_address + start_offset, nbytes);
-        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "Address %p on"
-                     " image %lu found in cache.", remote_address,
-                     node + 1);
-    } else {                    /*data not in cache */
-
-        /* data NOT from end of shared segment OR bigger than cacheline */
-        if (((remote_address + getCache_line_size) <=
-             (coarray_start_all_images[node].addr + shared_memory_size))
-            && (nbytes <= getCache_line_size)) {
-            gasnet_get(cache_line_address, node, remote_address,
-                       getCache_line_size);
-            cache_all_images[node]->remote_address = remote_address;
-            cache_all_images[node]->handle = 0;
-            memcpy(local_address, cache_line_address, nbytes);
-        } else {
-            gasnet_get(local_address, node, remote_address, nbytes);
-        }
-        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "Address %p on"
-                     " image %lu NOT found in cache.", remote_address,
-                     node + 1);
+    /* data NOT in the shared segment OR bigger than cacheline */
+    if (remote_address < cache_segment_start(node) ||
+        remote_address + nbytes > cache_segment_end(node) ||
+        nbytes > getCache_line_size) {
+        PROFILE_GETCACHE(bypasses);
+        gasnet_get(local_address, node, remote_address, nbytes);
+    } else {
+        cache_read(node, remote_address, nbytes, local_address);
     }
 
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
@@ -1408,58 +1685,51 @@ static void cache_check_and_get_strided(void *remote_src,
 {
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "entry");
 
-    void *cache_address = cache_all_images[node]->remote_address;
-    size_t start_offset;
-    void *cache_line_address = cache_all_images[node]->cache_line_address;
     size_t size;
+    size_t num_blks;
+    size_t cnt_strides[stride_levels + 1];
+    void *src_ptr = remote_src;
+    void *dest_ptr = local_dest;
     int i, j;
 
     size = src_strides[stride_levels - 1] * (count[stride_levels] - 1)
         + count[0];
 
-    /* data in cache */
-    if (cache_address > 0 && remote_src >= cache_address &&
-        remote_src + size <= cache_address + getCache_line_size) {
-        LIBCAF_TRACE(LIBCAF_LOG_CACHE,
-                     "Address %p on image %lu found in cache.", remote_src,
-                     node + 1);
-        start_offset = remote_src - cache_address;
-        if (cache_all_images[node]->handle) {
-            gasnet_wait_syncnb(cache_all_images[node]->handle);
-            cache_all_images[node]->handle = 0;
-        }
-
-        local_strided_copy(cache_line_address + start_offset,
-                           src_strides, local_dest, dest_strides,
-                           count, stride_levels);
-
-
-    } else {                    /*data not in cache */
-
-        /* data NOT from end of shared segment OR bigger than cacheline */
-        if (((remote_src + getCache_line_size) <=
-             (coarray_start_all_images[node].addr + shared_memory_size))
-            && (size <= getCache_line_size)) {
-            LIBCAF_TRACE(LIBCAF_LOG_CACHE,
-                         "Data for Address %p on image %lu NOT found in cache.",
-                         remote_src, node + 1);
-
-            gasnet_get(cache_line_address, node, remote_src,
-                       getCache_line_size);
-            cache_all_images[node]->remote_address = remote_src;
-            cache_all_images[node]->handle = 0;
+    /* data NOT in the shared segment OR bigger than cacheline */
+    if (remote_src < cache_segment_start(node) ||
+        remote_src + size > cache_segment_end(node) ||
+        size > getCache_line_size) {
+        PROFILE_GETCACHE(bypasses);
+        LIBCAF_TRACE(LIBCAF_LOG_COMM, "gasnet_gets_bulk from"
+                     " %p on image %lu to %p (stride_levels= %u)",
+                     remote_src, node + 1, local_dest, stride_levels);
+
+        gasnet_gets_bulk(local_dest, dest_strides, node, remote_src,
+                         src_strides, count, stride_levels);
+        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
+        return;
+    }
 
-            local_strided_copy(cache_line_address,
-                               src_strides, local_dest, dest_strides,
-                               count, stride_levels);
-        } else {
-            LIBCAF_TRACE(LIBCAF_LOG_COMM, "gasnet_gets_bulk from"
-                         " %p on image %lu to %p (stride_levels= %u)",
-                         remote_src, node + 1, local_dest, stride_levels);
+    /* copy block by block, as in local_strided_copy */
+    num_blks = 1;
+    cnt_strides[0] = 1;
+    for (i = 1; i <= stride_levels; i++) {
+        cnt_strides[i] = cnt_strides[i - 1] * count[i];
+        num_blks *= count[i];
+    }
 
-            gasnet_gets_bulk(local_dest, dest_strides, node, remote_src,
-                             src_strides, count, stride_levels);
+    for (i = 1; i <= num_blks; i++) {
+        cache_read(node, src_ptr, count[0], dest_ptr);
+        if (i == num_blks)
+            break;
+        for (j = 1; j <= stride_levels; j++) {
+            if (i % cnt_strides[j])
+                break;
+            src_ptr -= (count[j] - 1) * src_strides[j - 1];
+            dest_ptr -= (count[j] - 1) * dest_strides[j - 1];
         }
+        src_ptr += src_strides[j - 1];
+        dest_ptr += dest_strides[j - 1];
     }
 
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
@@ -1472,35 +1742,37 @@ static void update_cache(size_t node, void *remote_address,
 {
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "entry");
 
-    void *cache_address = cache_all_images[node]->remote_address;
-    size_t start_offset;
-    void *cache_line_address = cache_all_images[node]->cache_line_address;
-    if (cache_address > 0 && remote_address >= cache_address &&
-        remote_address + nbytes <= cache_address + getCache_line_size) {
-        start_offset = remote_address - cache_address;
-        memcpy(cache_line_address + start_offset, local_address, nbytes);
+    void *end = remote_address + nbytes;
+    size_t first, last, i;
+
+    if (cache_all_images[node]->lines == NULL ||
+        remote_address < cache_segment_start(node) ||
+        end > cache_segment_end(node) || nbytes == 0) {
+        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
+        return;
+    }
+
+    first = cache_tag(node, remote_address);
+    last = cache_tag(node, end - 1);
+    for (i = 0; i < cache_overlap_count(first, last); i++) {
+        struct cache_line *line = cache_overlap_line(node, first, last, i);
+        void *from, *to;
+
+        if (!line)
+            continue;
+
+        from = remote_address > line->remote_address ?
+            remote_address : line->remote_address;
+        to = end < line->remote_address + line->nbytes ?
+            end : line->remote_address + line->nbytes;
+
+        /* an outstanding prefetch would overwrite the new value */
+        cache_line_sync(line);
+        memcpy(line->cache_line_address + (from - line->remote_address),
+               local_address + (from - remote_address), to - from);
         LIBCAF_TRACE(LIBCAF_LOG_CACHE, "Value of address %p on"
                      " image %lu updated in cache due to write conflict.",
-                     remote_address, node + 1);
-    } else if (cache_address > 0 &&
-               remote_address >= cache_address &&
-               remote_address <= cache_address + getCache_line_size) {
-        start_offset = remote_address - cache_address;
-        nbytes = getCache_line_size - start_offset;
-        memcpy(cache_line_address + start_offset, local_address, nbytes);
-        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "Value of address %p on"
-                     " image %lu partially updated in cache (write conflict).",
-                     remote_address, node + 1);
-    } else if (cache_address > 0 &&
-               remote_address + nbytes >= cache_address &&
-               remote_address + nbytes <=
-               cache_address + getCache_line_size) {
-        start_offset = cache_address - remote_address;
-        nbytes = nbytes - start_offset;
-        memcpy(cache_line_address, local_address + start_offset, nbytes);
-        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "Value of address %p on"
-                     " image %lu partially updated in cache (write conflict).",
-                     remote_address, node + 1);
+                     from, node + 1);
     }
 
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
@@ -1515,45 +1787,43 @@ static void update_cache_strided(void *remote_dest_address,
 {
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "entry");
 
-    void *cache_address = cache_all_images[node]->remote_address;
-    size_t start_offset;
-    void *cache_line_address = cache_all_images[node]->cache_line_address;
     size_t size;
+    size_t first, last, i;
+
+    if (cache_all_images[node]->lines == NULL) {
+        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
+        return;
+    }
 
     /* calculate max size (very conservative!) */
     size = (dest_strides[stride_levels - 1] * (count[stride_levels] - 1))
         + count[0];
 
-    /* New data completely fit into cache */
-    if (cache_address > 0 && remote_dest_address >= cache_address &&
-        remote_dest_address + size <= cache_address + getCache_line_size) {
-        start_offset = remote_dest_address - cache_address;
+    if (remote_dest_address < cache_segment_start(node) ||
+        remote_dest_address + size > cache_segment_end(node)) {
+        LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
+        return;
+    }
 
-        local_strided_copy(local_src_address, src_strides,
-                           cache_line_address + start_offset, dest_strides,
-                           count, stride_levels);
+    /* make the overlapping lines invalid */
+    first = cache_tag(node, remote_dest_address);
+    last = cache_tag(node, remote_dest_address + size - 1);
+    for (i = 0; i < cache_overlap_count(first, last); i++) {
+        struct cache_line *line = cache_overlap_line(node, first, last, i);
 
-        LIBCAF_TRACE(LIBCAF_LOG_CACHE, " Value of address %p on"
-                     " image %lu updated in cache due to write conflict.",
-                     remote_dest_address, node + 1);
-    }
-    /* Some memory overlap */
-    else if (cache_address > 0 &&
-             ((remote_dest_address + size > cache_address &&
-               remote_dest_address + size <
-               cache_address + getCache_line_size)
-              || (remote_dest_address > cache_address
-                  && remote_dest_address <
-                  cache_address + getCache_line_size)
-             )) {
-        //make it invalid
-        cache_all_images[node]->remote_address = 0;
+        if (line) {
+            cache_line_sync(line);
+            line->remote_address = 0;
+            PROFILE_GETCACHE(invalidations);
+            LIBCAF_TRACE(LIBCAF_LOG_CACHE, "Line %lu of image %lu"
+                         " invalidated due to write conflict.",
+                         line->tag, node + 1);
+        }
     }
 
     LIBCAF_TRACE(LIBCAF_LOG_CACHE, "exit");
 }
 
-
 /*****************************************************************
  *      Helper Routines for Non-blocking Support
  *****************************************************************/
@@ -1777,6 +2047,9 @@ static void wait_on_all_pending_accesses_to_proc(unsigned long proc)
 
     LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
 
+    if (enable_put_combine)
+        wait_on_combined_puts_to_proc(proc);
+
     handle_node = nb_mgr[PUTS].handles[proc];
     while (handle_node) {
         if (handle_node->handle != GASNET_INVALID_HANDLE)
@@ -1819,6 +2092,10 @@ static inline void wait_on_all_pending_accesses()
     int i;
     LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
 
+    /* send all combined puts before waiting on any of them */
+    if (enable_put_combine)
+        wait_on_all_combined_puts();
+
     for (i = 0; i < num_procs; i++) {
         wait_on_all_pending_accesses_to_proc(i);
     }
@@ -1828,6 +2105,127 @@ static inline void wait_on_all_pending_accesses()
 }
 
 
+/*****************************************************************
+ *                  Write Combining
+ ****************************************************************/
+
+/* Small contiguous puts to an image are appended to its buffer as
+ * (target, nbytes, data) records, and the buffer is sent in a single
+ * active message once it is full, at sync points, before an atomic, or
+ * before an access which overlaps a put in the buffer. GASNet does not
+ * order active messages, so only one buffer per image is in flight at a
+ * time. */
+
+static void put_combine_send(size_t proc)
+{
+    struct put_combine_buffer *b = &put_combine[proc];
+
+    if (b->used == 0)
+        return;
+
+    GASNET_BLOCKUNTIL(!b->in_flight);
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "sending %lu combined puts (%lu bytes)"
+                 " to image %lu", b->nputs, b->used, proc + 1);
+
+    PROFILE_RMA_STORE_BEGIN(proc, b->used);
+
+    b->in_flight = 1;
+    b->min_in_flight_address = b->min_address;
+    b->max_in_flight_address = b->max_address;
+    /* the message is copied out before this returns */
+    gasnet_AMRequestMedium0(proc, GASNET_HANDLER_PUT_COMBINED_REQUEST,
+                            b->buf, b->used);
+
+    PROFILE_RMA_STORE_END(proc);
+
+    b->used = 0;
+    b->nputs = 0;
+    b->min_address = NULL;
+    b->max_address = NULL;
+}
+
+static void wait_on_combined_puts_to_proc(size_t proc)
+{
+    struct put_combine_buffer *b = &put_combine[proc];
+
+    put_combine_send(proc);
+    GASNET_BLOCKUNTIL(!b->in_flight);
+}
+
+static void wait_on_all_combined_puts()
+{
+    int i;
+
+    for (i = 0; i < num_procs; i++)
+        put_combine_send(i);
+    for (i = 0; i < num_procs; i++)
+        GASNET_BLOCKUNTIL(!put_combine[i].in_flight);
+}
+
+/* flushes the combined puts to proc if any may overlap the given range */
+static inline void wait_on_conflicting_combined_puts(size_t proc,
+                                                     void *remote_address,
+                                                     size_t size)
+{
+    struct put_combine_buffer *b;
+
+    if (!enable_put_combine)
+        return;
+
+    b = &put_combine[proc];
+    if ((b->used && remote_address < b->max_address &&
+         remote_address + size > b->min_address) ||
+        (b->in_flight && remote_address < b->max_in_flight_address &&
+         remote_address + size > b->min_in_flight_address)) {
+        wait_on_combined_puts_to_proc(proc);
+    }
+}
+
+/* Appends a put to the buffer of proc. Returns 0 if the put is not
+ * combined and should be sent on its own. */
+static int combine_put(size_t proc, void *remote_dest, void *src,
+                       size_t nbytes)
+{
+    struct put_combine_buffer *b = &put_combine[proc];
+    put_combine_record_t *r;
+    size_t record_size;
+
+    if (nbytes > PUT_COMBINE_MAX_XFER_SIZE || proc == my_proc)
+        return 0;
+
+    if (b->buf == NULL) {
+        if (put_combine_buffer_size > gasnet_AMMaxMedium())
+            put_combine_buffer_size = gasnet_AMMaxMedium();
+        if (put_combine_buffer_size < sizeof(put_combine_record_t) +
+            PUT_COMBINE_MAX_XFER_SIZE)
+            return 0;
+        b->buf = comm_malloc(put_combine_buffer_size);
+        if (b->buf == NULL)
+            Error("could not allocate write-combining buffer for image %lu",
+                  proc + 1);
+    }
+
+    record_size = sizeof(*r) + ((nbytes + 7) & ~(size_t) 7);
+    if (b->used + record_size > put_combine_buffer_size)
+        put_combine_send(proc);
+
+    r = (put_combine_record_t *) (b->buf + b->used);
+    r->target = remote_dest;
+    r->nbytes = nbytes;
+    memcpy(b->buf + b->used + sizeof(*r), src, nbytes);
+
+    if (b->used == 0 || remote_dest < b->min_address)
+        b->min_address = remote_dest;
+    if (b->used == 0 || remote_dest + nbytes > b->max_address)
+        b->max_address = remote_dest + nbytes;
+    b->used += record_size;
+    b->nputs++;
+
+    return 1;
+}
+
+
 /*****************************************************************
  *                  Shared Memory Management
  ****************************************************************/
@@ -1928,10 +2326,28 @@ void comm_memory_free()
     comm_free(nb_mgr[GETS].min_nb_address);
     comm_free(nb_mgr[GETS].max_nb_address);
 
-    if (enable_get_cache) {
+    if (enable_put_combine) {
         int i;
+        for (i = 0; i < num_procs; i++)
+            comm_free(put_combine[i].buf);
+        comm_free(put_combine);
+    }
+
+    if (enable_get_cache) {
+        int i, l;
+
+        if (get_env_flag(ENV_GETCACHE_STATS, DEFAULT_ENABLE_GETCACHE_STATS))
+            profile_getcache_report();
+
         for (i = 0; i < num_procs; i++) {
-            comm_free(cache_all_images[i]->cache_line_address);
+            struct cache_line *lines = cache_all_images[i]->lines;
+            if (lines) {
+                for (l = 0; l < getCache_sets * getCache_ways; l++) {
+                    cache_line_sync(&lines[l]);
+                    comm_free(lines[l].cache_line_address);
+                }
+                comm_free(lines);
+            }
             comm_free(cache_all_images[i]);
         }
         comm_free(cache_all_images);
@@ -2044,7 +2460,7 @@ void comm_barrier_all()
     gasnet_barrier_wait(barcount, barflag);
 
     if (enable_get_cache)
-        refetch_all_cache();
+        invalidate_all_cache();
 
     barcount += 1;
 
@@ -2106,7 +2522,7 @@ void comm_sync_all(int *status, int stat_len, char *errmsg, int errmsg_len)
     }
 
     if (enable_get_cache)
-        refetch_all_cache();
+        invalidate_all_cache();
 
     barcount += 1;
 
@@ -2129,7 +2545,7 @@ void comm_sync_memory(int *status, int stat_len, char *errmsg,
     wait_on_all_pending_accesses();
 
     if (enable_get_cache)
-        refetch_all_cache();
+        invalidate_all_cache();
 
     LOAD_STORE_FENCE();
 
@@ -2190,7 +2606,7 @@ void comm_sync_images(int *image_list, int image_count, int *status,
         sync_images_flag[q]--;
         gasnet_hsl_unlock(&sync_lock);
         if (enable_get_cache)
-            refetch_cache(q);
+            invalidate_cache(q);
     }
 
     LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
@@ -2497,6 +2913,7 @@ void comm_nbread(size_t proc, void *src, void *dest, size_t nbytes,
     remote_src = get_remote_address(src, proc);
     if (nb_mgr[PUTS].handles[proc])
         wait_on_pending_accesses(proc, remote_src, nbytes, PUTS);
+    wait_on_conflicting_combined_puts(proc, remote_src, nbytes);
 
     if (enable_get_cache) {
         cache_check_and_get(proc, remote_src, nbytes, dest);
@@ -2580,6 +2997,7 @@ void comm_read(size_t proc, void *src, void *dest, size_t nbytes)
     remote_src = get_remote_address(src, proc);
     if (nb_mgr[PUTS].handles[proc])
         wait_on_pending_accesses(proc, remote_src, nbytes, PUTS);
+    wait_on_conflicting_combined_puts(proc, remote_src, nbytes);
 
     if (enable_get_cache) {
         cache_check_and_get(proc, remote_src, nbytes, dest);
@@ -2630,6 +3048,24 @@ void comm_write_from_lcb(size_t proc, void *dest, void *src, size_t nbytes,
     }
 
     remote_dest = get_remote_address(dest, proc);
+
+    if (enable_put_combine && hdl != (void *) -1) {
+        if (nb_mgr[PUTS].handles[proc])
+            wait_on_pending_accesses(proc, remote_dest, nbytes, PUTS);
+        if (combine_put(proc, remote_dest, src, nbytes)) {
+            if (enable_get_cache)
+                update_cache(proc, remote_dest, nbytes, src);
+            comm_lcb_free(src);
+            if (hdl != NULL)
+                *hdl = NULL;
+
+            LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+            return;
+            /* does not reach */
+        }
+    }
+    wait_on_conflicting_combined_puts(proc, remote_dest, nbytes);
+
     if (ordered) {
         LIBCAF_TRACE(LIBCAF_LOG_COMM, "Before gasnet_put_nb to %p on "
                      "image %lu from %p size %lu",
@@ -2759,6 +3195,23 @@ void comm_write(size_t proc, void *dest, void *src,
     }
 
     remote_dest = get_remote_address(dest, proc);
+
+    if (enable_put_combine && hdl != (void *) -1) {
+        if (nb_mgr[PUTS].handles[proc])
+            wait_on_pending_accesses(proc, remote_dest, nbytes, PUTS);
+        if (combine_put(proc, remote_dest, src, nbytes)) {
+            if (enable_get_cache)
+                update_cache(proc, remote_dest, nbytes, src);
+            if (hdl != NULL)
+                *hdl = NULL;
+
+            LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+            return;
+            /* does not reach */
+        }
+    }
+    wait_on_conflicting_combined_puts(proc, remote_dest, nbytes);
+
     if (ordered) {
         /* use gasnet_put_nb to ensure local completion. If 2-, 4-, or
          * 8-bytes, it needs to be aligned */
@@ -2892,6 +3345,7 @@ void comm_strided_nbread(size_t proc,
         if (nb_mgr[PUTS].handles[proc]) {
             wait_on_pending_accesses(proc, remote_src, size, PUTS);
         }
+        wait_on_conflicting_combined_puts(proc, remote_src, size);
 
         if (enable_get_cache) {
 
@@ -2971,6 +3425,7 @@ void comm_strided_read(size_t proc,
         if (nb_mgr[PUTS].handles[proc]) {
             wait_on_pending_accesses(proc, remote_src, size, PUTS);
         }
+        wait_on_conflicting_combined_puts(proc, remote_src, size);
 
         if (enable_get_cache) {
 
@@ -3038,6 +3493,7 @@ void comm_strided_write_from_lcb(size_t proc,
 
             if (nb_mgr[PUTS].handles[proc])
                 wait_on_pending_accesses(proc, remote_dest, size, PUTS);
+            wait_on_conflicting_combined_puts(proc, remote_dest, size);
 
             PROFILE_RMA_STORE_STRIDED_BEGIN(proc, stride_levels, count);
 
@@ -3087,6 +3543,7 @@ void comm_strided_write_from_lcb(size_t proc,
 
             if (nb_mgr[PUTS].handles[proc])
                 wait_on_pending_accesses(proc, remote_dest, size, PUTS);
+            wait_on_conflicting_combined_puts(proc, remote_dest, size);
 
             PROFILE_RMA_STORE_STRIDED_BEGIN(proc, stride_levels, count);
 
@@ -3184,6 +3641,7 @@ void comm_strided_write(size_t proc,
 
             if (nb_mgr[PUTS].handles[proc])
                 wait_on_pending_accesses(proc, remote_dest, size, PUTS);
+            wait_on_conflicting_combined_puts(proc, remote_dest, size);
 
             /* GASNet doesn't provide non-contiguous, non-blocking PUT that
              * guarantees local completion. It may be cheaper to do
@@ -3249,6 +3707,7 @@ void comm_strided_write(size_t proc,
 
             if (nb_mgr[PUTS].handles[proc])
                 wait_on_pending_accesses(proc, remote_dest, size, PUTS);
+            wait_on_conflicting_combined_puts(proc, remote_dest, size);
 
             PROFILE_RMA_STORE_STRIDED_BEGIN(proc, stride_levels, count);
 
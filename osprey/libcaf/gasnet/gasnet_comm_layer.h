@@ -52,7 +52,9 @@ enum {
     GASNET_HANDLER_PUT_REQUEST = 135,
     GASNET_HANDLER_PUT_REPLY = 136,
     GASNET_HANDLER_GET_REQUEST = 137,
-    GASNET_HANDLER_GET_REPLY = 138
+    GASNET_HANDLER_GET_REPLY = 138,
+    GASNET_HANDLER_PUT_COMBINED_REQUEST = 139,
+    GASNET_HANDLER_PUT_COMBINED_REPLY = 140
 };
 
 #define GASNET_Safe(fncall) do {                                      \
@@ -105,11 +107,43 @@ struct nb_handle_manager {
     void **max_nb_address;
 };
 
+/* WRITE COMBINING OPTIMIZATION */
+/* a combined put in the buffer, followed by its data padded to 8 bytes */
+typedef struct {
+    void *target;
+    size_t nbytes;
+} put_combine_record_t;
+
+/* small puts to one image, sent together in one active message */
+struct put_combine_buffer {
+    void *buf;
+    size_t used;
+    unsigned long nputs;
+    void *min_address;          /* remote range of the buffered puts */
+    void *max_address;
+    volatile int in_flight;     /* sent, and not acknowledged yet */
+    void *min_in_flight_address;
+    void *max_in_flight_address;
+};
+
 /* GET CACHE OPTIMIZATION */
-struct cache {
-    void *remote_address;
+struct cache_line {
+    void *remote_address;       /* start of the line, 0 if invalid */
     void *cache_line_address;
-    gasnet_handle_t handle;
+    size_t nbytes;              /* short for the last line of a segment */
+    size_t tag;                 /* line number in the remote segment */
+    gasnet_handle_t handle;     /* outstanding prefetch */
+    unsigned long last_use;     /* for LRU replacement */
+    int prefetched;             /* prefetched and not read yet */
+};
+
+/* get-cache of one remote image */
+struct cache {
+    struct cache_line *lines;   /* getCache_sets x getCache_ways */
+    unsigned long use_clock;
+    /* stride between the last misses, for prefetching */
+    size_t last_miss_tag;
+    long stride;
 };
 
 #endif
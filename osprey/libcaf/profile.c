@@ -33,6 +33,25 @@
 #include "util.h"
 #include "profile.h"
 
+extern unsigned long _this_image;
+
+getcache_stats_t getcache_stats;
+
+/* prints the get-cache statistics of this image to stderr */
+void profile_getcache_report()
+{
+    unsigned long reads = getcache_stats.hits + getcache_stats.misses;
+
+    fprintf(stderr, "image %lu: get-cache %lu hits, %lu misses"
+            " (%.1f%% hit rate), %lu uncached reads, %lu prefetches"
+            " (%lu used), %lu invalidated lines\n", _this_image,
+            getcache_stats.hits, getcache_stats.misses,
+            reads ? 100.0 * getcache_stats.hits / reads : 0.0,
+            getcache_stats.bypasses, getcache_stats.prefetches,
+            getcache_stats.prefetch_hits, getcache_stats.invalidations);
+}
+
+#ifdef PCAF_INSTRUMENT
 
 typedef struct rma_node_t {
     int rmaid;
@@ -40,8 +59,6 @@ typedef struct rma_node_t {
     struct rma_node_t *next, *prev;
 } rma_node_t;
 
-extern unsigned long _this_image;
-
 rma_node_t *saved_store_rma_list = NULL;
 rma_node_t *saved_load_rma_list = NULL;
 
@@ -283,3 +300,5 @@ void uhcaf_profile_resume()
 {
     profiling_enabled = 1;
 }
+
+#endif                          /* PCAF_INSTRUMENT */
@@ -29,6 +29,23 @@
 #ifndef _PROFILE_H
 #define _PROFILE_H
 
+/* get-cache statistics of this image, kept whether or not the runtime is
+ * instrumented */
+typedef struct {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long bypasses;     /* reads larger than a line */
+    unsigned long prefetches;
+    unsigned long prefetch_hits;
+    unsigned long invalidations;
+} getcache_stats_t;
+
+extern getcache_stats_t getcache_stats;
+
+#define PROFILE_GETCACHE(event)     (getcache_stats.event++)
+
+void profile_getcache_report();
+
 #ifndef PCAF_INSTRUMENT
 
 #define PROFILE_REGION_ENTRY(rname,grp,rtype)                        ((void) 1)
@@ -0,0 +1 @@
+../alloc.c
\ No newline at end of file
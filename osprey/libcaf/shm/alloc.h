@@ -0,0 +1 @@
+../alloc.h
\ No newline at end of file
@@ -0,0 +1 @@
+../caf_collectives.c
\ No newline at end of file
@@ -0,0 +1 @@
+../caf_collectives.h
\ No newline at end of file
@@ -0,0 +1 @@
+../caf_rtl.c
\ No newline at end of file
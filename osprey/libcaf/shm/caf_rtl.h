@@ -0,0 +1 @@
+../caf_rtl.h
\ No newline at end of file
@@ -0,0 +1 @@
+../comm.h
\ No newline at end of file
@@ -0,0 +1 @@
+../env.c
\ No newline at end of file
@@ -0,0 +1 @@
+../env.h
\ No newline at end of file
@@ -0,0 +1 @@
+../lock.c
\ No newline at end of file
@@ -0,0 +1 @@
+../lock.h
\ No newline at end of file
@@ -0,0 +1 @@
+../profile.c
\ No newline at end of file
@@ -0,0 +1,1093 @@
+/*
+ Shared Memory Communication Layer for supporting Coarray Fortran
+
+ Copyright (C) 2009-2013 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+/*
+ * All images run on one node. At init the launching process maps one
+ * shared, anonymous region holding a control block and a segment per
+ * image, then forks the images. Every image therefore sees every segment
+ * at the same address, so reads and writes are plain memory copies,
+ * atomics are processor atomics on the target word, and nothing is ever
+ * left in flight: every non-blocking operation completes before it
+ * returns and every handle handed back is NULL.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#if defined(__linux__)
+#include <sys/prctl.h>
+#endif
+#include "caf_rtl.h"
+#include "comm.h"
+#include "alloc.h"
+#include "env.h"
+#include "lock.h"
+#include "shm_comm_layer.h"
+#include "trace.h"
+#include "util.h"
+#include "profile.h"
+
+
+extern unsigned long _this_image;
+extern unsigned long _num_images;
+extern mem_usage_info_t *mem_info;
+
+/* common_slot is a node in the shared memory link-list that keeps track
+ * of available memory that can used for both allocatable coarrays and
+ * asymmetric data. */
+extern shared_memory_slot_t *common_slot;
+
+/*
+ * Static Variable declarations
+ */
+static unsigned long my_proc;
+static unsigned long num_procs;
+
+static unsigned long static_symm_data_total_size_ = 0;
+#pragma weak static_symm_data_total_size = static_symm_data_total_size_
+extern unsigned long static_symm_data_total_size;
+
+/* control block, pids of the images and sync images counters, all in the
+ * shared mapping. sync_images_flag[q * num_procs + p] counts the sync
+ * images notifications image p has sent to image q. */
+static shm_control_t *shm_ctl = NULL;
+static volatile pid_t *image_pids;
+static volatile int *sync_images_flag;
+
+/* sense of this image in the barrier */
+static int barrier_sense = 0;
+
+/* Shared memory management:
+ * coarray_start_all_images stores the shared memory start address of all
+ * images, which is the same in every image */
+static void **coarray_start_all_images = NULL;
+static unsigned long shared_memory_size;
+
+/* image stoppage info */
+static unsigned short *stopped_image_exists = NULL;
+static unsigned short *this_image_stopped = NULL;
+
+/* guards critical sections */
+static lock_t *critical_lock;
+
+
+/* Local function declarations */
+static void *get_remote_address(void *src, size_t img);
+static void local_strided_copy(void *src, const size_t src_strides[],
+                               void *dest, const size_t dest_strides[],
+                               const size_t count[], size_t stride_levels);
+static unsigned long spawn_images();
+static void shm_barrier();
+
+
+
+/* must call comm_init() first */
+inline size_t comm_get_proc_id()
+{
+    return my_proc;
+}
+
+/* must call comm_init() first */
+inline size_t comm_get_num_procs()
+{
+    return num_procs;
+}
+
+/**************************************************************
+ *       Shared (RMA) Memory Segment Address Ranges
+ **************************************************************/
+
+inline ssize_t comm_address_translation_offset(size_t proc)
+{
+    char *remote_base_address = coarray_start_all_images[proc];
+    return remote_base_address -
+        (char *) coarray_start_all_images[my_proc];
+}
+
+inline void *comm_start_shared_mem(size_t proc)
+{
+    return get_remote_address(coarray_start_all_images[my_proc], proc);
+}
+
+inline void *comm_start_symmetric_mem(size_t proc)
+{
+    return comm_start_shared_mem(proc);
+}
+
+inline void *comm_start_static_data(size_t proc)
+{
+    return comm_start_shared_mem(proc);
+}
+
+inline void *comm_end_static_data(size_t proc)
+{
+    return (char *) comm_start_shared_mem(proc) +
+        static_symm_data_total_size;
+}
+
+inline void *comm_start_allocatable_heap(size_t proc)
+{
+    return comm_end_static_data(proc);
+}
+
+inline void *comm_end_allocatable_heap(size_t proc)
+{
+    return comm_end_symmetric_mem(proc);
+}
+
+inline void *comm_end_symmetric_mem(size_t proc)
+{
+    /* we can't directly use common_slot->addr as the argument, because the
+     * translation algorithm will treat it as part of the asymmetric memory
+     * space */
+    return get_remote_address(common_slot->addr - 1, proc) + 1;
+}
+
+inline void *comm_start_asymmetric_heap(size_t proc)
+{
+    if (proc != my_proc) {
+        return comm_end_symmetric_mem(proc);
+    } else {
+        return (char *) common_slot->addr + common_slot->size;
+    }
+}
+
+inline void *comm_end_asymmetric_heap(size_t proc)
+{
+    return comm_end_shared_mem(proc);
+}
+
+inline void *comm_end_shared_mem(size_t proc)
+{
+    return comm_start_shared_mem(proc) + shared_memory_size;
+}
+
+static inline int address_in_symmetric_mem(void *addr)
+{
+    void *start_symm_mem;
+    void *end_symm_mem;
+
+    start_symm_mem = coarray_start_all_images[my_proc];
+    end_symm_mem = common_slot->addr;
+
+    return (addr >= start_symm_mem && addr < end_symm_mem);
+}
+
+int comm_address_in_shared_mem(void *addr)
+{
+    void *start_shared_mem;
+    void *end_shared_mem;
+
+    start_shared_mem = coarray_start_all_images[my_proc];
+    end_shared_mem = start_shared_mem + shared_memory_size;
+
+    return (addr >= start_shared_mem && addr < end_shared_mem);
+}
+
+
+
+/**************************************************************
+ *                Memory Copy Helper Routines
+ **************************************************************/
+
+/* naive implementation of strided copy
+ * TODO: improve by finding maximal blocksize
+ */
+static void local_strided_copy(void *src, const size_t src_strides[],
+                               void *dest, const size_t dest_strides[],
+                               const size_t count[], size_t stride_levels)
+{
+    int i, j;
+    size_t num_blks;
+    size_t cnt_strides[stride_levels + 1];
+    void *dest_ptr = dest;
+    void *src_ptr = src;
+
+    /* assuming src_elem_size=dst_elem_size */
+    size_t blk_size = count[0];
+    num_blks = 1;
+    cnt_strides[0] = 1;
+    for (i = 1; i <= stride_levels; i++) {
+        cnt_strides[i] = cnt_strides[i - 1] * count[i];
+        num_blks *= count[i];
+    }
+
+    for (i = 1; i <= num_blks; i++) {
+        memcpy(dest_ptr, src_ptr, blk_size);
+        for (j = 1; j <= stride_levels; j++) {
+            if (i % cnt_strides[j])
+                break;
+            src_ptr -= (count[j] - 1) * src_strides[j - 1];
+            dest_ptr -= (count[j] - 1) * dest_strides[j - 1];
+        }
+        src_ptr += src_strides[j - 1];
+        dest_ptr += dest_strides[j - 1];
+    }
+}
+
+/* called in every wait loop: there is nothing to progress, so give the
+ * CPU to the image being waited on once the flag has been polled for a
+ * while */
+static inline void spin_wait(int *spins)
+{
+    if (++(*spins) < SHM_SPIN_COUNT) {
+        LOAD_STORE_FENCE();
+    } else {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+
+
+/*****************************************************************
+ *                      INITIALIZATION
+ *****************************************************************/
+
+/*
+ * spawn_images:
+ * The launching process forks one process per image and stays behind to
+ * wait for them. If an image fails, or does error termination, the others
+ * are killed and the launching process exits with its status. Returns the
+ * index of the calling image; only images return.
+ */
+
+static unsigned long spawn_images()
+{
+    unsigned long i;
+    unsigned long remaining;
+    int status;
+    int exit_code = 0;
+    pid_t pid;
+
+    if (num_procs == 1) {
+        image_pids[0] = getpid();
+        return 0;
+    }
+
+    /* don't let the images inherit buffered output */
+    fflush(NULL);
+
+    for (i = 0; i < num_procs; i++) {
+        pid = fork();
+        if (pid == 0) {
+#if defined(__linux__)
+            /* go down with the launching process */
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            if (getppid() == 1)
+                _exit(1);
+#endif
+            image_pids[i] = getpid();
+            return i;
+        } else if (pid < 0) {
+            fprintf(stderr, "** LIBCAF ERROR: could not start image %lu "
+                    "(%s)\n", i + 1, strerror(errno));
+            while (i-- > 0)
+                kill(image_pids[i], SIGKILL);
+            exit(1);
+        }
+        image_pids[i] = pid;
+    }
+
+    remaining = num_procs;
+    while (remaining > 0) {
+        pid = wait(&status);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (i = 0; i < num_procs; i++) {
+            if (image_pids[i] == pid) {
+                image_pids[i] = 0;
+                remaining--;
+                break;
+            }
+        }
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+            shm_ctl->error_stop == 0)
+            continue;
+
+        if (exit_code == 0) {
+            exit_code = WIFEXITED(status) ? WEXITSTATUS(status)
+                : 128 + WTERMSIG(status);
+        }
+        for (i = 0; i < num_procs; i++) {
+            if (image_pids[i] != 0)
+                kill(image_pids[i], SIGKILL);
+        }
+    }
+
+    exit(exit_code);
+    /* does not reach */
+}
+
+/*
+ * comm_init:
+ * 1) Map the control block and the segments of all images, and fork the
+ *    images.
+ * 2) Populates common_slot with this image's segment, which is used by
+ *    alloc.c to allocate/deallocate coarrays.
+ * 3) Allocate the critical section lock and stoppage flags in the
+ *    symmetric heap.
+ */
+
+void comm_init()
+{
+    int i;
+    long pagesize;
+    unsigned long caf_shared_memory_size;
+    unsigned long image_heap_size;
+    size_t control_size;
+    size_t mapping_size;
+    char *mapping;
+    shared_memory_slot_t *common_shared_memory_slot;
+
+    if (common_slot != NULL) {
+        LIBCAF_TRACE(LIBCAF_LOG_FATAL,
+                     "common_slot has already been initialized");
+    }
+
+    common_slot = malloc(sizeof(shared_memory_slot_t));
+    common_shared_memory_slot = common_slot;
+
+    /* Get total shared memory size, per image, requested by program (enough
+     * space for save coarrays + heap). */
+    caf_shared_memory_size = static_symm_data_total_size;
+    image_heap_size = get_env_size(ENV_IMAGE_HEAP_SIZE,
+                                   DEFAULT_IMAGE_HEAP_SIZE);
+    caf_shared_memory_size += image_heap_size;
+
+    __f90_set_args(ARGC, ARGV);
+
+    num_procs = get_env_size(ENV_NUM_IMAGES, DEFAULT_NUM_IMAGES);
+    if (num_procs == 0)
+        num_procs = 1;
+
+    if (num_procs >= MAX_NUM_IMAGES) {
+        Error("Number of images may not exceed %lu", MAX_NUM_IMAGES);
+    }
+
+    if (caf_shared_memory_size / 1024 >= MAX_SHARED_MEMORY_SIZE / 1024) {
+        Error("Image shared memory size must not exceed %lu GB",
+              MAX_SHARED_MEMORY_SIZE / (1024 * 1024 * 1024));
+    }
+
+    /* segments are page aligned, so that images don't share pages */
+    pagesize = sysconf(_SC_PAGESIZE);
+    caf_shared_memory_size = (caf_shared_memory_size + pagesize - 1)
+        / pagesize * pagesize;
+    control_size = sizeof(shm_control_t) + num_procs * sizeof(pid_t)
+        + num_procs * num_procs * sizeof(int);
+    control_size = (control_size + pagesize - 1) / pagesize * pagesize;
+    mapping_size = control_size + num_procs * caf_shared_memory_size;
+
+    /* pages are only backed once touched, and start out zeroed */
+    mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+        Error("mmap of %lu bytes of shared memory failed (%s)",
+              (unsigned long) mapping_size, strerror(errno));
+    }
+
+    shm_ctl = (shm_control_t *) mapping;
+    image_pids = (pid_t *) (mapping + sizeof(shm_control_t));
+    sync_images_flag = (int *) (image_pids + num_procs);
+
+    coarray_start_all_images = malloc(num_procs * sizeof(void *));
+    for (i = 0; i < num_procs; i++) {
+        coarray_start_all_images[i] = mapping + control_size
+            + i * caf_shared_memory_size;
+    }
+
+    my_proc = spawn_images();
+
+    /* set extern symbols used for THIS_IMAGE and NUM_IMAGES intrinsics */
+    _this_image = my_proc + 1;
+    _num_images = num_procs;
+
+    LIBCAF_TRACE_INIT();
+    LIBCAF_TRACE(LIBCAF_LOG_INIT, "after spawning %lu images", num_procs);
+
+    allocate_static_symm_data(coarray_start_all_images[my_proc]);
+
+    /* initialize common shared memory slot */
+    common_shared_memory_slot->addr = coarray_start_all_images[my_proc]
+        + static_symm_data_total_size;
+    common_shared_memory_slot->size = caf_shared_memory_size
+        - static_symm_data_total_size;
+    common_shared_memory_slot->feb = 0;
+    common_shared_memory_slot->next = 0;
+    common_shared_memory_slot->prev = 0;
+
+    shared_memory_size = caf_shared_memory_size;
+
+    /* allocate space in symmetric heap for memory usage info */
+    mem_info = (mem_usage_info_t *)
+        coarray_allocatable_allocate_(sizeof(*mem_info));
+    mem_info->current_heap_usage = sizeof(*mem_info);
+    mem_info->max_heap_usage = sizeof(*mem_info);
+    mem_info->reserved_heap_usage =
+        caf_shared_memory_size - static_symm_data_total_size;
+    mem_info->free_slots = 0;
+    mem_info->free_slots_size = 0;
+
+    /* create a symmetric lock variable for guarding critical sections */
+    critical_lock =
+        (lock_t *) coarray_allocatable_allocate_(sizeof(lock_t));
+
+    /* allocate space for recording image termination */
+    stopped_image_exists =
+        (unsigned short *) coarray_allocatable_allocate_(sizeof(short));
+    this_image_stopped =
+        (unsigned short *) coarray_allocatable_allocate_(sizeof(short));
+
+    *stopped_image_exists = 0;
+    *this_image_stopped = 0;
+
+    LIBCAF_TRACE(LIBCAF_LOG_INIT, "Finished. Waiting for global barrier."
+                 "common_slot->addr=%p, common_slot->size=%lu",
+                 common_shared_memory_slot->addr,
+                 common_shared_memory_slot->size);
+
+    comm_barrier_all();
+
+    LIBCAF_TRACE(LIBCAF_LOG_INIT, "exit");
+}
+
+
+/*****************************************************************
+ *                  Shared Memory Management
+ ****************************************************************/
+
+/* It should allocate memory to all static coarrays/targets from the
+ * shared memory created during init */
+void set_static_symm_data_(void *base_address)
+{
+    /* do nothing */
+}
+
+#pragma weak set_static_symm_data = set_static_symm_data_
+void set_static_symm_data(void *base_address);
+
+
+void allocate_static_symm_data(void *base_address)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
+    set_static_symm_data(base_address);
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+}
+
+void comm_translate_remote_addr(void **remote_addr, int proc)
+{
+    void *start_symm_mem, *end_symm_mem;
+    start_symm_mem = comm_start_symmetric_mem(proc);
+    end_symm_mem = comm_end_symmetric_mem(proc);
+
+    /* subtract the offset if remote address falls within the symmetric memory
+     * of the remote image
+     */
+    if (*remote_addr >= start_symm_mem && *remote_addr < end_symm_mem) {
+        *remote_addr = (char *) (*remote_addr) -
+            comm_address_translation_offset(proc);
+    }
+}
+
+/* Calculate the address on another image corresponding to a local address
+ * This is possible as all images must have the same coarrays, i.e the
+ * memory is symmetric. Addresses outside the symmetric memory already
+ * point into the segment of the image they belong to, and are valid as
+ * they are in every image. */
+static void *get_remote_address(void *src, size_t img)
+{
+    size_t offset;
+    if ((img == my_proc) || !address_in_symmetric_mem(src))
+        return src;
+    offset = src - coarray_start_all_images[my_proc];
+    return coarray_start_all_images[img] + offset;
+}
+
+/****************************************************************
+ *                         FINALIZATION
+ ****************************************************************/
+
+void comm_memory_free()
+{
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
+
+    if (coarray_start_all_images) {
+        coarray_free_all_shared_memory_slots(); /* in caf_rtl.c */
+        comm_free(coarray_start_all_images);
+        coarray_start_all_images = NULL;
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+}
+
+/* tell every image that this image has stopped */
+static void set_this_image_stopped()
+{
+    int p;
+
+    *this_image_stopped = 1;
+    for (p = 0; p < num_procs; p++) {
+        *(unsigned short *) get_remote_address(stopped_image_exists, p) = 1;
+    }
+    LOAD_STORE_FENCE();
+}
+
+void comm_exit(int status)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_EXIT, "entry");
+
+    if (shm_ctl == NULL) {
+        /* images have not been started yet */
+        exit(status);
+    }
+
+    set_this_image_stopped();
+
+    /* the launching process takes down the other images */
+    shm_ctl->error_stop = 1;
+    LOAD_STORE_FENCE();
+
+    comm_memory_free();
+    LIBCAF_TRACE(LIBCAF_LOG_EXIT, "exit with status %d.", status);
+
+    exit(status);
+}
+
+void comm_finalize(int exit_code)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_EXIT, "entry");
+
+    set_this_image_stopped();
+
+    comm_barrier_all();
+    comm_memory_free();
+
+    LIBCAF_TRACE(LIBCAF_LOG_EXIT, "exit");
+    exit(exit_code);
+
+    /* does not reach */
+}
+
+/***************************************************************
+ *                      SYNCHRONIZATION
+ ***************************************************************/
+
+/* sense-reversing barrier on the control block. The atomic increment is a
+ * full fence, so every write before the barrier is visible to all images
+ * after it. */
+static void shm_barrier()
+{
+    int spins = 0;
+
+    barrier_sense = !barrier_sense;
+    if (SYNC_FETCH_AND_ADD(&shm_ctl->barrier_count, 1) == num_procs - 1) {
+        shm_ctl->barrier_count = 0;
+        LOAD_STORE_FENCE();
+        shm_ctl->barrier_sense = barrier_sense;
+    } else {
+        while (shm_ctl->barrier_sense != barrier_sense)
+            spin_wait(&spins);
+    }
+    LOAD_STORE_FENCE();
+}
+
+/* TODO: Right now, for every critical section we simply acquire a lock on
+ * image 1. Instead, we should define a lock for each critical section in
+ * order to allow execution of different critical sections at the same time.
+ */
+
+void comm_critical()
+{
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
+
+    comm_lock(critical_lock, 1, NULL, 0);
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+}
+
+void comm_end_critical()
+{
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
+
+    comm_unlock(critical_lock, 1, NULL, 0);
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+}
+
+void comm_barrier_all()
+{
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
+
+    shm_barrier();
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+}
+
+void comm_sync(comm_handle_t hdl)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
+
+    /* all accesses complete before they return */
+    LOAD_STORE_FENCE();
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+}
+
+void comm_sync_all(int *status, int stat_len, char *errmsg, int errmsg_len)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
+
+    if (status != NULL) {
+        memset(status, 0, (size_t) stat_len);
+        *((INT2 *) status) = STAT_SUCCESS;
+    }
+    if (errmsg != NULL && errmsg_len) {
+        memset(errmsg, 0, (size_t) errmsg_len);
+    }
+
+    LOAD_STORE_FENCE();
+    if (status != NULL && *stopped_image_exists == 1) {
+        *((INT2 *) status) = STAT_STOPPED_IMAGE;
+        /* no barrier */
+    } else {
+        shm_barrier();
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+}
+
+void comm_sync_memory(int *status, int stat_len, char *errmsg,
+                      int errmsg_len)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
+
+    if (status != NULL) {
+        memset(status, 0, (size_t) stat_len);
+        *((INT2 *) status) = STAT_SUCCESS;
+    }
+    if (errmsg != NULL && errmsg_len) {
+        memset(errmsg, 0, (size_t) errmsg_len);
+    }
+
+    LOAD_STORE_FENCE();
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+}
+
+void comm_sync_images(int *image_list, int image_count, int *status,
+                      int stat_len, char *errmsg, int errmsg_len)
+{
+    int i;
+    volatile int *check_flag;   /* flag to wait on locally */
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "entry");
+
+    if (status != NULL) {
+        memset(status, 0, (size_t) stat_len);
+        *((INT2 *) status) = STAT_SUCCESS;
+    }
+    if (errmsg != NULL && errmsg_len) {
+        memset(errmsg, 0, (size_t) errmsg_len);
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "Syncing with"
+                 " %d images", image_count);
+
+    /* the atomic increment makes earlier writes visible to image q */
+    for (i = 0; i < image_count; i++) {
+        int q = image_list[i] - 1;
+        if (my_proc == q) {
+            continue;
+        }
+        (void) SYNC_FETCH_AND_ADD(&sync_images_flag[q * num_procs +
+                                                    my_proc], 1);
+    }
+
+    for (i = 0; i < image_count; i++) {
+        int spins = 0;
+        int q = image_list[i] - 1;
+        if (my_proc == q) {
+            continue;
+        }
+
+        check_flag = &sync_images_flag[my_proc * num_procs + q];
+
+        LIBCAF_TRACE(LIBCAF_LOG_SYNC, "Waiting on image %lu.", q + 1);
+
+        while (*check_flag == 0) {
+            if (status != NULL &&
+                *(unsigned short *) get_remote_address(this_image_stopped,
+                                                       q)) {
+                LOAD_STORE_FENCE();
+                if (*check_flag == 0) {
+                    *((INT2 *) status) = STAT_STOPPED_IMAGE;
+                    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+                    return;
+                }
+            }
+            spin_wait(&spins);
+        }
+
+        /* dont just make it 0, maybe more than 1 sync_images are present
+         * back to back */
+        (void) SYNC_FETCH_AND_ADD(check_flag, -1);
+
+        LIBCAF_TRACE(LIBCAF_LOG_SYNC, "Sync image over");
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_SYNC, "exit");
+}
+
+/***************************************************************
+ *                        ATOMICS
+ ***************************************************************/
+
+void comm_swap_request(void *target, void *value, size_t nbytes,
+                       int proc, void *retval)
+{
+    void *remote_address;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+    check_remote_address(proc + 1, target);
+    remote_address = get_remote_address(target, proc);
+
+    /* SYNC_SWAP is only an acquire barrier */
+    LOAD_STORE_FENCE();
+
+    if (nbytes == sizeof(INT4)) {
+        *(INT4 *) retval = SYNC_SWAP((INT4 *) remote_address,
+                                     *(INT4 *) value);
+    } else if (nbytes == sizeof(INT8)) {
+        *(INT8 *) retval = SYNC_SWAP((INT8 *) remote_address,
+                                     *(INT8 *) value);
+    } else if (nbytes == sizeof(INT1)) {
+        *(INT1 *) retval = SYNC_SWAP((INT1 *) remote_address,
+                                     *(INT1 *) value);
+    } else if (nbytes == sizeof(INT2)) {
+        *(INT2 *) retval = SYNC_SWAP((INT2 *) remote_address,
+                                     *(INT2 *) value);
+    } else {
+        Error("unsupported nbytes (%lu) in comm_swap_request",
+              (unsigned long) nbytes);
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+void
+comm_cswap_request(void *target, void *cond, void *value,
+                   size_t nbytes, int proc, void *retval)
+{
+    void *remote_address;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+    check_remote_address(proc + 1, target);
+    remote_address = get_remote_address(target, proc);
+
+    if (nbytes == sizeof(INT4)) {
+        *(INT4 *) retval = SYNC_CSWAP((INT4 *) remote_address,
+                                      *(INT4 *) cond, *(INT4 *) value);
+    } else if (nbytes == sizeof(INT8)) {
+        *(INT8 *) retval = SYNC_CSWAP((INT8 *) remote_address,
+                                      *(INT8 *) cond, *(INT8 *) value);
+    } else if (nbytes == sizeof(INT1)) {
+        *(INT1 *) retval = SYNC_CSWAP((INT1 *) remote_address,
+                                      *(INT1 *) cond, *(INT1 *) value);
+    } else if (nbytes == sizeof(INT2)) {
+        *(INT2 *) retval = SYNC_CSWAP((INT2 *) remote_address,
+                                      *(INT2 *) cond, *(INT2 *) value);
+    } else {
+        Error("unsupported nbytes (%lu) in comm_cswap_request",
+              (unsigned long) nbytes);
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+void comm_fadd_request(void *target, void *value, size_t nbytes, int proc,
+                       void *retval)
+{
+    void *remote_address;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+    check_remote_address(proc + 1, target);
+    remote_address = get_remote_address(target, proc);
+
+    if (nbytes == sizeof(INT4)) {
+        *(INT4 *) retval = SYNC_FETCH_AND_ADD((INT4 *) remote_address,
+                                              *(INT4 *) value);
+    } else if (nbytes == sizeof(INT8)) {
+        *(INT8 *) retval = SYNC_FETCH_AND_ADD((INT8 *) remote_address,
+                                              *(INT8 *) value);
+    } else if (nbytes == sizeof(INT1)) {
+        *(INT1 *) retval = SYNC_FETCH_AND_ADD((INT1 *) remote_address,
+                                              *(INT1 *) value);
+    } else if (nbytes == sizeof(INT2)) {
+        *(INT2 *) retval = SYNC_FETCH_AND_ADD((INT2 *) remote_address,
+                                              *(INT2 *) value);
+    } else {
+        Error("unsupported nbytes (%lu) in comm_fadd_request",
+              (unsigned long) nbytes);
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+void comm_fstore_request(void *target, void *value, size_t nbytes,
+                         int proc, void *retval)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+
+    comm_swap_request(target, value, nbytes, proc, retval);
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+/***************************************************************
+ *                    Local memory allocations
+ ***************************************************************/
+
+void *comm_lcb_malloc(size_t size)
+{
+    void *ptr;
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
+    /* allocate out of asymmetric heap if there is sufficient enough room */
+    ptr = coarray_asymmetric_allocate_if_possible_(size);
+    if (!ptr) {
+        ptr = malloc(size);
+    }
+
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+    return ptr;
+}
+
+void comm_lcb_free(void *ptr)
+{
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "entry");
+
+    if (!ptr) {
+        LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+        return;
+    }
+
+    if (!comm_address_in_shared_mem(ptr))
+        free(ptr);
+    else {
+        /* in shared memory segment, which means it was allocated using
+           coarray_asymmetric_allocate_ */
+        coarray_asymmetric_deallocate_(ptr);
+    }
+    LIBCAF_TRACE(LIBCAF_LOG_MEMORY, "exit");
+}
+
+void *comm_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void comm_free(void *ptr)
+{
+    if (!ptr)
+        return;
+    free(ptr);
+}
+
+/***************************************************************
+ *                  Read/Write Communication
+ ***************************************************************/
+
+void comm_service()
+{
+    /* nothing to progress; only called while waiting on another image */
+    sched_yield();
+}
+
+
+void comm_nbread(size_t proc, void *src, void *dest, size_t nbytes,
+                 comm_handle_t * hdl)
+{
+    comm_read(proc, src, dest, nbytes);
+
+    if (hdl != NULL)
+        *hdl = NULL;
+}
+
+void comm_read(size_t proc, void *src, void *dest, size_t nbytes)
+{
+    void *remote_src;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+
+    remote_src = get_remote_address(src, proc);
+
+    PROFILE_RMA_LOAD_BEGIN(proc, nbytes);
+    memcpy(dest, remote_src, nbytes);
+    PROFILE_RMA_LOAD_END(proc);
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM,
+                 "Read %lu bytes from %p on image %lu to %p",
+                 (unsigned long) nbytes, remote_src, proc + 1, dest);
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+void comm_write_from_lcb(size_t proc, void *dest, void *src, size_t nbytes,
+                         int ordered, comm_handle_t * hdl)
+{
+    comm_write(proc, dest, src, nbytes, ordered, hdl);
+    comm_lcb_free(src);
+}
+
+/* like comm_write_from_lcb, except we don't need to "release" the source
+ * buffer upon completion. The copy is remotely complete when it returns,
+ * whether ordered or not.
+ */
+void comm_write(size_t proc, void *dest, void *src,
+                size_t nbytes, int ordered, comm_handle_t * hdl)
+{
+    void *remote_dest;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+
+    remote_dest = get_remote_address(dest, proc);
+
+    PROFILE_RMA_STORE_BEGIN(proc, nbytes);
+    memcpy(remote_dest, src, nbytes);
+    PROFILE_RMA_STORE_END(proc);
+
+    if (hdl != NULL && hdl != (void *) -1)
+        *hdl = NULL;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM,
+                 "Wrote %lu bytes from %p to %p on image %lu",
+                 (unsigned long) nbytes, src, remote_dest, proc + 1);
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+
+void comm_strided_nbread(size_t proc,
+                         void *src, const size_t src_strides[],
+                         void *dest, const size_t dest_strides[],
+                         const size_t count[], size_t stride_levels,
+                         comm_handle_t * hdl)
+{
+    comm_strided_read(proc, src, src_strides, dest, dest_strides, count,
+                      stride_levels);
+
+    if (hdl != NULL)
+        *hdl = NULL;
+}
+
+void comm_strided_read(size_t proc,
+                       void *src, const size_t src_strides[],
+                       void *dest, const size_t dest_strides[],
+                       const size_t count[], size_t stride_levels)
+{
+    void *remote_src;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+
+    remote_src = get_remote_address(src, proc);
+
+    PROFILE_RMA_LOAD_STRIDED_BEGIN(proc, stride_levels, count);
+    local_strided_copy(remote_src, src_strides, dest, dest_strides,
+                       count, stride_levels);
+    PROFILE_RMA_LOAD_END(proc);
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "Read from %p on image %lu to %p "
+                 "(stride_levels= %u)", remote_src, proc + 1, dest,
+                 stride_levels);
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+
+void comm_strided_write_from_lcb(size_t proc,
+                                 void *dest, const size_t dest_strides[],
+                                 void *src, const size_t src_strides[],
+                                 const size_t count[],
+                                 size_t stride_levels, int ordered,
+                                 comm_handle_t * hdl)
+{
+    comm_strided_write(proc, dest, dest_strides, src, src_strides, count,
+                       stride_levels, ordered, hdl);
+    comm_lcb_free(src);
+}
+
+/* like comm_strided_write_from_lcb, except we don't need to "release" the
+ * source buffer upon completion
+ */
+void comm_strided_write(size_t proc,
+                        void *dest,
+                        const size_t dest_strides[], void *src,
+                        const size_t src_strides[],
+                        const size_t count[],
+                        size_t stride_levels, int ordered,
+                        comm_handle_t * hdl)
+{
+    void *remote_dest;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "entry");
+
+    remote_dest = get_remote_address(dest, proc);
+
+    PROFILE_RMA_STORE_STRIDED_BEGIN(proc, stride_levels, count);
+    local_strided_copy(src, src_strides, remote_dest, dest_strides,
+                       count, stride_levels);
+    PROFILE_RMA_STORE_END(proc);
+
+    if (hdl != NULL && hdl != (void *) -1)
+        *hdl = NULL;
+
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "Wrote from %p to %p on image %lu "
+                 "(stride_levels= %u)", src, remote_dest, proc + 1,
+                 stride_levels);
+    LIBCAF_TRACE(LIBCAF_LOG_COMM, "exit");
+}
+
+#ifdef PCAF_INSTRUMENT
+
+/***************************************************************
+ *                      Profiling Support
+ ***************************************************************/
+
+void profile_comm_handle_end(comm_handle_t hdl)
+{
+    /* no handle is ever left pending */
+}
+#endif
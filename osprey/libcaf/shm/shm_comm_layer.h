@@ -0,0 +1,55 @@
+/*
+ Shared Memory Communication Layer for supporting Coarray Fortran
+
+ Copyright (C) 2009-2013 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+
+#ifndef SHM_COMM_LAYER_H
+#define SHM_COMM_LAYER_H
+
+#include <sys/types.h>
+
+#define SHM_CACHE_LINE_SIZE  64
+
+/* busy-wait this many times on a flag before yielding the CPU */
+#define SHM_SPIN_COUNT       1000
+
+/* Control block at the start of the shared mapping, shared by all images.
+ * It is followed by the pids of the images and by the sync images
+ * counters, and then by one segment per image. */
+typedef struct {
+    /* sense-reversing barrier */
+    volatile int barrier_count;
+    volatile int barrier_sense;
+    char pad1[SHM_CACHE_LINE_SIZE - 2 * sizeof(int)];
+
+    /* set by an image on error termination, so that the launching process
+     * takes down the others */
+    volatile int error_stop;
+    char pad2[SHM_CACHE_LINE_SIZE - sizeof(int)];
+} shm_control_t;
+
+#endif
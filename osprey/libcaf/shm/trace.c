@@ -0,0 +1 @@
+../trace.c
\ No newline at end of file
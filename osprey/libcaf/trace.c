@@ -219,15 +219,25 @@ void __libcaf_tracers_init(void)
 static void __print_memory_summary(char *mem_usg_str)
 {
     if (mem_info) {
+        /* fragmentation is the part of the free memory that lies outside
+         * the common slot */
+        size_t free_size = mem_info->free_slots_size +
+            (common_slot ? common_slot->size : 0);
         snprintf(mem_usg_str, BUF_SIZE,
                  " current usage: %lu bytes (%.2lf%%), "
-                 " max usage: %lu bytes (%.2lf%%)\n",
+                 " max usage: %lu bytes (%.2lf%%)\n"
+                 "\t free slots: %lu (%lu bytes), "
+                 " fragmentation: %.2lf%%\n",
                  (unsigned long) mem_info->current_heap_usage,
                  100 * mem_info->current_heap_usage /
                  ((double) mem_info->reserved_heap_usage),
                  (unsigned long) mem_info->max_heap_usage,
                  100 * mem_info->max_heap_usage /
-                 ((double) mem_info->reserved_heap_usage));
+                 ((double) mem_info->reserved_heap_usage),
+                 (unsigned long) mem_info->free_slots,
+                 (unsigned long) mem_info->free_slots_size,
+                 free_size ? 100 * mem_info->free_slots_size /
+                 ((double) free_size) : 0.0);
     }
 }
 
@@ -15,6 +15,11 @@
 #include "acc_log.h"
 #include "vector.h"
 #include "acc_hashmap.h"
+#include "acc_present.h"
+#include "acc_mempool.h"
+#include "acc_pinned.h"
+#include "acc_queue.h"
+#include "acc_profile.h"
 
 #define max(a,b) (((a) > (b)) ? (a) : (b))
 #define min(a,b) (((a) < (b)) ? (a) : (b))
@@ -54,6 +59,20 @@ typedef enum
 	ACC_KDATA_DOUBLE
 } ACC_KERNEL_DATA_TYPE;
 
+/* the operator of a reduction, as the compiler passes it to __accr_fused_reduction_add */
+typedef enum
+{
+	ACC_REDUCTION_ADD = 0,
+	ACC_REDUCTION_MPY,
+	ACC_REDUCTION_MAX,
+	ACC_REDUCTION_MIN,
+	ACC_REDUCTION_BAND,
+	ACC_REDUCTION_BIOR,
+	ACC_REDUCTION_BXOR,
+	ACC_REDUCTION_CAND,
+	ACC_REDUCTION_CIOR
+} ACC_REDUCTION_OPR;
+
 
 typedef enum
 {
@@ -64,6 +83,7 @@ typedef enum
 } TRANSFER_TYPE;
 
 #define ACC_OK 0
+#define ACC_ERROR_NO_DEVICE 1
 
 #define acc_host_alloc(size) __acc_malloc_handler((size))
 #define acc_host_alloc_zero(size) memset(acc_host_alloc(size), 0, (size))
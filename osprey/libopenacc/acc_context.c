@@ -5,38 +5,79 @@
 
 #include "acc_context.h"
 #include "acc_kernel.h"
+#include "acc_reduction.h"
 
 
 context_t *context;
 acc_gpu_config_t *__acc_gpu_config;
 
-void __accr_setup(void)
+static acc_device_t __accr_select_device(acc_device_t device_type);
+
+static void __accr_setup_device(acc_device_t device_type);
+
+/*
+ * acc_device_default follows ACC_DEVICE_TYPE, e.g. ACC_DEVICE_TYPE=host
+ * runs everything on the host backend. That only works for programs which
+ * provide host versions of their kernels, see acc_host.c.
+ */
+static acc_device_t __accr_select_device(acc_device_t device_type)
 {
+	char *env;
 
-	/* it may have other initializations */
-	__acc_gpu_config_create(&__acc_gpu_config);
+	if(device_type == acc_device_default || device_type == acc_device_none)
+	{
+		env = getenv("ACC_DEVICE_TYPE");
+		if(env != NULL && (strcmp(env, "host") == 0 || strcmp(env, "HOST") == 0))
+			return acc_device_host;
+		return acc_device_default;
+	}
 
-	
+	return device_type;
+}
+
+static void __accr_setup_device(acc_device_t device_type)
+{
 	context = (context_t*)malloc(sizeof(context_t));
-	context->device_type = acc_device_cuda;
-//	cuDeviceGetName(context->name, 512, 0);
-	cuDeviceGet(&(context->cu_device), 0);
-	cuCtxCreate(&(context->cu_context), 0, context->cu_device);
+
+	if(device_type != acc_device_host)
+	{
+		if(__acc_gpu_config_create(&__acc_gpu_config) == ACC_OK)
+		{
+			context->device_type = acc_device_cuda;
+//			cuDeviceGetName(context->name, 512, 0);
+			cuDeviceGet(&(context->cu_device), 0);
+			cuCtxCreate(&(context->cu_context), 0, context->cu_device);
+			return;
+		}
+
+		/* no fallback to the host: compiled kernels only exist for CUDA */
+		ERROR(("No device available, abort"));
+	}
+
+	context->device_type = acc_device_host;
+	__accr_host_setup();
+	__acc_host_config_create(&__acc_gpu_config);
 }
 
-void acc_init(acc_device_t device_type)
+void __accr_setup(void)
 {
-	/*To do: add the support for different accel types */
-	__accr_setup();
 
-	/*
-	 * used for asynchronous streams, the stream array has
-	 * 12 elements, the last is reserved for default stream
-	 */
-	MODULE_BASE = 11;
+	/* it may have other initializations */
+	__accr_setup_device(__accr_select_device(acc_device_default));
+	__accr_profile_init();
+}
+
+void acc_init(acc_device_t device_type)
+{
+	__accr_setup_device(__accr_select_device(device_type));
+	__accr_profile_init();
 
     /* set up the default shared memory size */
     __accr_set_default_shared_mem_size();
+
+	/* eagerly load the kernel modules in ACC_PRELOAD_MODULES */
+	if(!ACC_ON_HOST())
+		__accr_preload_kernel_modules();
 }
 
 int __acc_gpu_config_create(acc_gpu_config_t** _config)
@@ -47,14 +88,16 @@ int __acc_gpu_config_create(acc_gpu_config_t** _config)
 	/* so far we just use the first device */
 	device_id = 0;
 	
-	cuInit(0);
+	if(cuInit(0) != CUDA_SUCCESS)
+		return ACC_ERROR_NO_DEVICE;
 
 	config = acc_host_alloc_zero(sizeof(*config));
 
 	cuDeviceGetCount(&(config->num_devices));
 	if(config->num_devices == 0)
 	{
-		ERROR(("No device available, abort"));
+		acc_host_free(config);
+		return ACC_ERROR_NO_DEVICE;
 	}
 	
 	cuDeviceComputeCapability(&(config->major), &(config->minor), device_id);
@@ -99,6 +142,31 @@ int __acc_gpu_config_create(acc_gpu_config_t** _config)
 	return ACC_OK;
 }
 
+/*
+ * the limits of the host backend, gangs and vectors are only bounded
+ * by what fits into an int
+ */
+int __acc_host_config_create(acc_gpu_config_t** _config)
+{
+	acc_gpu_config_t *config;
+	int i;
+
+	config = acc_host_alloc_zero(sizeof(*config));
+
+	config->num_devices = 1;
+	config->shared_mem_size = 48*1024;
+	config->max_threads_per_block = 1024;
+	for(i = 0; i < 3; i++)
+	{
+		config->max_block_dim[i] = 1024;
+		config->max_grid_dim[i] = INT_MAX;
+	}
+
+	INFO(("Host device with %d threads", __accr_host_get_num_threads()));
+	*_config = config;
+	return ACC_OK;
+}
+
 void __acc_gpu_config_destroy(acc_gpu_config_t* config)
 {
 	acc_host_free(config);
@@ -107,8 +175,21 @@ void __acc_gpu_config_destroy(acc_gpu_config_t* config)
 void __accr_cleanup(void)
 {
 	CUresult ret;
-	ret = cuCtxDestroy(context->cu_context);
-	CUDA_CHECK(ret);
+
+	/* the profiler reads its events, and cached blocks are freed, while the context is alive */
+	__accr_profile_finish();
+	__accr_destroy_fused_reduction();
+	__accr_destroy_device_pool();
+
+	if(ACC_ON_HOST())
+		__accr_host_cleanup();
+	else
+	{
+		__accr_destroy_kernel_cache();
+		acc_pinned_destroy();
+		ret = cuCtxDestroy(context->cu_context);
+		CUDA_CHECK(ret);
+	}
 
 	__acc_gpu_config_destroy(__acc_gpu_config);
 }
@@ -8,6 +8,7 @@
 
 #include "acc_common.h"
 #include "acc_data.h"
+#include "acc_host.h"
 
 typedef struct context_s{
 	acc_device_t device_type;
@@ -48,6 +49,9 @@ extern acc_gpu_config_t *__acc_gpu_config;
 
 extern context_t *context;
 
+/* whether the runtime executes on the host backend */
+#define ACC_ON_HOST() (context != NULL && context->device_type == acc_device_host)
+
 extern void __accr_setup(void);
 
 extern void acc_init(acc_device_t);
@@ -58,5 +62,7 @@ extern void acc_shutdown(acc_device_t);
 
 extern int __acc_gpu_config_create(acc_gpu_config_t** config);
 
+extern int __acc_host_config_create(acc_gpu_config_t** config);
+
 extern void __acc_gpu_config_destroy(acc_gpu_config_t* config);
 #endif
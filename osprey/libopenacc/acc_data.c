@@ -5,24 +5,43 @@
 
 #include "acc_data.h"
 
-vector param_list;
-acc_hashmap* map = NULL;
-cudaStream_t async_streams[12] = {NULL};
-int MODULE_BASE;
+__thread acc_kernel_frame_t __accr_kernel_frame;
+acc_present_table* present_table = NULL;
+acc_mempool_t* device_pool = NULL;
 
-static int __accr_remove_device_from_hashmap(void* pDevice);
+static void* __accr_cuda_pool_alloc(size_t size);
+
+static void __accr_cuda_pool_free(void* ptr);
+
+static void* __accr_cuda_pool_fence_record(void);
+
+static int __accr_cuda_pool_fence_done(void* fence);
+
+static void __accr_cuda_pool_fence_wait(void* fence);
+
+static void __accr_cuda_pool_fence_release(void* fence);
+
+static void __accr_memcpy_h2d_async(void* pDevice, void* pHost, size_t size, cudaStream_t stream);
+
+static void __accr_memcpy_d2h_async(void* pHost, void* pDevice, size_t size, cudaStream_t stream);
+
+static acc_mempool_backend_t cuda_pool_backend = {
+	"device", __accr_cuda_pool_alloc, __accr_cuda_pool_free,
+	__accr_cuda_pool_fence_record, __accr_cuda_pool_fence_done,
+	__accr_cuda_pool_fence_wait, __accr_cuda_pool_fence_release
+};
 
 extern void _w2c_mstore(void* src, int src_offset, void* dst, int dst_offset, int ilength)
 {
     memcpy(dst+dst_offset, src+src_offset, ilength);
 }
 
-void* __acc_malloc_handler(unsigned int size)
+void* __acc_malloc_handler(size_t size)
 {
 	void *ptr;
     ptr = malloc(size);
     if(ptr == NULL)
-		ERROR(("Cannot allocate %u bytes of memory", (size)));
+		ERROR(("Cannot allocate %lu bytes of memory", (size)));
 	   
 	return ptr;
 }
@@ -37,10 +56,10 @@ void __acc_free_handler(void* ptr)
  * the data allocated by acc_malloc does not have host address
  * i.e. the host address is NULL
  */
-void* acc_malloc(unsigned int size)
+void* acc_malloc(size_t size)
 {
 	void *ptr;
-	__accr_malloc_on_device(NULL, &ptr, size);
+	__accr_malloc_on_device(NULL, &ptr, size, 0);
 	return ptr;
 }
 
@@ -49,132 +68,277 @@ void acc_free(void* ptr)
 	__accr_free_on_device(ptr);
 }
 
-/* allocate memory on device */
-void __accr_malloc_on_device(void* pHost, void** pDevice, unsigned int size)
+static void* __accr_cuda_pool_alloc(size_t size)
 {
-	CUDART_CHECK( cudaMalloc(pDevice, size) );
-	/*add the data in the hashmap*/
-	param_t *param = (param_t*)malloc(sizeof(param_t));
-	param->host_addr = pHost;
-	param->device_addr = *pDevice;
-	param->size = size;
-	if(map == NULL)
-		map = acc_hashmap_create();
-	acc_hashmap_put(map, map->size, param);
+	void *ptr;
+
+	if(cudaMalloc(&ptr, size) != cudaSuccess)
+	{
+		/* clear the error so that the pool can trim and retry */
+		cudaGetLastError();
+		return NULL;
+	}
+	return ptr;
+}
+
+static void __accr_cuda_pool_free(void* ptr)
+{
+	CUDART_CHECK( cudaFree(ptr) );
+}
+
+/*
+ * a freed block may still be read or written by kernels and copies on
+ * any stream, so the pool keeps it until the work queued then is done
+ */
+static void* __accr_cuda_pool_fence_record(void)
+{
+	return __accr_record_fence();
+}
+
+static int __accr_cuda_pool_fence_done(void* fence)
+{
+	return __accr_test_fence((acc_queue_fence_t*)fence);
+}
+
+static void __accr_cuda_pool_fence_wait(void* fence)
+{
+	__accr_wait_fence((acc_queue_fence_t*)fence);
+}
+
+static void __accr_cuda_pool_fence_release(void* fence)
+{
+	__accr_release_fence((acc_queue_fence_t*)fence);
+}
+
+/*
+ * ACC_MEMPOOL_SIZE is the number of megabytes of freed device memory the
+ * runtime keeps for reuse, 0 gives every free back to the device
+ */
+void __accr_create_device_pool(void)
+{
+	char *env;
+	size_t limit;
+
+	limit = ACC_MEMPOOL_DEFAULT_SIZE;
+	env = getenv("ACC_MEMPOOL_SIZE");
+	if(env != NULL)
+		limit = (size_t)strtoul(env, NULL, 10);
+
+	if(ACC_ON_HOST())
+		device_pool = acc_mempool_create(&acc_mempool_host_backend, limit << 20);
+	else
+		device_pool = acc_mempool_create(&cuda_pool_backend, limit << 20);
+}
+
+void __accr_destroy_device_pool(void)
+{
+	acc_mempool_stats_t stats;
+
+	if(device_pool == NULL)
+		return;
+
+	acc_mempool_get_stats(device_pool, &stats);
+	INFO(("Device memory pool: %lu hits (%lu waited for the device), %lu misses, %lu bytes cached, %lu bytes trimmed",
+				stats.hits, stats.fence_waits, stats.misses, stats.bytes_cached, stats.bytes_trimmed));
+
+	acc_mempool_destroy(device_pool);
+	device_pool = NULL;
+}
+
+/*
+ * allocate size bytes on device for the data at pHost+offset, e.g. the
+ * sub-array a[lo:n] of the host array pHost=a at offset lo*sizeof(a[0]).
+ * *pDevice is the device address which corresponds to pHost, as given by
+ * __accr_get_device_addr, so that it is indexed like the host array;
+ * only [*pDevice+offset, *pDevice+offset+size) is allocated.
+ */
+void __accr_malloc_on_device(void* pHost, void** pDevice, size_t size, size_t offset)
+{
+	void *pHostData;
+
+	if(device_pool == NULL)
+		__accr_create_device_pool();
+
+	pHostData = pHost != NULL ? pHost + offset : NULL;
+
+	/* on the host the device copy is the host data itself */
+	if(ACC_ON_HOST() && pHost != NULL)
+		*pDevice = pHost;
+	else
+	{
+		*pDevice = acc_mempool_alloc(device_pool, size) - offset;
+		if(ACC_PROFILING())
+			__accr_profile_alloc(ACC_PROF_ALLOC, size);
+	}
+
+	/*add the data in the present table*/
+	if(present_table == NULL)
+		present_table = acc_present_table_create();
+	acc_present_table_insert(present_table, pHostData, *pDevice + offset, size, offset);
 }
 
 void __accr_free_on_device(void* pDevice)
 {
-	if(pDevice)
-    {
-        /* since it will no longer be on the device, 
-         * it should be removed from the hash table */
-        __accr_remove_device_from_hashmap(pDevice);
-       
-        /* release the device memory */ 
-		CUDART_CHECK( cudaFree(pDevice) );
-    }
+	acc_present_entry *entry;
+	size_t size;
+	int owned;
+
+	if(pDevice == NULL)
+		return;
+
+	/* the block and its size are only known from the present table,
+	 * pDevice is the address of the array start given by the allocation */
+	entry = NULL;
+	if(present_table != NULL)
+		entry = acc_present_table_find_device_base(present_table, pDevice);
+	if(entry == NULL)
+		ERROR(("ERROR: The given address %p is not present on the device", pDevice));
+
+	pDevice = entry->device_addr;
+
+	size = entry->size;
+	/* on the host only the memory from acc_malloc is owned by the runtime */
+	owned = !(ACC_ON_HOST() && entry->host_addr != NULL);
+
+	/* since it will no longer be on the device, 
+	 * it should be removed from the present table */
+	acc_present_table_remove(present_table, entry);
+
+	/* give the device memory back to the pool */
+	if(owned)
+	{
+		acc_mempool_free(device_pool, pDevice, size);
+		if(ACC_PROFILING())
+			__accr_profile_alloc(ACC_PROF_FREE, size);
+	}
+}
+
+/*
+ * an asynchronous copy needs page-locked host memory: a range which is
+ * registered already is copied directly, a large one is registered,
+ * and a small one is copied through the staging buffers
+ */
+static void __accr_memcpy_h2d_async(void* pDevice, void* pHost, size_t size, cudaStream_t stream)
+{
+	if(acc_pinned_lookup(pHost, size)
+		|| (size > ACC_STAGING_THRESHOLD && acc_pinned_register(pHost, size)))
+		CUDART_CHECK( cudaMemcpyAsync(pDevice, pHost, size, cudaMemcpyHostToDevice, stream) );
+	else
+		acc_staging_h2d(pDevice, pHost, size, stream);
+}
+
+static void __accr_memcpy_d2h_async(void* pHost, void* pDevice, size_t size, cudaStream_t stream)
+{
+	if(acc_pinned_lookup(pHost, size)
+		|| (size > ACC_STAGING_THRESHOLD && acc_pinned_register(pHost, size)))
+		CUDART_CHECK( cudaMemcpyAsync(pHost, pDevice, size, cudaMemcpyDeviceToHost, stream) );
+	else
+		acc_staging_d2h(pHost, pDevice, size, stream);
 }
 
 void __accr_memin_h2d(void* pHost, 
 					  void* pDevice, 
-					  unsigned int size, 
-					  unsigned int offset,
+					  size_t size, 
+					  size_t offset,
 					  int async_expr)
 {
-	int stream_pos;
+	acc_prof_mark_t mark;
+	CUstream stream;
 
 	if(pHost == NULL || pDevice == NULL)
 		ERROR(("Error in uploading data from host to device"));
-	
-	if(async_expr < 0)	
-		CUDART_CHECK( cudaMemcpy(pDevice, pHost, size, cudaMemcpyHostToDevice) );
-	else if(async_expr == 0)
+
+	if(ACC_ON_HOST())
 	{
-		CUDART_CHECK( cudaHostRegister(pHost + offset, size, cudaHostRegisterMapped) );
+		/* nothing to copy when the device data aliases the host data */
+		if(pDevice != pHost)
+			memmove(pDevice + offset, pHost + offset, size);
+		return;
+	}
+	
+	stream = NULL;
+	if(async_expr >= 0)
+		stream = __accr_get_queue_stream(async_expr);
 
-		if(async_streams[MODULE_BASE] == NULL)
-		{
-			CUDA_CHECK( cuStreamCreate(&async_streams[MODULE_BASE], 0) );
-		}	
-		
-		CUDART_CHECK( cudaMemcpyAsync(pDevice + offset, 
-									     pHost + offset, 
-									     size, 
-									 	 cudaMemcpyHostToDevice, 
-									 	 async_streams[MODULE_BASE]) );
+	if(ACC_PROFILING())
+		__accr_profile_start(&mark, stream, 1);
 
-	}else
-	{
-		CUDART_CHECK( cudaHostRegister(pHost + offset, size, cudaHostRegisterMapped) );
-		stream_pos = async_expr % MODULE_BASE;
-		
-		if(async_streams[stream_pos] == NULL)
-		{
-			CUDA_CHECK( cuStreamCreate(&async_streams[stream_pos], 0) );
-		}	
-		
-		CUDART_CHECK( cudaMemcpyAsync(pDevice + offset, 
-									     pHost + offset, 
-									     size, 
-									 	 cudaMemcpyHostToDevice, 
-									 	 async_streams[stream_pos]) );
+	if(async_expr < 0)	
+		CUDART_CHECK( cudaMemcpy(pDevice + offset, pHost + offset, size, cudaMemcpyHostToDevice) );
+	else
+		__accr_memcpy_h2d_async(pDevice + offset, pHost + offset, size, stream);
 
-	}
+	if(ACC_PROFILING())
+		__accr_profile_transfer(&mark, stream, 1, ACC_PROF_H2D, size, async_expr);
 	
-	DEBUG(("Uploading %u bytes data", size));
+	DEBUG(("Uploading %lu bytes data", size));
 }
 
 void __accr_memout_d2h(void* pDevice, 
 					   void* pHost, 
-					   unsigned int size, 
-					   unsigned int offset,
+					   size_t size, 
+					   size_t offset,
 					   int async_expr)
 {
-	int stream_pos;
+	acc_prof_mark_t mark;
+	CUstream stream;
 
 	if(pHost == NULL || pDevice == NULL)
 		ERROR(("Error in downloading data from device to host"));
 
-	if(async_expr < 0)
-		CUDART_CHECK( cudaMemcpy(pHost, pDevice, size, cudaMemcpyDeviceToHost) );
-	else if(async_expr == 0)
+	if(ACC_ON_HOST())
 	{
-		CUDART_CHECK( cudaHostRegister(pHost + offset, size, cudaHostRegisterMapped) );
+		if(pDevice != pHost)
+			memmove(pHost + offset, pDevice + offset, size);
+		return;
+	}
 
-		if(async_streams[MODULE_BASE] == NULL)
-		{
-			CUDA_CHECK( cuStreamCreate(&async_streams[MODULE_BASE], 0) );	
-		}
-	 
-		CUDART_CHECK( cudaMemcpyAsync(pHost + offset, 
-	    	 						 	 pDevice + offset, 
-									 	 size, 
-										 cudaMemcpyDeviceToHost, 
-										 async_streams[MODULE_BASE]) );
-	}else
-	{
-		CUDART_CHECK( cudaHostRegister(pHost + offset, size, cudaHostRegisterMapped) );
+	stream = NULL;
+	if(async_expr >= 0)
+		stream = __accr_get_queue_stream(async_expr);
 
-		stream_pos = async_expr % MODULE_BASE;
-		if(async_streams[stream_pos] == NULL)
-		{
-			CUDA_CHECK( cuStreamCreate(&async_streams[stream_pos], 0) );	
-		}
-	 
-		CUDART_CHECK( cudaMemcpyAsync(pHost + offset, 
-	    	 						 	 pDevice + offset, 
-									 	 size, 
-										 cudaMemcpyDeviceToHost, 
-										 async_streams[stream_pos]) );
-	}
+	if(ACC_PROFILING())
+		__accr_profile_start(&mark, stream, 1);
+
+	if(async_expr < 0)
+		CUDART_CHECK( cudaMemcpy(pHost + offset, pDevice + offset, size, cudaMemcpyDeviceToHost) );
+	else
+		__accr_memcpy_d2h_async(pHost + offset, pDevice + offset, size, stream);
+
+	if(ACC_PROFILING())
+		__accr_profile_transfer(&mark, stream, 1, ACC_PROF_D2H, size, async_expr);
 	
-	DEBUG(("Downloading %u bytes data", size));
+	DEBUG(("Downloading %lu bytes data", size));
 }
 
 void __accr_init_param_list()
 {
-	param_list = vector_create(sizeof(param_t));
+	__accr_kernel_frame.count = 0;
+	__accr_kernel_frame.offset = 0;
+}
+
+/* 
+ * copy a parameter of size bytes into the packed parameter buffer 
+ * and append it to the argument list 
+ */
+static void* __accr_push_kernel_param(void* pValue, size_t size)
+{
+	acc_kernel_frame_t *frame = &__accr_kernel_frame;
+	size_t offset;
+	void *slot;
+
+	/* natural alignment, as in the kernel parameter space */
+	offset = (frame->offset + size - 1) & ~(size - 1);
+	if(frame->count >= ACC_MAX_KERNEL_PARAMS || 
+	   offset + size > ACC_KERNEL_PARAM_BUFFER_SIZE)
+		ERROR(("Too many kernel parameters"));
+
+	slot = frame->buffer + offset;
+	memcpy(slot, pValue, size);
+	frame->offset = offset + size;
+	frame->args[frame->count++] = slot;
+
+	return slot;
 }
 
 /* 
@@ -183,192 +347,129 @@ void __accr_init_param_list()
  */
 void __accr_push_kernel_param_pointer(void** pParam)
 {
-	if(param_list == NULL)
-		__accr_init_param_list();
-	param_t *param = (param_t*)malloc(sizeof(param_t));
-	param->device_addr = *pParam;
-	vector_pushback(param_list, param);
+	__accr_push_kernel_param(pParam, sizeof(void*));
 
-	DEBUG(("Pushed array, device_addr: %p", param->device_addr));
+	DEBUG(("Pushed array, device_addr: %p", *pParam));
 }
 
 /* 
  * Add a parameter to a kernel's parameter space 
- * This parameter is a scalar
+ * This parameter is a scalar, its size is only known by the kernel,
+ * so the value is read from pValue when the kernel is launched
  */
 void __accr_push_kernel_param_scalar(void* pValue)
 {
-	if(param_list == NULL)
-		__accr_init_param_list();
-	param_t *param = (param_t*)malloc(sizeof(param_t));
-	param->host_addr = pValue;
-	param->device_addr = NULL;
-	vector_pushback(param_list, param);
+	acc_kernel_frame_t *frame = &__accr_kernel_frame;
+
+	if(frame->count >= ACC_MAX_KERNEL_PARAMS)
+		ERROR(("Too many kernel parameters"));
+	frame->args[frame->count++] = pValue;
 	
-	DEBUG(("Pushed scalar, host_addr: %p", param->host_addr));
+	DEBUG(("Pushed scalar, host_addr: %p", pValue));
 }
 
 void __accr_push_kernel_param_int(int* iValue)
 {
-	if(param_list == NULL)
-		__accr_init_param_list();
-	param_t *param = (param_t*)malloc(sizeof(param_t));
-	param->host_addr = iValue;
-	param->device_addr = NULL;
-	param->size = sizeof(int);
-	vector_pushback(param_list, param);
+	__accr_push_kernel_param(iValue, sizeof(int));
 	
-	DEBUG(("Pushed int, host_addr: %p", param->host_addr));
+	DEBUG(("Pushed int, host_addr: %p", iValue));
 }
 
 void __accr_push_kernel_param_float(float* ftValue)
 {
-	if(param_list == NULL)
-		__accr_init_param_list();
-	param_t *param = (param_t*)malloc(sizeof(param_t));
-	param->host_addr = ftValue;
-	param->device_addr = NULL;
-	param->size = sizeof(float);
-	vector_pushback(param_list, param);
+	__accr_push_kernel_param(ftValue, sizeof(float));
 	
-	DEBUG(("Pushed float, host_addr: %p", param->host_addr));
+	DEBUG(("Pushed float, host_addr: %p", ftValue));
 }
 
 void __accr_push_kernel_param_double(double* dbValue)
 {
-	if(param_list == NULL)
-		__accr_init_param_list();
-	param_t *param = (param_t*)malloc(sizeof(param_t));
-	param->host_addr = dbValue;
-	param->device_addr = NULL;
-	param->size = sizeof(double);
-	vector_pushback(param_list, param);
+	__accr_push_kernel_param(dbValue, sizeof(double));
 	
-	DEBUG(("Pushed double, host_addr: %p", param->host_addr));
+	DEBUG(("Pushed double, host_addr: %p", dbValue));
 }
 
 void __accr_clean_param_list()
 {
-	vector_destroy(param_list);	
+	__accr_init_param_list();
 }
 
-/* given a host address, find the device address in the hash map */
-int __accr_get_device_addr(void* pHostAddr, void** pDeviceAddr, unsigned int istart, unsigned int isize)
+/*
+ * look up the mapping of the host range [pHostAddr+istart, pHostAddr+istart+isize).
+ * A sub-array of a mapped array is found through the interval index.
+ */
+static acc_present_entry* __accr_lookup_host_range(void* pHostAddr, size_t istart, size_t isize)
 {
-	int key, map_length;
-    param_t *param;
-    
-	/*if the map has not created yet*/
-    if(map == NULL)
-	{
-		WARN(("WARN: The data map has not created yet"));
-    	return 1;
-	}
+	acc_present_entry *entry;
 
-    map_length = map->capacity;
+	entry = acc_present_table_lookup_host(present_table, pHostAddr + istart, isize);
 
-	/* TO FIX: should not traverse the whole map, it should search by hash */
-    for(key=0; key<map_length; key++)
-    {
-        param = (param_t*)acc_hashmap_get(map, key);
-        if((param != NULL) && (param->host_addr == pHostAddr))
-        {
-            *pDeviceAddr = param->device_addr;
-            return 1;
-        }
-    }
+	if(ACC_PROFILING())
+		__accr_profile_present(entry != NULL);
 
-    ERROR(("ERROR: The device address for host address %p is not found", pHostAddr));
-    return 0;
+	return entry;
 }
 
-/* 
- *start, length, size not used now
- *pBuffer is host address
- *determine whehter a data whose host addr is pBuffer is in the hashmap
- */
-int __accr_present_create(void* pBuffer, unsigned int start, int length, unsigned int size)
+/* given a host address, find the device address in the present table */
+int __accr_get_device_addr(void* pHostAddr, void** pDeviceAddr, size_t istart, size_t isize)
 {
-	int key, map_length;
-	param_t *param;
-	/*if the map has not created yet*/
-	if(map == NULL)
+	acc_present_entry *entry;
+    
+	/*if the table has not created yet*/
+	if(present_table == NULL)
 	{
 		WARN(("WARN: The data map has not created yet"));
-		return 0;
+		return 1;
 	}
 
-	map_length = map->capacity;
-	
-	/* TO FIX: should not traverse the whole map, it should search by hash */
-	for(key=0; key<map_length; key++)
+	entry = __accr_lookup_host_range(pHostAddr, istart, isize);
+	if(entry != NULL)
 	{
-        param = acc_hashmap_get(map, key);
-        if((param != NULL) && (param->host_addr == pBuffer))
-            return 1;
+		/* the device address which corresponds to pHostAddr */
+		*pDeviceAddr = entry->device_addr + (pHostAddr - entry->host_addr);
+		return 1;
 	}
-	
+
+	ERROR(("ERROR: The device address for host address %p is not found", pHostAddr));
 	return 0;
 }
 
-/*
- * given a device address
- * determine whether it is already in the hashmap
+/* 
+ *pBuffer is host address, start is the offset of the sub-array in bytes,
+ *length is the number of elements and size is the sub-array size in bytes.
+ *determine whether the data [pBuffer+start, pBuffer+start+size) is present
  */
-int __accr_device_addr_present(void* pDevice)
+int __accr_present_create(void* pBuffer, size_t start, size_t length, size_t size)
 {
-	int key, map_length;
-	param_t *param;
-
-	/*if the map has not created yet*/
-	if(map == NULL)
+	/*if the table has not created yet*/
+	if(present_table == NULL)
 	{
-		ERROR(("ERROR: The data map has not created yet"));
+		WARN(("WARN: The data map has not created yet"));
 		return 0;
 	}
-	
-	map_length = map->capacity;
-	for(key=0; key<map_length; key++)
-	{
-        param = (param_t*)acc_hashmap_get(map, key);
-        if((param != NULL) && (param->device_addr == pDevice))
-            return 1;
-	}
 
-	ERROR(("ERROR: The given address %p is not present on the device", pDevice));
-	return 0;
+	return __accr_lookup_host_range(pBuffer, start, size) != NULL;
 }
 
 /*
- * given a device address, remove it from the hashmap
- *
+ * given a device address
+ * determine whether it is already in the present table
  */
-static int __accr_remove_device_from_hashmap(void* pDevice)
+int __accr_device_addr_present(void* pDevice)
 {
-	int key, map_length;
-	param_t *param;
-    
-	/*if the map has not created yet*/
-	if(map == NULL)
+	/*if the table has not created yet*/
+	if(present_table == NULL)
 	{
 		ERROR(("ERROR: The data map has not created yet"));
 		return 0;
 	}
 	
-	map_length = map->capacity;
-	for(key=0; key<map_length; key++)
-	{
-        param = (param_t*)acc_hashmap_get(map, key);
-        if((param != NULL) && param->device_addr == pDevice)
-        {
-            DEBUG(("param device addr: %p, pDevice: %p", param->device_addr, pDevice));
-            acc_hashmap_remove(map, key);
-            return 1;
-        }        
-	}
+	if(acc_present_table_lookup_device(present_table, pDevice, 0) != NULL
+		|| acc_present_table_find_device_base(present_table, pDevice) != NULL)
+		return 1;
 
 	ERROR(("ERROR: The given address %p is not present on the device", pDevice));
-    return 0;
+	return 0;
 }
 
 void __accr_reduction_buff_malloc(void** pDevice, int type_size)
@@ -382,7 +483,8 @@ void __accr_reduction_buff_malloc(void** pDevice, int type_size)
 	//	unit_size = sizeof(double);
 	//size = threads*unit_size;
 
-	CUDART_CHECK( cudaMalloc(pDevice, type_size) );
+	/* freed by __accr_free_on_device like any other device buffer */
+	__accr_malloc_on_device(NULL, pDevice, type_size, 0);
 }
 
 /*
@@ -392,8 +494,8 @@ void __accr_reduction_buff_malloc(void** pDevice, int type_size)
  * async_expr > 0: async operation with use-specified stream
  */
 void __accr_update_device_variable(void* pHost, 
-								   unsigned int offset, 
-								   unsigned int size, 
+								   size_t offset, 
+								   size_t size, 
 								   int async_expr)
 {
 	//int stream_pos;
@@ -441,15 +543,15 @@ void __accr_update_device_variable(void* pHost,
 
 	}
 */
-	DEBUG(("Updating %u bytes data from host to device", size));
+	DEBUG(("Updating %lu bytes data from host to device", size));
 }
 
 /*
  * update the data from device to host
  */
 void __accr_update_host_variable(void* pHost, 
-								 unsigned int offset, 
-								 unsigned int size,
+								 size_t offset, 
+								 size_t size,
 								 int async_expr)
 {
 	//int stream_pos;
@@ -495,36 +597,38 @@ void __accr_update_host_variable(void* pHost,
 
 	}
 */
-	DEBUG(("Updating %u bytes data from device to host", size));
+	DEBUG(("Updating %lu bytes data from device to host", size));
 }
 
 /*
  * update the data from host to device asynchronously
  */
 void __accr_update_device_variable_async(void* pHost, 
-										 unsigned int offset, 
-										 unsigned int size, 
+										 size_t offset, 
+										 size_t size, 
 										 int scalar_expr)
 {
+	acc_prof_mark_t mark;
+	CUstream stream;
 	void *pDevice;
-	/*the position in the stream array*/
-	int stream_pos;
 	__accr_get_device_addr(pHost, &pDevice, offset, size);
 
-	CUDART_CHECK( cudaHostRegister(pHost + offset, size, cudaHostRegisterMapped) );
-
-	stream_pos = scalar_expr % MODULE_BASE;
-	if(async_streams[stream_pos] == NULL)
+	if(ACC_ON_HOST())
 	{
-		CUDA_CHECK( cuStreamCreate(&async_streams[stream_pos], 0) );
-	}	
-		
-	CUDART_CHECK( cudaMemcpyAsync(pDevice + offset, 
-								     pHost + offset, 
-								     size, 
-								 	 cudaMemcpyHostToDevice, 
-								 	 async_streams[stream_pos]) );
-	DEBUG(("Updating %u bytes data from host to device", size));
+		if(pDevice != pHost)
+			memmove(pDevice + offset, pHost + offset, size);
+		return;
+	}
+
+	stream = __accr_get_queue_stream(scalar_expr);
+	if(ACC_PROFILING())
+		__accr_profile_start(&mark, stream, 1);
+
+	__accr_memcpy_h2d_async(pDevice + offset, pHost + offset, size, stream);
+
+	if(ACC_PROFILING())
+		__accr_profile_transfer(&mark, stream, 1, ACC_PROF_H2D, size, scalar_expr);
+	DEBUG(("Updating %lu bytes data from host to device", size));
 	
 }
 
@@ -532,57 +636,43 @@ void __accr_update_device_variable_async(void* pHost,
  * update the data from device to host asynchronously
  */
 void __accr_update_host_variable_async(void* pHost, 
-									   unsigned int offset, 
-									   unsigned int size, 
+									   size_t offset, 
+									   size_t size, 
 									   int scalar_expr)
 {
+	acc_prof_mark_t mark;
+	CUstream stream;
 	void *pDevice;
-	/*the position in the stream array*/
-	int stream_pos;
 	__accr_get_device_addr(pHost, &pDevice, offset, size);
 
-	CUDART_CHECK( cudaHostRegister(pHost + offset, size, cudaHostRegisterMapped) );
-
-	stream_pos = scalar_expr % MODULE_BASE;
-	if(async_streams[stream_pos] == NULL)
+	if(ACC_ON_HOST())
 	{
-		CUDA_CHECK( cuStreamCreate(&async_streams[stream_pos], 0) );	
+		if(pDevice != pHost)
+			memmove(pHost + offset, pDevice + offset, size);
+		return;
 	}
-	 
-	CUDART_CHECK( cudaMemcpyAsync(pHost + offset, 
-	     						 	 pDevice + offset, 
-								 	 size, 
-									 cudaMemcpyDeviceToHost, 
-									 async_streams[stream_pos]) );
+
+	stream = __accr_get_queue_stream(scalar_expr);
+	if(ACC_PROFILING())
+		__accr_profile_start(&mark, stream, 1);
+
+	__accr_memcpy_d2h_async(pHost + offset, pDevice + offset, size, stream);
+
+	if(ACC_PROFILING())
+		__accr_profile_transfer(&mark, stream, 1, ACC_PROF_D2H, size, scalar_expr);
 	
-	DEBUG(("Updating %u bytes data from device to host", size));
+	DEBUG(("Updating %lu bytes data from device to host", size));
 	
 }
 
 void __accr_wait_stream(int async_expr)
 {
-	int stream_pos;
-	stream_pos = async_expr % MODULE_BASE;
-	if(async_streams[stream_pos] != NULL)
-	{
-		CUDA_CHECK( cuStreamSynchronize(async_streams[stream_pos]) );
-		
-		DEBUG(("Waiting for stream %d", stream_pos));
-	}
+	__accr_wait_queue(async_expr);
 }
 
 void __accr_wait_all_streams(void)
 {
-	int pos;
-	for(pos=0; pos<MODULE_BASE+1; pos++)
-	{
-		if(async_streams[pos] != NULL)
-		{
-			CUDA_CHECK( cuStreamSynchronize(async_streams[pos]) );
-		}
-	}
-		
-	DEBUG(("Waiting for all streams"));
+	__accr_wait_all_queues();
 }
 
 void __accr_wait_some_or_all_stream(int async_expr)
@@ -593,51 +683,37 @@ void __accr_wait_some_or_all_stream(int async_expr)
 		__accr_wait_stream(async_expr);
 }
 
+/*
+ * the later operations of async_expr wait for the current operations of
+ * wait_expr (all queues if wait_expr is 0), the host does not block
+ */
+void __accr_wait_stream_async(int wait_expr, int async_expr)
+{
+	/* host launches and copies are synchronous */
+	if(ACC_ON_HOST())
+		return;
+
+	if(async_expr < 0)
+		__accr_wait_some_or_all_stream(wait_expr);
+	else if(wait_expr == 0)
+		__accr_wait_all_queues_async(async_expr);
+	else
+		__accr_wait_queue_async(wait_expr, async_expr);
+}
+
 void __accr_destroy_all_streams(void)
 {
-	int pos;
-	for(pos=0; pos<MODULE_BASE+1; pos++)
-	{
-		if(async_streams[pos] != NULL)
-		{
-			CUDA_CHECK( cuStreamDestroy(async_streams[pos]) );
-		}
-	}
-	
-	DEBUG(("Destroyed all streams"));
+	__accr_destroy_all_queues();
 }
 
 int acc_async_test(int scalar_expr)
 {
-	int stream_pos;
-	CUresult ret;
-	stream_pos = scalar_expr % MODULE_BASE;
-	
-	if(async_streams[stream_pos] != NULL)
-	{
-		ret =  cuStreamQuery(async_streams[stream_pos]) ;
-		if(ret == CUDA_SUCCESS)
-			return 1;
-		else if(ret == CUDA_ERROR_NOT_READY)
-			return 0;
-	}
-	return 0;
+	return __accr_test_queue(scalar_expr);
 }
 
 int acc_async_test_all(void)
 {
-	int pos;
-	CUresult ret;
-	for(pos=0; pos<MODULE_BASE+1; pos++)
-	{
-		if(async_streams[pos] != NULL)
-		{
-			ret = cuStreamQuery(async_streams[pos]);
-			if(ret == CUDA_ERROR_NOT_READY)
-				return 0;
-		}
-	}
-	return 1;
+	return __accr_test_all_queues();
 }
 
 void acc_async_wait(int scalar_expr)
@@ -649,3 +725,13 @@ void acc_async_wait_all(void)
 {
 	__accr_wait_all_streams();
 }
+
+void acc_wait_async(int wait_arg, int async_arg)
+{
+	__accr_wait_stream_async(wait_arg, async_arg);
+}
+
+void acc_wait_all_async(int async_arg)
+{
+	__accr_wait_stream_async(0, async_arg);
+}
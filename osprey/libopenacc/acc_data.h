@@ -9,36 +9,54 @@
 #include "acc_common.h"
 #include "acc_kernel.h"
 
-typedef struct{
-	void *host_addr;
-	void *device_addr;
-	size_t size;
-	//TRANSFER_TYPE type; /*indicate in/out from device*/
-} param_t;
+/* the size of the CUDA kernel parameter space */
+#define ACC_KERNEL_PARAM_BUFFER_SIZE 4096
+#define ACC_MAX_KERNEL_PARAMS 256
+
+/* megabytes of freed device memory kept for reuse, see ACC_MEMPOOL_SIZE */
+#define ACC_MEMPOOL_DEFAULT_SIZE 256
+
+/*
+ * The arguments of the next kernel launch. Each thread owns one frame,
+ * which is reset after every launch and reused by the next one, so
+ * pushing parameters and launching never touches the heap. Parameters
+ * of known size are copied into buffer, packed at their natural
+ * alignment, in the order of the kernel signature, args[i] points to
+ * the value of the i-th parameter.
+ */
+typedef struct acc_kernel_frame_s{
+	int count;
+	size_t offset;
+	void *args[ACC_MAX_KERNEL_PARAMS];
+	char buffer[ACC_KERNEL_PARAM_BUFFER_SIZE] __attribute__((aligned(16)));
+} acc_kernel_frame_t;
 
-extern vector param_list;
-extern acc_hashmap* map;
-extern cudaStream_t async_streams[12];
-extern int MODULE_BASE;
+extern __thread acc_kernel_frame_t __accr_kernel_frame;
+extern acc_present_table* present_table;
+extern acc_mempool_t* device_pool;
 
-extern void* __acc_malloc_handler(unsigned int size);
+extern void* __acc_malloc_handler(size_t size);
 
 extern void __acc_free_handler(void* ptr);
 
-extern void __accr_malloc_on_device(void* pHost, void** pDevice, unsigned int size);
+extern void __accr_create_device_pool(void);
+
+extern void __accr_destroy_device_pool(void);
+
+extern void __accr_malloc_on_device(void* pHost, void** pDevice, size_t size, size_t offset);
 
 extern void __accr_free_on_device(void* pDevice);
 
 extern void __accr_memin_h2d(void* pHost, 
 							 void* pDevice, 
-							 unsigned int size, 
-							 unsigned int offset,
+							 size_t size, 
+							 size_t offset,
 							 int async_expr);
 
 extern void __accr_memout_d2h(void* pDevice, 
 							  void* pHost, 
-							  unsigned int size, 
-							  unsigned int offset,
+							  size_t size, 
+							  size_t offset,
 							  int async_expr);
 
 extern void __accr_init_param_list();
@@ -57,31 +75,31 @@ extern void __accr_clean_param_list();
 
 extern int __accr_get_device_addr(void* pHostAddr, 
 								   void** pDeviceAddr, 
-								   unsigned int istart, 
-								   unsigned int isize);
+								   size_t istart, 
+								   size_t isize);
 
 extern int __accr_present_create(void* pBuffer, 
-								 unsigned int start, 
-								 int length, 
-								 unsigned int size);
+								 size_t start, 
+								 size_t length, 
+								 size_t size);
 
 extern int __accr_device_addr_present(void* pDevice);
 
 extern void __accr_reduction_buff_malloc(void** pDevice, int type);
 
 extern void __accr_update_device_variable(void* pHost, 
-										  unsigned int offset, 
-										  unsigned int size, 
+										  size_t offset, 
+										  size_t size, 
 										  int async_expr);
 
 extern void __accr_update_host_variable(void* pHost, 
-										unsigned int offset, 
-										unsigned int size, 
+										size_t offset, 
+										size_t size, 
 										int async_expr);
 
-extern void __accr_update_device_variable_async(void* pHost, unsigned int offset, unsigned int size, int scalar_expr);
+extern void __accr_update_device_variable_async(void* pHost, size_t offset, size_t size, int scalar_expr);
 
-extern void __accr_update_host_variable_async(void* pHost, unsigned int offset, unsigned int size, int scalar_expr);
+extern void __accr_update_host_variable_async(void* pHost, size_t offset, size_t size, int scalar_expr);
 
 extern void __accr_wait_stream(int async_expr);
 
@@ -89,6 +107,8 @@ extern void __accr_wait_all_streams(void);
 
 extern void __accr_wait_some_or_all_stream(int async_expr);
 
+extern void __accr_wait_stream_async(int wait_expr, int async_expr);
+
 extern void __accr_destroy_all_streams(void);
 
 extern int acc_async_test(int);
@@ -99,7 +119,11 @@ extern void acc_async_wait(int);
 
 extern void acc_async_wait_all(void);
 
-extern void* acc_malloc(unsigned int);
+extern void acc_wait_async(int wait_arg, int async_arg);
+
+extern void acc_wait_all_async(int async_arg);
+
+extern void* acc_malloc(size_t);
 
 extern void acc_free(void*);
 #endif
@@ -0,0 +1,290 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+/**
+ * Multicore host backend. The gangs of a kernel launch are handed out to
+ * a pool of worker threads through a shared atomic counter, the calling
+ * thread works on gangs too and returns when all gangs are finished, so a
+ * host launch is always synchronous.
+ *
+ * The number of threads is taken from ACC_NUM_CORES, and defaults to the
+ * number of online processors.
+ *
+ * The compiler only generates CUDA kernels, so the host versions have to be
+ * provided by the program, registered with __accr_register_host_kernel or
+ * exported under the kernel name. A launch of a kernel without one is a
+ * fatal error.
+ *
+ * The pool runs one launch at a time. A launch which finds it busy, from
+ * another host thread, runs all of its gangs on the calling thread.
+ */
+
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <dlfcn.h>
+#include "acc_data.h"
+#include "acc_host.h"
+
+typedef struct acc_host_kernel_entry_s{
+	char *name;
+	acc_host_kernel_t kernel;
+	struct acc_host_kernel_entry_s *next;
+} acc_host_kernel_entry_t;
+
+typedef struct acc_host_worker_s{
+	pthread_t thread;
+	/* per-thread scratch memory reused across launches */
+	void *shared_mem;
+	unsigned int shared_capacity;
+} acc_host_worker_t;
+
+/* one launch, on the stack of the launching thread */
+typedef struct acc_host_job_s{
+	acc_host_kernel_t kernel;
+	void **args;
+	int gangs[3];
+	int vectors[3];
+	unsigned int shared_size;
+	int total_gangs;
+	volatile int next_gang;
+} acc_host_job_t;
+
+static acc_host_kernel_entry_t *host_kernels = NULL;
+static pthread_mutex_t host_kernels_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static acc_host_worker_t *host_workers = NULL;
+static int host_num_threads = 0;
+
+/* scratch memory of the launching thread, which is not a pool worker */
+static __thread acc_host_worker_t host_caller;
+
+/* held by the launch which owns the pool */
+static pthread_mutex_t host_launch_lock = PTHREAD_MUTEX_INITIALIZER;
+/* the launch the pool works on, under host_pool_lock */
+static acc_host_job_t *host_pool_job = NULL;
+static pthread_mutex_t host_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t host_pool_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t host_pool_done = PTHREAD_COND_INITIALIZER;
+static int host_pool_generation = 0;
+static int host_pool_finished = 0;
+static int host_pool_shutdown = 0;
+
+static void __accr_host_run_gangs(acc_host_worker_t* worker, acc_host_job_t* job);
+
+static void* __accr_host_worker(void* arg);
+
+static acc_host_kernel_t __accr_host_find_kernel(char* szKernelName);
+
+int __accr_host_get_num_threads(void)
+{
+	return host_num_threads;
+}
+
+void __accr_host_setup(void)
+{
+	char *env;
+	int i;
+
+	if(host_workers != NULL)
+		return;
+
+	host_num_threads = 0;
+	env = getenv("ACC_NUM_CORES");
+	if(env != NULL)
+		host_num_threads = atoi(env);
+	if(host_num_threads <= 0)
+		host_num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if(host_num_threads <= 0)
+		host_num_threads = 1;
+
+	host_workers = acc_host_alloc_zero(host_num_threads*sizeof(acc_host_worker_t));
+	host_pool_shutdown = 0;
+
+	/* worker 0 stands for the launching thread, see host_caller */
+	for(i = 1; i < host_num_threads; i++)
+	{
+		if(pthread_create(&host_workers[i].thread, NULL, __accr_host_worker, &host_workers[i]) != 0)
+			ERROR(("Cannot create host worker thread %d", i));
+	}
+
+	INFO(("Host backend uses %d threads", host_num_threads));
+}
+
+void __accr_host_cleanup(void)
+{
+	int i;
+
+	if(host_workers == NULL)
+		return;
+
+	pthread_mutex_lock(&host_pool_lock);
+	host_pool_shutdown = 1;
+	pthread_cond_broadcast(&host_pool_start);
+	pthread_mutex_unlock(&host_pool_lock);
+
+	for(i = 1; i < host_num_threads; i++)
+		pthread_join(host_workers[i].thread, NULL);
+
+	for(i = 1; i < host_num_threads; i++)
+		acc_host_free(host_workers[i].shared_mem);
+	acc_host_free(host_caller.shared_mem);
+	host_caller.shared_mem = NULL;
+	host_caller.shared_capacity = 0;
+	acc_host_free(host_workers);
+	host_workers = NULL;
+	host_num_threads = 0;
+}
+
+void __accr_register_host_kernel(char* szKernelName, acc_host_kernel_t kernel)
+{
+	acc_host_kernel_entry_t *entry;
+
+	entry = acc_host_alloc(sizeof(acc_host_kernel_entry_t));
+	entry->name = strdup(szKernelName);
+	entry->kernel = kernel;
+
+	pthread_mutex_lock(&host_kernels_lock);
+	entry->next = host_kernels;
+	host_kernels = entry;
+	pthread_mutex_unlock(&host_kernels_lock);
+}
+
+static acc_host_kernel_t __accr_host_find_kernel(char* szKernelName)
+{
+	acc_host_kernel_entry_t *entry;
+	acc_host_kernel_t kernel;
+
+	pthread_mutex_lock(&host_kernels_lock);
+	for(entry = host_kernels; entry != NULL; entry = entry->next)
+	{
+		if(strcmp(entry->name, szKernelName) == 0)
+		{
+			pthread_mutex_unlock(&host_kernels_lock);
+			return entry->kernel;
+		}
+	}
+	pthread_mutex_unlock(&host_kernels_lock);
+
+	kernel = (acc_host_kernel_t)dlsym(RTLD_DEFAULT, szKernelName);
+	if(kernel == NULL)
+		ERROR(("Kernel %s has no host version: the compiler only generates "
+			   "CUDA kernels, acc_device_host needs host kernels registered "
+			   "with __accr_register_host_kernel", szKernelName));
+
+	/* remember it so that the next launch does not go through dlsym */
+	__accr_register_host_kernel(szKernelName, kernel);
+
+	return kernel;
+}
+
+static void __accr_host_run_gangs(acc_host_worker_t* worker, acc_host_job_t* job)
+{
+	acc_host_kernel_ctx_t ctx;
+	int gang;
+
+	if(job->shared_size > worker->shared_capacity)
+	{
+		acc_host_free(worker->shared_mem);
+		worker->shared_mem = acc_host_alloc(job->shared_size);
+		worker->shared_capacity = job->shared_size;
+	}
+
+	memcpy(ctx.gangs, job->gangs, sizeof(ctx.gangs));
+	memcpy(ctx.vectors, job->vectors, sizeof(ctx.vectors));
+	ctx.shared_mem = worker->shared_mem;
+	ctx.shared_size = job->shared_size;
+
+	while((gang = __sync_fetch_and_add(&job->next_gang, 1)) < job->total_gangs)
+	{
+		ctx.gang_id[0] = gang % job->gangs[0];
+		ctx.gang_id[1] = (gang / job->gangs[0]) % job->gangs[1];
+		ctx.gang_id[2] = gang / (job->gangs[0]*job->gangs[1]);
+		job->kernel(job->args, &ctx);
+	}
+}
+
+static void* __accr_host_worker(void* arg)
+{
+	acc_host_worker_t *worker = (acc_host_worker_t*)arg;
+	acc_host_job_t *job;
+	int generation = 0;
+
+	for(;;)
+	{
+		pthread_mutex_lock(&host_pool_lock);
+		while(generation == host_pool_generation && !host_pool_shutdown)
+			pthread_cond_wait(&host_pool_start, &host_pool_lock);
+		if(host_pool_shutdown)
+		{
+			pthread_mutex_unlock(&host_pool_lock);
+			break;
+		}
+		generation = host_pool_generation;
+		job = host_pool_job;
+		pthread_mutex_unlock(&host_pool_lock);
+
+		__accr_host_run_gangs(worker, job);
+
+		pthread_mutex_lock(&host_pool_lock);
+		host_pool_finished++;
+		if(host_pool_finished == host_num_threads - 1)
+			pthread_cond_signal(&host_pool_done);
+		pthread_mutex_unlock(&host_pool_lock);
+	}
+
+	return NULL;
+}
+
+void __accr_host_launchkernel(char* szKernelName,
+							  void** args,
+							  int gangs[3],
+							  int vectors[3],
+							  unsigned int shared_size)
+{
+	acc_host_job_t job;
+	int i;
+
+	if(host_workers == NULL)
+		__accr_host_setup();
+
+	job.kernel = __accr_host_find_kernel(szKernelName);
+	job.args = args;
+	for(i = 0; i < 3; i++)
+	{
+		job.gangs[i] = gangs[i] > 0 ? gangs[i] : 1;
+		job.vectors[i] = vectors[i] > 0 ? vectors[i] : 1;
+	}
+	job.shared_size = shared_size;
+	job.total_gangs = job.gangs[0]*job.gangs[1]*job.gangs[2];
+	job.next_gang = 0;
+
+	DEBUG(("Launching host kernel %s with %d gangs on %d threads",
+				szKernelName, job.total_gangs, host_num_threads));
+
+	if(host_num_threads == 1 || job.total_gangs == 1 ||
+	   pthread_mutex_trylock(&host_launch_lock) != 0)
+	{
+		__accr_host_run_gangs(&host_caller, &job);
+		return;
+	}
+
+	pthread_mutex_lock(&host_pool_lock);
+	host_pool_job = &job;
+	host_pool_finished = 0;
+	host_pool_generation++;
+	pthread_cond_broadcast(&host_pool_start);
+	pthread_mutex_unlock(&host_pool_lock);
+
+	__accr_host_run_gangs(&host_caller, &job);
+
+	/* job goes out of scope, so wait for every worker to let go of it */
+	pthread_mutex_lock(&host_pool_lock);
+	while(host_pool_finished < host_num_threads - 1)
+		pthread_cond_wait(&host_pool_done, &host_pool_lock);
+	host_pool_job = NULL;
+	pthread_mutex_unlock(&host_pool_lock);
+
+	pthread_mutex_unlock(&host_launch_lock);
+}
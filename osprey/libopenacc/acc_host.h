@@ -0,0 +1,59 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+#ifndef __ACC_HOST_H__
+#define __ACC_HOST_H__
+
+#include <pthread.h>
+#include "acc_log.h"
+
+/*
+ * Host (multicore) backend, used when the device type is acc_device_host.
+ *
+ * "Device" memory is host memory: data clauses alias the host buffer, and
+ * a kernel is a host function which runs one gang per call. Gangs are
+ * distributed over a pool of pthreads; the vector lanes of a gang are
+ * iterated by the kernel itself in a plain countable inner loop, so that
+ * the C compiler can vectorize it.
+ *
+ * The compiler does not generate host kernels yet. Programs compiled with
+ * OpenACC directives abort at their first launch on this backend, unless
+ * they register host versions of their kernels themselves.
+ */
+typedef struct acc_host_kernel_ctx_s{
+	/* the gang this call runs */
+	int gang_id[3];
+
+	/* launch geometry */
+	int gangs[3];
+	int vectors[3];
+
+	/* per-gang scratch memory, the counterpart of CUDA shared memory */
+	void *shared_mem;
+	unsigned int shared_size;
+} acc_host_kernel_ctx_t;
+
+/* args has the same layout as the kernel parameters of cuLaunchKernel */
+typedef void (*acc_host_kernel_t)(void** args, acc_host_kernel_ctx_t* ctx);
+
+extern void __accr_host_setup(void);
+
+extern void __accr_host_cleanup(void);
+
+extern int __accr_host_get_num_threads(void);
+
+/*
+ * register the host version of a kernel, kernels which are not registered
+ * are looked up by name in the executable and its shared libraries
+ */
+extern void __accr_register_host_kernel(char* szKernelName, acc_host_kernel_t kernel);
+
+extern void __accr_host_launchkernel(char* szKernelName,
+									 void** args,
+									 int gangs[3],
+									 int vectors[3],
+									 unsigned int shared_size);
+
+#endif
@@ -3,6 +3,10 @@
  * University of Houston
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "acc_kernel.h"
 
 int gangs[3];
@@ -15,6 +19,31 @@ unsigned int shared_size = 0;
 CUmodule cu_module;
 CUfunction cu_function;
 
+#define ACC_KERNEL_CACHE_SIZE 256
+
+/* a loaded PTX file */
+typedef struct acc_module_s{
+	char *lib;
+	CUmodule module;
+	struct acc_module_s *next;
+} acc_module_t;
+
+/* a resolved kernel function, keyed by (library, kernel name) */
+typedef struct acc_kernel_entry_s{
+	char *name;
+	char *lib;
+	unsigned int hash;
+	CUmodule module;
+	CUfunction function;
+	struct acc_kernel_entry_s *next;
+} acc_kernel_entry_t;
+
+static acc_module_t *module_cache = NULL;
+static acc_kernel_entry_t *kernel_cache[ACC_KERNEL_CACHE_SIZE];
+static acc_kernel_entry_t *last_kernel = NULL;
+static int module_loads = 0;
+static int function_lookups = 0;
+
 void __accr_set_gangs(int x, int y, int z)
 {
 	gangs[0] = x;
@@ -141,77 +170,244 @@ void __accr_set_default_shared_mem_size()
 }
 
 /*
- *szKernelName: kernel function name
- *szKernelLib: kernel file name
+ *read the PTX file szKernelLib and load it as a CUDA module. The file is
+ *mapped instead of read, a mapping always ends with a NUL byte unless the
+ *file size is a multiple of the page size, in that case it is copied.
  */
-void __accr_launchkernel(char* szKernelName, char* szKernelLib, int async_expr)
+static CUmodule __accr_load_module_file(char* szKernelLib)
 {
-	void **args;
-	FILE *fp;
-	int file_size;
+	int fd;
+	struct stat st;
+	size_t file_size;
+	char *ptx_source;
+	CUmodule module;
 	CUresult ret;
-	int i, args_count;
-	param_t *param;
 
-	/*
-	 *if the kernel to be launched is different from the previous
-	 *kernel, then update the previous kernel as current kernel
-	 */
-	if(strcmp(cu_filename, szKernelLib) != 0)
+	fd = open(szKernelLib, O_RDONLY);
+	if(fd < 0 || fstat(fd, &st) != 0)
+		ERROR(("Cannot open the kernel file %s", szKernelLib));
+	file_size = st.st_size;
+
+	ptx_source = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(ptx_source == MAP_FAILED)
+		ERROR(("Cannot map the kernel file %s", szKernelLib));
+	close(fd);
+
+	if(file_size % sysconf(_SC_PAGESIZE) == 0)
 	{
-		char *ptx_source;
-		strncpy(cu_filename, szKernelLib, 512);
-		
-		fp = fopen(szKernelLib, "rb");
-		fseek(fp, 0, SEEK_END);
-		file_size = ftell(fp);
-		ptx_source = (char*)malloc((file_size+1)*sizeof(char));
-		fseek(fp, 0, SEEK_SET);
-		fread(ptx_source, sizeof(char), file_size, fp);
-		fclose(fp);
-		ptx_source[file_size] = '\0';
-	
-		//printf("Loading module %s\n", ptx_source);
-		ret = cuModuleLoadData(&cu_module, ptx_source);
-		CUDA_CHECK(ret);
-
-		free(ptx_source);
-
-		//printf("Kernel name: %s\n", szKernelName);	
-		//printf("Kernel file name: %s\n", szKernelLib);	
-		ret = cuModuleGetFunction(&cu_function, cu_module, szKernelName);	
-		CUDA_CHECK(ret);
-	}else
-    {
-        /*the file name are the same, but the kernel function may be different*/
-		ret = cuModuleGetFunction(&cu_function, cu_module, szKernelName);	
-		CUDA_CHECK(ret);
-    }
-	
-	args_count = vector_length(param_list);
-	args = (void**)malloc(args_count*sizeof(void*));
-	
-	for(i = args_count-1; i >=0; i--)
+		char *copy = (char*)malloc(file_size+1);
+		memcpy(copy, ptx_source, file_size);
+		copy[file_size] = '\0';
+		ret = cuModuleLoadData(&module, copy);
+		free(copy);
+	}
+	else
+		ret = cuModuleLoadData(&module, ptx_source);
+	CUDA_CHECK(ret);
+
+	munmap(ptx_source, file_size);
+	module_loads++;
+
+	DEBUG(("Loaded kernel module %s", szKernelLib));
+	return module;
+}
+
+static unsigned int __accr_kernel_hash(char* szKernelName, char* szKernelLib)
+{
+	unsigned int h = 5381;
+	char *c;
+
+	for(c = szKernelLib; *c; c++)
+		h = h*33 + (unsigned char)*c;
+	for(c = szKernelName; *c; c++)
+		h = h*33 + (unsigned char)*c;
+	return h;
+}
+
+/* return the loaded module of szKernelLib, load it the first time */
+static acc_module_t* __accr_get_module(char* szKernelLib)
+{
+	acc_module_t *m;
+
+	for(m = module_cache; m != NULL; m = m->next)
+	{
+		if(strcmp(m->lib, szKernelLib) == 0)
+			return m;
+	}
+
+	m = (acc_module_t*)malloc(sizeof(acc_module_t));
+	m->lib = strdup(szKernelLib);
+	m->module = __accr_load_module_file(szKernelLib);
+	m->next = module_cache;
+	module_cache = m;
+
+	return m;
+}
+
+/*
+ *find the kernel function szKernelName of the PTX file szKernelLib in the
+ *kernel cache, the module is loaded and the function is resolved only the
+ *first time a (library, kernel) pair is launched
+ */
+static acc_kernel_entry_t* __accr_get_kernel(char* szKernelName, char* szKernelLib)
+{
+	acc_kernel_entry_t *e;
+	acc_module_t *m;
+	unsigned int h;
+	CUresult ret;
+
+	/* the same kernel is usually launched many times in a row */
+	if(last_kernel != NULL && 
+	   strcmp(last_kernel->name, szKernelName) == 0 &&
+	   strcmp(last_kernel->lib, szKernelLib) == 0)
+		return last_kernel;
+
+	h = __accr_kernel_hash(szKernelName, szKernelLib);
+	for(e = kernel_cache[h % ACC_KERNEL_CACHE_SIZE]; e != NULL; e = e->next)
 	{
-		param = (param_t*)malloc(sizeof(param_t));
-		vector_popback(param_list, param);
-		if(param->device_addr != NULL)
+		if(e->hash == h && 
+		   strcmp(e->name, szKernelName) == 0 &&
+		   strcmp(e->lib, szKernelLib) == 0)
 		{
-			args[i] = &(param->device_addr);
-			DEBUG(("args[%d] device address: %p", i, param->device_addr));
+			last_kernel = e;
+			return e;
 		}
-		else
+	}
+
+	m = __accr_get_module(szKernelLib);
+
+	e = (acc_kernel_entry_t*)malloc(sizeof(acc_kernel_entry_t));
+	e->name = strdup(szKernelName);
+	e->lib = m->lib;
+	e->hash = h;
+	e->module = m->module;
+	ret = cuModuleGetFunction(&e->function, m->module, szKernelName);
+	CUDA_CHECK(ret);
+	function_lookups++;
+
+	e->next = kernel_cache[h % ACC_KERNEL_CACHE_SIZE];
+	kernel_cache[h % ACC_KERNEL_CACHE_SIZE] = e;
+	last_kernel = e;
+
+	return e;
+}
+
+/*
+ *make the kernel function szKernelName from the PTX file szKernelLib the
+ *current kernel
+ */
+static void __accr_load_kernel(char* szKernelName, char* szKernelLib)
+{
+	acc_kernel_entry_t *e;
+
+	e = __accr_get_kernel(szKernelName, szKernelLib);
+	if(strcmp(cu_filename, szKernelLib) != 0)
+		strncpy(cu_filename, szKernelLib, 512);
+	cu_module = e->module;
+	cu_function = e->function;
+}
+
+/* load a PTX file ahead of its first launch */
+void __accr_preload_kernel_module(char* szKernelLib)
+{
+	__accr_get_module(szKernelLib);
+}
+
+/*
+ *load the modules listed in ACC_PRELOAD_MODULES (separated by ':'), 
+ *so that the first launch of their kernels does not pay for the JIT
+ */
+void __accr_preload_kernel_modules(void)
+{
+	char *env, *list, *lib, *saveptr;
+
+	env = getenv("ACC_PRELOAD_MODULES");
+	if(env == NULL)
+		return;
+
+	list = strdup(env);
+	for(lib = strtok_r(list, ":", &saveptr); lib != NULL; lib = strtok_r(NULL, ":", &saveptr))
+	{
+		if(*lib)
+			__accr_preload_kernel_module(lib);
+	}
+	free(list);
+}
+
+void __accr_get_kernel_cache_stats(int* loads, int* lookups)
+{
+	*loads = module_loads;
+	*lookups = function_lookups;
+}
+
+/* unload all cached modules, it is called before the context is destroyed */
+void __accr_destroy_kernel_cache(void)
+{
+	acc_kernel_entry_t *e, *next;
+	acc_module_t *m, *mnext;
+	int i;
+
+	for(i = 0; i < ACC_KERNEL_CACHE_SIZE; i++)
+	{
+		for(e = kernel_cache[i]; e != NULL; e = next)
 		{
-			args[i] = param->host_addr;
-			DEBUG(("args[%d] host address: %p", i, param->host_addr));
+			next = e->next;
+			free(e->name);
+			free(e);
 		}
+		kernel_cache[i] = NULL;
+	}
 
+	for(m = module_cache; m != NULL; m = mnext)
+	{
+		mnext = m->next;
+		CUDA_CHECK( cuModuleUnload(m->module) );
+		free(m->lib);
+		free(m);
 	}
+	module_cache = NULL;
+	last_kernel = NULL;
+	cu_filename[0] = '\0';
+}
+
+/*
+ *szKernelName: kernel function name
+ *szKernelLib: kernel file name
+ */
+void __accr_launchkernel(char* szKernelName, char* szKernelLib, int async_expr)
+{
+	acc_prof_mark_t mark;
+	CUstream stream;
+	void **args;
+	CUresult ret;
+	int i, args_count;
+
+	/* the host backend runs the host version of the kernel instead */
+	if(!ACC_ON_HOST())
+		__accr_load_kernel(szKernelName, szKernelLib);
+	
+	/* the arguments are already in place in the per-thread frame */
+	args_count = __accr_kernel_frame.count;
+	args = __accr_kernel_frame.args;
+	
+	for(i = 0; i < args_count; i++)
+		DEBUG(("args[%d] address: %p", i, args[i]));
 
 	DEBUG(("Arguments added successfully"));
 	DEBUG(("gang_x: %d, gang_y: %d, gang_z: %d", gangs[0], gangs[1], gangs[2]));
 	DEBUG(("vector_x: %d, vector_y: %d, vector_z: %d", vectors[0], vectors[1], vectors[2]));
 
+	if(ACC_ON_HOST())
+	{
+		if(ACC_PROFILING())
+			__accr_profile_start(&mark, NULL, 0);
+		__accr_host_launchkernel(szKernelName, args, gangs, vectors, shared_size);
+		if(ACC_PROFILING())
+			__accr_profile_kernel(&mark, NULL, 0, szKernelName, gangs, vectors, async_expr);
+		__accr_init_param_list();
+		return;
+	}
+
 	if(gangs[0] > __acc_gpu_config->max_grid_dim[0] ||
 	   gangs[1] > __acc_gpu_config->max_grid_dim[1] ||
 	   gangs[2] > __acc_gpu_config->max_grid_dim[2] )
@@ -225,44 +421,24 @@ void __accr_launchkernel(char* szKernelName, char* szKernelLib, int async_expr)
 	
 
 	/* the asynchronous scalar expression do not accept negative value now*/
-	if(async_expr < 0)
-	{
-		ret = cuLaunchKernel(cu_function, gangs[0], gangs[1], gangs[2], 
-						     vectors[0], vectors[1], vectors[2], 
-						     shared_size, 
-						     NULL, args, NULL);
-		CUDA_CHECK(ret);
-	}else if(async_expr == 0)
-	{
-		if(async_streams[MODULE_BASE] == NULL)
-		{
-			CUDA_CHECK( cuStreamCreate(&async_streams[MODULE_BASE], 0) );	
-		}
-		
-		ret = cuLaunchKernel(cu_function, gangs[0], gangs[1], gangs[2], 
-						     vectors[0], vectors[1], vectors[2], 
-						     shared_size, 
-						     async_streams[MODULE_BASE], args, NULL);
-		CUDA_CHECK(ret);
-	}else
-	{
-		int stream_pos;
-		stream_pos = async_expr % MODULE_BASE;
-		
-		if(async_streams[stream_pos] == NULL)
-		{
-			CUDA_CHECK( cuStreamCreate(&async_streams[stream_pos], 0) );	
-		}
-		
-		ret = cuLaunchKernel(cu_function, gangs[0], gangs[1], gangs[2], 
-						     vectors[0], vectors[1], vectors[2], 
-						     shared_size, 
-						     async_streams[stream_pos], args, NULL);
-		CUDA_CHECK(ret);
-	}
+	stream = NULL;
+	if(async_expr >= 0)
+		stream = __accr_get_queue_stream(async_expr);
+
+	if(ACC_PROFILING())
+		__accr_profile_start(&mark, stream, 1);
+
+	ret = cuLaunchKernel(cu_function, gangs[0], gangs[1], gangs[2], 
+					     vectors[0], vectors[1], vectors[2], 
+					     shared_size, 
+					     stream, args, NULL);
+	CUDA_CHECK(ret);
+
+	if(ACC_PROFILING())
+		__accr_profile_kernel(&mark, stream, 1, szKernelName, gangs, vectors, async_expr);
 
 	DEBUG(("The kernel is launched successfully"));
-	/* free the memory of kernel parameter */
-	free(args);
+	/* the frame is ready for the next launch */
+	__accr_init_param_list();
 
 }
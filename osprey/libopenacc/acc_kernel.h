@@ -52,4 +52,12 @@ extern int __accr_get_total_num_vectors();
 
 extern void __accr_launchkernel(char* szKernelName, char* szKernelLib, int async_expr);
 
+extern void __accr_preload_kernel_module(char* szKernelLib);
+
+extern void __accr_preload_kernel_modules(void);
+
+extern void __accr_get_kernel_cache_stats(int* loads, int* lookups);
+
+extern void __accr_destroy_kernel_cache(void);
+
 #endif
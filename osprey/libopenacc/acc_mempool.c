@@ -0,0 +1,307 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+/**
+ * A caching allocator for device memory. Freed blocks are not given back
+ * to the backend (cudaFree synchronizes the device), they are kept on a
+ * free list of their size class and reused by the next allocation of the
+ * same class.
+ *
+ * Sizes are rounded up to a size class: 256 bytes and below share one
+ * class, above that each power of two is split into 4 classes, so at most
+ * 25% of a block is wasted. The bytes kept in the cache are bounded by the
+ * high water mark, the largest cached blocks are released first when it is
+ * reached. When the backend runs out of memory, the cache is trimmed and
+ * the allocation is retried.
+ *
+ * A block freed on the host may still be used by kernels or copies queued
+ * on the device. If the backend has fences, the block is cached with a
+ * fence for the work queued when it was freed, and it is only handed out
+ * again once that work has finished: an allocation takes a block whose
+ * work is done if there is one, otherwise it waits for the oldest block.
+ */
+
+#include <string.h>
+#include "acc_mempool.h"
+
+#define MEMPOOL_MIN_CLASS_SHIFT 8
+#define MEMPOOL_MIN_CLASS_SIZE (1UL << MEMPOOL_MIN_CLASS_SHIFT)
+
+static void* host_backend_alloc(size_t size);
+
+static void host_backend_free(void* ptr);
+
+static int size_class(size_t size, size_t* class_size);
+
+static size_t class_block_size(int c);
+
+static void trim_to(acc_mempool_t* pool, size_t bytes);
+
+static acc_mempool_block_t* take_block(acc_mempool_t* pool, int c, int* done);
+
+acc_mempool_backend_t acc_mempool_host_backend = {
+	"host", host_backend_alloc, host_backend_free
+};
+
+static void* host_backend_alloc(size_t size)
+{
+	return malloc(size);
+}
+
+static void host_backend_free(void* ptr)
+{
+	free(ptr);
+}
+
+/* return the size class index of size, and the block size of that class */
+static int size_class(size_t size, size_t* class_size)
+{
+	int k;
+	size_t step, cs;
+
+	if(size <= MEMPOOL_MIN_CLASS_SIZE)
+	{
+		*class_size = MEMPOOL_MIN_CLASS_SIZE;
+		return 0;
+	}
+
+	/* 2^k < size <= 2^(k+1) */
+	k = 63 - __builtin_clzl((unsigned long)(size - 1));
+	step = 1UL << (k - 2);
+	cs = (size + step - 1) & ~(step - 1);
+	*class_size = cs;
+
+	/* cs/step is one of 5, 6, 7, 8 */
+	return 1 + (k - MEMPOOL_MIN_CLASS_SHIFT)*4 + (int)(cs/step) - 5;
+}
+
+/* the block size of size class c, the inverse of size_class() */
+static size_t class_block_size(int c)
+{
+	int k;
+
+	if(c == 0)
+		return MEMPOOL_MIN_CLASS_SIZE;
+
+	k = (c - 1)/4 + MEMPOOL_MIN_CLASS_SHIFT;
+	return (size_t)((c - 1)%4 + 5) << (k - 2);
+}
+
+size_t acc_mempool_class_size(size_t size)
+{
+	size_t class_size;
+
+	size_class(size, &class_size);
+	return class_size;
+}
+
+acc_mempool_t* acc_mempool_create(acc_mempool_backend_t* backend, size_t high_water_mark)
+{
+	acc_mempool_t *pool;
+
+	pool = (acc_mempool_t*)malloc(sizeof(acc_mempool_t));
+	if(pool == NULL)
+		ERROR(("Cannot allocate the memory pool"));
+
+	memset(pool, 0, sizeof(acc_mempool_t));
+	pool->backend = *backend;
+	pool->high_water_mark = high_water_mark;
+	pthread_mutex_init(&pool->lock, NULL);
+
+	return pool;
+}
+
+/* release cached blocks, largest first, until at most bytes are cached */
+static void trim_to(acc_mempool_t* pool, size_t bytes)
+{
+	acc_mempool_block_t *b;
+	size_t class_size;
+	int c;
+
+	for(c = ACC_MEMPOOL_NUM_CLASSES - 1; c >= 0 && pool->stats.bytes_cached > bytes; c--)
+	{
+		while(pool->free_blocks[c] != NULL && pool->stats.bytes_cached > bytes)
+		{
+			b = pool->free_blocks[c];
+			pool->free_blocks[c] = b->next;
+
+			class_size = class_block_size(c);
+			if(b->fence != NULL)
+			{
+				pool->backend.fence_wait(b->fence);
+				pool->backend.fence_release(b->fence);
+				b->fence = NULL;
+			}
+			pool->backend.free(b->ptr);
+			pool->stats.bytes_cached -= class_size;
+			pool->stats.bytes_trimmed += class_size;
+
+			b->next = pool->spare_nodes;
+			pool->spare_nodes = b;
+		}
+	}
+}
+
+/*
+ * unlink a cached block of class c, preferring one which the device is
+ * done with, else the oldest one, whose fence the caller has to wait for
+ */
+static acc_mempool_block_t* take_block(acc_mempool_t* pool, int c, int* done)
+{
+	acc_mempool_block_t *b, **link, **last;
+
+	last = NULL;
+	*done = 0;
+	for(link = &pool->free_blocks[c]; *link != NULL; link = &(*link)->next)
+	{
+		last = link;
+		b = *link;
+		if(b->fence == NULL || pool->backend.fence_done(b->fence))
+		{
+			*done = 1;
+			break;
+		}
+	}
+
+	if(last == NULL)
+		return NULL;
+
+	b = *last;
+	*last = b->next;
+	return b;
+}
+
+void* acc_mempool_alloc(acc_mempool_t* pool, size_t size)
+{
+	acc_mempool_block_t *b;
+	size_t class_size;
+	void *ptr, *fence;
+	int c, done;
+
+	c = size_class(size, &class_size);
+	if(c >= ACC_MEMPOOL_NUM_CLASSES)
+		ERROR(("Cannot allocate %lu bytes from the %s pool", size, pool->backend.name));
+
+	pthread_mutex_lock(&pool->lock);
+
+	b = take_block(pool, c, &done);
+	if(b != NULL)
+	{
+		ptr = b->ptr;
+		fence = b->fence;
+		b->fence = NULL;
+		b->next = pool->spare_nodes;
+		pool->spare_nodes = b;
+
+		pool->stats.hits++;
+		pool->stats.bytes_cached -= class_size;
+		pool->stats.bytes_in_use += class_size;
+		if(!done)
+			pool->stats.fence_waits++;
+		pthread_mutex_unlock(&pool->lock);
+
+		/* the block is ours now, other threads need not wait with us */
+		if(fence != NULL)
+		{
+			if(!done)
+				pool->backend.fence_wait(fence);
+			pool->backend.fence_release(fence);
+		}
+		return ptr;
+	}
+
+	pool->stats.misses++;
+	ptr = pool->backend.alloc(class_size);
+	if(ptr == NULL && pool->stats.bytes_cached > 0)
+	{
+		/* the cached blocks may be what fills the memory */
+		trim_to(pool, 0);
+		ptr = pool->backend.alloc(class_size);
+	}
+	if(ptr != NULL)
+		pool->stats.bytes_in_use += class_size;
+
+	pthread_mutex_unlock(&pool->lock);
+
+	if(ptr == NULL)
+		ERROR(("Cannot allocate %lu bytes of %s memory", class_size, pool->backend.name));
+
+	return ptr;
+}
+
+void acc_mempool_free(acc_mempool_t* pool, void* ptr, size_t size)
+{
+	acc_mempool_block_t *b;
+	size_t class_size;
+	int c;
+
+	if(ptr == NULL)
+		return;
+
+	c = size_class(size, &class_size);
+
+	pthread_mutex_lock(&pool->lock);
+
+	pool->stats.bytes_in_use -= class_size;
+
+	if(pool->stats.bytes_cached + class_size > pool->high_water_mark)
+		trim_to(pool, pool->high_water_mark > class_size ? pool->high_water_mark - class_size : 0);
+
+	if(pool->stats.bytes_cached + class_size > pool->high_water_mark)
+	{
+		/* the block alone does not fit in the cache, the backend's free
+		 * has to wait for the device itself (cudaFree does) */
+		pool->backend.free(ptr);
+		pool->stats.bytes_trimmed += class_size;
+		pthread_mutex_unlock(&pool->lock);
+		return;
+	}
+
+	b = pool->spare_nodes;
+	if(b != NULL)
+		pool->spare_nodes = b->next;
+	else
+		b = (acc_mempool_block_t*)malloc(sizeof(acc_mempool_block_t));
+
+	b->ptr = ptr;
+	b->fence = NULL;
+	if(pool->backend.fence_record != NULL)
+		b->fence = pool->backend.fence_record();
+	b->next = pool->free_blocks[c];
+	pool->free_blocks[c] = b;
+	pool->stats.bytes_cached += class_size;
+
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void acc_mempool_trim(acc_mempool_t* pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	trim_to(pool, 0);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void acc_mempool_get_stats(acc_mempool_t* pool, acc_mempool_stats_t* stats)
+{
+	pthread_mutex_lock(&pool->lock);
+	*stats = pool->stats;
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void acc_mempool_destroy(acc_mempool_t* pool)
+{
+	acc_mempool_block_t *b, *next;
+
+	acc_mempool_trim(pool);
+
+	for(b = pool->spare_nodes; b != NULL; b = next)
+	{
+		next = b->next;
+		free(b);
+	}
+
+	pthread_mutex_destroy(&pool->lock);
+	free(pool);
+}
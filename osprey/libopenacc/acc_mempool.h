@@ -0,0 +1,88 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+#ifndef __ACC_MEMPOOL_H__
+#define __ACC_MEMPOOL_H__
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "acc_log.h"
+
+#define ACC_MEMPOOL_NUM_CLASSES 192
+
+/* where the pool gets its memory from, e.g. cudaMalloc/cudaFree or malloc/free */
+typedef struct acc_mempool_backend_s{
+	const char *name;
+	/* return NULL when out of memory */
+	void* (*alloc)(size_t size);
+	void (*free)(void* ptr);
+	/*
+	 * optional, for memory used by asynchronous work: a fence for the work
+	 * queued so far (NULL if there is none), a test whether that work has
+	 * finished, a wait for it, and the release of the fence
+	 */
+	void* (*fence_record)(void);
+	int (*fence_done)(void* fence);
+	void (*fence_wait)(void* fence);
+	void (*fence_release)(void* fence);
+} acc_mempool_backend_t;
+
+typedef struct acc_mempool_block_s{
+	void *ptr;
+	/* the work which may still use the block, NULL if there is none */
+	void *fence;
+	struct acc_mempool_block_s *next;
+} acc_mempool_block_t;
+
+typedef struct acc_mempool_stats_s{
+	/* allocations served from the cache */
+	unsigned long hits;
+	/* allocations which went to the backend */
+	unsigned long misses;
+	/* hits which had to wait for the device to finish with the block */
+	unsigned long fence_waits;
+	/* bytes of free blocks kept in the cache */
+	size_t bytes_cached;
+	/* bytes of blocks handed out and not freed yet */
+	size_t bytes_in_use;
+	/* bytes given back to the backend by trimming */
+	size_t bytes_trimmed;
+} acc_mempool_stats_t;
+
+typedef struct acc_mempool_s{
+	acc_mempool_backend_t backend;
+
+	/* the cache is trimmed when it would grow above this many bytes */
+	size_t high_water_mark;
+
+	/* free blocks of each size class */
+	acc_mempool_block_t *free_blocks[ACC_MEMPOOL_NUM_CLASSES];
+	/* unused list nodes, so caching a block does not call malloc */
+	acc_mempool_block_t *spare_nodes;
+
+	acc_mempool_stats_t stats;
+	pthread_mutex_t lock;
+} acc_mempool_t;
+
+extern acc_mempool_backend_t acc_mempool_host_backend;
+
+extern acc_mempool_t* acc_mempool_create(acc_mempool_backend_t* backend, size_t high_water_mark);
+
+/* the size of the block acc_mempool_alloc returns for size bytes */
+extern size_t acc_mempool_class_size(size_t size);
+
+extern void* acc_mempool_alloc(acc_mempool_t* pool, size_t size);
+
+/* size must be the size passed to acc_mempool_alloc */
+extern void acc_mempool_free(acc_mempool_t* pool, void* ptr, size_t size);
+
+/* give all cached blocks back to the backend */
+extern void acc_mempool_trim(acc_mempool_t* pool);
+
+extern void acc_mempool_get_stats(acc_mempool_t* pool, acc_mempool_stats_t* stats);
+
+extern void acc_mempool_destroy(acc_mempool_t* pool);
+
+#endif
@@ -0,0 +1,386 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+/**
+ * Page-locked host memory for asynchronous transfers.
+ *
+ * cudaMemcpyAsync only overlaps with the host when the host memory is
+ * page-locked, and cudaHostRegister is far too expensive to call on every
+ * update of the same array. The registered ranges are cached: each one is
+ * a page-aligned region, a range which overlaps or touches cached regions
+ * is merged with them into one registration, and the least recently used
+ * regions are unregistered when the total would go above ACC_PINNED_SIZE
+ * megabytes.
+ *
+ * Small transfers do not pay for a registration at all, they are copied
+ * through a few pre-pinned staging buffers instead, in chunks, so that
+ * filling one buffer overlaps with the copy out of the other one.
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include "acc_common.h"
+
+static acc_pinned_region_t *pinned_regions = NULL;
+static acc_pinned_stats_t pinned_stats;
+static size_t pinned_limit = 0;
+static uintptr_t page_size = 0;
+static unsigned long use_clock = 0;
+static pthread_mutex_t pinned_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static acc_staging_buffer_t staging_buffers[ACC_STAGING_NUM_BUFFERS];
+static int staging_ready = 0;
+static int staging_next = 0;
+static unsigned long staged_transfers = 0;
+static pthread_mutex_t staging_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void __accr_pinned_setup(void);
+
+static acc_pinned_region_t* __accr_pinned_find(uintptr_t start, uintptr_t end);
+
+static void __accr_pinned_unregister(acc_pinned_region_t* region);
+
+static void __accr_staging_setup(void);
+
+static acc_staging_buffer_t* __accr_staging_acquire(void);
+
+static void __accr_pinned_setup(void)
+{
+	char *env;
+	size_t limit;
+
+	page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+
+	limit = ACC_PINNED_DEFAULT_SIZE;
+	env = getenv("ACC_PINNED_SIZE");
+	if(env != NULL)
+		limit = (size_t)strtoul(env, NULL, 10);
+	pinned_limit = limit << 20;
+}
+
+/* the region which contains [start, end), NULL if there is none */
+static acc_pinned_region_t* __accr_pinned_find(uintptr_t start, uintptr_t end)
+{
+	acc_pinned_region_t *region;
+
+	for(region = pinned_regions; region != NULL && region->start <= start; region = region->next)
+	{
+		if(end <= region->end)
+			return region;
+	}
+	return NULL;
+}
+
+/* the caller has made sure no copy is using the region any more */
+static void __accr_pinned_unregister(acc_pinned_region_t* region)
+{
+	CUDART_CHECK( cudaHostUnregister((void*)region->start) );
+	pinned_stats.bytes_registered -= region->end - region->start;
+	free(region);
+}
+
+int acc_pinned_lookup(void* ptr, size_t size)
+{
+	acc_pinned_region_t *region;
+
+	pthread_mutex_lock(&pinned_lock);
+	if(page_size == 0)
+		__accr_pinned_setup();
+
+	region = __accr_pinned_find((uintptr_t)ptr, (uintptr_t)ptr + size);
+	if(region != NULL)
+	{
+		region->last_use = ++use_clock;
+		pinned_stats.hits++;
+	}
+	pthread_mutex_unlock(&pinned_lock);
+
+	return region != NULL;
+}
+
+int acc_pinned_register(void* ptr, size_t size)
+{
+	acc_pinned_region_t *region, *lru, **link, **lru_link;
+	uintptr_t start, end;
+	cudaError_t err;
+	int synchronized;
+
+	pthread_mutex_lock(&pinned_lock);
+	if(page_size == 0)
+		__accr_pinned_setup();
+
+	start = (uintptr_t)ptr & ~(page_size - 1);
+	end = ((uintptr_t)ptr + size + page_size - 1) & ~(page_size - 1);
+
+	region = __accr_pinned_find(start, end);
+	if(region != NULL)
+	{
+		region->last_use = ++use_clock;
+		pinned_stats.hits++;
+		pthread_mutex_unlock(&pinned_lock);
+		return 1;
+	}
+
+	/* the extent of the new region, together with the regions it overlaps or touches */
+	for(region = pinned_regions; region != NULL; region = region->next)
+	{
+		if(region->start <= end && region->end >= start)
+		{
+			start = min(start, region->start);
+			end = max(end, region->end);
+		}
+	}
+
+	if(end - start > pinned_limit)
+	{
+		pthread_mutex_unlock(&pinned_lock);
+		return 0;
+	}
+
+	/*
+	 * an asynchronous copy may still read or write a region which is
+	 * unregistered here, let all copies finish first
+	 */
+	synchronized = 0;
+
+	/* the merged regions are replaced by one registration */
+	link = &pinned_regions;
+	while(*link != NULL)
+	{
+		region = *link;
+		if(region->start >= start && region->end <= end)
+		{
+			if(!synchronized)
+			{
+				CUDART_CHECK( cudaDeviceSynchronize() );
+				synchronized = 1;
+			}
+			*link = region->next;
+			__accr_pinned_unregister(region);
+		}
+		else
+			link = &region->next;
+	}
+
+	while(pinned_stats.bytes_registered + (end - start) > pinned_limit)
+	{
+		lru = NULL;
+		lru_link = NULL;
+		for(link = &pinned_regions; *link != NULL; link = &(*link)->next)
+		{
+			if(lru == NULL || (*link)->last_use < lru->last_use)
+			{
+				lru = *link;
+				lru_link = link;
+			}
+		}
+
+		if(!synchronized)
+		{
+			CUDART_CHECK( cudaDeviceSynchronize() );
+			synchronized = 1;
+		}
+		*lru_link = lru->next;
+		__accr_pinned_unregister(lru);
+		pinned_stats.evictions++;
+	}
+
+	err = cudaHostRegister((void*)start, end - start, cudaHostRegisterMapped);
+	if(err != cudaSuccess)
+	{
+		/* clear the error, the caller falls back to a staged copy */
+		cudaGetLastError();
+		pthread_mutex_unlock(&pinned_lock);
+
+		/* the application has registered it by itself */
+		if(err == cudaErrorHostMemoryAlreadyRegistered)
+			return 1;
+
+		DEBUG(("Cannot register %lu bytes of host memory at %p", end - start, (void*)start));
+		return 0;
+	}
+
+	region = (acc_pinned_region_t*)malloc(sizeof(acc_pinned_region_t));
+	if(region == NULL)
+		ERROR(("Cannot allocate a pinned memory region"));
+	region->start = start;
+	region->end = end;
+	region->last_use = ++use_clock;
+
+	/* keep the list sorted by the start address */
+	for(link = &pinned_regions; *link != NULL && (*link)->start < start; link = &(*link)->next)
+		;
+	region->next = *link;
+	*link = region;
+
+	pinned_stats.registrations++;
+	pinned_stats.bytes_registered += end - start;
+
+	pthread_mutex_unlock(&pinned_lock);
+
+	DEBUG(("Registered %lu bytes of host memory at %p", end - start, (void*)start));
+	return 1;
+}
+
+static void __accr_staging_setup(void)
+{
+	int i;
+
+	for(i = 0; i < ACC_STAGING_NUM_BUFFERS; i++)
+	{
+		CUDART_CHECK( cudaMallocHost(&staging_buffers[i].ptr, ACC_STAGING_CHUNK_SIZE) );
+		CUDA_CHECK( cuEventCreate(&staging_buffers[i].done, CU_EVENT_DISABLE_TIMING) );
+		staging_buffers[i].busy = 0;
+	}
+	staging_next = 0;
+	staging_ready = 1;
+}
+
+/* the next staging buffer, after the copy which used it last has finished */
+static acc_staging_buffer_t* __accr_staging_acquire(void)
+{
+	acc_staging_buffer_t *buffer;
+
+	buffer = &staging_buffers[staging_next];
+	staging_next = (staging_next + 1) % ACC_STAGING_NUM_BUFFERS;
+
+	if(buffer->busy)
+	{
+		CUDA_CHECK( cuEventSynchronize(buffer->done) );
+		buffer->busy = 0;
+	}
+	return buffer;
+}
+
+/*
+ * the host data is copied into the staging buffers before this returns,
+ * so the host may change it while the copies to the device are in flight
+ */
+void acc_staging_h2d(void* pDevice, void* pHost, size_t size, cudaStream_t stream)
+{
+	acc_staging_buffer_t *buffer;
+	size_t offset, len;
+
+	pthread_mutex_lock(&staging_lock);
+	if(!staging_ready)
+		__accr_staging_setup();
+
+	for(offset = 0; offset < size; offset += len)
+	{
+		len = min(size - offset, ACC_STAGING_CHUNK_SIZE);
+		buffer = __accr_staging_acquire();
+
+		memcpy(buffer->ptr, (char*)pHost + offset, len);
+		CUDART_CHECK( cudaMemcpyAsync((char*)pDevice + offset,
+									  buffer->ptr,
+									  len,
+									  cudaMemcpyHostToDevice,
+									  stream) );
+		CUDA_CHECK( cuEventRecord(buffer->done, stream) );
+		buffer->busy = 1;
+	}
+	staged_transfers++;
+
+	pthread_mutex_unlock(&staging_lock);
+}
+
+/*
+ * the host data is only written once the copies have arrived, so unlike
+ * a copy from registered memory this one is finished when it returns
+ */
+void acc_staging_d2h(void* pHost, void* pDevice, size_t size, cudaStream_t stream)
+{
+	acc_staging_buffer_t *buffer, *prev;
+	size_t offset, len, prev_offset, prev_len;
+
+	pthread_mutex_lock(&staging_lock);
+	if(!staging_ready)
+		__accr_staging_setup();
+
+	prev = NULL;
+	prev_offset = prev_len = 0;
+	for(offset = 0; offset < size; offset += len)
+	{
+		len = min(size - offset, ACC_STAGING_CHUNK_SIZE);
+		buffer = __accr_staging_acquire();
+
+		CUDART_CHECK( cudaMemcpyAsync(buffer->ptr,
+									  (char*)pDevice + offset,
+									  len,
+									  cudaMemcpyDeviceToHost,
+									  stream) );
+		CUDA_CHECK( cuEventRecord(buffer->done, stream) );
+		buffer->busy = 1;
+
+		/* drain the previous chunk while this one is copied */
+		if(prev != NULL)
+		{
+			CUDA_CHECK( cuEventSynchronize(prev->done) );
+			memcpy((char*)pHost + prev_offset, prev->ptr, prev_len);
+			prev->busy = 0;
+		}
+		prev = buffer;
+		prev_offset = offset;
+		prev_len = len;
+	}
+
+	if(prev != NULL)
+	{
+		CUDA_CHECK( cuEventSynchronize(prev->done) );
+		memcpy((char*)pHost + prev_offset, prev->ptr, prev_len);
+		prev->busy = 0;
+	}
+	staged_transfers++;
+
+	pthread_mutex_unlock(&staging_lock);
+}
+
+void acc_pinned_get_stats(acc_pinned_stats_t* stats)
+{
+	pthread_mutex_lock(&pinned_lock);
+	*stats = pinned_stats;
+	pthread_mutex_unlock(&pinned_lock);
+
+	pthread_mutex_lock(&staging_lock);
+	stats->staged = staged_transfers;
+	pthread_mutex_unlock(&staging_lock);
+}
+
+void acc_pinned_destroy(void)
+{
+	acc_pinned_region_t *region, *next;
+	acc_pinned_stats_t stats;
+	int i;
+
+	acc_pinned_get_stats(&stats);
+	INFO(("Pinned memory: %lu hits, %lu registrations, %lu evictions, %lu staged transfers",
+				stats.hits, stats.registrations, stats.evictions, stats.staged));
+
+	pthread_mutex_lock(&pinned_lock);
+	if(pinned_regions != NULL)
+		CUDART_CHECK( cudaDeviceSynchronize() );
+	for(region = pinned_regions; region != NULL; region = next)
+	{
+		next = region->next;
+		__accr_pinned_unregister(region);
+	}
+	pinned_regions = NULL;
+	memset(&pinned_stats, 0, sizeof(acc_pinned_stats_t));
+	pthread_mutex_unlock(&pinned_lock);
+
+	pthread_mutex_lock(&staging_lock);
+	if(staging_ready)
+	{
+		for(i = 0; i < ACC_STAGING_NUM_BUFFERS; i++)
+		{
+			CUDA_CHECK( cuEventSynchronize(staging_buffers[i].done) );
+			CUDA_CHECK( cuEventDestroy(staging_buffers[i].done) );
+			CUDART_CHECK( cudaFreeHost(staging_buffers[i].ptr) );
+		}
+		staging_ready = 0;
+	}
+	staged_transfers = 0;
+	pthread_mutex_unlock(&staging_lock);
+}
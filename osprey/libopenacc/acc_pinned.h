@@ -0,0 +1,76 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+#ifndef __ACC_PINNED_H__
+#define __ACC_PINNED_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include "acc_log.h"
+
+/* megabytes of host memory which may stay registered, see ACC_PINNED_SIZE */
+#define ACC_PINNED_DEFAULT_SIZE 1024
+
+/* transfers up to this size go through the staging buffers */
+#define ACC_STAGING_THRESHOLD (1UL << 20)
+
+/* size of one staging buffer, larger transfers are split into chunks */
+#define ACC_STAGING_CHUNK_SIZE (256UL << 10)
+
+/* two buffers, one is filled while the other one is copied */
+#define ACC_STAGING_NUM_BUFFERS 2
+
+/* a page-aligned host range registered with cudaHostRegister */
+typedef struct acc_pinned_region_s{
+	uintptr_t start;
+	uintptr_t end;
+	/* larger is more recently used */
+	unsigned long last_use;
+	struct acc_pinned_region_s *next;
+} acc_pinned_region_t;
+
+typedef struct acc_staging_buffer_s{
+	void *ptr;
+	/* recorded after the last copy which reads or writes ptr */
+	CUevent done;
+	int busy;
+} acc_staging_buffer_t;
+
+typedef struct acc_pinned_stats_s{
+	/* transfers whose host range was registered already */
+	unsigned long hits;
+	/* calls to cudaHostRegister */
+	unsigned long registrations;
+	/* regions unregistered to stay under the limit */
+	unsigned long evictions;
+	/* transfers which went through the staging buffers */
+	unsigned long staged;
+	size_t bytes_registered;
+} acc_pinned_stats_t;
+
+/*
+ * make sure [ptr, ptr+size) is page-locked so that an asynchronous copy
+ * can use it, return 0 if it cannot be registered under the limit
+ */
+extern int acc_pinned_register(void* ptr, size_t size);
+
+/* return 1 if [ptr, ptr+size) is inside a registered region */
+extern int acc_pinned_lookup(void* ptr, size_t size);
+
+/* copy host memory to the device through the pre-pinned staging buffers */
+extern void acc_staging_h2d(void* pDevice, void* pHost, size_t size, cudaStream_t stream);
+
+/* copy device memory to the host through the pre-pinned staging buffers */
+extern void acc_staging_d2h(void* pHost, void* pDevice, size_t size, cudaStream_t stream);
+
+extern void acc_pinned_get_stats(acc_pinned_stats_t* stats);
+
+/* unregister all regions and release the staging buffers */
+extern void acc_pinned_destroy(void);
+
+#endif
@@ -0,0 +1,386 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+/**
+ * The present table keeps the host/device mappings of all data which is
+ * currently on the device. It has two indexes over the same entries:
+ *
+ * - the host index is an interval tree over [host_addr, host_addr+size),
+ *   it answers "which mapping contains the host range [p, p+len)", which
+ *   is what present checks and sub-array lookups need;
+ * - the device index is an interval tree over [device_addr, device_addr+size),
+ *   it is used when the device memory is released;
+ * - the base index holds the mappings of sub-arrays which do not start at
+ *   the start of their array, by device_addr-offset, the device address
+ *   the compiled code uses for the array, so that the mapping is found
+ *   again when that address is released.
+ *
+ * Both indexes are AVL trees ordered by the start address, augmented with
+ * the maximum end address of each subtree. Insert, remove and lookup are
+ * O(log n) in the number of live mappings. Mappings may overlap (the same
+ * host array can be mapped more than once), ties on the start address are
+ * broken by the node address so that every node has a unique position.
+ */
+
+#include "acc_present.h"
+
+#define PT_ENTRY_OF(n, member) \
+    ((acc_present_entry*)((char*)(n) - offsetof(acc_present_entry, member)))
+
+static int height(acc_present_node* n);
+
+static void update(acc_present_node* n);
+
+static int compare(acc_present_node* a, acc_present_node* b);
+
+static acc_present_node* rotate_left(acc_present_node* n);
+
+static acc_present_node* rotate_right(acc_present_node* n);
+
+static acc_present_node* balance(acc_present_node* n);
+
+static acc_present_node* insert_node(acc_present_node* root, acc_present_node* n);
+
+static acc_present_node* remove_min(acc_present_node* root, acc_present_node** min);
+
+static acc_present_node* remove_node(acc_present_node* root, acc_present_node* n);
+
+static acc_present_node* find_containing(acc_present_node* root, uintptr_t lo, uintptr_t hi);
+
+static void init_node(acc_present_node* n, void* addr, size_t size);
+
+static acc_present_node* find_start(acc_present_node* root, uintptr_t key);
+
+acc_present_table* acc_present_table_create()
+{
+    acc_present_table* table;
+
+    table = (acc_present_table*)malloc(sizeof(acc_present_table));
+    if(table == NULL)
+        ERROR(("Cannot allocate the present table"));
+
+    table->size = 0;
+    table->host_root = NULL;
+    table->device_root = NULL;
+    table->base_root = NULL;
+
+    return table;
+}
+
+static int height(acc_present_node* n)
+{
+    return n ? n->height : 0;
+}
+
+static void update(acc_present_node* n)
+{
+    int hl = height(n->left);
+    int hr = height(n->right);
+
+    n->height = (hl > hr ? hl : hr) + 1;
+    n->max_end = n->end;
+    if(n->left && n->left->max_end > n->max_end)
+        n->max_end = n->left->max_end;
+    if(n->right && n->right->max_end > n->max_end)
+        n->max_end = n->right->max_end;
+}
+
+static int compare(acc_present_node* a, acc_present_node* b)
+{
+    if(a->start != b->start)
+        return a->start < b->start ? -1 : 1;
+    if(a != b)
+        return a < b ? -1 : 1;
+    return 0;
+}
+
+static acc_present_node* rotate_left(acc_present_node* n)
+{
+    acc_present_node* r = n->right;
+
+    n->right = r->left;
+    r->left = n;
+    update(n);
+    update(r);
+    return r;
+}
+
+static acc_present_node* rotate_right(acc_present_node* n)
+{
+    acc_present_node* l = n->left;
+
+    n->left = l->right;
+    l->right = n;
+    update(n);
+    update(l);
+    return l;
+}
+
+static acc_present_node* balance(acc_present_node* n)
+{
+    int diff;
+
+    update(n);
+    diff = height(n->left) - height(n->right);
+    if(diff > 1)
+    {
+        if(height(n->left->left) < height(n->left->right))
+            n->left = rotate_left(n->left);
+        return rotate_right(n);
+    }
+    if(diff < -1)
+    {
+        if(height(n->right->right) < height(n->right->left))
+            n->right = rotate_right(n->right);
+        return rotate_left(n);
+    }
+    return n;
+}
+
+static acc_present_node* insert_node(acc_present_node* root, acc_present_node* n)
+{
+    if(root == NULL)
+        return n;
+
+    if(compare(n, root) < 0)
+        root->left = insert_node(root->left, n);
+    else
+        root->right = insert_node(root->right, n);
+
+    return balance(root);
+}
+
+/* detach the leftmost node of the subtree and return it in *min */
+static acc_present_node* remove_min(acc_present_node* root, acc_present_node** min)
+{
+    if(root->left == NULL)
+    {
+        *min = root;
+        return root->right;
+    }
+    root->left = remove_min(root->left, min);
+    return balance(root);
+}
+
+static acc_present_node* remove_node(acc_present_node* root, acc_present_node* n)
+{
+    int c;
+
+    if(root == NULL)
+        return NULL;
+
+    c = compare(n, root);
+    if(c < 0)
+        root->left = remove_node(root->left, n);
+    else if(c > 0)
+        root->right = remove_node(root->right, n);
+    else
+    {
+        acc_present_node* min;
+
+        if(root->right == NULL)
+            return root->left;
+        if(root->left == NULL)
+            return root->right;
+
+        /* replace the node with its in-order successor */
+        min = NULL;
+        root->right = remove_min(root->right, &min);
+        min->left = root->left;
+        min->right = root->right;
+        root = min;
+    }
+
+    return balance(root);
+}
+
+/*
+ * find a node whose interval contains [lo, hi), i.e. start <= lo and
+ * end >= hi. Only one path of the tree is visited: once a left subtree
+ * is known to hold an interval ending at or after hi, all its starts are
+ * already <= lo and the search follows max_end downwards.
+ */
+static acc_present_node* find_containing(acc_present_node* root, uintptr_t lo, uintptr_t hi)
+{
+    acc_present_node* n = root;
+
+    while(n != NULL)
+    {
+        if(n->start > lo)
+        {
+            n = n->left;
+            continue;
+        }
+        if(n->end >= hi)
+            return n;
+        if(n->left && n->left->max_end >= hi)
+        {
+            n = n->left;
+            while(n != NULL)
+            {
+                if(n->end >= hi)
+                    return n;
+                if(n->left && n->left->max_end >= hi)
+                    n = n->left;
+                else
+                    n = n->right;
+            }
+            return NULL;
+        }
+        n = n->right;
+    }
+
+    return NULL;
+}
+
+static void init_node(acc_present_node* n, void* addr, size_t size)
+{
+    n->start = (uintptr_t)addr;
+    n->end = n->start + size;
+    n->max_end = n->end;
+    n->height = 1;
+    n->left = NULL;
+    n->right = NULL;
+}
+
+/* find a node whose interval starts exactly at key */
+static acc_present_node* find_start(acc_present_node* n, uintptr_t key)
+{
+    while(n != NULL)
+    {
+        if(key == n->start)
+            return n;
+        n = key < n->start ? n->left : n->right;
+    }
+
+    return NULL;
+}
+
+/* insert a host/device mapping of size bytes, offset bytes into its array */
+acc_present_entry* acc_present_table_insert(acc_present_table* table,
+                                            void* host_addr,
+                                            void* device_addr,
+                                            size_t size,
+                                            size_t offset)
+{
+    acc_present_entry* entry;
+
+    entry = (acc_present_entry*)malloc(sizeof(acc_present_entry));
+    if(entry == NULL)
+        ERROR(("Cannot allocate a present table entry"));
+
+    entry->host_addr = host_addr;
+    entry->device_addr = device_addr;
+    entry->size = size;
+    entry->offset = offset;
+
+    init_node(&entry->host_node, host_addr, size);
+    init_node(&entry->device_node, device_addr, size);
+    init_node(&entry->base_node, (char*)device_addr - offset, size);
+
+    /* data allocated by acc_malloc has no host counterpart */
+    if(host_addr != NULL)
+        table->host_root = insert_node(table->host_root, &entry->host_node);
+    table->device_root = insert_node(table->device_root, &entry->device_node);
+    if(offset != 0)
+        table->base_root = insert_node(table->base_root, &entry->base_node);
+    table->size++;
+
+    return entry;
+}
+
+/* find the mapping which contains the host range [host_addr, host_addr+len) */
+acc_present_entry* acc_present_table_lookup_host(acc_present_table* table,
+                                                 void* host_addr,
+                                                 size_t len)
+{
+    acc_present_node* n;
+    uintptr_t lo = (uintptr_t)host_addr;
+
+    if(host_addr == NULL)
+        return NULL;
+
+    /* a zero length query asks whether the address itself is mapped */
+    n = find_containing(table->host_root, lo, lo + (len ? len : 1));
+
+    return n ? PT_ENTRY_OF(n, host_node) : NULL;
+}
+
+/* find the mapping which contains the device range [device_addr, device_addr+len) */
+acc_present_entry* acc_present_table_lookup_device(acc_present_table* table,
+                                                   void* device_addr,
+                                                   size_t len)
+{
+    acc_present_node* n;
+    uintptr_t lo = (uintptr_t)device_addr;
+
+    if(device_addr == NULL)
+        return NULL;
+
+    n = find_containing(table->device_root, lo, lo + (len ? len : 1));
+
+    return n ? PT_ENTRY_OF(n, device_node) : NULL;
+}
+
+/* find the mapping whose host range starts exactly at host_addr */
+acc_present_entry* acc_present_table_find_host(acc_present_table* table,
+                                               void* host_addr)
+{
+    acc_present_node* n;
+
+    n = find_start(table->host_root, (uintptr_t)host_addr);
+
+    return n ? PT_ENTRY_OF(n, host_node) : NULL;
+}
+
+/* find the mapping whose device array starts at device_base, i.e. device_addr-offset */
+acc_present_entry* acc_present_table_find_device_base(acc_present_table* table,
+                                                      void* device_base)
+{
+    acc_present_node* n;
+    acc_present_entry* entry;
+
+    if(device_base == NULL)
+        return NULL;
+
+    /* a sub-array in the middle of its array */
+    n = find_start(table->base_root, (uintptr_t)device_base);
+    if(n != NULL)
+        return PT_ENTRY_OF(n, base_node);
+
+    n = find_start(table->device_root, (uintptr_t)device_base);
+    if(n == NULL)
+        return NULL;
+    entry = PT_ENTRY_OF(n, device_node);
+
+    return entry->offset == 0 ? entry : NULL;
+}
+
+/* unlink the mapping from the table and release it */
+void acc_present_table_remove(acc_present_table* table, acc_present_entry* entry)
+{
+    if(entry->host_addr != NULL)
+        table->host_root = remove_node(table->host_root, &entry->host_node);
+    table->device_root = remove_node(table->device_root, &entry->device_node);
+    if(entry->offset != 0)
+        table->base_root = remove_node(table->base_root, &entry->base_node);
+    table->size--;
+
+    free(entry);
+}
+
+/* remove all mappings in this table */
+void acc_present_table_clear(acc_present_table* table)
+{
+    while(table->device_root != NULL)
+        acc_present_table_remove(table, PT_ENTRY_OF(table->device_root, device_node));
+}
+
+/* destroy the table */
+void acc_present_table_destroy(acc_present_table* table)
+{
+    acc_present_table_clear(table);
+    free(table);
+}
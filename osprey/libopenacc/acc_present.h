@@ -0,0 +1,94 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+#ifndef __ACC_PRESENT_H
+#define __ACC_PRESENT_H
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "acc_log.h"
+
+/*
+ * A node of an interval tree. The tree is an AVL tree ordered by the
+ * start address of the interval [start, end). Each node also keeps the
+ * largest end address in its subtree so that containment queries only
+ * need to walk one root-to-leaf path.
+ */
+typedef struct acc_present_node_s{
+    uintptr_t start;
+    uintptr_t end;
+    uintptr_t max_end;
+    int height;
+    struct acc_present_node_s* left;
+    struct acc_present_node_s* right;
+} acc_present_node;
+
+/*
+ * One host/device mapping. The same entry is linked into the host
+ * address tree (unless host_addr is NULL, e.g. data from acc_malloc)
+ * and into the device address tree. host_addr and device_addr are the
+ * first byte of the mapped data, offset bytes after the start of the
+ * array, e.g. lo*sizeof(a[0]) for the sub-array a[lo:n]. A mapping with
+ * a nonzero offset is also linked into the base tree, by the device
+ * address of the array start.
+ */
+typedef struct acc_present_entry_s{
+    void* host_addr;
+    void* device_addr;
+    size_t size;
+    size_t offset;
+
+    acc_present_node host_node;
+    acc_present_node device_node;
+    acc_present_node base_node;
+} acc_present_entry;
+
+typedef struct acc_present_table_s{
+    /* the number of mappings in this table */
+    int size;
+
+    acc_present_node* host_root;
+    acc_present_node* device_root;
+    acc_present_node* base_root;
+} acc_present_table;
+
+acc_present_table* acc_present_table_create();
+
+/* insert a host/device mapping of size bytes, offset bytes into its array */
+acc_present_entry* acc_present_table_insert(acc_present_table* table,
+                                            void* host_addr,
+                                            void* device_addr,
+                                            size_t size,
+                                            size_t offset);
+
+/* find the mapping which contains the host range [host_addr, host_addr+len) */
+acc_present_entry* acc_present_table_lookup_host(acc_present_table* table,
+                                                 void* host_addr,
+                                                 size_t len);
+
+/* find the mapping which contains the device range [device_addr, device_addr+len) */
+acc_present_entry* acc_present_table_lookup_device(acc_present_table* table,
+                                                   void* device_addr,
+                                                   size_t len);
+
+/* find the mapping whose host range starts exactly at host_addr */
+acc_present_entry* acc_present_table_find_host(acc_present_table* table,
+                                               void* host_addr);
+
+/* find the mapping whose device array starts at device_base, i.e. device_addr-offset */
+acc_present_entry* acc_present_table_find_device_base(acc_present_table* table,
+                                                      void* device_base);
+
+/* unlink the mapping from the table and release it */
+void acc_present_table_remove(acc_present_table* table, acc_present_entry* entry);
+
+/* remove all mappings in this table */
+void acc_present_table_clear(acc_present_table* table);
+
+/* destroy the table */
+void acc_present_table_destroy(acc_present_table* table);
+
+#endif
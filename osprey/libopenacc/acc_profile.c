@@ -0,0 +1,491 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+/**
+ * The runtime profiler. Operations on a GPU are timed with a pair of CUDA
+ * events on their stream, so that asynchronous kernels and copies get
+ * their device time instead of the launch time. The events are only read
+ * when too many are pending or at exit; times are relative to an event
+ * recorded when the profiler starts. Operations on the host backend, and
+ * allocations, are timed with the host clock.
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include "acc_data.h"
+
+typedef struct acc_prof_name_s{
+	char *name;
+	/* aggregated at exit */
+	unsigned long calls;
+	double total_us;
+	double min_us;
+	double max_us;
+	struct acc_prof_name_s *next;
+} acc_prof_name_t;
+
+int __accr_profiling = 0;
+
+static int profile_on_device = 0;
+static int profile_finished = 0;
+static int profile_registered = 0;
+static double host_base;
+static CUevent base_event;
+
+static acc_prof_record_t *records = NULL;
+static int num_records = 0;
+static int max_records = 0;
+/* the records before this one have their times */
+static int num_resolved = 0;
+
+static CUevent *free_events = NULL;
+static int num_free_events = 0;
+static int max_free_events = 0;
+
+static acc_prof_name_t *kernel_names = NULL;
+static unsigned long present_hits = 0;
+static unsigned long present_misses = 0;
+
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double __accr_profile_now(void);
+
+static CUevent __accr_profile_get_event(void);
+
+static void __accr_profile_put_event(CUevent event);
+
+static acc_prof_record_t* __accr_profile_new_record(acc_prof_mark_t* mark,
+													CUstream stream,
+													int on_device);
+
+static void __accr_profile_resolve(int upto);
+
+static const char* __accr_profile_intern(const char* szKernelName);
+
+static void __accr_profile_summary(FILE* fp);
+
+static void __accr_profile_trace(const char* filename);
+
+static double __accr_profile_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1.0e-9;
+}
+
+void __accr_profile_init(void)
+{
+	char *env;
+
+	env = getenv("ACC_PROFILE");
+	if(env == NULL || env[0] == '\0' || strcmp(env, "0") == 0)
+		return;
+
+	if(__accr_profiling)
+		return;
+
+	profile_on_device = !ACC_ON_HOST();
+	host_base = __accr_profile_now();
+	if(profile_on_device)
+	{
+		CUDA_CHECK( cuEventCreate(&base_event, CU_EVENT_DEFAULT) );
+		CUDA_CHECK( cuEventRecord(base_event, NULL) );
+	}
+
+	profile_finished = 0;
+	__accr_profiling = 1;
+
+	/* in case the program does not call acc_shutdown */
+	if(!profile_registered)
+	{
+		atexit(__accr_profile_finish);
+		profile_registered = 1;
+	}
+}
+
+/* the caller holds the profile lock */
+static CUevent __accr_profile_get_event(void)
+{
+	CUevent event;
+
+	if(num_free_events > 0)
+		return free_events[--num_free_events];
+
+	CUDA_CHECK( cuEventCreate(&event, CU_EVENT_DEFAULT) );
+	return event;
+}
+
+/* the caller holds the profile lock */
+static void __accr_profile_put_event(CUevent event)
+{
+	if(num_free_events == max_free_events)
+	{
+		max_free_events = max_free_events == 0 ? 256 : max_free_events*2;
+		free_events = (CUevent*)realloc(free_events, max_free_events*sizeof(CUevent));
+		if(free_events == NULL)
+			ERROR(("Cannot allocate the profiler event list"));
+	}
+	free_events[num_free_events++] = event;
+}
+
+void __accr_profile_start(acc_prof_mark_t* mark, CUstream stream, int on_device)
+{
+	mark->host_start = __accr_profile_now();
+	mark->start = NULL;
+
+	if(on_device)
+	{
+		pthread_mutex_lock(&profile_lock);
+		mark->start = __accr_profile_get_event();
+		pthread_mutex_unlock(&profile_lock);
+		CUDA_CHECK( cuEventRecord(mark->start, stream) );
+	}
+}
+
+/*
+ * read the device events of the records before upto and recycle them,
+ * this blocks until those operations have finished
+ */
+static void __accr_profile_resolve(int upto)
+{
+	acc_prof_record_t *record;
+	float ms;
+
+	for(; num_resolved < upto; num_resolved++)
+	{
+		record = &records[num_resolved];
+		if(record->start == NULL)
+			continue;
+
+		CUDA_CHECK( cuEventSynchronize(record->end) );
+		CUDA_CHECK( cuEventElapsedTime(&ms, base_event, record->start) );
+		record->start_us = ms*1.0e3;
+		CUDA_CHECK( cuEventElapsedTime(&ms, base_event, record->end) );
+		record->end_us = ms*1.0e3;
+
+		__accr_profile_put_event(record->start);
+		__accr_profile_put_event(record->end);
+		record->start = record->end = NULL;
+	}
+}
+
+/* the caller holds the profile lock */
+static acc_prof_record_t* __accr_profile_new_record(acc_prof_mark_t* mark,
+													CUstream stream,
+													int on_device)
+{
+	acc_prof_record_t *record;
+
+	if(num_records - num_resolved >= ACC_PROF_MAX_PENDING)
+		__accr_profile_resolve(num_resolved + ACC_PROF_MAX_PENDING/2);
+
+	if(num_records == max_records)
+	{
+		max_records = max_records == 0 ? 1024 : max_records*2;
+		records = (acc_prof_record_t*)realloc(records, max_records*sizeof(acc_prof_record_t));
+		if(records == NULL)
+			ERROR(("Cannot allocate the profiler records"));
+	}
+
+	record = &records[num_records++];
+	memset(record, 0, sizeof(acc_prof_record_t));
+	record->queue = -1;
+
+	if(mark == NULL)
+	{
+		/* an instant on the host clock */
+		record->start_us = record->end_us = (__accr_profile_now() - host_base)*1.0e6;
+	}
+	else if(on_device)
+	{
+		record->start = mark->start;
+		record->end = __accr_profile_get_event();
+		CUDA_CHECK( cuEventRecord(record->end, stream) );
+	}
+	else
+	{
+		record->start_us = (mark->host_start - host_base)*1.0e6;
+		record->end_us = (__accr_profile_now() - host_base)*1.0e6;
+	}
+
+	return record;
+}
+
+/* the caller holds the profile lock */
+static const char* __accr_profile_intern(const char* szKernelName)
+{
+	acc_prof_name_t *name;
+
+	for(name = kernel_names; name != NULL; name = name->next)
+	{
+		if(strcmp(name->name, szKernelName) == 0)
+			return name->name;
+	}
+
+	name = (acc_prof_name_t*)acc_host_alloc_zero(sizeof(acc_prof_name_t));
+	name->name = strdup(szKernelName);
+	name->next = kernel_names;
+	kernel_names = name;
+
+	return name->name;
+}
+
+void __accr_profile_kernel(acc_prof_mark_t* mark,
+						   CUstream stream,
+						   int on_device,
+						   const char* szKernelName,
+						   int gangs[3],
+						   int vectors[3],
+						   int queue)
+{
+	acc_prof_record_t *record;
+
+	pthread_mutex_lock(&profile_lock);
+	record = __accr_profile_new_record(mark, stream, on_device);
+	record->kind = ACC_PROF_KERNEL;
+	record->name = __accr_profile_intern(szKernelName);
+	record->queue = queue;
+	memcpy(record->gangs, gangs, sizeof(record->gangs));
+	memcpy(record->vectors, vectors, sizeof(record->vectors));
+	pthread_mutex_unlock(&profile_lock);
+}
+
+void __accr_profile_transfer(acc_prof_mark_t* mark,
+							 CUstream stream,
+							 int on_device,
+							 acc_prof_kind_t kind,
+							 size_t bytes,
+							 int queue)
+{
+	acc_prof_record_t *record;
+
+	pthread_mutex_lock(&profile_lock);
+	record = __accr_profile_new_record(mark, stream, on_device);
+	record->kind = kind;
+	record->bytes = bytes;
+	record->queue = queue;
+	pthread_mutex_unlock(&profile_lock);
+}
+
+void __accr_profile_alloc(acc_prof_kind_t kind, size_t bytes)
+{
+	acc_prof_record_t *record;
+
+	pthread_mutex_lock(&profile_lock);
+	record = __accr_profile_new_record(NULL, NULL, 0);
+	record->kind = kind;
+	record->bytes = bytes;
+	pthread_mutex_unlock(&profile_lock);
+}
+
+void __accr_profile_present(int hit)
+{
+	if(hit)
+		__sync_fetch_and_add(&present_hits, 1);
+	else
+		__sync_fetch_and_add(&present_misses, 1);
+}
+
+static void __accr_profile_summary(FILE* fp)
+{
+	acc_prof_name_t *name, **sorted;
+	acc_prof_record_t *record;
+	unsigned long count[ACC_PROF_NUM_KINDS];
+	double total_us[ACC_PROF_NUM_KINDS];
+	size_t bytes[ACC_PROF_NUM_KINDS];
+	double us;
+	int i, j, num_names;
+
+	memset(count, 0, sizeof(count));
+	memset(total_us, 0, sizeof(total_us));
+	memset(bytes, 0, sizeof(bytes));
+
+	for(name = kernel_names; name != NULL; name = name->next)
+	{
+		name->calls = 0;
+		name->total_us = name->max_us = 0.0;
+		name->min_us = 1.0e300;
+	}
+
+	for(i = 0; i < num_records; i++)
+	{
+		record = &records[i];
+		us = record->end_us - record->start_us;
+		count[record->kind]++;
+		total_us[record->kind] += us;
+		bytes[record->kind] += record->bytes;
+
+		if(record->kind == ACC_PROF_KERNEL)
+		{
+			for(name = kernel_names; name->name != record->name; name = name->next)
+				;
+			name->calls++;
+			name->total_us += us;
+			name->min_us = min(name->min_us, us);
+			name->max_us = max(name->max_us, us);
+		}
+	}
+
+	/* the kernels which take the most time first */
+	num_names = 0;
+	for(name = kernel_names; name != NULL; name = name->next)
+		num_names++;
+	sorted = (acc_prof_name_t**)acc_host_alloc((num_names + 1)*sizeof(acc_prof_name_t*));
+	num_names = 0;
+	for(name = kernel_names; name != NULL; name = name->next)
+	{
+		for(j = num_names; j > 0 && sorted[j-1]->total_us < name->total_us; j--)
+			sorted[j] = sorted[j-1];
+		sorted[j] = name;
+		num_names++;
+	}
+
+	fprintf(fp, "==== OpenACC runtime profile ====\n");
+	fprintf(fp, "Kernels: %lu launches, %.3f ms\n", count[ACC_PROF_KERNEL], total_us[ACC_PROF_KERNEL]*1.0e-3);
+	if(num_names > 0)
+		fprintf(fp, "  %12s %8s %12s %12s %12s  %s\n", "time(ms)", "calls", "avg(us)", "min(us)", "max(us)", "name");
+	for(j = 0; j < num_names; j++)
+	{
+		name = sorted[j];
+		fprintf(fp, "  %12.3f %8lu %12.2f %12.2f %12.2f  %s\n",
+				name->total_us*1.0e-3, name->calls, name->total_us/name->calls,
+				name->min_us, name->max_us, name->name);
+	}
+	acc_host_free(sorted);
+
+	fprintf(fp, "Transfers:\n");
+	for(i = ACC_PROF_H2D; i <= ACC_PROF_D2H; i++)
+	{
+		fprintf(fp, "  %s: %lu copies, %.3f MB, %.3f ms, %.3f GB/s\n",
+				i == ACC_PROF_H2D ? "host to device" : "device to host",
+				count[i], bytes[i]/1.0e6, total_us[i]*1.0e-3,
+				total_us[i] > 0.0 ? bytes[i]/(total_us[i]*1.0e3) : 0.0);
+	}
+	fprintf(fp, "Allocations: %lu allocations of %.3f MB, %lu frees of %.3f MB\n",
+			count[ACC_PROF_ALLOC], bytes[ACC_PROF_ALLOC]/1.0e6,
+			count[ACC_PROF_FREE], bytes[ACC_PROF_FREE]/1.0e6);
+	fprintf(fp, "Present table: %lu hits, %lu misses\n", present_hits, present_misses);
+}
+
+static void __accr_profile_trace(const char* filename)
+{
+	static const char *kind_names[ACC_PROF_NUM_KINDS] = {
+		"kernel", "h2d", "d2h", "alloc", "free"
+	};
+	acc_prof_record_t *record;
+	char *seen;
+	int max_queue, tid, i;
+	FILE *fp;
+
+	fp = fopen(filename, "w");
+	if(fp == NULL)
+	{
+		WARN(("Cannot open the profile trace %s", filename));
+		return;
+	}
+
+	/* one track per async queue, track 0 is the synchronous operations */
+	max_queue = -1;
+	for(i = 0; i < num_records; i++)
+		max_queue = max(max_queue, records[i].queue);
+	seen = (char*)acc_host_alloc_zero(max_queue + 2);
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+	fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"OpenACC\"}}");
+	for(i = 0; i < num_records; i++)
+	{
+		record = &records[i];
+		tid = record->queue < 0 ? 0 : record->queue + 1;
+		if(!seen[tid])
+		{
+			seen[tid] = 1;
+			if(tid == 0)
+				fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"sync\"}}");
+			else
+				fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"async(%d)\"}}",
+						tid, record->queue);
+		}
+
+		switch(record->kind)
+		{
+		case ACC_PROF_KERNEL:
+			fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"kernel\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+						"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"gangs\":\"%dx%dx%d\",\"vectors\":\"%dx%dx%d\"}}",
+					record->name, tid, record->start_us, record->end_us - record->start_us,
+					record->gangs[0], record->gangs[1], record->gangs[2],
+					record->vectors[0], record->vectors[1], record->vectors[2]);
+			break;
+		case ACC_PROF_H2D:
+		case ACC_PROF_D2H:
+			fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"transfer\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+						"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"bytes\":%lu,\"GB/s\":%.3f}}",
+					kind_names[record->kind], tid, record->start_us, record->end_us - record->start_us,
+					(unsigned long)record->bytes,
+					record->end_us > record->start_us ? record->bytes/((record->end_us - record->start_us)*1.0e3) : 0.0);
+			break;
+		default:
+			fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"memory\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%d,"
+						"\"ts\":%.3f,\"args\":{\"bytes\":%lu}}",
+					kind_names[record->kind], tid, record->start_us, (unsigned long)record->bytes);
+			break;
+		}
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	acc_host_free(seen);
+	fclose(fp);
+}
+
+void __accr_profile_finish(void)
+{
+	acc_prof_name_t *name, *next;
+	char filename[256];
+	char *env;
+	int i;
+
+	if(!__accr_profiling || profile_finished)
+		return;
+
+	pthread_mutex_lock(&profile_lock);
+	profile_finished = 1;
+	__accr_profiling = 0;
+
+	__accr_profile_resolve(num_records);
+
+	__accr_profile_summary(stderr);
+
+	env = getenv("ACC_PROFILE_FILE");
+	if(env != NULL && env[0] != '\0')
+		snprintf(filename, sizeof(filename), "%s", env);
+	else
+		snprintf(filename, sizeof(filename), "openacc_trace.%d.json", (int)getpid());
+	__accr_profile_trace(filename);
+	fprintf(stderr, "Trace written to %s\n", filename);
+
+	if(profile_on_device)
+	{
+		for(i = 0; i < num_free_events; i++)
+			CUDA_CHECK( cuEventDestroy(free_events[i]) );
+		CUDA_CHECK( cuEventDestroy(base_event) );
+	}
+	free(free_events);
+	free_events = NULL;
+	num_free_events = max_free_events = 0;
+
+	free(records);
+	records = NULL;
+	num_records = max_records = num_resolved = 0;
+
+	for(name = kernel_names; name != NULL; name = next)
+	{
+		next = name->next;
+		free(name->name);
+		acc_host_free(name);
+	}
+	kernel_names = NULL;
+	present_hits = present_misses = 0;
+
+	pthread_mutex_unlock(&profile_lock);
+}
@@ -0,0 +1,95 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+#ifndef __ACC_PROFILE_H__
+#define __ACC_PROFILE_H__
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <cuda.h>
+#include "acc_log.h"
+
+/*
+ * Runtime profiler, enabled by ACC_PROFILE=1. It records kernel launches,
+ * transfers, allocations and present table lookups, and at exit prints a
+ * summary to stderr and writes a Chrome trace (chrome://tracing, Perfetto)
+ * to ACC_PROFILE_FILE, openacc_trace.<pid>.json by default.
+ *
+ * Every hook is guarded by ACC_PROFILING(), so a disabled profiler costs
+ * one predictable branch.
+ */
+#define ACC_PROFILING() __builtin_expect(__accr_profiling, 0)
+
+/* records whose device events have not been read yet, see __accr_profile_resolve */
+#define ACC_PROF_MAX_PENDING 4096
+
+typedef enum
+{
+	ACC_PROF_KERNEL = 0,
+	ACC_PROF_H2D,
+	ACC_PROF_D2H,
+	ACC_PROF_ALLOC,
+	ACC_PROF_FREE,
+	ACC_PROF_NUM_KINDS
+} acc_prof_kind_t;
+
+/* the beginning of a profiled operation */
+typedef struct acc_prof_mark_s{
+	double host_start;
+	CUevent start;
+} acc_prof_mark_t;
+
+typedef struct acc_prof_record_s{
+	acc_prof_kind_t kind;
+	/* the kernel name, owned by the profiler */
+	const char *name;
+	/* the async queue, negative for synchronous operations */
+	int queue;
+	int gangs[3];
+	int vectors[3];
+	size_t bytes;
+
+	/* microseconds since the profiler started */
+	double start_us;
+	double end_us;
+
+	/* device events of operations on a GPU stream, NULL once they are read */
+	CUevent start;
+	CUevent end;
+} acc_prof_record_t;
+
+extern int __accr_profiling;
+
+extern void __accr_profile_init(void);
+
+/* print the summary and write the trace, later calls do nothing */
+extern void __accr_profile_finish(void);
+
+/*
+ * stream is the stream of the operation, on_device is 0 for operations
+ * which are timed on the host clock
+ */
+extern void __accr_profile_start(acc_prof_mark_t* mark, CUstream stream, int on_device);
+
+extern void __accr_profile_kernel(acc_prof_mark_t* mark,
+								  CUstream stream,
+								  int on_device,
+								  const char* szKernelName,
+								  int gangs[3],
+								  int vectors[3],
+								  int queue);
+
+extern void __accr_profile_transfer(acc_prof_mark_t* mark,
+									CUstream stream,
+									int on_device,
+									acc_prof_kind_t kind,
+									size_t bytes,
+									int queue);
+
+extern void __accr_profile_alloc(acc_prof_kind_t kind, size_t bytes);
+
+extern void __accr_profile_present(int hit);
+
+#endif
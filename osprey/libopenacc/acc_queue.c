@@ -0,0 +1,341 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+/**
+ * The async queues. Any non-negative async value gets a queue of its own,
+ * kept in a hash table which grows with the number of queues, and the
+ * stream of a queue is only created by the first operation put on it.
+ * A queue which has never been used has nothing pending, so waiting for
+ * or testing it does not touch the device.
+ *
+ * wait(a) async(b) is an event recorded on queue a which the stream of
+ * queue b waits for, so the host does not block.
+ */
+
+#include "acc_data.h"
+
+static acc_queue_table_t queue_table = {NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER};
+
+static acc_queue_t* __accr_find_queue(int id, int create);
+
+static void __accr_grow_queue_table(void);
+
+static acc_queue_t** __accr_snapshot_queues(int* count);
+
+static void __accr_fence_stream(acc_queue_fence_t* fence, CUstream stream);
+
+static void __accr_grow_queue_table(void)
+{
+	acc_queue_t **buckets, *queue, *next;
+	int num_buckets, i, b;
+
+	num_buckets = queue_table.num_buckets == 0 ? ACC_QUEUE_TABLE_SIZE : queue_table.num_buckets*2;
+	buckets = (acc_queue_t**)acc_host_alloc_zero(num_buckets*sizeof(acc_queue_t*));
+
+	for(i = 0; i < queue_table.num_buckets; i++)
+	{
+		for(queue = queue_table.buckets[i]; queue != NULL; queue = next)
+		{
+			next = queue->next;
+			b = queue->id & (num_buckets - 1);
+			queue->next = buckets[b];
+			buckets[b] = queue;
+		}
+	}
+
+	acc_host_free(queue_table.buckets);
+	queue_table.buckets = buckets;
+	queue_table.num_buckets = num_buckets;
+}
+
+/* the caller holds the table lock */
+static acc_queue_t* __accr_find_queue(int id, int create)
+{
+	acc_queue_t *queue;
+	int b;
+
+	if(queue_table.num_buckets > 0)
+	{
+		b = id & (queue_table.num_buckets - 1);
+		for(queue = queue_table.buckets[b]; queue != NULL; queue = queue->next)
+		{
+			if(queue->id == id)
+				return queue;
+		}
+	}
+
+	if(!create)
+		return NULL;
+
+	if(queue_table.num_queues >= queue_table.num_buckets*2)
+		__accr_grow_queue_table();
+
+	queue = (acc_queue_t*)acc_host_alloc(sizeof(acc_queue_t));
+	queue->id = id;
+	queue->event = NULL;
+	CUDA_CHECK( cuStreamCreate(&queue->stream, 0) );
+
+	b = id & (queue_table.num_buckets - 1);
+	queue->next = queue_table.buckets[b];
+	queue_table.buckets[b] = queue;
+	queue_table.num_queues++;
+
+	DEBUG(("Created the stream of async queue %d", id));
+	return queue;
+}
+
+/*
+ * a copy of the queue list, so that the host can block on the streams
+ * without holding the lock, queues are only freed at shutdown
+ */
+static acc_queue_t** __accr_snapshot_queues(int* count)
+{
+	acc_queue_t **queues, *queue;
+	int i, n;
+
+	pthread_mutex_lock(&queue_table.lock);
+	queues = NULL;
+	n = 0;
+	if(queue_table.num_queues > 0)
+	{
+		queues = (acc_queue_t**)acc_host_alloc(queue_table.num_queues*sizeof(acc_queue_t*));
+		for(i = 0; i < queue_table.num_buckets; i++)
+			for(queue = queue_table.buckets[i]; queue != NULL; queue = queue->next)
+				queues[n++] = queue;
+	}
+	pthread_mutex_unlock(&queue_table.lock);
+
+	*count = n;
+	return queues;
+}
+
+CUstream __accr_get_queue_stream(int async_expr)
+{
+	acc_queue_t *queue;
+
+	if(async_expr < 0)
+		ERROR(("Invalid async queue %d", async_expr));
+
+	pthread_mutex_lock(&queue_table.lock);
+	queue = __accr_find_queue(async_expr, 1);
+	pthread_mutex_unlock(&queue_table.lock);
+
+	return queue->stream;
+}
+
+void __accr_wait_queue(int async_expr)
+{
+	acc_queue_t *queue;
+
+	pthread_mutex_lock(&queue_table.lock);
+	queue = __accr_find_queue(async_expr, 0);
+	pthread_mutex_unlock(&queue_table.lock);
+
+	if(queue != NULL)
+	{
+		CUDA_CHECK( cuStreamSynchronize(queue->stream) );
+		DEBUG(("Waiting for async queue %d", async_expr));
+	}
+}
+
+void __accr_wait_all_queues(void)
+{
+	acc_queue_t **queues;
+	int i, n;
+
+	queues = __accr_snapshot_queues(&n);
+	for(i = 0; i < n; i++)
+		CUDA_CHECK( cuStreamSynchronize(queues[i]->stream) );
+	acc_host_free(queues);
+
+	DEBUG(("Waiting for all async queues"));
+}
+
+void __accr_wait_queue_async(int wait_expr, int async_expr)
+{
+	acc_queue_t *src, *dst;
+
+	if(wait_expr == async_expr)
+		return;
+
+	pthread_mutex_lock(&queue_table.lock);
+	src = __accr_find_queue(wait_expr, 0);
+	if(src == NULL)
+	{
+		/* nothing to wait for */
+		pthread_mutex_unlock(&queue_table.lock);
+		return;
+	}
+	dst = __accr_find_queue(async_expr, 1);
+	if(src->event == NULL)
+		CUDA_CHECK( cuEventCreate(&src->event, CU_EVENT_DISABLE_TIMING) );
+
+	CUDA_CHECK( cuEventRecord(src->event, src->stream) );
+	CUDA_CHECK( cuStreamWaitEvent(dst->stream, src->event, 0) );
+	pthread_mutex_unlock(&queue_table.lock);
+
+	DEBUG(("Async queue %d waits for async queue %d", async_expr, wait_expr));
+}
+
+void __accr_wait_all_queues_async(int async_expr)
+{
+	acc_queue_t **queues;
+	int i, n;
+
+	queues = __accr_snapshot_queues(&n);
+	for(i = 0; i < n; i++)
+		__accr_wait_queue_async(queues[i]->id, async_expr);
+	acc_host_free(queues);
+}
+
+int __accr_test_queue(int async_expr)
+{
+	acc_queue_t *queue;
+	CUresult ret;
+
+	pthread_mutex_lock(&queue_table.lock);
+	queue = __accr_find_queue(async_expr, 0);
+	pthread_mutex_unlock(&queue_table.lock);
+
+	if(queue == NULL)
+		return 1;
+
+	ret = cuStreamQuery(queue->stream);
+	if(ret == CUDA_ERROR_NOT_READY)
+		return 0;
+	CUDA_CHECK(ret);
+	return 1;
+}
+
+int __accr_test_all_queues(void)
+{
+	acc_queue_t **queues;
+	int i, n, done;
+	CUresult ret;
+
+	done = 1;
+	queues = __accr_snapshot_queues(&n);
+	for(i = 0; i < n && done; i++)
+	{
+		ret = cuStreamQuery(queues[i]->stream);
+		if(ret == CUDA_ERROR_NOT_READY)
+			done = 0;
+		else
+			CUDA_CHECK(ret);
+	}
+	acc_host_free(queues);
+
+	return done;
+}
+
+int __accr_get_num_queues(void)
+{
+	int n;
+
+	pthread_mutex_lock(&queue_table.lock);
+	n = queue_table.num_queues;
+	pthread_mutex_unlock(&queue_table.lock);
+
+	return n;
+}
+
+/* add an event on stream to the fence if the stream has work queued */
+static void __accr_fence_stream(acc_queue_fence_t* fence, CUstream stream)
+{
+	CUevent event;
+	CUresult ret;
+
+	ret = cuStreamQuery(stream);
+	if(ret != CUDA_ERROR_NOT_READY)
+	{
+		CUDA_CHECK(ret);
+		return;
+	}
+
+	CUDA_CHECK( cuEventCreate(&event, CU_EVENT_DISABLE_TIMING) );
+	CUDA_CHECK( cuEventRecord(event, stream) );
+	fence->events[fence->num_events++] = event;
+}
+
+acc_queue_fence_t* __accr_record_fence(void)
+{
+	acc_queue_t **queues;
+	acc_queue_fence_t *fence;
+	int i, n;
+
+	queues = __accr_snapshot_queues(&n);
+	fence = (acc_queue_fence_t*)acc_host_alloc(sizeof(acc_queue_fence_t) + n*sizeof(CUevent));
+	fence->num_events = 0;
+
+	__accr_fence_stream(fence, NULL);
+	for(i = 0; i < n; i++)
+		__accr_fence_stream(fence, queues[i]->stream);
+	acc_host_free(queues);
+
+	if(fence->num_events == 0)
+	{
+		acc_host_free(fence);
+		return NULL;
+	}
+	return fence;
+}
+
+int __accr_test_fence(acc_queue_fence_t* fence)
+{
+	CUresult ret;
+	int i;
+
+	for(i = 0; i < fence->num_events; i++)
+	{
+		ret = cuEventQuery(fence->events[i]);
+		if(ret == CUDA_ERROR_NOT_READY)
+			return 0;
+		CUDA_CHECK(ret);
+	}
+	return 1;
+}
+
+void __accr_wait_fence(acc_queue_fence_t* fence)
+{
+	int i;
+
+	for(i = 0; i < fence->num_events; i++)
+		CUDA_CHECK( cuEventSynchronize(fence->events[i]) );
+}
+
+void __accr_release_fence(acc_queue_fence_t* fence)
+{
+	int i;
+
+	for(i = 0; i < fence->num_events; i++)
+		CUDA_CHECK( cuEventDestroy(fence->events[i]) );
+	acc_host_free(fence);
+}
+
+void __accr_destroy_all_queues(void)
+{
+	acc_queue_t *queue, *next;
+	int i;
+
+	pthread_mutex_lock(&queue_table.lock);
+	for(i = 0; i < queue_table.num_buckets; i++)
+	{
+		for(queue = queue_table.buckets[i]; queue != NULL; queue = next)
+		{
+			next = queue->next;
+			CUDA_CHECK( cuStreamDestroy(queue->stream) );
+			if(queue->event != NULL)
+				CUDA_CHECK( cuEventDestroy(queue->event) );
+			acc_host_free(queue);
+		}
+	}
+	acc_host_free(queue_table.buckets);
+	queue_table.buckets = NULL;
+	queue_table.num_buckets = 0;
+	queue_table.num_queues = 0;
+	pthread_mutex_unlock(&queue_table.lock);
+
+	DEBUG(("Destroyed all async queues"));
+}
@@ -0,0 +1,81 @@
+/**
+ * Author: Rengan Xu
+ * University of Houston
+ */
+
+#ifndef __ACC_QUEUE_H__
+#define __ACC_QUEUE_H__
+
+#include <pthread.h>
+#include <cuda.h>
+#include "acc_log.h"
+
+/* the initial number of buckets of the queue table, a power of two */
+#define ACC_QUEUE_TABLE_SIZE 16
+
+/*
+ * One async queue, i.e. the value of an async clause. Every queue has its
+ * own stream, created when the first operation is put on the queue, so
+ * that unrelated queues never serialize on a shared stream.
+ */
+typedef struct acc_queue_s{
+	int id;
+	CUstream stream;
+	/* recorded on the stream when another queue waits for this one */
+	CUevent event;
+	struct acc_queue_s *next;
+} acc_queue_t;
+
+/*
+ * The work queued on the device at some point: an event on each stream,
+ * the default one included, which was not idle then.
+ */
+typedef struct acc_queue_fence_s{
+	int num_events;
+	CUevent events[1];
+} acc_queue_fence_t;
+
+typedef struct acc_queue_table_s{
+	/* hash table of the queues by id, it grows with the number of queues */
+	acc_queue_t **buckets;
+	int num_buckets;
+	int num_queues;
+	pthread_mutex_t lock;
+} acc_queue_table_t;
+
+/* the stream of queue async_expr (>= 0), created if it does not exist */
+extern CUstream __accr_get_queue_stream(int async_expr);
+
+/* block the host until queue async_expr is empty */
+extern void __accr_wait_queue(int async_expr);
+
+extern void __accr_wait_all_queues(void);
+
+/*
+ * make the later operations of queue async_expr wait for the current
+ * operations of queue wait_expr, without blocking the host
+ */
+extern void __accr_wait_queue_async(int wait_expr, int async_expr);
+
+extern void __accr_wait_all_queues_async(int async_expr);
+
+/* return 1 if queue async_expr is empty */
+extern int __accr_test_queue(int async_expr);
+
+extern int __accr_test_all_queues(void);
+
+extern int __accr_get_num_queues(void);
+
+/* a fence for the work queued so far, NULL if every stream is idle */
+extern acc_queue_fence_t* __accr_record_fence(void);
+
+/* return 1 if the work before the fence has finished */
+extern int __accr_test_fence(acc_queue_fence_t* fence);
+
+extern void __accr_wait_fence(acc_queue_fence_t* fence);
+
+extern void __accr_release_fence(acc_queue_fence_t* fence);
+
+extern void __accr_destroy_all_queues(void);
+
+#endif
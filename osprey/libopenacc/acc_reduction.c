@@ -340,3 +340,336 @@ void __accr_final_reduction_algorithm(void* device_result, void *d_idata, char*
     //__accr_memout_d2h(__device_result, result, type_size, 0, -2); 
     //__accr_free_on_device(__device_result);
 }
+
+static __thread acc_fused_reduction_t fused_reduction;
+
+/* combine x[0..n) pairwise, as a tree, the result ends up in x[0] */
+#define ACC_TREE_REDUCE(x, n, a, b, expr) \
+	for(s = 1; s < (n); s *= 2) \
+		for(i = 0; i + s < (n); i += 2*s) \
+		{ \
+			a = x[i]; \
+			b = x[i+s]; \
+			x[i] = (expr); \
+		}
+
+#define ACC_DEFINE_INT_REDUCTION(name, T) \
+static void name(void* data, int n, ACC_REDUCTION_OPR opr) \
+{ \
+	T *x = (T*)data; \
+	T a, b; \
+	int s, i; \
+	switch(opr) \
+	{ \
+	case ACC_REDUCTION_ADD:  ACC_TREE_REDUCE(x, n, a, b, a + b); break; \
+	case ACC_REDUCTION_MPY:  ACC_TREE_REDUCE(x, n, a, b, a * b); break; \
+	case ACC_REDUCTION_MAX:  ACC_TREE_REDUCE(x, n, a, b, max(a, b)); break; \
+	case ACC_REDUCTION_MIN:  ACC_TREE_REDUCE(x, n, a, b, min(a, b)); break; \
+	case ACC_REDUCTION_BAND: ACC_TREE_REDUCE(x, n, a, b, a & b); break; \
+	case ACC_REDUCTION_BIOR: ACC_TREE_REDUCE(x, n, a, b, a | b); break; \
+	case ACC_REDUCTION_BXOR: ACC_TREE_REDUCE(x, n, a, b, a ^ b); break; \
+	case ACC_REDUCTION_CAND: ACC_TREE_REDUCE(x, n, a, b, a && b); break; \
+	case ACC_REDUCTION_CIOR: ACC_TREE_REDUCE(x, n, a, b, a || b); break; \
+	default: ERROR(("Invalid reduction operator %d", opr)); \
+	} \
+}
+
+#define ACC_DEFINE_FLOAT_REDUCTION(name, T) \
+static void name(void* data, int n, ACC_REDUCTION_OPR opr) \
+{ \
+	T *x = (T*)data; \
+	T a, b; \
+	int s, i; \
+	switch(opr) \
+	{ \
+	case ACC_REDUCTION_ADD:  ACC_TREE_REDUCE(x, n, a, b, a + b); break; \
+	case ACC_REDUCTION_MPY:  ACC_TREE_REDUCE(x, n, a, b, a * b); break; \
+	case ACC_REDUCTION_MAX:  ACC_TREE_REDUCE(x, n, a, b, max(a, b)); break; \
+	case ACC_REDUCTION_MIN:  ACC_TREE_REDUCE(x, n, a, b, min(a, b)); break; \
+	case ACC_REDUCTION_CAND: ACC_TREE_REDUCE(x, n, a, b, a && b); break; \
+	case ACC_REDUCTION_CIOR: ACC_TREE_REDUCE(x, n, a, b, a || b); break; \
+	default: ERROR(("Invalid reduction operator %d for a floating point type", opr)); \
+	} \
+}
+
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_i8, signed char)
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_i16, short)
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_i32, int)
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_i64, long long)
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_u8, unsigned char)
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_u16, unsigned short)
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_u32, unsigned int)
+ACC_DEFINE_INT_REDUCTION(__accr_tree_reduce_u64, unsigned long long)
+ACC_DEFINE_FLOAT_REDUCTION(__accr_tree_reduce_float, float)
+ACC_DEFINE_FLOAT_REDUCTION(__accr_tree_reduce_double, double)
+
+/*
+ * reduce the partial results in data, in place, and copy the result to
+ * host_result. The compiler passes the signed MTYPE_I* types as
+ * ACC_KDATA_UINT* and the unsigned ones as ACC_KDATA_INT*.
+ */
+static void __accr_host_tree_reduce(acc_fused_reduction_item_t* item, void* data)
+{
+	if(item->num_elements <= 0)
+		return;
+
+	switch(item->type)
+	{
+	case ACC_KDATA_UINT8:
+		__accr_tree_reduce_i8(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_UINT16:
+		__accr_tree_reduce_i16(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_UINT32:
+		__accr_tree_reduce_i32(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_UINT64:
+		__accr_tree_reduce_i64(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_INT8:
+		__accr_tree_reduce_u8(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_INT16:
+		__accr_tree_reduce_u16(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_INT32:
+		__accr_tree_reduce_u32(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_INT64:
+		__accr_tree_reduce_u64(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_FLOAT:
+		__accr_tree_reduce_float(data, item->num_elements, item->opr);
+		break;
+	case ACC_KDATA_DOUBLE:
+		__accr_tree_reduce_double(data, item->num_elements, item->opr);
+		break;
+	default:
+		ERROR(("Invalid reduction type %d", item->type));
+	}
+	memcpy(item->host_result, data, item->type_size);
+}
+
+static void* __accr_fused_host_buffer(size_t size)
+{
+	acc_fused_reduction_t *r = &fused_reduction;
+
+	if(r->host_size < size)
+	{
+		acc_host_free(r->host_buffer);
+		r->host_buffer = acc_host_alloc(size);
+		r->host_size = size;
+	}
+	return r->host_buffer;
+}
+
+/* one synchronous copy from the device, seen by the profiler like any other */
+static void __accr_fused_copy_d2h(void* pHost, void* pDevice, size_t size)
+{
+	acc_prof_mark_t mark;
+
+	if(ACC_PROFILING())
+		__accr_profile_start(&mark, NULL, 1);
+
+	CUDART_CHECK( cudaMemcpy(pHost, pDevice, size, cudaMemcpyDeviceToHost) );
+
+	if(ACC_PROFILING())
+		__accr_profile_transfer(&mark, NULL, 1, ACC_PROF_D2H, size, -1);
+}
+
+void __accr_fused_reduction_buff_malloc(void** pDevice, int size)
+{
+	acc_fused_reduction_t *r = &fused_reduction;
+	size_t bytes;
+
+	bytes = ((size_t)size + ACC_FUSED_REDUCTION_ALIGN - 1) & ~((size_t)ACC_FUSED_REDUCTION_ALIGN - 1);
+	r->requested += bytes;
+
+	if(r->arena_used + bytes <= r->arena_size)
+	{
+		*pDevice = (char*)r->arena + r->arena_used;
+		r->arena_used += bytes;
+		return;
+	}
+
+	/* the arena is grown to the size of this region by the final reduction */
+	__accr_malloc_on_device(NULL, pDevice, size, 0);
+	if(r->num_overflow == r->max_overflow)
+	{
+		void **overflow;
+
+		r->max_overflow = r->max_overflow == 0 ? 8 : r->max_overflow*2;
+		overflow = (void**)acc_host_alloc(r->max_overflow*sizeof(void*));
+		if(r->num_overflow > 0)
+			memcpy(overflow, r->overflow, r->num_overflow*sizeof(void*));
+		acc_host_free(r->overflow);
+		r->overflow = overflow;
+	}
+	r->overflow[r->num_overflow++] = *pDevice;
+}
+
+void __accr_fused_reduction_add(void* d_partial, 
+								void* host_result, 
+								char* kernel_name, 
+								int num_elements, 
+								unsigned int type_size, 
+								int opr, 
+								int type)
+{
+	acc_fused_reduction_t *r = &fused_reduction;
+	acc_fused_reduction_item_t *item;
+
+	if(type_size > ACC_FUSED_REDUCTION_SLOT)
+		ERROR(("Reduction type of %u bytes is not supported", type_size));
+
+	if(r->num_items == r->max_items)
+	{
+		acc_fused_reduction_item_t *items;
+
+		r->max_items = r->max_items == 0 ? 8 : r->max_items*2;
+		items = (acc_fused_reduction_item_t*)acc_host_alloc(r->max_items*sizeof(acc_fused_reduction_item_t));
+		if(r->num_items > 0)
+			memcpy(items, r->items, r->num_items*sizeof(acc_fused_reduction_item_t));
+		acc_host_free(r->items);
+		r->items = items;
+	}
+
+	item = &r->items[r->num_items++];
+	item->d_partial = d_partial;
+	item->host_result = host_result;
+	item->kernel_name = kernel_name;
+	item->num_elements = num_elements;
+	item->type_size = type_size;
+	item->opr = (ACC_REDUCTION_OPR)opr;
+	item->type = (ACC_KERNEL_DATA_TYPE)type;
+}
+
+/* all partial results are combined on the host, after one transfer of the arena */
+static void __accr_final_fused_reduction_on_host(void)
+{
+	acc_fused_reduction_t *r = &fused_reduction;
+	acc_fused_reduction_item_t *item;
+	char *host;
+	size_t offset, bytes;
+	int i;
+
+	host = NULL;
+	if(r->arena_used > 0)
+	{
+		host = (char*)__accr_fused_host_buffer(r->arena_used);
+		__accr_fused_copy_d2h(host, r->arena, r->arena_used);
+	}
+
+	for(i = 0; i < r->num_items; i++)
+	{
+		item = &r->items[i];
+		bytes = (size_t)item->num_elements*item->type_size;
+		offset = (char*)item->d_partial - (char*)r->arena;
+
+		if(item->d_partial >= r->arena && offset + bytes <= r->arena_used)
+			__accr_host_tree_reduce(item, host + offset);
+		else
+		{
+			/* a partial buffer outside of the arena */
+			void *data = acc_host_alloc(bytes);
+			__accr_fused_copy_d2h(data, item->d_partial, bytes);
+			__accr_host_tree_reduce(item, data);
+			acc_host_free(data);
+		}
+	}
+}
+
+/* the reduction kernels write into result slots, which come back in one transfer */
+static void __accr_final_fused_reduction_on_device(void)
+{
+	acc_fused_reduction_t *r = &fused_reduction;
+	acc_fused_reduction_item_t *item;
+	char *host;
+	int i;
+
+	if(r->num_slots < r->num_items)
+	{
+		if(r->slots != NULL)
+			__accr_free_on_device(r->slots);
+		r->num_slots = max(r->num_items, 8);
+		__accr_malloc_on_device(NULL, &r->slots, r->num_slots*ACC_FUSED_REDUCTION_SLOT, 0);
+	}
+
+	for(i = 0; i < r->num_items; i++)
+	{
+		item = &r->items[i];
+		__accr_final_reduction_algorithm((char*)r->slots + i*ACC_FUSED_REDUCTION_SLOT, 
+										 item->d_partial, 
+										 item->kernel_name, 
+										 item->num_elements, 
+										 item->type_size);
+	}
+
+	host = (char*)__accr_fused_host_buffer(r->num_items*ACC_FUSED_REDUCTION_SLOT);
+	__accr_fused_copy_d2h(host, r->slots, r->num_items*ACC_FUSED_REDUCTION_SLOT);
+	for(i = 0; i < r->num_items; i++)
+	{
+		item = &r->items[i];
+		memcpy(item->host_result, host + i*ACC_FUSED_REDUCTION_SLOT, item->type_size);
+	}
+}
+
+void __accr_final_fused_reduction(void)
+{
+	acc_fused_reduction_t *r = &fused_reduction;
+	size_t partial_bytes;
+	int i;
+
+	partial_bytes = 0;
+	for(i = 0; i < r->num_items; i++)
+		partial_bytes += (size_t)r->items[i].num_elements*r->items[i].type_size;
+
+	if(ACC_ON_HOST())
+	{
+		/* the partial results are in host memory already */
+		for(i = 0; i < r->num_items; i++)
+			__accr_host_tree_reduce(&r->items[i], r->items[i].d_partial);
+	}
+	else if(partial_bytes <= ACC_FUSED_REDUCTION_HOST_LIMIT)
+		__accr_final_fused_reduction_on_host();
+	else
+		__accr_final_fused_reduction_on_device();
+
+	DEBUG(("Fused final reduction of %d variables, %lu bytes of partial results", 
+				r->num_items, partial_bytes));
+
+	/* the copies above are synchronous, nothing uses the partial buffers any more */
+	for(i = 0; i < r->num_overflow; i++)
+		__accr_free_on_device(r->overflow[i]);
+	r->num_overflow = 0;
+
+	if(r->requested > r->arena_size)
+	{
+		if(r->arena != NULL)
+			__accr_free_on_device(r->arena);
+		__accr_malloc_on_device(NULL, &r->arena, r->requested, 0);
+		r->arena_size = r->requested;
+	}
+	r->arena_used = 0;
+	r->requested = 0;
+	r->num_items = 0;
+}
+
+void __accr_destroy_fused_reduction(void)
+{
+	acc_fused_reduction_t *r = &fused_reduction;
+	int i;
+
+	for(i = 0; i < r->num_overflow; i++)
+		__accr_free_on_device(r->overflow[i]);
+	if(r->arena != NULL)
+		__accr_free_on_device(r->arena);
+	if(r->slots != NULL)
+		__accr_free_on_device(r->slots);
+
+	acc_host_free(r->overflow);
+	acc_host_free(r->items);
+	acc_host_free(r->host_buffer);
+	memset(r, 0, sizeof(acc_fused_reduction_t));
+}
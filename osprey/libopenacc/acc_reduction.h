@@ -25,4 +25,67 @@ extern double benchmarkReduce(int n, int numThreads, int numBlcoks,
 //extern void __accr_final_reduction_algorithm(double* result, double *d_idata, int type);
 extern void __accr_final_reduction_algorithm(void* result, void *d_idata, char* kernel_name, unsigned int size, unsigned int type_size);
 
+/*
+ * The fused final reduction of a region. The partial results of all its
+ * top level reductions are packed in one device buffer, which comes back
+ * to the host in one transfer, and every variable is combined there in a
+ * single tree reduction pass. When there are more than
+ * ACC_FUSED_REDUCTION_HOST_LIMIT bytes of partial results, the reduction
+ * kernels run on the device instead, and only their results come back,
+ * again in one transfer.
+ */
+#define ACC_FUSED_REDUCTION_HOST_LIMIT (1 << 20)
+/* the alignment of a partial result buffer in the packed buffer */
+#define ACC_FUSED_REDUCTION_ALIGN 16
+/* the largest reduction type, the size of a result slot on the device */
+#define ACC_FUSED_REDUCTION_SLOT 8
+
+typedef struct acc_fused_reduction_item_s{
+	void *d_partial;
+	void *host_result;
+	char *kernel_name;
+	int num_elements;
+	int type_size;
+	ACC_REDUCTION_OPR opr;
+	ACC_KERNEL_DATA_TYPE type;
+} acc_fused_reduction_item_t;
+
+typedef struct acc_fused_reduction_s{
+	/* the packed partial results on the device */
+	void *arena;
+	size_t arena_size;
+	size_t arena_used;
+	/* the bytes asked for since the last final reduction, the arena grows to it */
+	size_t requested;
+	/* the partial buffers which did not fit in the arena */
+	void **overflow;
+	int num_overflow;
+	int max_overflow;
+
+	acc_fused_reduction_item_t *items;
+	int num_items;
+	int max_items;
+
+	/* the host copy of the arena, or of the result slots */
+	void *host_buffer;
+	size_t host_size;
+	/* the result slots of the reduction kernels on the device */
+	void *slots;
+	int num_slots;
+} acc_fused_reduction_t;
+
+extern void __accr_fused_reduction_buff_malloc(void** pDevice, int size);
+
+extern void __accr_fused_reduction_add(void* d_partial, 
+									   void* host_result, 
+									   char* kernel_name, 
+									   int num_elements, 
+									   unsigned int type_size, 
+									   int opr, 
+									   int type);
+
+extern void __accr_final_fused_reduction(void);
+
+extern void __accr_destroy_fused_reduction(void);
+
 #endif
@@ -0,0 +1,128 @@
+/*
+ * Tests of the async queues on a stubbed CUDA layer
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "acc_data.h"
+
+extern int stub_streams_created;
+extern int stub_stream_syncs;
+extern int stub_stream_waits;
+extern void stub_set_stream_busy(CUstream hStream, int busy);
+
+static int num_queues = 1000;
+
+#define CHECK(cond)                                             \
+	do {                                                        \
+		if(!(cond))                                             \
+		{                                                       \
+			printf("FAILED: %s (line %d)\n", #cond, __LINE__);  \
+			exit(1);                                            \
+		}                                                       \
+	}while(0)
+
+/* every thread asks for the streams of the same queues, in its own order */
+static void* get_streams(void* arg)
+{
+	long tid = (long)arg;
+	CUstream *streams;
+	int i, q;
+
+	streams = (CUstream*)malloc(num_queues*sizeof(CUstream));
+	for(i = 0; i < num_queues; i++)
+	{
+		q = (int)((i*7 + tid*13) % num_queues) + 1000;
+		streams[q - 1000] = __accr_get_queue_stream(q);
+	}
+	return streams;
+}
+
+int main(int argc, char** argv)
+{
+	int nthreads = 8;
+	pthread_t *threads;
+	CUstream **streams;
+	CUstream s1, s12;
+	int i, t, syncs, waits;
+
+	if(argc > 1)
+		nthreads = atoi(argv[1]);
+	if(argc > 2)
+		num_queues = atoi(argv[2]);
+
+	acc_init(acc_device_default);
+
+	/* unused queues have nothing pending */
+	CHECK(acc_async_test(5) == 1);
+	CHECK(acc_async_test_all() == 1);
+	CHECK(__accr_get_num_queues() == 0);
+
+	/* queues which used to share a stream slot get streams of their own */
+	s1 = __accr_get_queue_stream(1);
+	s12 = __accr_get_queue_stream(12);
+	CHECK(s1 != s12);
+	CHECK(__accr_get_queue_stream(1) == s1);
+	CHECK(__accr_get_num_queues() == 2);
+
+	/* per-queue completion */
+	stub_set_stream_busy(s12, 1);
+	CHECK(acc_async_test(1) == 1);
+	CHECK(acc_async_test(12) == 0);
+	CHECK(acc_async_test_all() == 0);
+
+	/* wait(12) async(1) is an event on the device, the host does not block */
+	syncs = stub_stream_syncs;
+	waits = stub_stream_waits;
+	acc_wait_async(12, 1);
+	CHECK(stub_stream_waits == waits + 1);
+	CHECK(stub_stream_syncs == syncs);
+	CHECK(acc_async_test(12) == 0);
+
+	/* waiting for a queue which was never used does nothing */
+	acc_wait_async(99, 1);
+	CHECK(stub_stream_waits == waits + 1);
+	CHECK(__accr_get_num_queues() == 2);
+
+	/* wait(1) only blocks on queue 1 */
+	acc_async_wait(1);
+	CHECK(acc_async_test(12) == 0);
+	acc_async_wait(12);
+	CHECK(acc_async_test(12) == 1);
+	CHECK(acc_async_test_all() == 1);
+
+	/* many queues created by several threads at once */
+	threads = (pthread_t*)malloc(nthreads*sizeof(pthread_t));
+	streams = (CUstream**)malloc(nthreads*sizeof(CUstream*));
+	for(t = 0; t < nthreads; t++)
+		pthread_create(&threads[t], NULL, get_streams, (void*)(long)t);
+	for(t = 0; t < nthreads; t++)
+		pthread_join(threads[t], (void**)&streams[t]);
+
+	CHECK(__accr_get_num_queues() == num_queues + 2);
+	CHECK(stub_streams_created == num_queues + 2);
+	for(i = 0; i < num_queues; i++)
+	{
+		for(t = 1; t < nthreads; t++)
+			CHECK(streams[t][i] == streams[0][i]);
+		if(i > 0)
+			CHECK(streams[0][i] != streams[0][i-1]);
+	}
+
+	/* wait async(1) for every queue */
+	waits = stub_stream_waits;
+	acc_wait_all_async(1);
+	CHECK(stub_stream_waits == waits + num_queues + 1);
+
+	for(t = 0; t < nthreads; t++)
+		free(streams[t]);
+	free(streams);
+	free(threads);
+
+	acc_shutdown(acc_device_default);
+	CHECK(__accr_get_num_queues() == 0);
+
+	printf("PASSED: %d queues from %d threads\n", num_queues + 2, nthreads);
+	return 0;
+}
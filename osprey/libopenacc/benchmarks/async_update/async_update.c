@@ -0,0 +1,77 @@
+/*
+ * Repeated asynchronous updates of the same host arrays
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "acc_data.h"
+
+extern int stub_host_registers;
+extern int stub_host_unregisters;
+
+static double get_time()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec*1.0e-6;
+}
+
+int main(int argc, char** argv)
+{
+	int steps = 1000;
+	unsigned int large = 64u << 20;
+	unsigned int small = 4096;
+	char *a, *b;
+	void *d_a, *d_b;
+	double start, elapsed;
+	unsigned int i;
+	int step;
+
+	if(argc > 1)
+		steps = atoi(argv[1]);
+	if(argc > 2)
+		large = (unsigned int)strtoul(argv[2], NULL, 10);
+	if(argc > 3)
+		small = (unsigned int)strtoul(argv[3], NULL, 10);
+
+	acc_init(acc_device_default);
+
+	a = (char*)malloc(large);
+	b = (char*)malloc(small);
+	__accr_malloc_on_device(a, &d_a, large, 0);
+	__accr_malloc_on_device(b, &d_b, small, 0);
+
+	start = get_time();
+	for(step = 0; step < steps; step++)
+	{
+		a[0] = b[0] = (char)step;
+
+		/* the whole arrays, then the upper half of the large one */
+		__accr_update_device_variable_async(a, 0, large, 1);
+		__accr_update_device_variable_async(b, 0, small, 1);
+		__accr_update_device_variable_async(a, large/2, large/2, 2);
+		__accr_update_host_variable_async(b, 0, small, 2);
+		acc_async_wait_all();
+	}
+	elapsed = get_time() - start;
+
+	for(i = 0; i < small; i++)
+	{
+		if(((char*)d_b)[i] != b[i])
+		{
+			printf("FAILED at %u\n", i);
+			return 1;
+		}
+	}
+
+	printf("%d steps: %.3f ms/step, %d host registrations, %d unregistrations\n",
+			steps, elapsed*1.0e3/steps, stub_host_registers, stub_host_unregisters);
+
+	__accr_free_on_device(d_a);
+	__accr_free_on_device(d_b);
+	acc_shutdown(acc_device_default);
+	printf("after shutdown: %d host registrations, %d unregistrations\n",
+			stub_host_registers, stub_host_unregisters);
+	return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * several reduction variables of one parallel region, combined by one
+ * fused final reduction, on the host backend
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <openacc_rtl.h>
+
+static int failures = 0;
+
+static void check(int cond, const char* what)
+{
+	printf("%-60s %s\n", what, cond ? "ok" : "FAILED");
+	if(!cond)
+		failures++;
+}
+
+/* one parallel region with a sum, a max, a min and a product */
+static void region(int n)
+{
+	int *isum;
+	double *dmax;
+	float *fmin;
+	long long *lprod;
+	unsigned int *ubxor;
+	int sum = 0, i;
+	double maxv = 0.0;
+	float minv = 0.0f;
+	long long prod = 0;
+	unsigned int bx = 0;
+	int expected_sum = 0;
+	unsigned int expected_bx = 0;
+
+	__accr_fused_reduction_buff_malloc((void**)&isum, n*sizeof(int));
+	__accr_fused_reduction_buff_malloc((void**)&dmax, n*sizeof(double));
+	__accr_fused_reduction_buff_malloc((void**)&fmin, n*sizeof(float));
+	__accr_fused_reduction_buff_malloc((void**)&lprod, n*sizeof(long long));
+	__accr_fused_reduction_buff_malloc((void**)&ubxor, n*sizeof(unsigned int));
+
+	/* what the kernel leaves in the partial buffers */
+	for(i = 0; i < n; i++)
+	{
+		isum[i] = i - n/2;
+		dmax[i] = (double)((i*7919) % n);
+		fmin[i] = (float)(n - i) + 0.5f;
+		lprod[i] = (i < 40) ? 2 : 1;
+		ubxor[i] = (unsigned int)i*2654435761u;
+		expected_sum += isum[i];
+		expected_bx ^= ubxor[i];
+	}
+
+	/* the compiler names the signed types ACC_KDATA_UINT* */
+	__accr_fused_reduction_add(isum, &sum, NULL, n, sizeof(int), ACC_REDUCTION_ADD, ACC_KDATA_UINT32);
+	__accr_fused_reduction_add(dmax, &maxv, NULL, n, sizeof(double), ACC_REDUCTION_MAX, ACC_KDATA_DOUBLE);
+	__accr_fused_reduction_add(fmin, &minv, NULL, n, sizeof(float), ACC_REDUCTION_MIN, ACC_KDATA_FLOAT);
+	__accr_fused_reduction_add(lprod, &prod, NULL, n, sizeof(long long), ACC_REDUCTION_MPY, ACC_KDATA_UINT64);
+	__accr_fused_reduction_add(ubxor, &bx, NULL, n, sizeof(unsigned int), ACC_REDUCTION_BXOR, ACC_KDATA_INT32);
+	__accr_final_fused_reduction();
+
+	check(sum == expected_sum, "integer sum");
+	check(maxv == (double)(n - 1), "double max");
+	check(minv == 1.5f, "float min");
+	check(prod == 1LL << (n < 40 ? n : 40), "long long product");
+	check(bx == expected_bx, "unsigned xor");
+}
+
+int main(int argc, char** argv)
+{
+	int n = 1000;
+
+	if(argc > 1)
+		n = atoi(argv[1]);
+
+	acc_init(acc_device_host);
+
+	region(n);
+	/* the second time, all buffers come from the arena */
+	region(n);
+
+	acc_shutdown(acc_device_host);
+
+	if(failures)
+	{
+		printf("FAILED: %d checks\n", failures);
+		return 1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * saxpy and sum on the libopenacc host backend
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include <openacc_rtl.h>
+
+static double get_time()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec*1.0e-6;
+}
+
+/* one gang: the gang strides over the array, the vector lanes are the inner loop */
+void saxpy_host(void** args, acc_host_kernel_ctx_t* ctx)
+{
+	float *x = *(float**)args[0];
+	float *y = *(float**)args[1];
+	int n = *(int*)args[2];
+	float a = *(float*)args[3];
+	int vlen = ctx->vectors[0];
+	int stride = ctx->gangs[0]*vlen;
+	int i, v;
+
+	for(i = ctx->gang_id[0]*vlen; i < n; i += stride)
+	{
+		int len = (n - i < vlen) ? n - i : vlen;
+		for(v = 0; v < len; v++)
+			y[i+v] = a*x[i+v] + y[i+v];
+	}
+}
+
+/* one partial sum per gang */
+void sum_host(void** args, acc_host_kernel_ctx_t* ctx)
+{
+	float *x = *(float**)args[0];
+	double *partial = *(double**)args[1];
+	int n = *(int*)args[2];
+	int chunk = (n + ctx->gangs[0] - 1)/ctx->gangs[0];
+	int start = ctx->gang_id[0]*chunk;
+	int end = (start + chunk < n) ? start + chunk : n;
+	double s = 0.0;
+	int i;
+
+	for(i = start; i < end; i++)
+		s += x[i];
+	partial[ctx->gang_id[0]] = s;
+}
+
+int main(int argc, char** argv)
+{
+	int n = 1<<24;
+	int iters = 100;
+	int gangs = 256;
+	int i, it;
+	float a = 2.0f;
+	float *x, *y;
+	double *partial;
+	void *d_x, *d_y, *d_partial;
+	double start, elapsed, sum;
+
+	if(argc > 1)
+		n = atoi(argv[1]);
+	if(argc > 2)
+		iters = atoi(argv[2]);
+
+	acc_init(acc_device_host);
+	__accr_register_host_kernel("saxpy_host", saxpy_host);
+	__accr_register_host_kernel("sum_host", sum_host);
+
+	x = (float*)malloc(n*sizeof(float));
+	y = (float*)malloc(n*sizeof(float));
+	partial = (double*)malloc(gangs*sizeof(double));
+	for(i = 0; i < n; i++)
+	{
+		x[i] = 1.0f;
+		y[i] = 0.0f;
+	}
+
+	__accr_malloc_on_device(x, &d_x, n*sizeof(float), 0);
+	__accr_malloc_on_device(y, &d_y, n*sizeof(float), 0);
+	__accr_malloc_on_device(partial, &d_partial, gangs*sizeof(double), 0);
+	__accr_memin_h2d(x, d_x, n*sizeof(float), 0, -2);
+	__accr_memin_h2d(y, d_y, n*sizeof(float), 0, -2);
+
+	start = get_time();
+	for(it = 0; it < iters; it++)
+	{
+		__accr_set_gangs(gangs, 1, 1);
+		__accr_set_vectors(128, 1, 1);
+		__accr_push_kernel_param_pointer(&d_x);
+		__accr_push_kernel_param_pointer(&d_y);
+		__accr_push_kernel_param_scalar(&n);
+		__accr_push_kernel_param_scalar(&a);
+		__accr_launchkernel("saxpy_host", NULL, -2);
+	}
+	elapsed = get_time() - start;
+	printf("saxpy: %d iterations, %.3f ms/iteration, %.2f GB/s\n", iters, 
+			elapsed*1.0e3/iters, 3.0*n*sizeof(float)*iters/elapsed/1.0e9);
+
+	__accr_set_gangs(gangs, 1, 1);
+	__accr_set_vectors(1, 1, 1);
+	__accr_push_kernel_param_pointer(&d_y);
+	__accr_push_kernel_param_pointer(&d_partial);
+	__accr_push_kernel_param_scalar(&n);
+	__accr_launchkernel("sum_host", NULL, -2);
+
+	__accr_memout_d2h(d_y, y, n*sizeof(float), 0, -2);
+	__accr_memout_d2h(d_partial, partial, gangs*sizeof(double), 0, -2);
+	sum = 0.0;
+	for(i = 0; i < gangs; i++)
+		sum += partial[i];
+
+	__accr_free_on_device(d_x);
+	__accr_free_on_device(d_y);
+	__accr_free_on_device(d_partial);
+	acc_shutdown(acc_device_host);
+
+	if(fabs(sum - (double)n*a*iters) > 1.0e-6*sum)
+	{
+		printf("FAILED: sum %f, expected %f\n", sum, (double)n*a*iters);
+		return 1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * sizes and offsets above 2^32 in the data API, on the host backend
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <openacc_rtl.h>
+
+#define GB (1UL << 30)
+#define MB (1UL << 20)
+#define PAGE 4096UL
+
+static int failures = 0;
+
+static void check(int cond, const char* what)
+{
+	printf("%-60s %s\n", what, cond ? "ok" : "FAILED");
+	if(!cond)
+		failures++;
+}
+
+/* a sparse host array of size bytes, present on the device */
+static void test_present(size_t size)
+{
+	char *host;
+	void *dev, *addr;
+	size_t offset;
+
+	host = (char*)mmap(NULL, size, PROT_READ|PROT_WRITE,
+					   MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+	if(host == MAP_FAILED)
+	{
+		perror("mmap");
+		exit(1);
+	}
+
+	__accr_malloc_on_device(host, &dev, size, 0);
+
+	/* the last page, which lies above 4GB */
+	offset = size - PAGE;
+	check(__accr_present_create(host, offset, PAGE, PAGE),
+		  "sub-array above 4GB is present");
+
+	/*
+	 * a range past the end: truncated to 32 bits, its offset would
+	 * fall inside the array and be found
+	 */
+	check(!__accr_present_create(host + PAGE, size, PAGE, PAGE),
+		  "range past the end of the array is not present");
+
+	addr = NULL;
+	__accr_get_device_addr(host + offset, &addr, 0, PAGE);
+	check(addr == (char*)dev + offset, "device address above 4GB");
+
+	/* the whole array in one update */
+	host[offset] = 42;
+	__accr_update_device_variable(host, 0, size, -1);
+	__accr_update_host_variable(host, offset, PAGE, -1);
+	check(((char*)dev)[offset] == 42, "update of the whole array");
+
+	__accr_free_on_device(dev);
+	munmap(host, size);
+}
+
+/* a device buffer of more than 4GB, touched at its end */
+static void test_malloc(size_t size)
+{
+	char *dev;
+
+	dev = (char*)acc_malloc(size);
+	check(dev != NULL, "acc_malloc of more than 4GB");
+
+	dev[size - 1] = 1;
+	check(__accr_device_addr_present(dev + size - 1),
+		  "last byte of the acc_malloc buffer is present");
+
+	acc_free(dev);
+}
+
+int main(int argc, char** argv)
+{
+	size_t present_size = 6*GB;
+	size_t malloc_size = 4*GB + MB;
+
+	if(argc > 1)
+		present_size = strtoul(argv[1], NULL, 10)*GB;
+	if(argc > 2)
+		malloc_size = strtoul(argv[2], NULL, 10)*MB;
+
+	acc_init(acc_device_host);
+
+	test_present(present_size);
+	if(malloc_size > 0)
+		test_malloc(malloc_size);
+
+	acc_shutdown(acc_device_host);
+
+	if(failures)
+	{
+		printf("FAILED: %d checks\n", failures);
+		return 1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
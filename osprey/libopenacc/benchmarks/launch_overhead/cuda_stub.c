@@ -0,0 +1,224 @@
+/*
+ * A stubbed CUDA driver/runtime layer with the entry points used by
+ * libopenacc. Device memory is host memory, launches do nothing, module
+ * loads sleep for STUB_JIT_US microseconds and host memory registrations
+ * for STUB_REGISTER_US microseconds. Streams never have pending work
+ * unless a test marks them busy with stub_set_stream_busy.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+int stub_module_loads = 0;
+int stub_function_lookups = 0;
+int stub_launches = 0;
+int stub_host_registers = 0;
+int stub_host_unregisters = 0;
+int stub_streams_created = 0;
+int stub_stream_syncs = 0;
+int stub_stream_waits = 0;
+
+typedef struct stub_stream_s{
+	int id;
+	volatile int busy;
+} stub_stream_t;
+
+void stub_set_stream_busy(CUstream hStream, int busy)
+{
+	((stub_stream_t*)hStream)->busy = busy;
+}
+
+CUresult cuInit(unsigned int flags) { return CUDA_SUCCESS; }
+
+CUresult cuDeviceGetCount(int* count) { *count = 1; return CUDA_SUCCESS; }
+
+CUresult cuDeviceGet(CUdevice* device, int ordinal) { *device = 0; return CUDA_SUCCESS; }
+
+CUresult cuDeviceComputeCapability(int* major, int* minor, CUdevice dev)
+{
+	*major = 3;
+	*minor = 5;
+	return CUDA_SUCCESS;
+}
+
+/* the runtime passes a 32-bit field here, leave it untouched */
+CUresult cuDeviceTotalMem(size_t* bytes, CUdevice dev) { return CUDA_SUCCESS; }
+
+CUresult cuDeviceGetAttribute(int* pi, CUdevice_attribute attrib, CUdevice dev)
+{
+	*pi = 65535;
+	if(attrib == CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_BLOCK)
+		*pi = 1024;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuCtxCreate(CUcontext* pctx, unsigned int flags, CUdevice dev)
+{
+	*pctx = (CUcontext)1;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuCtxDestroy(CUcontext ctx) { return CUDA_SUCCESS; }
+
+CUresult cuCtxSynchronize(void) { return CUDA_SUCCESS; }
+
+CUresult cuModuleLoad(CUmodule* module, const char* fname) { return cuModuleLoadData(module, fname); }
+
+CUresult cuModuleLoadData(CUmodule* module, const void* image)
+{
+	static long jit_us = -1;
+	if(jit_us < 0)
+		jit_us = getenv("STUB_JIT_US") ? atol(getenv("STUB_JIT_US")) : 200;
+	if(jit_us > 0)
+		usleep(jit_us);
+	stub_module_loads++;
+	*module = (CUmodule)(size_t)stub_module_loads;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuModuleUnload(CUmodule hmod) { return CUDA_SUCCESS; }
+
+CUresult cuModuleGetFunction(CUfunction* hfunc, CUmodule hmod, const char* name)
+{
+	stub_function_lookups++;
+	*hfunc = (CUfunction)(size_t)stub_function_lookups;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuLaunchKernel(CUfunction f, 
+						unsigned int gridDimX, unsigned int gridDimY, unsigned int gridDimZ,
+						unsigned int blockDimX, unsigned int blockDimY, unsigned int blockDimZ,
+						unsigned int sharedMemBytes, CUstream hStream, 
+						void** kernelParams, void** extra)
+{
+	stub_launches++;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuStreamCreate(CUstream* phStream, unsigned int flags)
+{
+	stub_stream_t *stream = (stub_stream_t*)calloc(1, sizeof(stub_stream_t));
+	stream->id = __sync_add_and_fetch(&stub_streams_created, 1);
+	*phStream = (CUstream)stream;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuStreamDestroy(CUstream hStream)
+{
+	free(hStream);
+	return CUDA_SUCCESS;
+}
+
+CUresult cuStreamQuery(CUstream hStream)
+{
+	if(hStream != NULL && ((stub_stream_t*)hStream)->busy)
+		return CUDA_ERROR_NOT_READY;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuStreamSynchronize(CUstream hStream)
+{
+	__sync_fetch_and_add(&stub_stream_syncs, 1);
+	if(hStream != NULL)
+		((stub_stream_t*)hStream)->busy = 0;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuStreamWaitEvent(CUstream hStream, CUevent hEvent, unsigned int flags)
+{
+	__sync_fetch_and_add(&stub_stream_waits, 1);
+	return CUDA_SUCCESS;
+}
+
+/* an event is the host time at which it was recorded */
+CUresult cuEventCreate(CUevent* phEvent, unsigned int flags)
+{
+	*phEvent = (CUevent)calloc(1, sizeof(struct timeval));
+	return CUDA_SUCCESS;
+}
+
+CUresult cuEventRecord(CUevent hEvent, CUstream hStream)
+{
+	gettimeofday((struct timeval*)hEvent, NULL);
+	return CUDA_SUCCESS;
+}
+
+CUresult cuEventSynchronize(CUevent hEvent) { return CUDA_SUCCESS; }
+
+CUresult cuEventElapsedTime(float* pMilliseconds, CUevent hStart, CUevent hEnd)
+{
+	struct timeval *start = (struct timeval*)hStart, *end = (struct timeval*)hEnd;
+	*pMilliseconds = (end->tv_sec - start->tv_sec)*1.0e3f + (end->tv_usec - start->tv_usec)*1.0e-3f;
+	return CUDA_SUCCESS;
+}
+
+CUresult cuEventDestroy(CUevent hEvent)
+{
+	free(hEvent);
+	return CUDA_SUCCESS;
+}
+
+cudaError_t cudaMalloc(void** devPtr, size_t size)
+{
+	*devPtr = malloc(size);
+	return *devPtr ? cudaSuccess : cudaErrorMemoryAllocation;
+}
+
+cudaError_t cudaFree(void* devPtr)
+{
+	free(devPtr);
+	return cudaSuccess;
+}
+
+cudaError_t cudaMemcpy(void* dst, const void* src, size_t count, enum cudaMemcpyKind kind)
+{
+	memcpy(dst, src, count);
+	return cudaSuccess;
+}
+
+cudaError_t cudaMemcpyAsync(void* dst, const void* src, size_t count, 
+							enum cudaMemcpyKind kind, cudaStream_t stream)
+{
+	memcpy(dst, src, count);
+	return cudaSuccess;
+}
+
+cudaError_t cudaHostRegister(void* ptr, size_t size, unsigned int flags)
+{
+	static long register_us = -1;
+	if(register_us < 0)
+		register_us = getenv("STUB_REGISTER_US") ? atol(getenv("STUB_REGISTER_US")) : 100;
+	if(register_us > 0)
+		usleep(register_us);
+	stub_host_registers++;
+	return cudaSuccess;
+}
+
+cudaError_t cudaHostUnregister(void* ptr)
+{
+	stub_host_unregisters++;
+	return cudaSuccess;
+}
+
+cudaError_t cudaMallocHost(void** ptr, size_t size)
+{
+	*ptr = malloc(size);
+	return *ptr ? cudaSuccess : cudaErrorMemoryAllocation;
+}
+
+cudaError_t cudaFreeHost(void* ptr)
+{
+	free(ptr);
+	return cudaSuccess;
+}
+
+cudaError_t cudaDeviceSynchronize(void) { return cudaSuccess; }
+
+cudaError_t cudaGetLastError(void) { return cudaSuccess; }
+
+const char* cudaGetErrorString(cudaError_t error) { return "stub error"; }
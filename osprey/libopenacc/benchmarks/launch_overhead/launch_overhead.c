@@ -0,0 +1,79 @@
+/*
+ * Launch overhead of kernels which alternate between two PTX files
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "acc_kernel.h"
+
+extern int stub_module_loads;
+extern int stub_function_lookups;
+extern int stub_launches;
+
+static double get_time()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec*1.0e-6;
+}
+
+static void write_ptx(char* name)
+{
+	FILE *fp = fopen(name, "w");
+	if(fp == NULL)
+	{
+		perror(name);
+		exit(1);
+	}
+	fprintf(fp, "// stub PTX file\n.version 3.1\n.target sm_35\n");
+	fclose(fp);
+}
+
+int main(int argc, char** argv)
+{
+	int launches = 100000;
+	int i, n = 1024;
+	void *d_a;
+	double start, elapsed;
+	int loads, lookups;
+
+	if(argc > 1)
+		launches = atoi(argv[1]);
+
+	write_ptx("launch_overhead_a.ptx");
+	write_ptx("launch_overhead_b.ptx");
+
+	acc_init(acc_device_cuda);
+	__accr_malloc_on_device(NULL, &d_a, n*sizeof(double), 0);
+
+	start = get_time();
+	for(i = 0; i < launches; i++)
+	{
+		__accr_set_gangs(64, 1, 1);
+		__accr_set_vectors(128, 1, 1);
+		__accr_push_kernel_param_pointer(&d_a);
+		__accr_push_kernel_param_scalar(&n);
+		/* two kernels per file, alternating between the files */
+		switch(i % 4)
+		{
+		case 0: __accr_launchkernel("__accrg_a_1_1", "launch_overhead_a.ptx", -2); break;
+		case 1: __accr_launchkernel("__accrg_b_1_1", "launch_overhead_b.ptx", -2); break;
+		case 2: __accr_launchkernel("__accrg_a_2_1", "launch_overhead_a.ptx", -2); break;
+		case 3: __accr_launchkernel("__accrg_b_2_1", "launch_overhead_b.ptx", -2); break;
+		}
+	}
+	elapsed = get_time() - start;
+
+	__accr_get_kernel_cache_stats(&loads, &lookups);
+	printf("launches:          %d\n", stub_launches);
+	printf("module loads:      %d (runtime: %d)\n", stub_module_loads, loads);
+	printf("function lookups:  %d (runtime: %d)\n", stub_function_lookups, lookups);
+	printf("overhead:          %.1f ns/launch\n", elapsed*1.0e9/launches);
+
+	__accr_free_on_device(d_a);
+	acc_shutdown(acc_device_cuda);
+	remove("launch_overhead_a.ptx");
+	remove("launch_overhead_b.ptx");
+	return 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * acc_malloc/acc_free churn through the device memory pool
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <openacc_rtl.h>
+
+static double get_time()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec*1.0e-6;
+}
+
+int main(int argc, char** argv)
+{
+	int iters = 100000;
+	int nlive = 16;
+	void **live;
+	unsigned int size;
+	unsigned int seed = 12345;
+	double start, end;
+	int i, slot;
+
+	if(argc > 1)
+		iters = atoi(argv[1]);
+	if(argc > 2)
+		nlive = atoi(argv[2]);
+
+	acc_init(acc_device_host);
+
+	live = (void**)calloc(nlive, sizeof(void*));
+
+	start = get_time();
+	for(i = 0; i < iters; i++)
+	{
+		/* replace a random live buffer by one of a random size up to 4MB */
+		slot = rand_r(&seed) % nlive;
+		if(live[slot] != NULL)
+			acc_free(live[slot]);
+		size = 1024u << (rand_r(&seed) % 13);
+		live[slot] = acc_malloc(size);
+		((char*)live[slot])[0] = (char)i;
+	}
+	end = get_time();
+
+	for(slot = 0; slot < nlive; slot++)
+		if(live[slot] != NULL)
+			acc_free(live[slot]);
+	free(live);
+
+	printf("%d acc_malloc/acc_free pairs: %.3f s, %.1f ns per pair\n",
+			iters, end - start, (end - start)*1.0e9/iters);
+
+	acc_shutdown(acc_device_host);
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Present table micro-benchmark: insert N disjoint mappings, then time
+ * whole-array lookups, sub-array lookups, device lookups and removal.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "acc_present.h"
+
+#define MAPPING_SIZE 4096
+#define MAPPING_GAP  512
+
+static double get_time()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec*1.0e-6;
+}
+
+int main(int argc, char** argv)
+{
+	int n = 100000;
+	int lookups = 1000000;
+	int i, found;
+	char *host_base, *device_base;
+	acc_present_table *table;
+	acc_present_entry **entries;
+	double start, elapsed;
+
+	if(argc > 1)
+		n = atoi(argv[1]);
+	if(argc > 2)
+		lookups = atoi(argv[2]);
+
+	/* synthetic, never dereferenced address ranges */
+	host_base = (char*)0x100000000UL;
+	device_base = (char*)0x700000000UL;
+	entries = (acc_present_entry**)malloc(n*sizeof(acc_present_entry*));
+	table = acc_present_table_create();
+	srand(12345);
+
+	start = get_time();
+	for(i = 0; i < n; i++)
+	{
+		entries[i] = acc_present_table_insert(table, 
+					host_base + (size_t)i*(MAPPING_SIZE+MAPPING_GAP),
+					device_base + (size_t)i*MAPPING_SIZE,
+					MAPPING_SIZE, 0);
+	}
+	elapsed = get_time() - start;
+	printf("insert:          %d mappings, %8.1f ns/op\n", n, elapsed*1.0e9/n);
+
+	found = 0;
+	start = get_time();
+	for(i = 0; i < lookups; i++)
+	{
+		size_t k = rand() % n;
+		found += acc_present_table_lookup_host(table, 
+					host_base + k*(MAPPING_SIZE+MAPPING_GAP), MAPPING_SIZE) != NULL;
+	}
+	elapsed = get_time() - start;
+	printf("lookup (whole):  %d found, %8.1f ns/op\n", found, elapsed*1.0e9/lookups);
+
+	found = 0;
+	start = get_time();
+	for(i = 0; i < lookups; i++)
+	{
+		size_t k = rand() % n;
+		size_t offset = rand() % (MAPPING_SIZE/2);
+		found += acc_present_table_lookup_host(table, 
+					host_base + k*(MAPPING_SIZE+MAPPING_GAP) + offset, MAPPING_SIZE/2) != NULL;
+	}
+	elapsed = get_time() - start;
+	printf("lookup (sub):    %d found, %8.1f ns/op\n", found, elapsed*1.0e9/lookups);
+
+	found = 0;
+	start = get_time();
+	for(i = 0; i < lookups; i++)
+	{
+		size_t k = rand() % n;
+		found += acc_present_table_lookup_host(table, 
+					host_base + k*(MAPPING_SIZE+MAPPING_GAP) + MAPPING_SIZE, 1) != NULL;
+	}
+	elapsed = get_time() - start;
+	printf("lookup (miss):   %d found, %8.1f ns/op\n", found, elapsed*1.0e9/lookups);
+
+	found = 0;
+	start = get_time();
+	for(i = 0; i < lookups; i++)
+	{
+		size_t k = rand() % n;
+		found += acc_present_table_lookup_device(table, 
+					device_base + k*MAPPING_SIZE, 0) != NULL;
+	}
+	elapsed = get_time() - start;
+	printf("lookup (device): %d found, %8.1f ns/op\n", found, elapsed*1.0e9/lookups);
+
+	start = get_time();
+	for(i = 0; i < n; i++)
+		acc_present_table_remove(table, entries[i]);
+	elapsed = get_time() - start;
+	printf("remove:          %d mappings, %8.1f ns/op\n", n, elapsed*1.0e9/n);
+
+	if(table->size != 0 || table->host_root != NULL || table->device_root != NULL)
+	{
+		printf("FAILED: the table is not empty after removal\n");
+		return 1;
+	}
+
+	acc_present_table_destroy(table);
+	free(entries);
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Check of the present table for sub-arrays which do not start at the
+ * start of their array, a[lo:n] with lo > 0. It runs on the host backend
+ * (acc_device_host), so it needs no GPU.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <openacc_rtl.h>
+#include "acc_present.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if(!(cond)) \
+		{ \
+			printf("FAILED line %d: %s\n", __LINE__, #cond); \
+			failures++; \
+		} \
+	} while(0)
+
+/* the table alone, with distinct host and device addresses */
+static void check_table(void)
+{
+	acc_present_table *table;
+	acc_present_entry *entry, *other;
+	char *host = (char*)0x100000;
+	char *block = (char*)0x900000;
+	size_t lo = 4096, n = 1024;
+
+	table = acc_present_table_create();
+
+	/* a[lo:n] is at host+lo on the host and in block on the device,
+	 * whose array start is block-lo */
+	entry = acc_present_table_insert(table, host + lo, block, n, lo);
+	/* a whole array right below the sub-array's array start on the device */
+	other = acc_present_table_insert(table, (char*)0x500000, block - lo - 256, 256, 0);
+
+	CHECK(acc_present_table_lookup_host(table, host + lo, n) == entry);
+	CHECK(acc_present_table_lookup_host(table, host + lo + n - 1, 1) == entry);
+	CHECK(acc_present_table_lookup_host(table, host, 1) == NULL);
+	CHECK(acc_present_table_lookup_host(table, host + lo - 1, 1) == NULL);
+	CHECK(acc_present_table_lookup_host(table, host + lo + n, 1) == NULL);
+	CHECK(acc_present_table_lookup_host(table, host + lo, n + 1) == NULL);
+
+	CHECK(acc_present_table_lookup_device(table, block, n) == entry);
+	CHECK(acc_present_table_find_device_base(table, block - lo) == entry);
+	CHECK(acc_present_table_find_device_base(table, block) == NULL);
+	CHECK(acc_present_table_find_device_base(table, block - lo - 256) == other);
+
+	acc_present_table_remove(table, entry);
+	CHECK(acc_present_table_find_device_base(table, block - lo) == NULL);
+	CHECK(acc_present_table_lookup_host(table, host + lo, 1) == NULL);
+	CHECK(acc_present_table_find_device_base(table, block - lo - 256) == other);
+
+	acc_present_table_destroy(table);
+}
+
+/* the runtime calls the compiler makes for data regions */
+static void check_runtime(void)
+{
+	double *a, *b;
+	void *d_a, *d_b, *p;
+	size_t n = 1000, lo = 100, len = 50;
+	size_t s = sizeof(double);
+
+	a = (double*)malloc(n*s);
+	b = (double*)malloc(n*s);
+
+	/* copyin(a[lo:len]) and create(b[0:n]) */
+	__accr_malloc_on_device(a, &d_a, len*s, lo*s);
+	__accr_malloc_on_device(b, &d_b, n*s, 0);
+
+	CHECK(__accr_present_create(a, lo*s, len, len*s));
+	CHECK(__accr_present_create(a, (lo + 10)*s, 10, 10*s));
+	CHECK(__accr_present_create(a, (lo + len - 1)*s, 1, s));
+	CHECK(!__accr_present_create(a, 0, 1, s));
+	CHECK(!__accr_present_create(a, (lo - 1)*s, 1, s));
+	CHECK(!__accr_present_create(a, (lo + len)*s, 1, s));
+	CHECK(!__accr_present_create(a, 0, lo + len, (lo + len)*s));
+	CHECK(__accr_present_create(b, 0, n, n*s));
+
+	/* the device address of the array start, indexed like the host array */
+	p = NULL;
+	__accr_get_device_addr(a, &p, (lo + 10)*s, s);
+	CHECK(p == d_a);
+	p = NULL;
+	__accr_get_device_addr(b, &p, 0, n*s);
+	CHECK(p == d_b);
+
+	__accr_free_on_device(d_a);
+	CHECK(!__accr_present_create(a, lo*s, len, len*s));
+	CHECK(__accr_present_create(b, 0, n, n*s));
+	__accr_free_on_device(d_b);
+	CHECK(!__accr_present_create(b, 0, n, n*s));
+
+	free(a);
+	free(b);
+}
+
+int main(int argc, char** argv)
+{
+	acc_init(acc_device_host);
+
+	check_table();
+	check_runtime();
+
+	acc_shutdown(acc_device_host);
+
+	if(failures == 0)
+		printf("PASSED\n");
+	return failures != 0;
+}
@@ -1,3 +1,5 @@
+#include <stddef.h>
+
 
 typedef enum
 {
@@ -34,24 +36,48 @@ typedef enum
 	ACC_KDATA_DOUBLE
 } ACC_KERNEL_DATA_TYPE;
 
+/* the operator of a reduction, as the compiler passes it to __accr_fused_reduction_add */
+typedef enum
+{
+	ACC_REDUCTION_ADD = 0,
+	ACC_REDUCTION_MPY,
+	ACC_REDUCTION_MAX,
+	ACC_REDUCTION_MIN,
+	ACC_REDUCTION_BAND,
+	ACC_REDUCTION_BIOR,
+	ACC_REDUCTION_BXOR,
+	ACC_REDUCTION_CAND,
+	ACC_REDUCTION_CIOR
+} ACC_REDUCTION_OPR;
+
+typedef struct acc_host_kernel_ctx_s{
+	int gang_id[3];
+	int gangs[3];
+	int vectors[3];
+	void *shared_mem;
+	unsigned int shared_size;
+} acc_host_kernel_ctx_t;
+
+typedef void (*acc_host_kernel_t)(void** args, acc_host_kernel_ctx_t* ctx);
+
 extern void __accr_setup(void);
 
 extern void __accr_cleanup(void);
 
-extern void __accr_malloc_on_device(void* pHost, void** pDevice, unsigned int size);
+extern void __accr_malloc_on_device(void* pHost, void** pDevice, size_t size, size_t offset);
 
 extern void __accr_free_on_device(void* pDevice);
 
 extern void __accr_memin_h2d(void* pHost, 
 							 void* pDevice, 
-							 unsigned int size, 
-							 unsigned int offset,
+							 size_t size, 
+							 size_t offset,
 							 int async_expr);
 
 extern void __accr_memout_d2h(void* pDevice, 
 							  void* pHost, 
-							  unsigned int size, 
-							  unsigned int offset,
+							  size_t size, 
+							  size_t offset,
 							  int async_expr);
 
 extern void __accr_init_param_list();
@@ -70,36 +96,38 @@ extern void __accr_clean_param_list();
 
 extern int __accr_get_device_addr(void* pHostAddr, 
 								   void** pDeviceAddr, 
-								   unsigned int istart, 
-								   unsigned int isize);
+								   size_t istart, 
+								   size_t isize);
 
 extern int __accr_present_create(void* pBuffer, 
-								 unsigned int start, 
-								 int length, 
-								 unsigned int size);
+								 size_t start, 
+								 size_t length, 
+								 size_t size);
 
 extern int __accr_device_addr_present(void* pDevice);
 
 extern void __accr_reduction_buff_malloc(void** pDevice, int type);
 
 extern void __accr_update_device_variable(void* pHost, 
-										  unsigned int offset, 
-										  unsigned int size,
+										  size_t offset, 
+										  size_t size,
 										  int async_expr);
 
 extern void __accr_update_host_variable(void* pHost, 
-										unsigned int offset, 
-										unsigned int size,
+										size_t offset, 
+										size_t size,
 										int async_expr);
 
-extern void __accr_update_device_variable_async(void* pHost, unsigned int offset, unsigned int size, int scalar_expr);
+extern void __accr_update_device_variable_async(void* pHost, size_t offset, size_t size, int scalar_expr);
 
-extern void __accr_update_host_variable_async(void* pHost, unsigned int offset, unsigned int size, int scalar_expr);
+extern void __accr_update_host_variable_async(void* pHost, size_t offset, size_t size, int scalar_expr);
 
 extern void __accr_wait_stream(int async_expr);
 
 extern void __accr_wait_all_streams(void);
 
+extern void __accr_wait_stream_async(int wait_expr, int async_expr);
+
 extern int acc_async_test(int);
 
 extern int acc_async_test_all(void);
@@ -108,6 +136,10 @@ extern void acc_async_wait(int);
 
 extern void acc_async_wait_all(void);
 
+extern void acc_wait_async(int, int);
+
+extern void acc_wait_all_async(int);
+
 extern void __accr_set_gangs(int x, int y, int z);
 
 extern void __accr_set_vectors(int x, int y, int z);
@@ -144,13 +176,29 @@ extern int __accr_get_total_num_vectors();
 
 extern void __accr_launchkernel(char* szKernelName, char* szKernelLib, int async_expr);
 
+extern void __accr_register_host_kernel(char* szKernelName, acc_host_kernel_t kernel);
+
+extern void __accr_preload_kernel_module(char* szKernelLib);
+
 //extern void __accr_final_reduction_algorithm(double* result, double *d_idata, int type);
 extern void __accr_final_reduction_algorithm(void* result, void *d_idata, char* kernel_name, unsigned int size, unsigned int type_size);
 
+extern void __accr_fused_reduction_buff_malloc(void** pDevice, int size);
+
+extern void __accr_fused_reduction_add(void* d_partial, 
+									   void* host_result, 
+									   char* kernel_name, 
+									   int num_elements, 
+									   unsigned int type_size, 
+									   int opr, 
+									   int type);
+
+extern void __accr_final_fused_reduction(void);
+
 extern void acc_init(acc_device_t);
 
 extern void acc_shutdown(acc_device_t);
 
-extern void* acc_malloc(unsigned int);
+extern void* acc_malloc(size_t);
 
 extern void acc_free(void*);
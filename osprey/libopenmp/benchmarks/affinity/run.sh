@@ -0,0 +1,22 @@
+#!/bin/sh
+#
+# Runs the placement benchmark unbound and with every binding policy, e.g.
+#   ./run.sh 8 26
+# for 8 threads and arrays of 2^26 doubles. stream has to be built first
+# (see README).
+
+threads=${1:-4}
+log2_size=${2:-25}
+
+echo "=== unbound"
+OMP_NUM_THREADS=$threads ./stream $log2_size
+
+for places in threads cores numa_domains sockets
+do
+  for bind in close spread master
+  do
+    echo "=== OMP_PLACES=$places OMP_PROC_BIND=$bind,close"
+    OMP_NUM_THREADS=$threads OMP_PLACES=$places OMP_PROC_BIND=$bind,close \
+      ./stream $log2_size
+  done
+done
@@ -0,0 +1,100 @@
+/*
+ * thread placement: prints the place and partition of every thread of a
+ * team and of a nested team of two under each of them, then the
+ * bandwidth of the STREAM triad on arrays of 2^n doubles, e.g.
+ *   ./stream 26
+ * The arrays are first touched with the schedule of the triad, so that
+ * every page is local to the thread using it as long as threads do not
+ * move.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define REPS 10
+
+static const char *bind_name(omp_proc_bind_t bind)
+{
+  switch (bind) {
+  case omp_proc_bind_false:  return "false";
+  case omp_proc_bind_true:   return "true";
+  case omp_proc_bind_master: return "master";
+  case omp_proc_bind_close:  return "close";
+  case omp_proc_bind_spread: return "spread";
+  }
+  return "unknown";
+}
+
+static void print_place(const char *indent, int outer)
+{
+  int place = omp_get_place_num();
+  int num_procs = place < 0 ? 0 : omp_get_place_num_procs(place);
+  int procs[1024], i;
+
+  if (num_procs > 1024)
+    num_procs = 1024;
+  if (num_procs > 0)
+    omp_get_place_proc_ids(place, procs);
+
+#pragma omp critical
+  {
+    printf("%sthread %d.%d: place %d of %d places in its partition, cpus",
+           indent, outer, omp_get_thread_num(), place,
+           omp_get_partition_num_places());
+    for (i = 0; i < num_procs; i++)
+      printf(" %d", procs[i]);
+    printf("\n");
+  }
+}
+
+int main(int argc, char **argv)
+{
+  long n = 1L << (argc > 1 ? atoi(argv[1]) : 25);
+  double *a, *b, *c, s = 3.0, t, best = 1e30;
+  long i;
+  int r;
+
+  printf("%d places, binding %s\n", omp_get_num_places(),
+         bind_name(omp_get_proc_bind()));
+
+  omp_set_nested(1);
+#pragma omp parallel
+  {
+    int outer = omp_get_thread_num();
+
+    print_place("", outer);
+#pragma omp parallel num_threads(2)
+    print_place("  ", outer);
+  }
+  omp_set_nested(0);
+
+  a = malloc(n * sizeof(double));
+  b = malloc(n * sizeof(double));
+  c = malloc(n * sizeof(double));
+  if (a == NULL || b == NULL || c == NULL) {
+    fprintf(stderr, "cannot allocate 3 arrays of %ld doubles\n", n);
+    return 1;
+  }
+
+#pragma omp parallel for schedule(static)
+  for (i = 0; i < n; i++) {
+    a[i] = 0.0;
+    b[i] = 1.0;
+    c[i] = 2.0;
+  }
+
+  for (r = 0; r < REPS; r++) {
+    t = omp_get_wtime();
+#pragma omp parallel for schedule(static)
+    for (i = 0; i < n; i++)
+      a[i] = b[i] + s * c[i];
+    t = omp_get_wtime() - t;
+    if (t < best)
+      best = t;
+  }
+
+  printf("triad: %.1f MB/s (best of %d)\n",
+         3.0 * n * sizeof(double) / best / 1e6, REPS);
+  return a[n - 1] == 7.0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/*
+ * barrier latency: the time of an explicit barrier, of a parallel region
+ * with nothing in it, and of a contended omp_set_lock/omp_unset_lock pair,
+ * for team sizes 1, 2, 4, ... up to the number of threads given (default
+ * omp_get_max_threads()), e.g.
+ *   ./latency 16 100000
+ * goes up to 16 threads with 100000 repetitions per measurement.
+ *
+ * Every barrier also checks that no thread got through it early.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define MAX_THREADS 256
+
+static volatile int phase[MAX_THREADS];
+
+static double barrier_latency(int nthreads, long reps, long *bad)
+{
+  double t;
+  long errors = 0;
+
+  t = omp_get_wtime();
+#pragma omp parallel num_threads(nthreads) reduction(+:errors)
+  {
+    int me = omp_get_thread_num(), n = omp_get_num_threads();
+    long r;
+    int i;
+
+    for (r = 0; r < reps; r++) {
+      phase[me] = (int) r;
+#pragma omp barrier
+      for (i = 0; i < n; i++)
+        if (phase[i] < (int) r)
+          errors++;
+    }
+  }
+  t = omp_get_wtime() - t;
+
+  *bad += errors;
+  return t / reps * 1e6;
+}
+
+static double parallel_latency(int nthreads, long reps)
+{
+  double t;
+  long r;
+
+  t = omp_get_wtime();
+  for (r = 0; r < reps; r++) {
+#pragma omp parallel num_threads(nthreads)
+    phase[omp_get_thread_num()]++;
+  }
+  t = omp_get_wtime() - t;
+
+  return t / reps * 1e6;
+}
+
+static double lock_latency(int nthreads, long reps, long *bad)
+{
+  omp_lock_t lock;
+  long counter = 0;
+  double t;
+
+  omp_init_lock(&lock);
+  t = omp_get_wtime();
+#pragma omp parallel num_threads(nthreads)
+  {
+    long r;
+
+    for (r = 0; r < reps; r++) {
+      omp_set_lock(&lock);
+      counter++;
+      omp_unset_lock(&lock);
+    }
+  }
+  t = omp_get_wtime() - t;
+  omp_destroy_lock(&lock);
+
+  if (counter != reps * nthreads)
+    (*bad)++;
+  return t / (reps * nthreads) * 1e6;
+}
+
+int main(int argc, char **argv)
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : omp_get_max_threads();
+  long reps = argc > 2 ? atol(argv[2]) : 20000;
+  long bad = 0;
+  int n;
+
+  if (max_threads > MAX_THREADS)
+    max_threads = MAX_THREADS;
+
+  /* start the threads before timing anything */
+#pragma omp parallel num_threads(max_threads)
+  phase[omp_get_thread_num()] = 0;
+
+  printf("%8s %14s %14s %14s\n", "threads", "barrier (us)",
+         "parallel (us)", "lock (us)");
+  for (n = 1; n <= max_threads; n = n < max_threads && 2 * n > max_threads ?
+                                      max_threads : 2 * n) {
+    double b = barrier_latency(n, reps, &bad);
+    double p = parallel_latency(n, reps / 10 + 1);
+    double l = lock_latency(n, reps, &bad);
+    printf("%8d %14.3f %14.3f %14.3f\n", n, b, p, l);
+  }
+
+  if (bad)
+    printf("FAILED: %ld errors\n", bad);
+  return bad != 0;
+}
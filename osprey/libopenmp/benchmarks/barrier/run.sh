@@ -0,0 +1,14 @@
+#!/bin/sh
+#
+# Runs the barrier latency benchmark with every barrier algorithm, e.g.
+#   ./run.sh 8
+# for teams of up to 8 threads. latency has to be built first (see README).
+
+threads=${1:-4}
+reps=${2:-20000}
+
+for barrier in linear simple tour tree dissem
+do
+  echo "=== O64_OMP_XBARRIER_TYPE=$barrier"
+  O64_OMP_XBARRIER_TYPE=$barrier ./latency $threads $reps
+done
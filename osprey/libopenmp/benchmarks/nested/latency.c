@@ -0,0 +1,54 @@
+/*
+ * nested fork/join latency: the time of an empty parallel region of the
+ * level-1 team, and of an empty parallel region of a nested team forked
+ * by every thread of the outer team, e.g.
+ *   OMP_NUM_THREADS=4 ./latency 2 10000
+ * for an outer team of 4 threads, each forking 10000 nested teams of 2.
+ *
+ * Every nested region counts its threads, to check that none was lost.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+int main(int argc, char **argv)
+{
+  int inner = argc > 1 ? atoi(argv[1]) : 2;
+  long reps = argc > 2 ? atol(argv[2]) : 10000;
+  long r, threads = 0, expected;
+  int outer = omp_get_max_threads();
+  double level_1, nested;
+
+  omp_set_nested(1);
+
+  /* the first regions create the threads */
+#pragma omp parallel
+#pragma omp parallel num_threads(inner)
+  ;
+
+  level_1 = omp_get_wtime();
+  for (r = 0; r < reps; r++) {
+#pragma omp parallel
+    ;
+  }
+  level_1 = omp_get_wtime() - level_1;
+
+  nested = omp_get_wtime();
+#pragma omp parallel reduction(+:threads)
+  {
+    long i;
+
+    for (i = 0; i < reps; i++) {
+#pragma omp parallel num_threads(inner) reduction(+:threads)
+      threads++;
+    }
+  }
+  nested = omp_get_wtime() - nested;
+
+  expected = (long) outer * inner * reps;
+  printf("outer %3d inner %3d: level-1 %8.2f us  nested %8.2f us%s\n",
+         outer, inner, level_1 / reps * 1e6, nested / reps * 1e6,
+         threads == expected ? "" : "  WRONG THREAD COUNT");
+  return threads != expected;
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+#
+# Runs the nested fork/join benchmark for outer teams of 1, 2, 4, ...
+# threads, e.g.
+#   ./run.sh 8 4 10000
+# for outer teams of up to 8 threads forking nested teams of 4 threads,
+# 10000 times. latency has to be built first (see README).
+
+outer=${1:-4}
+inner=${2:-2}
+reps=${3:-10000}
+
+n=1
+while [ $n -le $outer ]
+do
+  OMP_NUM_THREADS=$n ./latency $inner $reps
+  n=`expr $n \* 2`
+done
@@ -0,0 +1,74 @@
+/*
+ * Reductions in nested teams of any size, e.g.
+ *   ./nested 7 2000
+ * for outer and nested teams of 1 to 7 threads, 2000 regions each.
+ *
+ * Every thread of an outer team forks a nested team that reduces an int
+ * sum, a long product, an int max and min and a double sum, and checks
+ * the results. Team sizes that are not a power of two leave threads
+ * without a partner in some rounds of the combining tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+static long check(int inner, long reps)
+{
+  long r, bad = 0;
+
+  for (r = 0; r < reps; r++) {
+    int sum = 0, max = -1, min = 1 << 30;
+    long prod = 1;
+    double dsum = 0;
+    int n = 0;
+
+#pragma omp parallel num_threads(inner) \
+    reduction(+:sum,dsum,n) reduction(*:prod) reduction(max:max) \
+    reduction(min:min)
+    {
+      int me = omp_get_thread_num() + 1;
+
+      sum += me + r;
+      prod *= me % 3 == 0 ? -1 : 1;
+      if (me + r > max)
+        max = me + r;
+      if (me + r < min)
+        min = me + r;
+      dsum += 0.5 * me;
+      n++;
+    }
+
+    if (sum != n * (n + 1) / 2 + n * r || prod != (n / 3 % 2 ? -1 : 1) ||
+        max != n + r || min != 1 + r || dsum != 0.25 * n * (n + 1))
+      bad++;
+  }
+  return bad;
+}
+
+int main(int argc, char **argv)
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : 7;
+  long reps = argc > 2 ? atol(argv[2]) : 2000;
+  int outer, inner;
+  long bad = 0;
+
+  omp_set_nested(1);
+  omp_set_dynamic(0);
+
+  for (outer = 1; outer <= max_threads; outer++)
+    for (inner = 1; inner <= max_threads; inner++) {
+      long wrong = 0;
+      double t = omp_get_wtime();
+
+#pragma omp parallel num_threads(outer) reduction(+:wrong)
+      wrong += check(inner, reps);
+
+      t = omp_get_wtime() - t;
+      printf("outer %2d nested %2d %10.3f us/region%s\n", outer, inner,
+             t / reps * 1e6, wrong ? "  WRONG RESULTS" : "");
+      bad += wrong;
+    }
+
+  return bad != 0;
+}
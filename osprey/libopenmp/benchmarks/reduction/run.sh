@@ -0,0 +1,11 @@
+#!/bin/sh
+#
+# Runs the nested reduction check for teams of 1 to N threads, e.g.
+#   ./run.sh 7 2000
+# for outer and nested teams of up to 7 threads and 2000 regions each.
+# nested has to be built first (see README).
+
+threads=${1:-7}
+reps=${2:-2000}
+
+./nested $threads $reps
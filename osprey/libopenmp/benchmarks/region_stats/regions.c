@@ -0,0 +1,88 @@
+/*
+ * Overhead of O64_OMP_REGION_STATS, and what it reports, e.g.
+ *   OMP_NUM_THREADS=4 O64_OMP_REGION_STATS=table ./regions 2000 4000
+ * for 2000 runs of each region and 4000 iterations per loop.
+ *
+ * balanced is a static loop of equal iterations, skewed a static loop
+ * where the iterations of the last thread cost four times as much, so
+ * the others wait for it in the barrier, and locked a loop that takes a
+ * critical section in every iteration.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+static double work(int i, int cost)
+{
+  double x = i;
+  int k;
+
+  for (k = 0; k < cost; k++)
+    x = x * 0.999999 + 1.0;
+  return x;
+}
+
+static double balanced(int n)
+{
+  double sum = 0;
+  int i;
+
+#pragma omp parallel for schedule(static) reduction(+:sum)
+  for (i = 0; i < n; i++)
+    sum += work(i, 20);
+  return sum;
+}
+
+static double skewed(int n)
+{
+  double sum = 0;
+  int i;
+
+#pragma omp parallel for schedule(static) reduction(+:sum)
+  for (i = 0; i < n; i++)
+    sum += work(i, i >= n - n / omp_get_num_threads() ? 80 : 20);
+  return sum;
+}
+
+static double locked(int n)
+{
+  double sum = 0;
+  int i;
+
+#pragma omp parallel for schedule(static)
+  for (i = 0; i < n; i++) {
+    double x = work(i, 20);
+#pragma omp critical
+    sum += x;
+  }
+  return sum;
+}
+
+int main(int argc, char **argv)
+{
+  int runs = argc > 1 ? atoi(argv[1]) : 2000;
+  int n = argc > 2 ? atoi(argv[2]) : 4000;
+  double t, sum = 0;
+  int r;
+
+  t = omp_get_wtime();
+  for (r = 0; r < runs; r++)
+    sum += balanced(n);
+  printf("balanced threads %3d %10.3f us per region\n",
+         omp_get_max_threads(), (omp_get_wtime() - t) * 1e6 / runs);
+
+  t = omp_get_wtime();
+  for (r = 0; r < runs; r++)
+    sum += skewed(n);
+  printf("skewed   threads %3d %10.3f us per region\n",
+         omp_get_max_threads(), (omp_get_wtime() - t) * 1e6 / runs);
+
+  t = omp_get_wtime();
+  for (r = 0; r < runs; r++)
+    sum += locked(n);
+  printf("locked   threads %3d %10.3f us per region\n",
+         omp_get_max_threads(), (omp_get_wtime() - t) * 1e6 / runs);
+
+  return sum < 0;
+}
@@ -0,0 +1,21 @@
+#!/bin/sh
+#
+# Runs the regions benchmark for 1, 2, 4, ... threads, once without and
+# once with O64_OMP_REGION_STATS, e.g.
+#   ./run.sh 8 2000 4000
+# for up to 8 threads, 2000 runs of each region and 4000 iterations.
+# regions has to be built first (see README). The reports of the runs
+# with accounting go to stats.<threads>.txt.
+
+threads=${1:-4}
+runs=${2:-2000}
+n=${3:-4000}
+
+t=1
+while [ $t -le $threads ]
+do
+  OMP_NUM_THREADS=$t ./regions $runs $n
+  OMP_NUM_THREADS=$t O64_OMP_REGION_STATS=table \
+    O64_OMP_REGION_STATS_FILE=stats.$t.txt ./regions $runs $n
+  t=`expr $t \* 2`
+done
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Runs the scheduling benchmark for 1, 2, 3, 4, 6, 8, ... threads, with
+# the shared loop counter and with pre-split slices and stealing
+# (O64_OMP_SCHEDULE_STEAL), e.g.
+#   ./run.sh 16 1000000 5
+# for up to 16 threads, 1000000 iterations and 5 repetitions.
+# sched has to be built first (see README).
+
+threads=${1:-8}
+n=${2:-1000000}
+reps=${3:-5}
+
+for steal in false true
+do
+  echo "O64_OMP_SCHEDULE_STEAL=$steal"
+  t=1
+  while [ $t -le $threads ]
+  do
+    O64_OMP_SCHEDULE_STEAL=$steal OMP_NUM_THREADS=$t ./sched $n $reps
+    if [ $t -ge 2 ] && [ `expr $t + $t / 2` -le $threads ]
+    then
+      O64_OMP_SCHEDULE_STEAL=$steal OMP_NUM_THREADS=`expr $t + $t / 2` \
+        ./sched $n $reps
+    fi
+    t=`expr $t \* 2`
+  done
+done
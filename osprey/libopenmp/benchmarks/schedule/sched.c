@@ -0,0 +1,109 @@
+/*
+ * Loop scheduling: time and check static, dynamic and guided schedules
+ * with several chunk sizes, on loops with int and with long long
+ * induction variables, e.g.
+ *   OMP_NUM_THREADS=4 ./sched 1000000 5
+ * for loops of 1000000 iterations, each timed 5 times.
+ *
+ * The long long loops start above 2^32 and the int loops count down, so
+ * that both the 4- and 8-byte entries of the scheduler are used with a
+ * positive and a negative increment. Every iteration increments its own
+ * counter, which must be exactly the number of repetitions afterwards.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define BASE_8 ((long long) 3 << 32)
+
+static int *hits;
+
+static int check(long n, int reps)
+{
+  long i, bad = 0;
+
+  for (i = 0; i < n; i++) {
+    if (hits[i] != reps)
+      bad++;
+    hits[i] = 0;
+  }
+  return bad != 0;
+}
+
+static void run_4(const char *sched, int chunk, long n, int reps)
+{
+  int lo = 0, hi = (int) n - 1;
+  int i, r;
+  double t = omp_get_wtime();
+
+  for (r = 0; r < reps; r++) {
+    if (sched[0] == 's') {
+#pragma omp parallel for schedule(static, chunk)
+      for (i = hi; i >= lo; i--)
+        __sync_fetch_and_add(&hits[i], 1);
+    } else if (sched[0] == 'd') {
+#pragma omp parallel for schedule(dynamic, chunk)
+      for (i = hi; i >= lo; i--)
+        __sync_fetch_and_add(&hits[i], 1);
+    } else {
+#pragma omp parallel for schedule(guided, chunk)
+      for (i = hi; i >= lo; i--)
+        __sync_fetch_and_add(&hits[i], 1);
+    }
+  }
+  t = omp_get_wtime() - t;
+
+  printf("threads %3d int       %-8s chunk %5d %10.3f ms%s\n",
+         omp_get_max_threads(), sched, chunk, t / reps * 1e3,
+         check(n, reps) ? "  WRONG ITERATIONS" : "");
+}
+
+static void run_8(const char *sched, int chunk, long n, int reps)
+{
+  long long lo = BASE_8, hi = BASE_8 + n;
+  long long i;
+  int r;
+  double t = omp_get_wtime();
+
+  for (r = 0; r < reps; r++) {
+    if (sched[0] == 's') {
+#pragma omp parallel for schedule(static, chunk)
+      for (i = lo; i < hi; i++)
+        __sync_fetch_and_add(&hits[i - BASE_8], 1);
+    } else if (sched[0] == 'd') {
+#pragma omp parallel for schedule(dynamic, chunk)
+      for (i = lo; i < hi; i++)
+        __sync_fetch_and_add(&hits[i - BASE_8], 1);
+    } else {
+#pragma omp parallel for schedule(guided, chunk)
+      for (i = lo; i < hi; i++)
+        __sync_fetch_and_add(&hits[i - BASE_8], 1);
+    }
+  }
+  t = omp_get_wtime() - t;
+
+  printf("threads %3d long long %-8s chunk %5d %10.3f ms%s\n",
+         omp_get_max_threads(), sched, chunk, t / reps * 1e3,
+         check(n, reps) ? "  WRONG ITERATIONS" : "");
+}
+
+int main(int argc, char **argv)
+{
+  long n = argc > 1 ? atol(argv[1]) : 1000000;
+  int reps = argc > 2 ? atoi(argv[2]) : 5;
+  static const char *scheds[] = { "static", "dynamic", "guided" };
+  static const int chunks[] = { 1, 7, 64, 1000 };
+  int s, c;
+
+  hits = calloc(n, sizeof(int));
+
+  for (s = 0; s < 3; s++)
+    for (c = 0; c < 4; c++) {
+      run_4(scheds[s], chunks[c], n, reps);
+      run_8(scheds[s], chunks[c], n, reps);
+    }
+
+  free(hits);
+  return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * tiled Cholesky factorization (lower, A = L*L^T) scheduled three ways:
+ * serially, with one taskwait per stage, and with depend clauses
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+
+static int nt, bs;
+
+#define TILE(A, i, j) ((A)[(i)*nt + (j)])
+
+/* Akk = chol(Akk) */
+static void potrf(double *a)
+{
+  int i, j, k;
+
+  for (k = 0; k < bs; k++) {
+    a[k*bs + k] = sqrt(a[k*bs + k]);
+    for (i = k + 1; i < bs; i++)
+      a[i*bs + k] /= a[k*bs + k];
+    for (j = k + 1; j < bs; j++)
+      for (i = j; i < bs; i++)
+        a[i*bs + j] -= a[i*bs + k] * a[j*bs + k];
+  }
+}
+
+/* b = b * l^-T */
+static void trsm(const double *l, double *b)
+{
+  int i, j, k;
+
+  for (i = 0; i < bs; i++)
+    for (j = 0; j < bs; j++) {
+      double s = b[i*bs + j];
+      for (k = 0; k < j; k++)
+        s -= b[i*bs + k] * l[j*bs + k];
+      b[i*bs + j] = s / l[j*bs + j];
+    }
+}
+
+/* c -= a * b^T */
+static void gemm(const double *a, const double *b, double *c)
+{
+  int i, j, k;
+
+  for (i = 0; i < bs; i++)
+    for (j = 0; j < bs; j++) {
+      double s = c[i*bs + j];
+      for (k = 0; k < bs; k++)
+        s -= a[i*bs + k] * b[j*bs + k];
+      c[i*bs + j] = s;
+    }
+}
+
+static void cholesky_serial(double **A)
+{
+  int i, j, k;
+
+  for (k = 0; k < nt; k++) {
+    potrf(TILE(A, k, k));
+    for (i = k + 1; i < nt; i++)
+      trsm(TILE(A, k, k), TILE(A, i, k));
+    for (i = k + 1; i < nt; i++)
+      for (j = k + 1; j <= i; j++)
+        gemm(TILE(A, i, k), TILE(A, j, k), TILE(A, i, j));
+  }
+}
+
+/* what the solvers do today: every stage waits for the previous one */
+static void cholesky_taskwait(double **A)
+{
+  int i, j, k;
+
+#pragma omp parallel private(i, j, k)
+#pragma omp single
+  for (k = 0; k < nt; k++) {
+    potrf(TILE(A, k, k));
+    for (i = k + 1; i < nt; i++) {
+#pragma omp task firstprivate(i, k)
+      trsm(TILE(A, k, k), TILE(A, i, k));
+    }
+#pragma omp taskwait
+    for (i = k + 1; i < nt; i++)
+      for (j = k + 1; j <= i; j++) {
+#pragma omp task firstprivate(i, j, k)
+        gemm(TILE(A, i, k), TILE(A, j, k), TILE(A, i, j));
+      }
+#pragma omp taskwait
+  }
+}
+
+/* the same graph with the edges spelled out; tiles of stage k+1 start as
+   soon as their own inputs are ready */
+static void cholesky_depend(double **A)
+{
+  int i, j, k;
+
+#pragma omp parallel private(i, j, k)
+#pragma omp single
+  {
+    for (k = 0; k < nt; k++) {
+#pragma omp task firstprivate(k) depend(inout: TILE(A, k, k))
+      potrf(TILE(A, k, k));
+      for (i = k + 1; i < nt; i++) {
+#pragma omp task firstprivate(i, k) \
+                 depend(in: TILE(A, k, k)) depend(inout: TILE(A, i, k))
+        trsm(TILE(A, k, k), TILE(A, i, k));
+      }
+      for (i = k + 1; i < nt; i++)
+        for (j = k + 1; j <= i; j++) {
+#pragma omp task firstprivate(i, j, k) \
+                 depend(in: TILE(A, i, k), TILE(A, j, k)) \
+                 depend(inout: TILE(A, i, j))
+          gemm(TILE(A, i, k), TILE(A, j, k), TILE(A, i, j));
+        }
+    }
+#pragma omp taskwait
+  }
+}
+
+static double **alloc_matrix(void)
+{
+  double **A = malloc(nt * nt * sizeof(double *));
+  int i;
+
+  for (i = 0; i < nt * nt; i++)
+    A[i] = malloc(bs * bs * sizeof(double));
+  return A;
+}
+
+static void free_matrix(double **A)
+{
+  int i;
+
+  for (i = 0; i < nt * nt; i++)
+    free(A[i]);
+  free(A);
+}
+
+/* symmetric, diagonally dominant, so positive definite */
+static void init_matrix(double **A)
+{
+  int n = nt * bs, i, j;
+
+  for (i = 0; i < n; i++)
+    for (j = 0; j < n; j++) {
+      double v = (i == j) ? n : 1.0 / (1 + ((i * 31 + j * 17) % 97));
+      if (j > i)
+        v = 1.0 / (1 + ((j * 31 + i * 17) % 97));
+      TILE(A, i / bs, j / bs)[(i % bs) * bs + j % bs] = v;
+    }
+}
+
+static double max_diff(double **A, double **B)
+{
+  double d = 0.0;
+  int i, j, e;
+
+  for (i = 0; i < nt; i++)
+    for (j = 0; j <= i; j++)
+      for (e = 0; e < bs * bs; e++) {
+        double x = fabs(TILE(A, i, j)[e] - TILE(B, i, j)[e]);
+        if (x > d)
+          d = x;
+      }
+  return d;
+}
+
+static double run(void (*fn)(double **), double **A)
+{
+  double t;
+
+  init_matrix(A);
+  t = omp_get_wtime();
+  fn(A);
+  return omp_get_wtime() - t;
+}
+
+int main(int argc, char **argv)
+{
+  double **ref, **A;
+  double t_serial, t_wait, t_dep, d_wait, d_dep;
+
+  nt = argc > 1 ? atoi(argv[1]) : 16;
+  bs = argc > 2 ? atoi(argv[2]) : 64;
+  if (nt <= 0 || bs <= 0) {
+    fprintf(stderr, "usage: %s [tiles] [tile size]\n", argv[0]);
+    return 1;
+  }
+
+  ref = alloc_matrix();
+  A = alloc_matrix();
+
+  t_serial = run(cholesky_serial, ref);
+  t_wait = run(cholesky_taskwait, A);
+  d_wait = max_diff(ref, A);
+  t_dep = run(cholesky_depend, A);
+  d_dep = max_diff(ref, A);
+
+  printf("cholesky %dx%d tiles of %d, %d threads\n",
+         nt, nt, bs, omp_get_max_threads());
+  printf("  serial   %10.4f s\n", t_serial);
+  printf("  taskwait %10.4f s  max diff %g\n", t_wait, d_wait);
+  printf("  depend   %10.4f s  max diff %g\n", t_dep, d_dep);
+
+  free_matrix(ref);
+  free_matrix(A);
+
+  if (d_wait > 1e-9 || d_dep > 1e-9) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
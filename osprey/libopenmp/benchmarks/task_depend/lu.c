@@ -0,0 +1,234 @@
+/*
+ * tiled LU factorization without pivoting (A = L*U, unit lower L) scheduled
+ * three ways: serially, with one taskwait per stage, and with depend clauses
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+
+static int nt, bs;
+
+#define TILE(A, i, j) ((A)[(i)*nt + (j)])
+
+/* Akk = L*U in place */
+static void getrf(double *a)
+{
+  int i, j, k;
+
+  for (k = 0; k < bs; k++)
+    for (i = k + 1; i < bs; i++) {
+      a[i*bs + k] /= a[k*bs + k];
+      for (j = k + 1; j < bs; j++)
+        a[i*bs + j] -= a[i*bs + k] * a[k*bs + j];
+    }
+}
+
+/* b = l^-1 * b, l unit lower */
+static void trsm_lower(const double *l, double *b)
+{
+  int i, j, k;
+
+  for (i = 0; i < bs; i++)
+    for (k = 0; k < i; k++)
+      for (j = 0; j < bs; j++)
+        b[i*bs + j] -= l[i*bs + k] * b[k*bs + j];
+}
+
+/* b = b * u^-1, u upper */
+static void trsm_upper(const double *u, double *b)
+{
+  int i, j, k;
+
+  for (i = 0; i < bs; i++)
+    for (j = 0; j < bs; j++) {
+      double s = b[i*bs + j];
+      for (k = 0; k < j; k++)
+        s -= b[i*bs + k] * u[k*bs + j];
+      b[i*bs + j] = s / u[j*bs + j];
+    }
+}
+
+/* c -= a * b */
+static void gemm(const double *a, const double *b, double *c)
+{
+  int i, j, k;
+
+  for (i = 0; i < bs; i++)
+    for (k = 0; k < bs; k++) {
+      double aik = a[i*bs + k];
+      for (j = 0; j < bs; j++)
+        c[i*bs + j] -= aik * b[k*bs + j];
+    }
+}
+
+static void lu_serial(double **A)
+{
+  int i, j, k;
+
+  for (k = 0; k < nt; k++) {
+    getrf(TILE(A, k, k));
+    for (j = k + 1; j < nt; j++)
+      trsm_lower(TILE(A, k, k), TILE(A, k, j));
+    for (i = k + 1; i < nt; i++)
+      trsm_upper(TILE(A, k, k), TILE(A, i, k));
+    for (i = k + 1; i < nt; i++)
+      for (j = k + 1; j < nt; j++)
+        gemm(TILE(A, i, k), TILE(A, k, j), TILE(A, i, j));
+  }
+}
+
+/* what the solvers do today: every stage waits for the previous one */
+static void lu_taskwait(double **A)
+{
+  int i, j, k;
+
+#pragma omp parallel private(i, j, k)
+#pragma omp single
+  for (k = 0; k < nt; k++) {
+    getrf(TILE(A, k, k));
+    for (j = k + 1; j < nt; j++) {
+#pragma omp task firstprivate(j, k)
+      trsm_lower(TILE(A, k, k), TILE(A, k, j));
+    }
+    for (i = k + 1; i < nt; i++) {
+#pragma omp task firstprivate(i, k)
+      trsm_upper(TILE(A, k, k), TILE(A, i, k));
+    }
+#pragma omp taskwait
+    for (i = k + 1; i < nt; i++)
+      for (j = k + 1; j < nt; j++) {
+#pragma omp task firstprivate(i, j, k)
+        gemm(TILE(A, i, k), TILE(A, k, j), TILE(A, i, j));
+      }
+#pragma omp taskwait
+  }
+}
+
+/* the same graph with the edges spelled out; the panel of stage k+1 can
+   start while the trailing update of stage k is still running */
+static void lu_depend(double **A)
+{
+  int i, j, k;
+
+#pragma omp parallel private(i, j, k)
+#pragma omp single
+  {
+    for (k = 0; k < nt; k++) {
+#pragma omp task firstprivate(k) depend(inout: TILE(A, k, k))
+      getrf(TILE(A, k, k));
+      for (j = k + 1; j < nt; j++) {
+#pragma omp task firstprivate(j, k) \
+                 depend(in: TILE(A, k, k)) depend(inout: TILE(A, k, j))
+        trsm_lower(TILE(A, k, k), TILE(A, k, j));
+      }
+      for (i = k + 1; i < nt; i++) {
+#pragma omp task firstprivate(i, k) \
+                 depend(in: TILE(A, k, k)) depend(inout: TILE(A, i, k))
+        trsm_upper(TILE(A, k, k), TILE(A, i, k));
+      }
+      for (i = k + 1; i < nt; i++)
+        for (j = k + 1; j < nt; j++) {
+#pragma omp task firstprivate(i, j, k) \
+                 depend(in: TILE(A, i, k), TILE(A, k, j)) \
+                 depend(inout: TILE(A, i, j))
+          gemm(TILE(A, i, k), TILE(A, k, j), TILE(A, i, j));
+        }
+    }
+#pragma omp taskwait
+  }
+}
+
+static double **alloc_matrix(void)
+{
+  double **A = malloc(nt * nt * sizeof(double *));
+  int i;
+
+  for (i = 0; i < nt * nt; i++)
+    A[i] = malloc(bs * bs * sizeof(double));
+  return A;
+}
+
+static void free_matrix(double **A)
+{
+  int i;
+
+  for (i = 0; i < nt * nt; i++)
+    free(A[i]);
+  free(A);
+}
+
+/* diagonally dominant, so no pivoting is needed */
+static void init_matrix(double **A)
+{
+  int n = nt * bs, i, j;
+
+  for (i = 0; i < n; i++)
+    for (j = 0; j < n; j++)
+      TILE(A, i / bs, j / bs)[(i % bs) * bs + j % bs] =
+        (i == j) ? n : 1.0 / (1 + ((i * 31 + j * 17) % 97));
+}
+
+static double max_diff(double **A, double **B)
+{
+  double d = 0.0;
+  int t, e;
+
+  for (t = 0; t < nt * nt; t++)
+    for (e = 0; e < bs * bs; e++) {
+      double x = fabs(A[t][e] - B[t][e]);
+      if (x > d)
+        d = x;
+    }
+  return d;
+}
+
+static double run(void (*fn)(double **), double **A)
+{
+  double t;
+
+  init_matrix(A);
+  t = omp_get_wtime();
+  fn(A);
+  return omp_get_wtime() - t;
+}
+
+int main(int argc, char **argv)
+{
+  double **ref, **A;
+  double t_serial, t_wait, t_dep, d_wait, d_dep;
+
+  nt = argc > 1 ? atoi(argv[1]) : 16;
+  bs = argc > 2 ? atoi(argv[2]) : 64;
+  if (nt <= 0 || bs <= 0) {
+    fprintf(stderr, "usage: %s [tiles] [tile size]\n", argv[0]);
+    return 1;
+  }
+
+  ref = alloc_matrix();
+  A = alloc_matrix();
+
+  t_serial = run(lu_serial, ref);
+  t_wait = run(lu_taskwait, A);
+  d_wait = max_diff(ref, A);
+  t_dep = run(lu_depend, A);
+  d_dep = max_diff(ref, A);
+
+  printf("lu %dx%d tiles of %d, %d threads\n",
+         nt, nt, bs, omp_get_max_threads());
+  printf("  serial   %10.4f s\n", t_serial);
+  printf("  taskwait %10.4f s  max diff %g\n", t_wait, d_wait);
+  printf("  depend   %10.4f s  max diff %g\n", t_dep, d_dep);
+
+  free_matrix(ref);
+  free_matrix(A);
+
+  if (d_wait > 1e-9 || d_dep > 1e-9) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * recursive Fibonacci, one task per call down to a cutoff depth
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+static int cutoff;
+
+static long fib_serial(int n)
+{
+  return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static long fib(int n, int depth)
+{
+  long x, y;
+
+  if (n < 2)
+    return n;
+  if (depth >= cutoff)
+    return fib_serial(n);
+
+#pragma omp task shared(x) firstprivate(n, depth)
+  x = fib(n - 1, depth + 1);
+#pragma omp task shared(y) firstprivate(n, depth)
+  y = fib(n - 2, depth + 1);
+#pragma omp taskwait
+  return x + y;
+}
+
+int main(int argc, char **argv)
+{
+  int n;
+  long ref, result = 0;
+  double t_serial, t_task;
+
+  n = argc > 1 ? atoi(argv[1]) : 34;
+  cutoff = argc > 2 ? atoi(argv[2]) : 20;
+  if (n < 0 || cutoff < 0) {
+    fprintf(stderr, "usage: %s [n] [cutoff depth]\n", argv[0]);
+    return 1;
+  }
+
+  t_serial = omp_get_wtime();
+  ref = fib_serial(n);
+  t_serial = omp_get_wtime() - t_serial;
+
+  t_task = omp_get_wtime();
+#pragma omp parallel
+#pragma omp single
+  result = fib(n, 0);
+  t_task = omp_get_wtime() - t_task;
+
+  printf("fib %d, cutoff depth %d, %d threads\n",
+         n, cutoff, omp_get_max_threads());
+  printf("  serial %10.4f s\n", t_serial);
+  printf("  tasks  %10.4f s\n", t_task);
+
+  if (result != ref) {
+    printf("FAILED (%ld, expected %ld)\n", result, ref);
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
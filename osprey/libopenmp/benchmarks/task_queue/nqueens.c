@@ -0,0 +1,108 @@
+/*
+ * number of solutions of the n-queens problem, one task per placed queen
+ * down to a cutoff row
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+static int n, cutoff;
+
+/* can a queen go to column col of row row, given the columns of the queens
+ * in rows 0..row-1? */
+static int ok(const char *cols, int row, int col)
+{
+  int i;
+
+  for (i = 0; i < row; i++) {
+    int d = cols[i] - col;
+    if (d == 0 || d == row - i || d == i - row)
+      return 0;
+  }
+  return 1;
+}
+
+static long solve_serial(char *cols, int row)
+{
+  long count = 0;
+  int col;
+
+  if (row == n)
+    return 1;
+  for (col = 0; col < n; col++)
+    if (ok(cols, row, col)) {
+      cols[row] = col;
+      count += solve_serial(cols, row + 1);
+    }
+  return count;
+}
+
+static long solve(const char *cols, int row)
+{
+  long counts[32];
+  long count = 0;
+  int col;
+
+  if (row >= cutoff) {
+    char mine[32];
+    memcpy(mine, cols, row);
+    return solve_serial(mine, row);
+  }
+
+  for (col = 0; col < n; col++) {
+    counts[col] = 0;
+    if (ok(cols, row, col)) {
+#pragma omp task shared(counts) firstprivate(col, row)
+      {
+        /* each task works on its own copy of the board */
+        char next[32];
+        memcpy(next, cols, row);
+        next[row] = col;
+        counts[col] = solve(next, row + 1);
+      }
+    }
+  }
+#pragma omp taskwait
+
+  for (col = 0; col < n; col++)
+    count += counts[col];
+  return count;
+}
+
+int main(int argc, char **argv)
+{
+  char cols[32];
+  long ref, result = 0;
+  double t_serial, t_task;
+
+  n = argc > 1 ? atoi(argv[1]) : 12;
+  cutoff = argc > 2 ? atoi(argv[2]) : 4;
+  if (n <= 0 || n > 32 || cutoff < 0) {
+    fprintf(stderr, "usage: %s [n <= 32] [cutoff row]\n", argv[0]);
+    return 1;
+  }
+
+  t_serial = omp_get_wtime();
+  ref = solve_serial(cols, 0);
+  t_serial = omp_get_wtime() - t_serial;
+
+  t_task = omp_get_wtime();
+#pragma omp parallel
+#pragma omp single
+  result = solve(cols, 0);
+  t_task = omp_get_wtime() - t_task;
+
+  printf("nqueens %d, cutoff row %d, %d threads\n",
+         n, cutoff, omp_get_max_threads());
+  printf("  serial %10.4f s\n", t_serial);
+  printf("  tasks  %10.4f s\n", t_task);
+
+  if (result != ref) {
+    printf("FAILED (%ld, expected %ld)\n", result, ref);
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
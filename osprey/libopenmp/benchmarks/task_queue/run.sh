@@ -0,0 +1,16 @@
+#!/bin/sh
+#
+# Runs the task queue benchmarks once with every queue storage, e.g.
+#   ./run.sh 8
+# for 8 threads. The programs have to be built first (see README).
+
+threads=${1:-4}
+
+for storage in array dyn_array list lockless chase_lev
+do
+  echo "=== O64_OMP_QUEUE_STORAGE=$storage"
+  for prog in "./stress" "./fib" "./nqueens" "./sort"
+  do
+    OMP_NUM_THREADS=$threads O64_OMP_QUEUE_STORAGE=$storage $prog
+  done
+done
@@ -0,0 +1,93 @@
+/*
+ * merge sort: both halves are sorted by tasks, the merge is serial
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+static long cutoff;
+
+static int cmp(const void *a, const void *b)
+{
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+static void merge(int *a, long n, long mid, int *tmp)
+{
+  long i = 0, j = mid, k = 0;
+
+  while (i < mid && j < n)
+    tmp[k++] = a[i] <= a[j] ? a[i++] : a[j++];
+  while (i < mid)
+    tmp[k++] = a[i++];
+  while (j < n)
+    tmp[k++] = a[j++];
+  memcpy(a, tmp, n * sizeof(int));
+}
+
+static void sort(int *a, long n, int *tmp)
+{
+  long mid = n / 2;
+
+  if (n <= cutoff) {
+    qsort(a, n, sizeof(int), cmp);
+    return;
+  }
+
+#pragma omp task firstprivate(a, mid, tmp)
+  sort(a, mid, tmp);
+#pragma omp task firstprivate(a, n, mid, tmp)
+  sort(a + mid, n - mid, tmp + mid);
+#pragma omp taskwait
+
+  merge(a, n, mid, tmp);
+}
+
+int main(int argc, char **argv)
+{
+  long n, i;
+  int *a, *ref, *tmp;
+  double t_serial, t_task;
+
+  n = argc > 1 ? atol(argv[1]) : 1L << 24;
+  cutoff = argc > 2 ? atol(argv[2]) : 2048;
+  if (n <= 0 || cutoff <= 0) {
+    fprintf(stderr, "usage: %s [n] [cutoff length]\n", argv[0]);
+    return 1;
+  }
+
+  a = malloc(n * sizeof(int));
+  ref = malloc(n * sizeof(int));
+  tmp = malloc(n * sizeof(int));
+  srand(42);
+  for (i = 0; i < n; i++)
+    ref[i] = a[i] = rand();
+
+  t_serial = omp_get_wtime();
+  qsort(ref, n, sizeof(int), cmp);
+  t_serial = omp_get_wtime() - t_serial;
+
+  t_task = omp_get_wtime();
+#pragma omp parallel
+#pragma omp single
+  sort(a, n, tmp);
+  t_task = omp_get_wtime() - t_task;
+
+  printf("sort %ld ints, cutoff %ld, %d threads\n",
+         n, cutoff, omp_get_max_threads());
+  printf("  qsort  %10.4f s\n", t_serial);
+  printf("  tasks  %10.4f s\n", t_task);
+
+  if (memcmp(a, ref, n * sizeof(int)) != 0) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("PASSED\n");
+  free(a);
+  free(ref);
+  free(tmp);
+  return 0;
+}
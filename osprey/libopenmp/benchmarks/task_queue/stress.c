@@ -0,0 +1,122 @@
+/*
+ * stress test for the task queues: every task marks its own slot, and the
+ * test checks that each one ran exactly once
+ *
+ *  - one thread creates all tasks, far more than a queue holds, while the
+ *    others steal them
+ *  - every thread creates tasks at once
+ *  - an unbalanced tree of tasks, in which idle threads keep stealing from
+ *    a few busy ones
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+static int *hits;
+static long num_tasks;
+
+static void hit(long i)
+{
+#pragma omp atomic
+  hits[i]++;
+}
+
+static long check(const char *name, long n, double t)
+{
+  long i, bad = 0;
+
+  for (i = 0; i < n; i++)
+    if (hits[i] != 1)
+      bad++;
+  printf("  %-12s %10.4f s  %ld tasks  %ld wrong\n", name, t, n, bad);
+  memset(hits, 0, n * sizeof(int));
+  return bad;
+}
+
+static void one_producer(long n)
+{
+  long i;
+
+#pragma omp parallel
+#pragma omp single
+  for (i = 0; i < n; i++) {
+#pragma omp task firstprivate(i)
+    hit(i);
+  }
+}
+
+static void all_producers(long n)
+{
+#pragma omp parallel
+  {
+    int me = omp_get_thread_num(), nthreads = omp_get_num_threads();
+    long i;
+
+    for (i = me; i < n; i += nthreads) {
+#pragma omp task firstprivate(i)
+      hit(i);
+    }
+  }
+}
+
+/* the first child gets most of the work: node covers [lo, hi) */
+static void tree(long lo, long hi)
+{
+  long split;
+
+  if (lo >= hi)
+    return;
+  hit(lo);
+  split = hi - (hi - lo - 1) / 8;
+
+#pragma omp task firstprivate(lo, split)
+  tree(lo + 1, split);
+#pragma omp task firstprivate(split, hi)
+  tree(split, hi);
+#pragma omp taskwait
+}
+
+static void unbalanced(long n)
+{
+#pragma omp parallel
+#pragma omp single
+  tree(0, n);
+}
+
+static double run(void (*fn)(long), long n)
+{
+  double t = omp_get_wtime();
+  fn(n);
+  return omp_get_wtime() - t;
+}
+
+int main(int argc, char **argv)
+{
+  long bad = 0;
+  int rep, reps;
+
+  num_tasks = argc > 1 ? atol(argv[1]) : 1000000;
+  reps = argc > 2 ? atoi(argv[2]) : 5;
+  if (num_tasks <= 0 || reps <= 0) {
+    fprintf(stderr, "usage: %s [tasks] [repetitions]\n", argv[0]);
+    return 1;
+  }
+  hits = calloc(num_tasks, sizeof(int));
+
+  printf("task queue stress, %d threads\n", omp_get_max_threads());
+  for (rep = 0; rep < reps; rep++) {
+    bad += check("one producer", num_tasks, run(one_producer, num_tasks));
+    bad += check("all threads", num_tasks, run(all_producers, num_tasks));
+    bad += check("unbalanced", num_tasks, run(unbalanced, num_tasks));
+  }
+  free(hits);
+
+  if (bad) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * taskloop against parallel for on load-imbalanced loops, e.g.
+ *   OMP_NUM_THREADS=4 ./imbalance 20000 64 256
+ * for 20000 iterations, grainsize(64) and num_tasks(256).
+ *
+ * In the triangular loop iteration i does work proportional to i, in the
+ * sparse loop a random tenth of the iterations do 50 times the work of
+ * the others.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+static int *cost;
+
+static double work(int i)
+{
+  double x = i;
+  int k;
+
+  for (k = 0; k < cost[i]; k++)
+    x = x * 0.999999 + 1.0;
+  return x;
+}
+
+static double run_static(int n)
+{
+  double sum = 0;
+  int i;
+
+#pragma omp parallel for schedule(static) reduction(+:sum)
+  for (i = 0; i < n; i++)
+    sum += work(i);
+  return sum;
+}
+
+static double run_dynamic(int n)
+{
+  double sum = 0;
+  int i;
+
+#pragma omp parallel for schedule(dynamic) reduction(+:sum)
+  for (i = 0; i < n; i++)
+    sum += work(i);
+  return sum;
+}
+
+/* 0 for grainsize and num_tasks takes the default chunking */
+static double run_taskloop(int n, int grain, int tasks)
+{
+  double *res = malloc(n * sizeof(double));
+  double sum = 0;
+  int i;
+
+#pragma omp parallel
+#pragma omp single
+  {
+    if (grain > 0) {
+#pragma omp taskloop grainsize(grain)
+      for (i = 0; i < n; i++)
+        res[i] = work(i);
+    } else if (tasks > 0) {
+#pragma omp taskloop num_tasks(tasks)
+      for (i = 0; i < n; i++)
+        res[i] = work(i);
+    } else {
+#pragma omp taskloop
+      for (i = 0; i < n; i++)
+        res[i] = work(i);
+    }
+  }
+
+  for (i = 0; i < n; i++)
+    sum += res[i];
+  free(res);
+  return sum;
+}
+
+static void report(const char *loop, const char *version, double t,
+                   double sum, double ref)
+{
+  double d = sum - ref;
+
+  printf("%-10s threads %3d %-22s %10.3f ms%s\n", loop,
+         omp_get_max_threads(), version, t * 1000,
+         d > 1e-6 * ref || d < -1e-6 * ref ? "  WRONG SUM" : "");
+}
+
+static void bench(const char *loop, int n, int grain, int tasks)
+{
+  char name[64];
+  double t, sum, ref;
+
+  t = omp_get_wtime();
+  ref = run_static(n);
+  report(loop, "for schedule(static)", omp_get_wtime() - t, ref, ref);
+
+  t = omp_get_wtime();
+  sum = run_dynamic(n);
+  report(loop, "for schedule(dynamic)", omp_get_wtime() - t, sum, ref);
+
+  t = omp_get_wtime();
+  sum = run_taskloop(n, 0, 0);
+  report(loop, "taskloop", omp_get_wtime() - t, sum, ref);
+
+  t = omp_get_wtime();
+  sum = run_taskloop(n, grain, 0);
+  sprintf(name, "taskloop grainsize(%d)", grain);
+  report(loop, name, omp_get_wtime() - t, sum, ref);
+
+  t = omp_get_wtime();
+  sum = run_taskloop(n, 0, tasks);
+  sprintf(name, "taskloop num_tasks(%d)", tasks);
+  report(loop, name, omp_get_wtime() - t, sum, ref);
+}
+
+int main(int argc, char **argv)
+{
+  int n = argc > 1 ? atoi(argv[1]) : 20000;
+  int grain = argc > 2 ? atoi(argv[2]) : 64;
+  int tasks = argc > 3 ? atoi(argv[3]) : 256;
+  int i;
+
+  cost = malloc(n * sizeof(int));
+
+  for (i = 0; i < n; i++)
+    cost[i] = i / 4;
+  bench("triangular", n, grain, tasks);
+
+  srand(1);
+  for (i = 0; i < n; i++)
+    cost[i] = rand() % 10 == 0 ? 50 * (n / 8) / 10 : (n / 8) / 10;
+  bench("sparse", n, grain, tasks);
+
+  free(cost);
+  return 0;
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+#
+# Runs the taskloop benchmark for 1, 2, 4, ... threads, e.g.
+#   ./run.sh 8 20000 64 256
+# for up to 8 threads, 20000 iterations, grainsize(64) and num_tasks(256).
+# imbalance has to be built first (see README).
+
+threads=${1:-4}
+n=${2:-20000}
+grain=${3:-64}
+tasks=${4:-256}
+
+t=1
+while [ $t -le $threads ]
+do
+  OMP_NUM_THREADS=$t ./imbalance $n $grain $tasks
+  t=`expr $t \* 2`
+done
@@ -38,10 +38,16 @@ LIBOPENMP_1.0 {
     __ompc_cur_numthreads;
     __ompc_reduction;
     __ompc_end_reduction;
+    __ompc_reduce;
     __ompc_ebarrier;
     __ompc_task_create;
+    __ompc_task_create_deps;
     __ompc_task_wait;
     __ompc_task_exit;
+    __ompc_taskloop_begin;
+    __ompc_taskloop_next;
+    __ompc_taskgroup_begin;
+    __ompc_taskgroup_end;
     __ompc_task_firstprivates_alloc;
     __ompc_task_firstprivates_free;
     __ompc_task_will_defer;
@@ -0,0 +1,665 @@
+/*
+ Thread Placement for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include "omp_rtl.h"
+#include "omp_util.h"
+#include "omp_affinity.h"
+
+/* Description: OMP_PLACES describes the places, either by name (threads,
+ * cores, ll_caches, numa_domains, sockets) or as an explicit list of
+ * processor sets. The named places are built from the topology the kernel
+ * exports under /sys/devices/system/cpu, so a place never straddles the
+ * unit it is named after, and neighbouring places are neighbours in the
+ * machine. OMP_PROC_BIND gives, per nesting level, how the threads of a
+ * team are spread over the partition of places of the thread forking it.
+ *
+ * Places are built once, from the processors the process may run on.
+ * Every thread carries its place and partition in its v_thread, and binds
+ * itself when it starts on a new task; a thread which stays on the same
+ * place does not make a system call.
+ */
+
+omp_place_t *__omp_places = NULL;
+int __omp_num_places = 0;
+int __omp_place_threads = 0;
+omp_place_info_t __omp_root_place_info = { 0, 0, 0 };
+
+static omp_proc_bind_policy_t __omp_proc_bind[OMP_MAX_BIND_LEVELS];
+static int __omp_num_bind_levels = 0;
+
+/* the place the calling thread is bound to */
+static __thread int __omp_bound_place = -1;
+
+#define SYS_CPU_DIR "/sys/devices/system/cpu"
+
+typedef struct {
+  int cpu;
+  int socket;
+  int node;
+  int llc;
+  int core;
+} omp_cpu_topology_t;
+
+static int __ompc_read_sys_int(const char *path, int dflt)
+{
+  FILE *f;
+  int val;
+
+  f = fopen(path, "r");
+  if (f == NULL)
+    return dflt;
+  /* for a processor list, the first processor */
+  if (fscanf(f, "%d", &val) != 1)
+    val = dflt;
+  fclose(f);
+  return val;
+}
+
+static int __ompc_cpu_numa_node(int cpu)
+{
+  char path[128];
+  DIR *dir;
+  struct dirent *entry;
+  int node = 0;
+
+  snprintf(path, sizeof(path), SYS_CPU_DIR "/cpu%d", cpu);
+  dir = opendir(path);
+  if (dir == NULL)
+    return 0;
+  while ((entry = readdir(dir)) != NULL) {
+    if (strncmp(entry->d_name, "node", 4) == 0 &&
+        isdigit(entry->d_name[4])) {
+      node = atoi(entry->d_name + 4);
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+}
+
+/* the last level cache of cpu, named after the first processor sharing it */
+static int __ompc_cpu_llc(int cpu)
+{
+  char path[128];
+  int index, level, best_level = -1, llc = cpu;
+
+  for (index = 0; ; index++) {
+    snprintf(path, sizeof(path), SYS_CPU_DIR "/cpu%d/cache/index%d/level",
+             cpu, index);
+    level = __ompc_read_sys_int(path, -1);
+    if (level < 0)
+      break;
+    if (level > best_level) {
+      best_level = level;
+      snprintf(path, sizeof(path),
+               SYS_CPU_DIR "/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+      llc = __ompc_read_sys_int(path, cpu);
+    }
+  }
+  return llc;
+}
+
+static int __ompc_cpu_topology_cmp(const void *a, const void *b)
+{
+  const omp_cpu_topology_t *x = a, *y = b;
+
+  if (x->socket != y->socket) return x->socket - y->socket;
+  if (x->node != y->node) return x->node - y->node;
+  if (x->llc != y->llc) return x->llc - y->llc;
+  if (x->core != y->core) return x->core - y->core;
+  return x->cpu - y->cpu;
+}
+
+/* the available processors, in topology order */
+static int __ompc_get_topology(cpu_set_t *available, omp_cpu_topology_t **topo)
+{
+  omp_cpu_topology_t *cpus;
+  char path[128];
+  int cpu, n = 0;
+
+  cpus = malloc(sizeof(omp_cpu_topology_t) * CPU_COUNT(available));
+  Is_True(cpus != NULL, ("Can't allocate the processor topology"));
+
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, available))
+      continue;
+    cpus[n].cpu = cpu;
+    snprintf(path, sizeof(path),
+             SYS_CPU_DIR "/cpu%d/topology/physical_package_id", cpu);
+    cpus[n].socket = __ompc_read_sys_int(path, 0);
+    snprintf(path, sizeof(path), SYS_CPU_DIR "/cpu%d/topology/core_id", cpu);
+    cpus[n].core = __ompc_read_sys_int(path, cpu);
+    cpus[n].node = __ompc_cpu_numa_node(cpu);
+    cpus[n].llc = __ompc_cpu_llc(cpu);
+    n++;
+  }
+
+  qsort(cpus, n, sizeof(omp_cpu_topology_t), __ompc_cpu_topology_cmp);
+  *topo = cpus;
+  return n;
+}
+
+static omp_place_t *__ompc_add_place(omp_place_t *places, int *num_places)
+{
+  places = realloc(places, sizeof(omp_place_t) * (*num_places + 1));
+  Is_True(places != NULL, ("Can't allocate __omp_places"));
+  CPU_ZERO(&places[*num_places].cpus);
+  places[*num_places].num_procs = 0;
+  (*num_places)++;
+  return places;
+}
+
+typedef enum {
+  OMP_PLACES_THREADS,
+  OMP_PLACES_CORES,
+  OMP_PLACES_LL_CACHES,
+  OMP_PLACES_NUMA_DOMAINS,
+  OMP_PLACES_SOCKETS
+} omp_places_kind_t;
+
+static int __ompc_place_key(omp_cpu_topology_t *cpu, omp_places_kind_t kind)
+{
+  switch (kind) {
+  case OMP_PLACES_CORES:        return cpu->socket * 65536 + cpu->core;
+  case OMP_PLACES_LL_CACHES:    return cpu->llc;
+  case OMP_PLACES_NUMA_DOMAINS: return cpu->node;
+  case OMP_PLACES_SOCKETS:      return cpu->socket;
+  default:                      return cpu->cpu;
+  }
+}
+
+/* one place per unit of the given kind, at most max_places of them */
+static omp_place_t *__ompc_named_places(cpu_set_t *available,
+                                        omp_places_kind_t kind,
+                                        int max_places, int *num_places)
+{
+  omp_cpu_topology_t *topo;
+  omp_place_t *places = NULL;
+  int i, n, key = 0;
+
+  *num_places = 0;
+  n = __ompc_get_topology(available, &topo);
+  for (i = 0; i < n; i++) {
+    if (i == 0 || __ompc_place_key(&topo[i], kind) != key) {
+      if (*num_places == max_places)
+        break;
+      places = __ompc_add_place(places, num_places);
+      key = __ompc_place_key(&topo[i], kind);
+    }
+    CPU_SET(topo[i].cpu, &places[*num_places - 1].cpus);
+  }
+  free(topo);
+  return places;
+}
+
+static void __ompc_skip_spaces(char **s)
+{
+  while (isspace(**s))
+    (*s)++;
+}
+
+static int __ompc_parse_number(char **s, int *val)
+{
+  char *end;
+
+  __ompc_skip_spaces(s);
+  *val = (int)strtol(*s, &end, 10);
+  if (end == *s)
+    return 0;
+  *s = end;
+  __ompc_skip_spaces(s);
+  return 1;
+}
+
+/* [':' len [':' stride]], len defaults to 1 and stride to 1 */
+static int __ompc_parse_interval(char **s, int *len, int *stride)
+{
+  *len = 1;
+  *stride = 1;
+  if (**s != ':')
+    return 1;
+  (*s)++;
+  if (!__ompc_parse_number(s, len) || *len <= 0)
+    return 0;
+  if (**s != ':')
+    return 1;
+  (*s)++;
+  return __ompc_parse_number(s, stride);
+}
+
+static int __ompc_valid_cpu(int cpu)
+{
+  return cpu >= 0 && cpu < CPU_SETSIZE;
+}
+
+/* '{' res [':' len [':' stride]] | '!' res, ... '}' */
+static int __ompc_parse_place(char **s, cpu_set_t *cpus)
+{
+  int res, len, stride, exclude, i;
+
+  CPU_ZERO(cpus);
+  __ompc_skip_spaces(s);
+  if (**s != '{')
+    return 0;
+  (*s)++;
+  for (;;) {
+    __ompc_skip_spaces(s);
+    exclude = (**s == '!');
+    if (exclude)
+      (*s)++;
+    if (!__ompc_parse_number(s, &res))
+      return 0;
+    if (exclude) {
+      if (!__ompc_valid_cpu(res))
+        return 0;
+      CPU_CLR(res, cpus);
+    } else {
+      if (!__ompc_parse_interval(s, &len, &stride))
+        return 0;
+      for (i = 0; i < len; i++) {
+        if (!__ompc_valid_cpu(res + i * stride))
+          return 0;
+        CPU_SET(res + i * stride, cpus);
+      }
+    }
+    if (**s == '}')
+      break;
+    if (**s != ',')
+      return 0;
+    (*s)++;
+  }
+  (*s)++;
+  __ompc_skip_spaces(s);
+  return 1;
+}
+
+/* place [':' len [':' stride]], ... */
+static omp_place_t *__ompc_explicit_places(char *s, int *num_places)
+{
+  omp_place_t *places = NULL;
+  cpu_set_t cpus;
+  int len, stride, i, cpu;
+
+  *num_places = 0;
+  for (;;) {
+    __ompc_skip_spaces(&s);
+    if (*s == '!') {
+      Warning("OMP_PLACES: excluded places are not supported, "
+              "the exclusion is ignored");
+      s++;
+      if (!__ompc_parse_place(&s, &cpus))
+        return NULL;
+    } else {
+      if (!__ompc_parse_place(&s, &cpus) ||
+          !__ompc_parse_interval(&s, &len, &stride))
+        return NULL;
+      for (i = 0; i < len; i++) {
+        places = __ompc_add_place(places, num_places);
+        for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+          if (!CPU_ISSET(cpu, &cpus))
+            continue;
+          if (!__ompc_valid_cpu(cpu + i * stride))
+            return NULL;
+          CPU_SET(cpu + i * stride, &places[*num_places - 1].cpus);
+        }
+      }
+    }
+    if (*s == '\0')
+      break;
+    if (*s != ',')
+      return NULL;
+    s++;
+  }
+  return places;
+}
+
+static void __ompc_init_places(cpu_set_t *available)
+{
+  static const struct {
+    const char *name;
+    omp_places_kind_t kind;
+  } names[] = {
+    { "threads", OMP_PLACES_THREADS },
+    { "cores", OMP_PLACES_CORES },
+    { "ll_caches", OMP_PLACES_LL_CACHES },
+    { "numa_domains", OMP_PLACES_NUMA_DOMAINS },
+    { "sockets", OMP_PLACES_SOCKETS }
+  };
+  char *env_var_str, *s;
+  int i, j, len, max_places;
+
+  env_var_str = getenv("OMP_PLACES");
+  if (env_var_str == NULL)
+    env_var_str = "cores";
+  s = env_var_str;
+  __ompc_skip_spaces(&s);
+
+  if (*s == '{') {
+    __omp_places = __ompc_explicit_places(s, &__omp_num_places);
+    if (__omp_places == NULL)
+      Not_Valid("OMP_PLACES should be threads|cores|ll_caches|"
+                "numa_domains|sockets[(n)] or a list of places "
+                "like {0:4},{4:4}");
+  } else {
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+      len = strlen(names[i].name);
+      if (strncasecmp(s, names[i].name, len) == 0)
+        break;
+    }
+    if (i == sizeof(names) / sizeof(names[0]))
+      Not_Valid("OMP_PLACES should be threads|cores|ll_caches|"
+                "numa_domains|sockets[(n)] or a list of places "
+                "like {0:4},{4:4}");
+    s += len;
+    __ompc_skip_spaces(&s);
+    max_places = CPU_SETSIZE;
+    if (*s == '(') {
+      s++;
+      if (!__ompc_parse_number(&s, &max_places) || max_places <= 0 ||
+          *s != ')')
+        Not_Valid("OMP_PLACES: the number of places should be a "
+                  "positive integer");
+      s++;
+      __ompc_skip_spaces(&s);
+    }
+    if (*s != '\0')
+      Not_Valid("OMP_PLACES: trailing characters after the place name");
+    __omp_places = __ompc_named_places(available, names[i].kind,
+                                       max_places, &__omp_num_places);
+  }
+
+  /* only keep the processors the process may run on */
+  for (i = 0, j = 0; i < __omp_num_places; i++) {
+    CPU_AND(&__omp_places[j].cpus, &__omp_places[i].cpus, available);
+    __omp_places[j].num_procs = CPU_COUNT(&__omp_places[j].cpus);
+    if (__omp_places[j].num_procs > 0)
+      j++;
+  }
+  __omp_num_places = j;
+  Is_Valid(__omp_num_places > 0,
+           ("OMP_PLACES: no place holds an available processor"));
+}
+
+static void __ompc_init_proc_bind(void)
+{
+  static const struct {
+    const char *name;
+    omp_proc_bind_policy_t policy;
+  } names[] = {
+    { "false", OMP_PROC_BIND_FALSE },
+    { "true", OMP_PROC_BIND_TRUE },
+    { "master", OMP_PROC_BIND_MASTER },
+    { "primary", OMP_PROC_BIND_MASTER },
+    { "close", OMP_PROC_BIND_CLOSE },
+    { "spread", OMP_PROC_BIND_SPREAD }
+  };
+  char *env_var_str, *s;
+  int i, len;
+
+  env_var_str = getenv("OMP_PROC_BIND");
+  if (env_var_str == NULL) {
+    /* OMP_PLACES alone asks for binding */
+    __omp_proc_bind[0] = OMP_PROC_BIND_TRUE;
+    __omp_num_bind_levels = 1;
+    return;
+  }
+
+  s = env_var_str;
+  for (;;) {
+    __ompc_skip_spaces(&s);
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+      len = strlen(names[i].name);
+      if (strncasecmp(s, names[i].name, len) == 0)
+        break;
+    }
+    if (i == sizeof(names) / sizeof(names[0]) ||
+        __omp_num_bind_levels == OMP_MAX_BIND_LEVELS)
+      Not_Valid("OMP_PROC_BIND should be a list of "
+                "true|false|master|close|spread");
+    __omp_proc_bind[__omp_num_bind_levels++] = names[i].policy;
+    s += len;
+    __ompc_skip_spaces(&s);
+    if (*s == '\0')
+      break;
+    if (*s != ',')
+      Not_Valid("OMP_PROC_BIND should be a list of "
+                "true|false|master|close|spread");
+    s++;
+  }
+}
+
+int __ompc_affinity_init(void)
+{
+  cpu_set_t available;
+  int return_val;
+
+  if (getenv("OMP_PLACES") == NULL && getenv("OMP_PROC_BIND") == NULL)
+    return -1;
+
+  __ompc_init_proc_bind();
+  if (__omp_proc_bind[0] == OMP_PROC_BIND_FALSE)
+    return 0;
+
+  return_val = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                      &available);
+  Is_True(return_val == 0, ("Get affinity error"));
+  __ompc_init_places(&available);
+
+  __omp_place_threads = 1;
+  __omp_root_place_info.place = 0;
+  __omp_root_place_info.partition_first = 0;
+  __omp_root_place_info.partition_len = __omp_num_places;
+  return 1;
+}
+
+/* the policy for the teams forked at the given nesting level, as set */
+omp_proc_bind_policy_t __ompc_affinity_policy(int level)
+{
+  if (__omp_num_bind_levels == 0)
+    return OMP_PROC_BIND_FALSE;
+  if (level < 1)
+    level = 1;
+  if (level > __omp_num_bind_levels)
+    level = __omp_num_bind_levels;
+  return __omp_proc_bind[level - 1];
+}
+
+/* which of len places thread i of a team of team_size takes, counting from
+ * the place of the forking thread; with more threads than places, threads
+ * come in consecutive groups and the first groups get one thread more */
+static int __ompc_affinity_subset(int i, int team_size, int len)
+{
+  int per_place, extra;
+
+  if (team_size <= len)
+    return i;
+  per_place = team_size / len;
+  extra = team_size % len;
+  if (i < extra * (per_place + 1))
+    return i / (per_place + 1);
+  return extra + (i - extra * (per_place + 1)) / per_place;
+}
+
+void __ompc_affinity_place_thread(omp_place_info_t *parent,
+                                  int team_size, int level, int i,
+                                  omp_place_info_t *info)
+{
+  omp_proc_bind_policy_t policy;
+  int first, len, p, size, extra, k;
+
+  *info = *parent;
+  if (!__omp_place_threads || parent->partition_len <= 0)
+    return;
+
+  first = parent->partition_first;
+  len = parent->partition_len;
+  p = parent->place - first;
+  if (p < 0 || p >= len)
+    p = 0;
+
+  policy = __ompc_affinity_policy(level);
+  if (policy == OMP_PROC_BIND_TRUE)
+    policy = level <= 1 ? OMP_PROC_BIND_SPREAD : OMP_PROC_BIND_CLOSE;
+
+  switch (policy) {
+  case OMP_PROC_BIND_CLOSE:
+    info->place = first + (p + __ompc_affinity_subset(i, team_size, len)) % len;
+    break;
+
+  case OMP_PROC_BIND_SPREAD:
+    if (team_size > len) {
+      info->place = first +
+          (p + __ompc_affinity_subset(i, team_size, len)) % len;
+      info->partition_first = info->place;
+      info->partition_len = 1;
+      break;
+    }
+    /* team_size subpartitions, the first len % team_size one place
+     * larger; thread 0 keeps the place of the forking thread and the
+     * others take the first place of the subpartitions after it */
+    size = len / team_size;
+    extra = len % team_size;
+    if (p < extra * (size + 1))
+      k = p / (size + 1);
+    else
+      k = extra + (p - extra * (size + 1)) / size;
+    k = (k + i) % team_size;
+    info->partition_first = first + k * size + (k < extra ? k : extra);
+    info->partition_len = size + (k < extra);
+    info->place = i == 0 ? parent->place : info->partition_first;
+    break;
+
+  default:
+    /* master, or unbound below: where the forking thread is */
+    break;
+  }
+}
+
+void __ompc_affinity_bind(omp_place_info_t *info)
+{
+  int return_val;
+
+  if (!__omp_place_threads || info->place == __omp_bound_place)
+    return;
+
+  return_val = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                      &__omp_places[info->place].cpus);
+  Is_True(return_val == 0, ("Set affinity error"));
+  __omp_bound_place = info->place;
+}
+
+void __ompc_affinity_print_proc_bind(void)
+{
+  static const char *names[] = { "false", "true", "master", "close", "spread" };
+  int i;
+
+  fprintf(stderr, "__omp_proc_bind = ");
+  if (__omp_num_bind_levels == 0)
+    fprintf(stderr, "unset");
+  for (i = 0; i < __omp_num_bind_levels; i++)
+    fprintf(stderr, "%s%s", i ? "," : "", names[__omp_proc_bind[i]]);
+  fprintf(stderr, "\n");
+}
+
+void __ompc_affinity_print_places(void)
+{
+  int i, cpu, n;
+
+  fprintf(stderr, "__omp_places = ");
+  if (__omp_num_places == 0)
+    fprintf(stderr, "unset");
+  for (i = 0; i < __omp_num_places; i++) {
+    fprintf(stderr, "%s{", i ? "," : "");
+    for (cpu = 0, n = 0; cpu < CPU_SETSIZE; cpu++)
+      if (CPU_ISSET(cpu, &__omp_places[i].cpus))
+        fprintf(stderr, "%s%d", n++ ? "," : "", cpu);
+    fprintf(stderr, "}");
+  }
+  fprintf(stderr, "\n");
+}
+
+int __ompc_get_proc_bind(void)
+{
+  if (!__omp_place_threads)
+    return OMP_PROC_BIND_FALSE;
+  return __ompc_affinity_policy(__omp_current_v_thread->team->team_level + 1);
+}
+
+int __ompc_get_num_places(void)
+{
+  return __omp_num_places;
+}
+
+int __ompc_get_place_num_procs(int place)
+{
+  if (place < 0 || place >= __omp_num_places)
+    return 0;
+  return __omp_places[place].num_procs;
+}
+
+void __ompc_get_place_proc_ids(int place, int *ids)
+{
+  int cpu, n = 0;
+
+  if (place < 0 || place >= __omp_num_places)
+    return;
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    if (CPU_ISSET(cpu, &__omp_places[place].cpus))
+      ids[n++] = cpu;
+}
+
+int __ompc_get_place_num(void)
+{
+  if (!__omp_place_threads)
+    return -1;
+  return __omp_current_v_thread->place_info.place;
+}
+
+int __ompc_get_partition_num_places(void)
+{
+  if (!__omp_place_threads)
+    return 0;
+  return __omp_current_v_thread->place_info.partition_len;
+}
+
+void __ompc_get_partition_place_nums(int *place_nums)
+{
+  omp_place_info_t *info = &__omp_current_v_thread->place_info;
+  int i;
+
+  if (!__omp_place_threads)
+    return;
+  for (i = 0; i < info->partition_len; i++)
+    place_nums[i] = info->partition_first + i;
+}
@@ -0,0 +1,92 @@
+/*
+ Thread Placement for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#ifndef __omp_affinity_included
+#define __omp_affinity_included
+
+#include <sched.h>
+
+/* OMP_PROC_BIND policies, with the values of omp_proc_bind_t */
+typedef enum {
+  OMP_PROC_BIND_FALSE  = 0,
+  OMP_PROC_BIND_TRUE   = 1,
+  OMP_PROC_BIND_MASTER = 2,
+  OMP_PROC_BIND_CLOSE  = 3,
+  OMP_PROC_BIND_SPREAD = 4
+} omp_proc_bind_policy_t;
+
+/* one policy per nesting level, the last one holds for deeper levels */
+#define OMP_MAX_BIND_LEVELS 8
+
+/* A place is a set of processors a thread may run on. The places are
+ * ordered by socket, NUMA node, last level cache and core, so that
+ * neighbouring places share as much as possible. */
+typedef struct {
+  cpu_set_t cpus;
+  int num_procs;
+} omp_place_t;
+
+/* Where a thread runs: its place, and the contiguous range of places
+ * [partition_first, partition_first + partition_len) from which the
+ * threads of the teams it forks are placed. */
+typedef struct {
+  int place;
+  int partition_first;
+  int partition_len;
+} omp_place_info_t;
+
+extern omp_place_t *__omp_places;
+extern int __omp_num_places;
+
+/* threads are placed by OMP_PLACES/OMP_PROC_BIND rather than
+ * O64_OMP_SET_AFFINITY */
+extern int __omp_place_threads;
+
+extern omp_place_info_t __omp_root_place_info;
+
+/* -1 when neither OMP_PLACES nor OMP_PROC_BIND is set, 0 when threads
+ * are not to be bound, 1 when they are bound to places */
+extern int __ompc_affinity_init(void);
+extern omp_proc_bind_policy_t __ompc_affinity_policy(int level);
+extern void __ompc_affinity_place_thread(omp_place_info_t *parent,
+                                         int team_size, int level, int i,
+                                         omp_place_info_t *info);
+extern void __ompc_affinity_bind(omp_place_info_t *info);
+extern void __ompc_affinity_print_proc_bind(void);
+extern void __ompc_affinity_print_places(void);
+
+/* for the OpenMP place API */
+extern int __ompc_get_proc_bind(void);
+extern int __ompc_get_num_places(void);
+extern int __ompc_get_place_num_procs(int place);
+extern void __ompc_get_place_proc_ids(int place, int *ids);
+extern int __ompc_get_place_num(void);
+extern int __ompc_get_partition_num_places(void);
+extern void __ompc_get_partition_place_nums(int *place_nums);
+
+#endif /* __omp_affinity_included */
@@ -202,6 +202,8 @@ typedef enum {
 	OMP_REQ_STOP = 6,
 	OMP_REQ_PAUSE = 7,
 	OMP_REQ_RESUME = 8,
+	OMP_REQ_TASK_ALLOC_STATS = 9,	/* Open64 extension */
+	OMP_REQ_REGION_STATS = 10,	/* Open64 extension */
 	OMP_REQ_LAST
 } OMP_COLLECTORAPI_REQUEST;
 
@@ -322,8 +324,67 @@ typedef enum {
  *	   Return Value: none
  *	   Async-signal-safe: no
  *
+ *    OMP_REQ_TASK_ALLOC_STATS
+ *		Returns the counters of the per-thread task allocator,
+ *		summed over all threads: task descriptors and firstprivate
+ *		frames handed out, frees by the owning thread and by other
+ *		threads, the batches in which the latter were handed back,
+ *		and the slabs allocated.  The counters are read without
+ *		stopping the threads, so they are only a snapshot.
+ *		May be called from any thread.
+ *
+ *	   Input parameters: none
+ *	   Return Value: omp_task_alloc_stats_t
+ *	   Async-signal-safe: no
+ *
+ *    OMP_REQ_REGION_STATS
+ *		Returns the time each thread spent in each parallel region,
+ *		split by what it was doing, as one omp_region_stats_t per
+ *		region and thread. The time is only accounted when the
+ *		program runs with O64_OMP_REGION_STATS set, otherwise
+ *		OMP_ERRCODE_UNSUPPORTED is returned. If mem cannot hold all
+ *		the records, OMP_ERRCODE_MEM_TOO_SMALL is returned, mem holds
+ *		as many as fit and rsz is the size needed for all of them.
+ *		The counters are read without stopping the threads, so they
+ *		are only a snapshot. May be called from any thread.
+ *
+ *	   Input parameters: none
+ *	   Return Value: array of omp_region_stats_t
+ *	   Async-signal-safe: no
+ *
  */
 
+typedef struct {
+	unsigned long task_allocs;	/* task descriptors */
+	unsigned long frame_allocs;	/* firstprivate frames from a size class */
+	unsigned long large_allocs;	/* frames too big for a size class */
+	unsigned long local_frees;	/* freed by the owning thread */
+	unsigned long remote_frees;	/* freed by another thread */
+	unsigned long remote_batches;	/* chains handed back to their owner */
+	unsigned long slabs;		/* slabs allocated */
+} omp_task_alloc_stats_t;
+
+/* What the time of a thread in a region is counted as */
+typedef enum {
+	OMP_REGION_STATS_WORK = 0,	/* THR_WORK_STATE, and running tasks */
+	OMP_REGION_STATS_BARRIER = 1,	/* THR_IBAR_STATE, THR_EBAR_STATE */
+	OMP_REGION_STATS_OVERHEAD = 2,	/* THR_OVHD_STATE: fork, join, loop scheduling */
+	OMP_REGION_STATS_REDUCTION = 3,	/* THR_REDUC_STATE */
+	OMP_REGION_STATS_SYNC = 4,	/* THR_LKWT, THR_CTWT, THR_ODWT, THR_ATWT_STATE */
+	OMP_REGION_STATS_TASK_STEAL = 5,/* taking tasks from the task pools */
+	OMP_REGION_STATS_IDLE = 6,	/* THR_IDLE_STATE, THR_SERIAL_STATE */
+	OMP_REGION_STATS_LAST
+} OMP_REGION_STATS_COUNTER;
+
+typedef struct {
+	void *region;		/* outlined function of the region, NULL
+				   for the time outside of any region */
+	int thread;		/* threads are numbered as they first run */
+	unsigned long entries;	/* times the thread entered the region */
+	unsigned long tasks;	/* tasks taken from the task pools */
+	unsigned long long ns[OMP_REGION_STATS_LAST];
+} omp_region_stats_t;
+
 
 /******************************************************************
  *  Return Codes in the 'ec' Field
@@ -30,6 +30,7 @@
 #include "omp_rtl.h"
 #include "omp_lock.h"
 #include "omp_collector_api.h"
+#include "omp_task_alloc.h"
 #include <assert.h>
 
 char OMP_EVENT_NAME[22][50]= {
@@ -83,6 +84,8 @@ int unregister_event(omp_collector_message *req);
 int return_state(omp_collector_message *req);
 int return_current_prid(omp_collector_message *req);
 int return_parent_prid(omp_collector_message *req);
+int return_task_alloc_stats(omp_collector_message *req);
+int return_region_stats(omp_collector_message *req);
 
 extern omp_v_thread_t* __omp_level_1_team;
 
@@ -293,6 +296,14 @@ int process_top_request(omp_collector_message *req)
     __ompc_req_resume(req);
     break;
 
+  case OMP_REQ_TASK_ALLOC_STATS:
+    return_task_alloc_stats(req);
+    break;
+
+  case OMP_REQ_REGION_STATS:
+    return_region_stats(req);
+    break;
+
   default:
     *(req->ec) = OMP_ERRCODE_UNKNOWN;
     *(req->rsz) = 0;   
@@ -478,6 +489,41 @@ int return_parent_prid(omp_collector_message *req)
   return 1;
 }
        
+int return_task_alloc_stats(omp_collector_message *req)
+{
+  if((req->sz - 4*sizeof(int)) < sizeof(omp_task_alloc_stats_t)) {
+    *(req->rsz)=0;
+    *(req->ec) = OMP_ERRCODE_MEM_TOO_SMALL;
+    return 0;
+  }
+
+  __ompc_task_alloc_get_stats((omp_task_alloc_stats_t *) req->mem);
+  *(req->rsz)=sizeof(omp_task_alloc_stats_t);
+  *(req->ec) = OMP_ERRCODE_OK;
+  return 1;
+}
+
+int return_region_stats(omp_collector_message *req)
+{
+  int max, n;
+
+  if (!__omp_region_stats) {
+    *(req->rsz)=0;
+    *(req->ec) = OMP_ERRCODE_UNSUPPORTED;
+    return 0;
+  }
+
+  max = (req->sz - 4*sizeof(int)) / sizeof(omp_region_stats_t);
+  n = __ompc_region_stats_get((omp_region_stats_t *) req->mem, max);
+  *(req->rsz) = n * sizeof(omp_region_stats_t);
+  if (n > max) {
+    *(req->ec) = OMP_ERRCODE_MEM_TOO_SMALL;
+    return 0;
+  }
+  *(req->ec) = OMP_ERRCODE_OK;
+  return 1;
+}
+
 void __omp_collector_init() {
   __ompc_init_spinlock(&init_lock);
   __ompc_init_spinlock(&paused_lock);
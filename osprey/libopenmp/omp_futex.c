@@ -0,0 +1,191 @@
+/*
+ Futex Based Waiting for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "omp_rtl.h"
+#include "omp_futex.h"
+
+/* Description: each thread keeps a moving average of how long its recent
+ * waits took, counted in __ompc_cpu_relax iterations. A wait which ended
+ * while spinning counts the iterations it spun, a wait which slept counts
+ * its spin plus the time asleep, converted with the cost of one iteration
+ * measured in __ompc_futex_init. A thread spins up to twice its average
+ * before it sleeps, so that it catches the wake-ups it can expect soon
+ * without burning a time slice on those it can't. When the average is
+ * beyond O64_OMP_SPIN_COUNT, spinning is not worth it and the thread only
+ * spins OMP_FUTEX_MIN_SPIN times, which still covers a wake-up that is
+ * already on its way.
+ *
+ * With more threads in the level-1 team than processors, the thread a
+ * waiter waits for may well need its processor, and the short sleeps this
+ * leads to would look like waits worth spinning for. Threads then always
+ * spin only OMP_FUTEX_MIN_SPIN times.
+ */
+
+/* picoseconds per __ompc_cpu_relax iteration */
+static long __omp_futex_spin_ps = 1000;
+
+static __thread long __omp_futex_wait_avg = -1;
+static __thread long __omp_futex_spin_limit = -1;
+
+static inline long __ompc_futex_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static inline long __ompc_futex_get_spin_limit(void)
+{
+  if (__omp_level_1_team_size > __omp_num_processors)
+    return __omp_spin_count < OMP_FUTEX_MIN_SPIN ?
+        __omp_spin_count : OMP_FUTEX_MIN_SPIN;
+  if (__omp_futex_spin_limit < 0)
+    __omp_futex_spin_limit = __omp_spin_count;
+  return __omp_futex_spin_limit;
+}
+
+static void __ompc_futex_record(long spins)
+{
+  long avg = __omp_futex_wait_avg;
+
+  avg = avg < 0 ? spins : (3 * avg + spins) / 4;
+  __omp_futex_wait_avg = avg;
+
+  if (2 * avg <= __omp_spin_count)
+    __omp_futex_spin_limit = 2 * avg > OMP_FUTEX_MIN_SPIN ?
+        2 * avg : OMP_FUTEX_MIN_SPIN;
+  else
+    __omp_futex_spin_limit = OMP_FUTEX_MIN_SPIN;
+
+  if (__omp_futex_spin_limit > __omp_spin_count)
+    __omp_futex_spin_limit = __omp_spin_count;
+}
+
+static inline long __ompc_futex_slept_spins(long start_ns)
+{
+  long slept = __ompc_futex_now_ns() - start_ns;
+
+  /* anything beyond a millisecond is just long */
+  if (slept > 1000000)
+    slept = 1000000;
+  return slept * 1000 / __omp_futex_spin_ps;
+}
+
+void __ompc_futex_init(void)
+{
+  long start, elapsed;
+  int i;
+
+  start = __ompc_futex_now_ns();
+  for (i = 0; i < 10000; i++)
+    __ompc_cpu_relax();
+  elapsed = __ompc_futex_now_ns() - start;
+
+  /* 10000 iterations, in picoseconds each */
+  __omp_futex_spin_ps = elapsed / 10;
+  if (__omp_futex_spin_ps <= 0)
+    __omp_futex_spin_ps = 1;
+}
+
+/* sleep as long as *word == old, at most timeout_ns if not 0; may return
+ * early for no reason */
+void __ompc_futex_sleep(volatile int *word, int old, long timeout_ns)
+{
+  struct timespec ts, *tsp = NULL;
+
+  if (timeout_ns > 0) {
+    ts.tv_sec = timeout_ns / 1000000000L;
+    ts.tv_nsec = timeout_ns % 1000000000L;
+    tsp = &ts;
+  }
+  syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, old, tsp, NULL, 0);
+}
+
+void __ompc_futex_wake(volatile int *word, int count)
+{
+  syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/* Wait until *word != old. With a timeout, returns after at most one sleep
+ * of timeout_ns whether the word changed or not, so the caller must check
+ * again. */
+void __ompc_futex_wait(volatile int *word, int old, volatile int *waiters,
+                       long timeout_ns)
+{
+  long i, limit, start;
+
+  limit = __ompc_futex_get_spin_limit();
+  for (i = 0; i < limit; i++) {
+    if (*word != old) {
+      __ompc_futex_record(i);
+      return;
+    }
+    __ompc_cpu_relax();
+  }
+
+  start = __ompc_futex_now_ns();
+  __ompc_atomic_inc(waiters);
+  if (timeout_ns > 0) {
+    if (*word == old)
+      __ompc_futex_sleep(word, old, timeout_ns);
+  } else {
+    while (*word == old)
+      __ompc_futex_sleep(word, old, 0);
+  }
+  __ompc_atomic_dec(waiters);
+
+  __ompc_futex_record(limit + __ompc_futex_slept_spins(start));
+}
+
+/* the slow path of __ompc_futex_lock */
+void __ompc_futex_lock_wait(volatile int *lock)
+{
+  long i, limit, start;
+
+  limit = __ompc_futex_get_spin_limit();
+  for (i = 0; i < limit; i++) {
+    __ompc_cpu_relax();
+    if (*lock == 0 && __ompc_cas(lock, 0, 1)) {
+      __ompc_futex_record(i);
+      return;
+    }
+  }
+
+  /* from here on the word says 2, so the owner wakes somebody on unlock */
+  start = __ompc_futex_now_ns();
+  while (__sync_lock_test_and_set(lock, 2) != 0)
+    __ompc_futex_sleep(lock, 2, 0);
+
+  __ompc_futex_record(limit + __ompc_futex_slept_spins(start));
+}
@@ -0,0 +1,97 @@
+/*
+ Futex Based Waiting for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#ifndef __omp_futex_included
+#define __omp_futex_included
+
+#include <limits.h>
+#include "omp_sys.h"
+
+/* A thread waiting for a word to change spins for a while, then sleeps in
+ * the kernel until it is woken. How long it spins follows the waits the
+ * thread has seen lately, bounded by O64_OMP_SPIN_COUNT.
+ *
+ * Every word which is waited on has a count of the threads sleeping on it,
+ * so that a wake is only a system call when somebody sleeps. A waiter
+ * raises the count before it checks the word for the last time, the waker
+ * changes the word before it reads the count, and both sides have a full
+ * fence in between. */
+
+/* the shortest spin before sleeping, in __ompc_cpu_relax iterations */
+#define OMP_FUTEX_MIN_SPIN  64
+
+extern void __ompc_futex_init(void);
+extern void __ompc_futex_sleep(volatile int *word, int old, long timeout_ns);
+extern void __ompc_futex_wake(volatile int *word, int count);
+extern void __ompc_futex_wait(volatile int *word, int old,
+                              volatile int *waiters, long timeout_ns);
+
+extern void __ompc_futex_lock_wait(volatile int *lock);
+
+/* wake every thread asleep on word, after word has been changed */
+static inline void
+__ompc_futex_wake_all(volatile int *word, volatile int *waiters)
+{
+  __ompc_mfence();
+  if (*waiters != 0)
+    __ompc_futex_wake(word, INT_MAX);
+}
+
+/* the aligned word which holds the byte flag at p, for flags which share
+ * a word with others */
+static inline volatile int *
+__ompc_futex_word(volatile void *p)
+{
+  return (volatile int *)((unsigned long)p & ~(sizeof(int) - 1));
+}
+
+/* Lock word: 0 unlocked, 1 locked, 2 locked and maybe contended. The
+ * owner only makes a system call on unlock when the word was 2. */
+static inline void
+__ompc_futex_lock(volatile int *lock)
+{
+  if (!__ompc_cas(lock, 0, 1))
+    __ompc_futex_lock_wait(lock);
+}
+
+static inline int
+__ompc_futex_trylock(volatile int *lock)
+{
+  return __ompc_cas(lock, 0, 1);
+}
+
+static inline void
+__ompc_futex_unlock(volatile int *lock)
+{
+  if (__sync_fetch_and_sub(lock, 1) != 1) {
+    *lock = 0;
+    __ompc_futex_wake(lock, 1);
+  }
+}
+
+#endif /* __omp_futex_included */
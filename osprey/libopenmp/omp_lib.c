@@ -158,6 +158,76 @@ omp_get_nested(void)
 
 omp_int_t omp_get_nested_(void);
 #pragma weak omp_get_nested_ = omp_get_nested
+
+/*
+ * Thread Affinity Functions
+ */
+omp_proc_bind_t
+omp_get_proc_bind(void)
+{
+  return (omp_proc_bind_t)__ompc_get_proc_bind();
+}
+
+omp_proc_bind_t omp_get_proc_bind_(void);
+#pragma weak omp_get_proc_bind_ = omp_get_proc_bind
+
+omp_int_t
+omp_get_num_places(void)
+{
+  return (omp_int_t)__ompc_get_num_places();
+}
+
+omp_int_t omp_get_num_places_(void);
+#pragma weak omp_get_num_places_ = omp_get_num_places
+
+omp_int_t
+omp_get_place_num_procs(omp_int_t place_num)
+{
+  return (omp_int_t)__ompc_get_place_num_procs(place_num);
+}
+
+omp_int_t omp_get_place_num_procs_(omp_int_t *place_num)
+{
+  return (omp_int_t)__ompc_get_place_num_procs(*place_num);
+}
+
+void
+omp_get_place_proc_ids(omp_int_t place_num, omp_int_t *ids)
+{
+  __ompc_get_place_proc_ids(place_num, ids);
+}
+
+void omp_get_place_proc_ids_(omp_int_t *place_num, omp_int_t *ids)
+{
+  __ompc_get_place_proc_ids(*place_num, ids);
+}
+
+omp_int_t
+omp_get_place_num(void)
+{
+  return (omp_int_t)__ompc_get_place_num();
+}
+
+omp_int_t omp_get_place_num_(void);
+#pragma weak omp_get_place_num_ = omp_get_place_num
+
+omp_int_t
+omp_get_partition_num_places(void)
+{
+  return (omp_int_t)__ompc_get_partition_num_places();
+}
+
+omp_int_t omp_get_partition_num_places_(void);
+#pragma weak omp_get_partition_num_places_ = omp_get_partition_num_places
+
+void
+omp_get_partition_place_nums(omp_int_t *place_nums)
+{
+  __ompc_get_partition_place_nums(place_nums);
+}
+
+void omp_get_partition_place_nums_(omp_int_t *place_nums);
+#pragma weak omp_get_partition_place_nums_ = omp_get_partition_place_nums
 /*
  * Lock Functions
  */
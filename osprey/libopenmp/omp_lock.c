@@ -42,14 +42,17 @@
 #include "omp_lock.h"
 #include "omp_rtl.h"
 #include "omp_sys.h"
+#include "omp_futex.h"
 
+/* User locks are futex locks which spin a while before they sleep, or
+ * pthread spin locks with O64_OMP_SPIN_USER_LOCK. */
 extern int __omp_spin_user_lock;
 
 inline void 
 __ompc_init_lock (volatile ompc_lock_t *lp)
 {
   if (__omp_spin_user_lock == 0)
-    pthread_mutex_init(&(lp->lock.mutex_data), NULL);
+    lp->lock.futex_data = 0;
   else
     pthread_spin_init(&(lp->lock.spin_data), PTHREAD_PROCESS_PRIVATE);
 }
@@ -81,7 +84,7 @@ void
 __ompc_lock(volatile ompc_lock_t *lp)
 {
   if (__omp_spin_user_lock == 0)
-    pthread_mutex_lock(&(lp->lock.mutex_data));
+    __ompc_futex_lock(&(lp->lock.futex_data));
   else 
     pthread_spin_lock(&(lp->lock.spin_data));
 }
@@ -92,7 +95,7 @@ inline void
 __ompc_unlock (volatile ompc_lock_t *lp)
 {
   if (__omp_spin_user_lock == 0)
-    pthread_mutex_unlock(&(lp->lock.mutex_data));
+    __ompc_futex_unlock(&(lp->lock.futex_data));
   else 
     pthread_spin_unlock(&(lp->lock.spin_data));
 
@@ -109,9 +112,7 @@ __ompc_unlock_s(volatile ompc_lock_t *lp)
 inline void 
 __ompc_destroy_lock (volatile ompc_lock_t *lp)
 {
-  if (__omp_spin_user_lock == 0)
-    pthread_mutex_destroy(&(lp->lock.mutex_data));
-  else 
+  if (__omp_spin_user_lock != 0)
     pthread_spin_destroy(&(lp->lock.spin_data));
 }
 
@@ -120,7 +121,7 @@ inline int
 __ompc_test_lock (volatile ompc_lock_t *lp)
 {
   if (__omp_spin_user_lock == 0)
-    return (pthread_mutex_trylock(&(lp->lock.mutex_data)) == 0);
+    return __ompc_futex_trylock(&(lp->lock.futex_data));
   else
     return (pthread_spin_trylock(&(lp->lock.spin_data)) == 0);
 }
@@ -53,6 +53,7 @@ typedef struct {
   union{
     pthread_spinlock_t spin_data;
     pthread_mutex_t mutex_data;
+    volatile int futex_data;    /* see __ompc_futex_lock */
   } lock;
 }__attribute__ ((__aligned__(ALIGN_SIZE))) ompc_lock_t;
 
@@ -289,9 +289,31 @@ int __ompc_queue_array_put_head(omp_queue_t *q, omp_queue_item_t item)
 
 /* implementation for transferring chunks of work */
 
-/* this assumes that the destination queue is empty, mainly to avoid having to
- * acquire a lock for it (threads shouldn't try to update the head/tail
- * indexes or ready the used_slots field while the queue has is_empty=1).
+/* lock1 of both queues, taken in address order so that two threads moving
+ * work between the same two queues in opposite directions don't deadlock */
+static inline void
+__ompc_queue_lock_pair(omp_queue_t *a, omp_queue_t *b)
+{
+  if (a < b) {
+    __ompc_lock(&a->lock1);
+    __ompc_lock(&b->lock1);
+  } else {
+    __ompc_lock(&b->lock1);
+    __ompc_lock(&a->lock1);
+  }
+}
+
+static inline void
+__ompc_queue_unlock_pair(omp_queue_t *a, omp_queue_t *b)
+{
+  __ompc_unlock(&a->lock1);
+  __ompc_unlock(&b->lock1);
+}
+
+/* the destination queue is expected to be empty, it is the calling thread's
+ * own queue which it has just found empty. Both queues are locked, since
+ * other threads may still steal from or put to the destination. If it is no
+ * longer empty once locked, only the first item is taken.
  */
 omp_queue_item_t __ompc_queue_array_transfer_chunk_from_head_to_empty(
                                                    omp_queue_t *src,
@@ -300,7 +322,6 @@ omp_queue_item_t __ompc_queue_array_transfer_chunk_from_head_to_empty(
 {
   Is_True(src != NULL, ("tried to get from  NULL src queue"));
   Is_True(dst != NULL, ("tried to add to NULL dst queue"));
-  Is_True(dst->is_empty, ("dst should have been empty and wasn't"));
 
   int num_slots;
   int avail_slots;
@@ -314,13 +335,16 @@ omp_queue_item_t __ompc_queue_array_transfer_chunk_from_head_to_empty(
     return NULL;
   }
 
-  __ompc_lock(&src->lock1);
+  __ompc_queue_lock_pair(src, dst);
 
   if (__ompc_queue_is_empty(src)) {
-    __ompc_unlock(&src->lock1);
+    __ompc_queue_unlock_pair(src, dst);
     return NULL;
   }
 
+  if (!__ompc_queue_is_empty(dst))
+    chunk_size = 1;
+
   used_slots = src->used_slots;
 
   /* calculate number of items we can actually transfer */
@@ -363,16 +387,17 @@ omp_queue_item_t __ompc_queue_array_transfer_chunk_from_head_to_empty(
   /* update destination (reset is_empty after updated head/tail index)
    * while is_empty is 1, the dst queue should not be read by other threads
    */
-  dst->head_index = 0;
-  dst->tail_index = actual_chunk_size-1;
-  dst->used_slots = actual_chunk_size-1;
-  if (actual_chunk_size > 1)
+  if (actual_chunk_size > 1) {
+    dst->head_index = 0;
+    dst->tail_index = actual_chunk_size-1;
+    dst->used_slots = actual_chunk_size-1;
     dst->is_empty = 0;
+  }
 
   if (src->used_slots == 0)
     src->is_empty = 1;
 
-  __ompc_unlock(&src->lock1);
+  __ompc_queue_unlock_pair(src, dst);
 
   return item;
 
@@ -460,6 +485,8 @@ omp_queue_item_t __ompc_queue_cfifo_array_get(omp_queue_t *q)
 
 /* implementation for transferring chunks of work
  *   CFIFO version does not use used_slots field for performance reasons.
+ *   Locks the queues like the version above, and lock2 of the destination
+ *   as well since puts to its tail take only that one.
  */
 omp_queue_item_t __ompc_queue_cfifo_array_transfer_chunk_to_empty(
                                                    omp_queue_t *src,
@@ -468,7 +495,6 @@ omp_queue_item_t __ompc_queue_cfifo_array_transfer_chunk_to_empty(
 {
   Is_True(src != NULL, ("tried to get from  NULL src queue"));
   Is_True(dst != NULL, ("tried to add to NULL dst queue"));
-  Is_True(dst->is_empty, ("dst should have been empty and wasn't"));
 
   int num_slots;
   int avail_slots;
@@ -482,13 +508,18 @@ omp_queue_item_t __ompc_queue_cfifo_array_transfer_chunk_to_empty(
     return NULL;
   }
 
-  __ompc_lock(&src->lock1);
+  __ompc_queue_lock_pair(src, dst);
+  __ompc_lock(&dst->lock2);
 
   if (__ompc_queue_is_empty(src)) {
-    __ompc_unlock(&src->lock1);
+    __ompc_unlock(&dst->lock2);
+    __ompc_queue_unlock_pair(src, dst);
     return NULL;
   }
 
+  if (!__ompc_queue_is_empty(dst))
+    chunk_size = 1;
+
   used_slots = __ompc_queue_cfifo_array_num_used_slots(src);
 
   /* calculate number of items we can actually transfer */
@@ -529,11 +560,12 @@ omp_queue_item_t __ompc_queue_cfifo_array_transfer_chunk_to_empty(
   /* update destination (reset is_empty after updated head/tail index)
    * while is_empty is 1, the dst queue should not be read by other threads
    */
-  dst->head_index = 0;
-  dst->tail_index = actual_chunk_size-1;
   if (actual_chunk_size > 1) {
+    dst->head_index = 0;
+    dst->tail_index = actual_chunk_size-1;
     dst->is_empty = 0;
   }
+  __ompc_unlock(&dst->lock2);
 
   /* only acquire the lock for setting is_empty if it looks like the queue is
    * actually empty
@@ -546,7 +578,7 @@ omp_queue_item_t __ompc_queue_cfifo_array_transfer_chunk_to_empty(
     __ompc_unlock(&src->lock2);
   }
 
-  __ompc_unlock(&src->lock1);
+  __ompc_queue_unlock_pair(src, dst);
 
   return item;
 
@@ -1089,3 +1121,209 @@ int __ompc_queue_lockless_put_tail(omp_queue_t *q, omp_queue_item_t item)
 
   return 1;
 }
+
+/*******************************************************************
+ *       OMP QUEUE CHASE-LEV IMPLEMENTATION
+ *******************************************************************/
+
+/* Work-stealing deque of Chase and Lev ("Dynamic Circular Work-Stealing
+ * Deque", SPAA 2005), with the fences placed as in Le et al. ("Correct and
+ * Efficient Work-Stealing for Weak Memory Models", PPoPP 2013).
+ *
+ * Only the thread which owns the queue may put to or get from the tail.
+ * Any thread may steal from the head, the owner included. Instead of
+ * rejecting a task when the array is full, the owner copies the deque into
+ * an array twice the size.
+ */
+
+static omp_queue_cl_array_t *__ompc_queue_cl_array_new(long size)
+{
+  omp_queue_cl_array_t *a;
+
+  a = aligned_malloc(sizeof(omp_queue_cl_array_t) +
+                     (size - 1) * sizeof(omp_queue_item_t), CACHE_LINE_SIZE);
+  Is_True(a != NULL,
+      ("__ompc_queue_cl_array_new: couldn't malloc deque array"));
+  a->size = size;
+  a->prev = NULL;
+  return a;
+}
+
+static omp_queue_cl_array_t *
+__ompc_queue_cl_grow(omp_queue_t *q, omp_queue_cl_array_t *a,
+                     long bottom, long top)
+{
+  omp_queue_cl_array_t *new_a;
+  long i;
+
+  new_a = __ompc_queue_cl_array_new(a->size * 2);
+  for (i = top; i < bottom; i++)
+    new_a->items[i & (new_a->size - 1)] = a->items[i & (a->size - 1)];
+  new_a->prev = a;
+
+  /* the items have to be in place before a thief can see the array */
+  __ompc_store_fence();
+  q->cl_array = new_a;
+  q->num_slots = new_a->size;
+  return new_a;
+}
+
+void __ompc_queue_cl_init(omp_queue_t * q, int num_slots)
+{
+  long size = 2;
+
+  while (size < num_slots)
+    size *= 2;
+
+  q->cl_array = __ompc_queue_cl_array_new(size);
+  q->cl_bottom = q->cl_top = 0;
+  q->num_slots = size;
+  q->slots = NULL;
+  q->head = q->tail = NULL;
+  q->head_index = q->tail_index = q->used_slots = q->reject = 0;
+  q->is_empty = 1;
+  __ompc_init_lock(&q->lock1);
+  __ompc_init_lock(&q->lock2);
+}
+
+void __ompc_queue_cl_free_slots(omp_queue_t *q)
+{
+  omp_queue_cl_array_t *a, *prev;
+
+  Is_True(q->cl_array != NULL,
+      ("__ompc_queue_free_slots: slots already NULL"));
+  for (a = q->cl_array; a != NULL; a = prev) {
+    prev = a->prev;
+    aligned_free(a);
+  }
+  q->cl_array = NULL;
+}
+
+inline int __ompc_queue_cl_is_empty(omp_queue_t *q)
+{
+  return q->cl_bottom <= q->cl_top;
+}
+
+inline int __ompc_queue_cl_num_used_slots(omp_queue_t *q)
+{
+  long top, bottom;
+
+  top = q->cl_top;
+  bottom = q->cl_bottom;
+  return bottom > top ? (int)(bottom - top) : 0;
+}
+
+/* the deque grows instead */
+inline int __ompc_queue_cl_is_full(omp_queue_t *q)
+{
+  return 0;
+}
+
+int __ompc_queue_cl_put_tail(omp_queue_t *q, omp_queue_item_t item)
+{
+  long bottom, top;
+  omp_queue_cl_array_t *a;
+
+  Is_True(q != NULL, ("tried to put to tail on NULL queue"));
+
+  bottom = q->cl_bottom;
+  top = q->cl_top;
+  a = q->cl_array;
+  if (bottom - top > a->size - 1)
+    a = __ompc_queue_cl_grow(q, a, bottom, top);
+
+  a->items[bottom & (a->size - 1)] = item;
+  __ompc_store_fence();
+  q->cl_bottom = bottom + 1;
+
+  return 1;
+}
+
+omp_queue_item_t __ompc_queue_cl_get_tail(omp_queue_t *q)
+{
+  long bottom, top;
+  omp_queue_cl_array_t *a;
+  omp_queue_item_t item;
+
+  Is_True(q != NULL, ("tried to get tail from NULL queue"));
+
+  bottom = q->cl_bottom - 1;
+  a = q->cl_array;
+  q->cl_bottom = bottom;
+  /* a thief must see the smaller bottom before we read top */
+  __ompc_mfence();
+  top = q->cl_top;
+
+  if (top > bottom) {
+    /* empty */
+    q->cl_bottom = bottom + 1;
+    return NULL;
+  }
+
+  item = a->items[bottom & (a->size - 1)];
+  if (top == bottom) {
+    /* last item, race the thieves for it */
+    if (!__sync_bool_compare_and_swap(&q->cl_top, top, top + 1))
+      item = NULL;
+    q->cl_bottom = bottom + 1;
+  }
+
+  return item;
+}
+
+omp_queue_item_t __ompc_queue_cl_steal_head(omp_queue_t *q)
+{
+  long bottom, top;
+  omp_queue_cl_array_t *a;
+  omp_queue_item_t item;
+
+  Is_True(q != NULL, ("tried to steal head from NULL queue"));
+
+  top = q->cl_top;
+  __ompc_mfence();
+  bottom = q->cl_bottom;
+
+  if (top >= bottom)
+    return NULL;
+
+  __ompc_load_fence();
+  a = q->cl_array;
+  item = a->items[top & (a->size - 1)];
+  if (!__sync_bool_compare_and_swap(&q->cl_top, top, top + 1))
+    return NULL;   /* lost against another thief or the owner */
+
+  return item;
+}
+
+/* Steals up to chunk_size items from the head of src, but never more than
+ * half of them, and returns the first one. The rest is put to the tail of
+ * dst, which must be owned by the calling thread. */
+omp_queue_item_t __ompc_queue_cl_transfer_chunk_from_head(omp_queue_t *src,
+                                                          omp_queue_t *dst,
+                                                          int chunk_size)
+{
+  omp_queue_item_t first, item;
+  int half, i;
+
+  Is_True(src != NULL, ("tried to get from  NULL src queue"));
+  Is_True(dst != NULL, ("tried to add to NULL dst queue"));
+
+  half = (__ompc_queue_cl_num_used_slots(src) + 1) / 2;
+  if (chunk_size > half)
+    chunk_size = half;
+  if (chunk_size == 0)
+    return NULL;
+
+  first = __ompc_queue_cl_steal_head(src);
+  if (first == NULL)
+    return NULL;
+
+  for (i = 1; i < chunk_size; i++) {
+    item = __ompc_queue_cl_steal_head(src);
+    if (item == NULL)
+      break;
+    __ompc_queue_cl_put_tail(dst, item);
+  }
+
+  return first;
+}
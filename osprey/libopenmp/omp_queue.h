@@ -36,7 +36,8 @@ typedef enum {
   ARRAY_QUEUE_STORAGE,
   DYN_ARRAY_QUEUE_STORAGE,
   LIST_QUEUE_STORAGE,
-  LOCKLESS_QUEUE_STORAGE
+  LOCKLESS_QUEUE_STORAGE,
+  CHASE_LEV_QUEUE_STORAGE
 } queue_storage_t;
 
 extern queue_storage_t __omp_queue_storage;
@@ -53,6 +54,15 @@ struct omp_queue_slot {
 };
 typedef struct omp_queue_slot omp_queue_slot_t;
 
+/* circular array of a Chase-Lev deque. A grown deque keeps the arrays it
+ * replaced on the prev chain, since a thief may still read from them. */
+struct omp_queue_cl_array {
+  long size;    /* power of 2 */
+  struct omp_queue_cl_array *prev;
+  omp_queue_item_t items[1];
+};
+typedef struct omp_queue_cl_array omp_queue_cl_array_t;
+
 struct omp_queue {
   omp_queue_slot_t *slots;
 
@@ -70,6 +80,12 @@ struct omp_queue {
   volatile int reject;
   volatile int is_empty;
   volatile int used_slots;
+
+  /* for the Chase-Lev deque: the owner pushes and pops at bottom, thieves
+   * take from top */
+  omp_queue_cl_array_t * volatile cl_array;
+  volatile long cl_bottom;
+  volatile long cl_top __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
 } __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
 typedef struct omp_queue omp_queue_t;
 
@@ -185,5 +201,18 @@ extern omp_queue_item_t __ompc_queue_lockless_get_head(omp_queue_t *q);
 extern omp_queue_item_t __ompc_queue_lockless_get_tail(omp_queue_t *q);
 extern int __ompc_queue_lockless_put_tail(omp_queue_t *q, omp_queue_item_t item);
 
+/* Chase-Lev implementation */
+extern void __ompc_queue_cl_init(omp_queue_t * q, int num_slots);
+extern void __ompc_queue_cl_free_slots(omp_queue_t *q);
+extern int __ompc_queue_cl_is_empty(omp_queue_t *q);
+extern int __ompc_queue_cl_num_used_slots(omp_queue_t *q);
+extern int __ompc_queue_cl_is_full(omp_queue_t *q);
+extern omp_queue_item_t __ompc_queue_cl_steal_head(omp_queue_t *q);
+extern omp_queue_item_t __ompc_queue_cl_get_tail(omp_queue_t *q);
+extern int __ompc_queue_cl_put_tail(omp_queue_t *q, omp_queue_item_t item);
+extern omp_queue_item_t
+__ompc_queue_cl_transfer_chunk_from_head(omp_queue_t *src, omp_queue_t *dst,
+                                         int chunk_size);
+
 
 #endif /* __omp_queue_included */
@@ -0,0 +1,436 @@
+/*
+ Per-Region Time Accounting for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "omp_rtl.h"
+#include "omp_sys.h"
+#include "omp_futex.h"
+#include "omp_task_pool.h"
+#include "omp_region_stats.h"
+
+/* Description: with O64_OMP_REGION_STATS set, every thread counts where
+ * its time goes. The states set by __ompc_set_state map to the counters of
+ * OMP_REGION_STATS_COUNTER; on every change of state, the ticks since the
+ * last change are added to the counter of the old state, in the record of
+ * the region the thread runs. Threads keep their records to themselves, so
+ * counting takes no atomics; a record is only read by others for a report.
+ *
+ * A region is known by its outlined function. The time a thread spends
+ * outside of any region (serial, or idle as a slave) goes to the record of
+ * the NULL region. Running a task from a pool counts as work whatever the
+ * state of the thread, and taking it from the pool as task stealing: the
+ * pool's remove function is wrapped to count the time spent in it.
+ */
+
+typedef struct omp_region_stats_entry omp_region_stats_entry_t;
+struct omp_region_stats_entry {
+  omp_region_stats_entry_t *next;       /* all regions of the thread */
+  omp_region_stats_entry_t *hash_next;
+  void *region;
+  unsigned long entries;
+  unsigned long tasks;
+  unsigned long long ticks[OMP_REGION_STATS_LAST];
+};
+
+typedef struct omp_region_stats_thread omp_region_stats_thread_t;
+struct omp_region_stats_thread {
+  omp_region_stats_thread_t *next;
+  int thread;
+  /* what the ticks since last are counted as, and in which region */
+  int counter;
+  unsigned long long last;
+  omp_region_stats_entry_t *current;
+
+  /* entries are only ever added at the head, so that readers can walk
+   * the list while the thread adds to it */
+  omp_region_stats_entry_t * volatile entries;
+  omp_region_stats_entry_t *buckets[OMP_REGION_STATS_BUCKETS];
+
+  /* the regions the thread has entered and not left yet */
+  omp_region_stats_entry_t *stack[OMP_REGION_STATS_MAX_DEPTH];
+  int depth;
+};
+
+int __omp_region_stats = OMP_REGION_STATS_OFF;
+
+static char *__omp_region_stats_file = NULL;
+
+static omp_region_stats_thread_t * volatile __omp_region_stats_threads = NULL;
+static int __omp_region_stats_num_threads = 0;
+static volatile int __omp_region_stats_lock = 0;
+
+static __thread omp_region_stats_thread_t *__omp_region_stats_self = NULL;
+
+/* when counting started, in ticks and in nanoseconds */
+static unsigned long long __omp_region_stats_ticks0;
+static long long __omp_region_stats_ns0;
+
+static omp_task_t *(*__omp_region_stats_remove_task)(omp_task_pool_t *pool);
+
+/* indexed by OMP_COLLECTOR_API_THR_STATE */
+static const char __omp_region_stats_counter_of[THR_LAST_STATE] = {
+  OMP_REGION_STATS_IDLE,        /* no state yet */
+  OMP_REGION_STATS_OVERHEAD,    /* THR_OVHD_STATE */
+  OMP_REGION_STATS_WORK,        /* THR_WORK_STATE */
+  OMP_REGION_STATS_BARRIER,     /* THR_IBAR_STATE */
+  OMP_REGION_STATS_BARRIER,     /* THR_EBAR_STATE */
+  OMP_REGION_STATS_IDLE,        /* THR_IDLE_STATE */
+  OMP_REGION_STATS_IDLE,        /* THR_SERIAL_STATE */
+  OMP_REGION_STATS_REDUCTION,   /* THR_REDUC_STATE */
+  OMP_REGION_STATS_SYNC,        /* THR_LKWT_STATE */
+  OMP_REGION_STATS_SYNC,        /* THR_CTWT_STATE */
+  OMP_REGION_STATS_SYNC,        /* THR_ODWT_STATE */
+  OMP_REGION_STATS_SYNC         /* THR_ATWT_STATE */
+};
+
+static const char *__omp_region_stats_counter_name[OMP_REGION_STATS_LAST] = {
+  "work", "barrier", "overhead", "reduction", "sync", "task_steal", "idle"
+};
+
+static long long __ompc_region_stats_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static omp_region_stats_entry_t *
+__ompc_region_stats_lookup(omp_region_stats_thread_t *self, void *region)
+{
+  omp_region_stats_entry_t *entry;
+  int bucket;
+
+  bucket = ((unsigned long) region >> 4) % OMP_REGION_STATS_BUCKETS;
+  for (entry = self->buckets[bucket]; entry != NULL; entry = entry->hash_next)
+    if (entry->region == region)
+      return entry;
+
+  entry = calloc(1, sizeof(omp_region_stats_entry_t));
+  Is_True(entry != NULL, ("cannot allocate region statistics"));
+  entry->region = region;
+  entry->hash_next = self->buckets[bucket];
+  self->buckets[bucket] = entry;
+
+  entry->next = self->entries;
+  __ompc_store_fence();
+  self->entries = entry;
+  return entry;
+}
+
+static omp_region_stats_thread_t *__ompc_region_stats_get_self(void)
+{
+  omp_region_stats_thread_t *self = __omp_region_stats_self;
+
+  if (self != NULL)
+    return self;
+
+  self = aligned_malloc(sizeof(omp_region_stats_thread_t), CACHE_LINE_SIZE);
+  Is_True(self != NULL, ("cannot allocate region statistics"));
+  memset(self, 0, sizeof(omp_region_stats_thread_t));
+  self->counter = OMP_REGION_STATS_IDLE;
+  self->current = __ompc_region_stats_lookup(self, NULL);
+  self->last = __ompc_ticks();
+
+  __ompc_futex_lock(&__omp_region_stats_lock);
+  self->thread = __omp_region_stats_num_threads++;
+  self->next = __omp_region_stats_threads;
+  __ompc_store_fence();
+  __omp_region_stats_threads = self;
+  __ompc_futex_unlock(&__omp_region_stats_lock);
+
+  __omp_region_stats_self = self;
+  return self;
+}
+
+/* add the ticks since the last change to the counter in use, and count
+ * from now on in counter */
+static inline void
+__ompc_region_stats_charge(omp_region_stats_thread_t *self, int counter)
+{
+  unsigned long long now = __ompc_ticks();
+
+  self->current->ticks[self->counter] += now - self->last;
+  self->last = now;
+  self->counter = counter;
+}
+
+void __ompc_region_stats_set_state(int state)
+{
+  __ompc_region_stats_charge(__ompc_region_stats_get_self(),
+                             __omp_region_stats_counter_of[state]);
+}
+
+void __ompc_region_stats_enter(void *region)
+{
+  omp_region_stats_thread_t *self = __ompc_region_stats_get_self();
+
+  __ompc_region_stats_charge(self, self->counter);
+  if (self->depth < OMP_REGION_STATS_MAX_DEPTH) {
+    self->stack[self->depth] = self->current;
+    self->current = __ompc_region_stats_lookup(self, region);
+    self->current->entries++;
+  }
+  self->depth++;
+}
+
+void __ompc_region_stats_leave(void)
+{
+  omp_region_stats_thread_t *self = __ompc_region_stats_get_self();
+
+  __ompc_region_stats_charge(self, self->counter);
+  Is_True(self->depth > 0, ("region statistics: leaving no region"));
+  self->depth--;
+  if (self->depth < OMP_REGION_STATS_MAX_DEPTH)
+    self->current = self->stack[self->depth];
+}
+
+int __ompc_region_stats_task_begin(void)
+{
+  omp_region_stats_thread_t *self = __ompc_region_stats_get_self();
+  int counter = self->counter;
+
+  __ompc_region_stats_charge(self, OMP_REGION_STATS_WORK);
+  return counter;
+}
+
+void __ompc_region_stats_task_end(int counter)
+{
+  __ompc_region_stats_charge(__ompc_region_stats_get_self(), counter);
+}
+
+/* installed as __ompc_remove_task_from_pool */
+static omp_task_t *__ompc_region_stats_remove_task(omp_task_pool_t *pool)
+{
+  omp_region_stats_thread_t *self = __ompc_region_stats_get_self();
+  int counter = self->counter;
+  omp_task_t *task;
+
+  __ompc_region_stats_charge(self, OMP_REGION_STATS_TASK_STEAL);
+  task = __omp_region_stats_remove_task(pool);
+  __ompc_region_stats_charge(self, counter);
+  if (task != NULL)
+    self->current->tasks++;
+  return task;
+}
+
+/* must come after the task pool is configured */
+void __ompc_region_stats_init(int format, char *file)
+{
+  __omp_region_stats = format;
+  __omp_region_stats_file = file;
+  __omp_region_stats_ticks0 = __ompc_ticks();
+  __omp_region_stats_ns0 = __ompc_region_stats_now_ns();
+
+  __omp_region_stats_remove_task = __ompc_remove_task_from_pool;
+  __ompc_remove_task_from_pool = &__ompc_region_stats_remove_task;
+}
+
+void __ompc_region_stats_print_env(void)
+{
+  fprintf(stderr, "__omp_region_stats = %s%s%s\n",
+          __omp_region_stats == OMP_REGION_STATS_TABLE ? "table" :
+          __omp_region_stats == OMP_REGION_STATS_JSON ? "json" : "false",
+          __omp_region_stats_file != NULL ? " > " : "",
+          __omp_region_stats_file != NULL ? __omp_region_stats_file : "");
+}
+
+/* nanoseconds per tick, measured over the time counted so far */
+static double __ompc_region_stats_ns_per_tick(void)
+{
+  unsigned long long ticks = __ompc_ticks() - __omp_region_stats_ticks0;
+  long long ns = __ompc_region_stats_now_ns() - __omp_region_stats_ns0;
+
+  return ticks == 0 ? 1.0 : (double) ns / ticks;
+}
+
+int __ompc_region_stats_get(omp_region_stats_t *stats, int max)
+{
+  omp_region_stats_thread_t *thread;
+  omp_region_stats_entry_t *entry;
+  double ns_per_tick = __ompc_region_stats_ns_per_tick();
+  int n = 0, i;
+
+  for (thread = __omp_region_stats_threads; thread != NULL;
+       thread = thread->next) {
+    __ompc_load_fence();
+    for (entry = thread->entries; entry != NULL; entry = entry->next) {
+      __ompc_load_fence();
+      if (n < max) {
+        stats[n].region = entry->region;
+        stats[n].thread = thread->thread;
+        stats[n].entries = entry->entries;
+        stats[n].tasks = entry->tasks;
+        for (i = 0; i < OMP_REGION_STATS_LAST; i++)
+          stats[n].ns[i] =
+              (unsigned long long) (entry->ticks[i] * ns_per_tick);
+      }
+      n++;
+    }
+  }
+  return n;
+}
+
+/* regions in the order of their outlined functions, the time outside of
+ * regions last, and threads in order within a region */
+static int __ompc_region_stats_compare(const void *_a, const void *_b)
+{
+  const omp_region_stats_t *a = _a, *b = _b;
+
+  if (a->region != b->region) {
+    if (a->region == NULL)
+      return 1;
+    if (b->region == NULL)
+      return -1;
+    return (unsigned long) a->region < (unsigned long) b->region ? -1 : 1;
+  }
+  return a->thread - b->thread;
+}
+
+static void __ompc_region_stats_print_table(FILE *out, omp_region_stats_t *s,
+                                            int n, double seconds)
+{
+  omp_region_stats_t total;
+  unsigned long long max_work = 0;
+  int i, j, k, threads;
+
+  fprintf(out, "O64_OMP_REGION_STATS: %d threads, %.3f s, times in ms\n",
+          __omp_region_stats_num_threads, seconds);
+  fprintf(out, "%-18s %6s %8s", "region", "thread", "entries");
+  for (k = 0; k < OMP_REGION_STATS_LAST; k++)
+    fprintf(out, " %10s", __omp_region_stats_counter_name[k]);
+  fprintf(out, " %8s\n", "tasks");
+
+  for (i = 0; i < n; i = j) {
+    memset(&total, 0, sizeof(total));
+    max_work = 0;
+    for (j = i; j < n && s[j].region == s[i].region; j++) {
+      if (s[i].region != NULL)
+        fprintf(out, "%-18p", s[j].region);
+      else
+        fprintf(out, "%-18s", "(outside)");
+      fprintf(out, " %6d %8lu", s[j].thread, s[j].entries);
+      for (k = 0; k < OMP_REGION_STATS_LAST; k++) {
+        fprintf(out, " %10.3f", s[j].ns[k] / 1e6);
+        total.ns[k] += s[j].ns[k];
+      }
+      fprintf(out, " %8lu\n", s[j].tasks);
+      total.entries += s[j].entries;
+      total.tasks += s[j].tasks;
+      if (s[j].ns[OMP_REGION_STATS_WORK] > max_work)
+        max_work = s[j].ns[OMP_REGION_STATS_WORK];
+    }
+
+    threads = j - i;
+    if (s[i].region == NULL || threads == 1)
+      continue;
+    fprintf(out, "%-18s %6s %8lu", "", "all", total.entries);
+    for (k = 0; k < OMP_REGION_STATS_LAST; k++)
+      fprintf(out, " %10.3f", total.ns[k] / 1e6);
+    fprintf(out, " %8lu\n", total.tasks);
+    /* the most loaded thread against the average */
+    if (total.ns[OMP_REGION_STATS_WORK] > 0)
+      fprintf(out, "%-18s %6s imbalance %.2f\n", "", "",
+              (double) max_work * threads / total.ns[OMP_REGION_STATS_WORK]);
+  }
+}
+
+static void __ompc_region_stats_print_json(FILE *out, omp_region_stats_t *s,
+                                           int n, double seconds)
+{
+  int i, j, k;
+
+  fprintf(out, "{\n  \"threads\": %d,\n  \"seconds\": %.6f,\n"
+          "  \"regions\": [", __omp_region_stats_num_threads, seconds);
+  for (i = 0; i < n; i = j) {
+    fprintf(out, "%s\n    { \"region\": ", i == 0 ? "" : ",");
+    if (s[i].region != NULL)
+      fprintf(out, "\"%p\"", s[i].region);
+    else
+      fprintf(out, "null");
+    fprintf(out, ", \"threads\": [");
+    for (j = i; j < n && s[j].region == s[i].region; j++) {
+      fprintf(out, "%s\n        { \"thread\": %d, \"entries\": %lu, "
+              "\"tasks\": %lu", j == i ? "" : ",", s[j].thread,
+              s[j].entries, s[j].tasks);
+      for (k = 0; k < OMP_REGION_STATS_LAST; k++)
+        fprintf(out, ", \"%s_ns\": %llu",
+                __omp_region_stats_counter_name[k], s[j].ns[k]);
+      fprintf(out, " }");
+    }
+    fprintf(out, "\n      ] }");
+  }
+  fprintf(out, "\n  ]\n}\n");
+}
+
+/* at exit */
+void __ompc_region_stats_report(void)
+{
+  omp_region_stats_t *stats;
+  FILE *out = stderr;
+  double seconds;
+  int n, max;
+
+  if (__omp_region_stats_self != NULL)
+    __ompc_region_stats_charge(__omp_region_stats_self,
+                               __omp_region_stats_self->counter);
+
+  seconds = (__ompc_region_stats_now_ns() - __omp_region_stats_ns0) / 1e9;
+  /* other threads may still enter new regions */
+  max = __ompc_region_stats_get(NULL, 0) + OMP_REGION_STATS_BUCKETS;
+  stats = malloc(max * sizeof(omp_region_stats_t));
+  if (stats == NULL) {
+    Warning("O64_OMP_REGION_STATS: cannot allocate the report");
+    return;
+  }
+  n = __ompc_region_stats_get(stats, max);
+  if (n > max)
+    n = max;
+  qsort(stats, n, sizeof(omp_region_stats_t), __ompc_region_stats_compare);
+
+  if (__omp_region_stats_file != NULL) {
+    out = fopen(__omp_region_stats_file, "w");
+    if (out == NULL) {
+      Warning("O64_OMP_REGION_STATS_FILE cannot be opened, "
+              "reporting to stderr");
+      out = stderr;
+    }
+  }
+
+  if (__omp_region_stats == OMP_REGION_STATS_JSON)
+    __ompc_region_stats_print_json(out, stats, n, seconds);
+  else
+    __ompc_region_stats_print_table(out, stats, n, seconds);
+
+  if (out != stderr)
+    fclose(out);
+  free(stats);
+}
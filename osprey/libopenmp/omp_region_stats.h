@@ -0,0 +1,63 @@
+/*
+ Per-Region Time Accounting for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#ifndef __omp_region_stats_included
+#define __omp_region_stats_included
+
+#include "omp_collector_api.h"
+
+/* O64_OMP_REGION_STATS: off, or the format of the report at exit */
+#define OMP_REGION_STATS_OFF    0
+#define OMP_REGION_STATS_TABLE  1
+#define OMP_REGION_STATS_JSON   2
+
+/* regions of a thread are looked up by their outlined function */
+#define OMP_REGION_STATS_BUCKETS    64
+/* deeper nested regions are counted in the region above them */
+#define OMP_REGION_STATS_MAX_DEPTH  16
+
+extern int __omp_region_stats;
+
+extern void __ompc_region_stats_init(int format, char *file);
+extern void __ompc_region_stats_print_env(void);
+
+/* called on every __ompc_set_state */
+extern void __ompc_region_stats_set_state(int state);
+/* the calling thread starts to run region, until the matching leave */
+extern void __ompc_region_stats_enter(void *region);
+extern void __ompc_region_stats_leave(void);
+/* around running a task from a pool; task_end takes what task_begin
+ * returned */
+extern int __ompc_region_stats_task_begin(void);
+extern void __ompc_region_stats_task_end(int counter);
+
+/* Fills stats with up to max records, returns how many there are in all */
+extern int __ompc_region_stats_get(omp_region_stats_t *stats, int max);
+extern void __ompc_region_stats_report(void);
+
+#endif /* __omp_region_stats_included */
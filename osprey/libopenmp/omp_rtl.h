@@ -53,6 +53,8 @@
 #include "omp_task_pool.h"
 #include "omp_sys.h"
 #include "omp_xbarrier.h"
+#include "omp_affinity.h"
+#include "omp_region_stats.h"
 
 
 /* default setting values*/
@@ -131,6 +133,9 @@ extern int *        __omp_list_processors;
 /* default schedule type and chunk size of runtime schedule*/
 extern omp_sched_t  __omp_rt_sched_type;
 extern int  	    __omp_rt_sched_size;
+/* whether dynamic and guided loops are pre-split among the threads,
+ * set by O64_OMP_SCHEDULE_STEAL*/
+extern int  	    __omp_sched_steal;
 /* flag, whether the RTL data structure has been initializaed yet*/
 extern int 	    __omp_rtl_initialized;
 
@@ -177,6 +182,19 @@ struct omp_loop_info {
   omp_uint64 next_index;
 };
 
+/* The iterations of a dynamic or guided loop owned by one thread, as
+ * iteration numbers [next, end), when the loop is pre-split among the
+ * threads. The owner takes chunks from the front, a thread whose own
+ * slice has run out steals the back half of another one.
+ */
+typedef struct omp_loop_slice {
+  ompc_spinlock_t lock;
+  /* the loop_count of the team when the slice was set up */
+  volatile int loop_count;
+  volatile omp_uint64 next;
+  volatile omp_uint64 end;
+} omp_loop_slice_t;
+
 
 /* team*/
 struct omp_team {
@@ -202,6 +220,9 @@ struct omp_team {
   volatile omp_int64 schedule_count;
   /* We still need a semphore for scheduler initialization */
   volatile int loop_count;
+  /* For dynamic and guided schedule, see dispatch_next*/
+  omp_uint64 dispatch_trip_count;
+  int	dispatch_steal;
 
   /* for collapsed loop */
   unsigned collapse_count;
@@ -217,9 +238,11 @@ struct omp_team {
   volatile omp_int64 ordered_count;
   // using a dummy field to make the following layout better
   int dummy11;
-  // offset = 128, when -m64 
-  pthread_mutex_t barrier_lock;
-  pthread_cond_t barrier_cond;
+  /* threads asleep in __ompc_futex_wait on barrier_flag, exit_count and
+   * new_task */
+  volatile int barrier_waiters;
+  volatile int exit_waiters;
+  volatile int new_task_waiters;
   pthread_cond_t ordered_cond;
 
   /* for single*/
@@ -260,6 +283,12 @@ struct omp_team {
 
   callback callbacks[OMP_EVENT_THR_END_ATWT+1];
 
+  /* The next iteration number of a dynamic or guided loop not given to
+   * any thread yet. Threads take chunks with an atomic fetch-and-add
+   * (compare-and-swap for guided), so it has a cache line of its own.
+   */
+  volatile omp_uint64 dispatch_next __attribute__ ((__aligned__(CACHE_LINE_SIZE_L2L3)));
+
 } __attribute__ ((__aligned__(CACHE_LINE_SIZE_L2L3)));
 
 /* user thread*/
@@ -299,6 +328,15 @@ struct omp_v_thread {
   unsigned long thr_ebar_state_id;
   unsigned long thr_odwt_state_id;
 
+  /* For pre-split dynamic and guided schedule*/
+  omp_loop_slice_t loop_slice;
+
+  /* For tree-combining reductions*/
+  omp_reduction_node_t reduction_node;
+
+  /* The place this thread runs on, and the partition of its own teams */
+  omp_place_info_t place_info;
+
   /* Maybe a few more bytes should be here for alignment.*/
   /* TODO: stuff bytes*/
 } __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
@@ -374,6 +412,43 @@ extern void __ompc_end_critical(int gtid, volatile ompc_lock_t **lck);
 extern void __ompc_reduction(int gtid, volatile ompc_lock_t **lck);
 extern void __ompc_end_reduction(int gtid, volatile ompc_lock_t **lck);
 
+/* A scalar reduction variable of __ompc_reduce. kind is
+ * (type << OMP_REDUCTION_TYPE_SHIFT) | operator
+ */
+typedef enum {
+  OMP_REDUCTION_ADD = 0,
+  OMP_REDUCTION_MPY,
+  OMP_REDUCTION_MAX,
+  OMP_REDUCTION_MIN,
+  OMP_REDUCTION_BAND,
+  OMP_REDUCTION_BIOR,
+  OMP_REDUCTION_BXOR,
+  OMP_REDUCTION_LAND,
+  OMP_REDUCTION_LIOR,
+  OMP_REDUCTION_EQV,
+  OMP_REDUCTION_NEQV
+} omp_reduction_op_t;
+
+typedef enum {
+  OMP_REDUCTION_I4 = 0,
+  OMP_REDUCTION_I8,
+  OMP_REDUCTION_U4,
+  OMP_REDUCTION_U8,
+  OMP_REDUCTION_F4,
+  OMP_REDUCTION_F8
+} omp_reduction_type_t;
+
+#define OMP_REDUCTION_TYPE_SHIFT 8
+
+struct omp_reduction_var {
+  void *private_addr;
+  void *shared_addr;
+  long kind;
+};
+typedef struct omp_reduction_var omp_reduction_var_t;
+
+extern void __ompc_reduce(int gtid, omp_reduction_var_t *vars, int num_vars);
+
 /* Other stuff fuctions*/
 
 /* Maybe we should use libhoard for Dynamic memory 
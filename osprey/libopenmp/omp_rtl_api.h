@@ -86,6 +86,7 @@ extern "C" {
  /* added by Oscar Hernandez at the University of Houston 2009 */
   extern void __ompc_reduction(omp_int32 gtid, omp_int32 **lck);
   extern void __ompc_end_reduction(omp_int32 gtid, omp_int32 **lck);
+  extern void __ompc_reduce(omp_int32 gtid, void *vars, omp_int32 num_vars);
 
   /* Not exposed any longer*/
   /* TODO: Fix the Interface*/
@@ -161,8 +162,16 @@ extern "C" {
   extern int __ompc_task_will_defer(int may_delay);
   extern void __ompc_task_create(omp_task_func taskfunc, void *frame_pointer,
                 void *firstprivates, int may_delay, int is_tied, int blocks_parent);
+  extern void __ompc_task_create_deps(omp_task_func taskfunc,
+                void *frame_pointer, void *firstprivates, int may_delay,
+                int is_tied, int blocks_parent, void *deps, int num_deps);
   extern void __ompc_task_wait();
   extern void __ompc_task_exit();
+  extern void __ompc_taskgroup_begin(void);
+  extern void __ompc_taskgroup_end(void);
+  extern void __ompc_taskloop_begin(long lb, long ub, long step,
+                long grainsize, long num_tasks);
+  extern int __ompc_taskloop_next(long *lo, long *hi);
 
   extern void __ompc_task_firstprivates_alloc(void **firstprivates, int size);
   extern void __ompc_task_firstprivates_free(void *firstprivates);
@@ -276,6 +276,185 @@ __ompc_is_ordered (omp_sched_t schedtype)
     }
 }
 
+/* number of iterations of a loop, 0 if it is empty */
+static inline omp_uint64
+__ompc_loop_trip_count (omp_int64 lower, omp_int64 upper, omp_int64 incr)
+{
+  if (incr > 0) {
+    if (upper < lower)
+      return 0;
+    return ((omp_uint64)upper - (omp_uint64)lower) / (omp_uint64)incr + 1;
+  } else {
+    if (upper > lower)
+      return 0;
+    return ((omp_uint64)lower - (omp_uint64)upper) / (omp_uint64)(-incr) + 1;
+  }
+}
+
+/* whether a loop of schedtype is pre-split among the threads. Only the
+ * level 1 team is, since a thief has to find the other threads of its
+ * team by their global_tid.
+ */
+static inline int
+__ompc_dispatch_steal (omp_sched_t schedtype)
+{
+  return __omp_sched_steal && (__omp_exe_mode & OMP_EXE_MODE_NORMAL) &&
+    (schedtype == OMP_SCHED_DYNAMIC || schedtype == OMP_SCHED_GUIDED);
+}
+
+/* done by the first thread calling schedule_init, holding schedule_lock */
+static inline void
+__ompc_dispatch_init (omp_team_t *p_team, omp_sched_t schedtype,
+		      omp_int64 lower, omp_int64 upper, omp_int64 stride)
+{
+  p_team->dispatch_trip_count = __ompc_loop_trip_count(lower, upper, stride);
+  p_team->dispatch_steal = __ompc_dispatch_steal(schedtype);
+  p_team->dispatch_next = 0;
+}
+
+/* done by every thread for its own slice, an even share of the loop.
+ * The slice is tagged with the loop_count of the team, which is the same
+ * in all threads once the loop is initialized.
+ */
+static void
+__ompc_dispatch_slice_init (omp_team_t *p_team, omp_v_thread_t *p_vthread,
+			    omp_int32 global_tid, omp_int64 lower,
+			    omp_int64 upper, omp_int64 stride)
+{
+  omp_loop_slice_t *slice = &(p_vthread->loop_slice);
+  omp_uint64 trip_count, share, rest;
+
+  trip_count = __ompc_loop_trip_count(lower, upper, stride);
+  share = trip_count / p_team->team_size;
+  rest = trip_count % p_team->team_size;
+
+  __ompc_lock_spinlock(&(slice->lock));
+  slice->next = share * global_tid +
+    ((omp_uint64)global_tid < rest ? global_tid : rest);
+  slice->end = slice->next + share + ((omp_uint64)global_tid < rest ? 1 : 0);
+  slice->loop_count = p_team->loop_count;
+  __ompc_unlock_spinlock(&(slice->lock));
+}
+
+/* take the next chunk of the own slice */
+static int
+__ompc_dispatch_slice_next (omp_loop_slice_t *slice, int is_guided,
+			    omp_uint64 chunk, omp_uint64 *pfirst,
+			    omp_uint64 *plast)
+{
+  omp_uint64 remaining, size;
+
+  __ompc_lock_spinlock(&(slice->lock));
+  if (slice->next >= slice->end) {
+    __ompc_unlock_spinlock(&(slice->lock));
+    return 0;
+  }
+  remaining = slice->end - slice->next;
+  size = chunk;
+  if (is_guided && remaining / 2 > size)
+    size = remaining / 2;
+  if (size > remaining)
+    size = remaining;
+  *pfirst = slice->next;
+  *plast = slice->next + size - 1;
+  slice->next += size;
+  __ompc_unlock_spinlock(&(slice->lock));
+
+  return 1;
+}
+
+/* move the back half of the slice of another thread into the own one */
+static int
+__ompc_dispatch_slice_steal (omp_team_t *p_team, omp_v_thread_t *p_vthread,
+			     omp_int32 global_tid)
+{
+  omp_loop_slice_t *slice, *victim;
+  omp_uint64 first, end;
+  int loop_count, i;
+
+  slice = &(p_vthread->loop_slice);
+  loop_count = p_team->loop_count;
+  for (i = 1; i < p_team->team_size; i++) {
+    victim = &(__omp_level_1_team[(global_tid + i) % p_team->team_size].loop_slice);
+    /* a slice not set up for this loop yet is left to its owner */
+    if (victim->loop_count != loop_count ||
+	victim->next >= victim->end)
+      continue;
+
+    __ompc_lock_spinlock(&(victim->lock));
+    if (victim->loop_count != loop_count ||
+	victim->next >= victim->end) {
+      __ompc_unlock_spinlock(&(victim->lock));
+      continue;
+    }
+    end = victim->end;
+    first = end - (end - victim->next + 1) / 2;
+    victim->end = first;
+    __ompc_unlock_spinlock(&(victim->lock));
+
+    __ompc_lock_spinlock(&(slice->lock));
+    slice->next = first;
+    slice->end = end;
+    __ompc_unlock_spinlock(&(slice->lock));
+    return 1;
+  }
+
+  return 0;
+}
+
+/* Hand out the next chunk [*pfirst, *plast] of iteration numbers of a
+ * dynamic or guided loop, return 0 if there are no more iterations.
+ * The shared counter is never locked: a dynamic chunk is a fetch-and-add,
+ * a guided one a compare-and-swap since its size depends on the
+ * iterations left.
+ */
+static int
+__ompc_dispatch_next (omp_team_t *p_team, omp_v_thread_t *p_vthread,
+		      omp_int32 global_tid, omp_uint64 *pfirst,
+		      omp_uint64 *plast)
+{
+  omp_uint64 chunk, trip_count, first, size;
+  int is_guided;
+
+  is_guided = (p_team->schedule_type == OMP_SCHED_GUIDED);
+  chunk = p_team->chunk_size > 0 ? p_team->chunk_size : 1;
+
+  if (p_team->dispatch_steal) {
+    do {
+      if (__ompc_dispatch_slice_next(&(p_vthread->loop_slice), is_guided,
+				     chunk, pfirst, plast))
+	return 1;
+    } while (__ompc_dispatch_slice_steal(p_team, p_vthread, global_tid));
+    return 0;
+  }
+
+  trip_count = p_team->dispatch_trip_count;
+  if (!is_guided) {
+    if (p_team->dispatch_next >= trip_count)
+      return 0;
+    first = __sync_fetch_and_add(&(p_team->dispatch_next), chunk);
+    if (first >= trip_count)
+      return 0;
+    size = chunk;
+  } else {
+    do {
+      first = p_team->dispatch_next;
+      if (first >= trip_count)
+	return 0;
+      size = (trip_count - first) / (2 * p_team->team_size);
+      if (size < chunk)
+	size = chunk;
+    } while (!__sync_bool_compare_and_swap(&(p_team->dispatch_next),
+					   first, first + size));
+  }
+
+  if (size > trip_count - first)
+    size = trip_count - first;
+  *pfirst = first;
+  *plast = first + size - 1;
+  return 1;
+}
+
 /* Other schedule type, including dynamic, guided,
  * runtime, OMP_SCHEDULE specified
  * static schedule, and Ordered schedule types.
@@ -352,7 +531,6 @@ __ompc_scheduler_init_4 (omp_int32 global_tid, omp_sched_t schedtype,
   if (p_team->loop_count >= p_vthread->loop_count) {
     /* We assume that the initialization has already OK */
     __ompc_unlock_spinlock(&(p_team->schedule_lock));
-    return;
   } else {
     /* The first one call schedule_init do the initialization work */
     /* Initializing */
@@ -364,13 +542,16 @@ __ompc_scheduler_init_4 (omp_int32 global_tid, omp_sched_t schedtype,
     p_team->schedule_count = 0;
     if (__ompc_is_ordered(schedtype))
       p_team->ordered_count = 0;
+    __ompc_dispatch_init(p_team, schedtype, lower, upper, stride);
     /* Initialization finished */
     p_team->loop_count++;
 
     __ompc_unlock_spinlock(&(p_team->schedule_lock));
-
-    return;
   }
+
+  if (__ompc_dispatch_steal(schedtype))
+    __ompc_dispatch_slice_init(p_team, p_vthread, global_tid,
+			       lower, upper, stride);
 }         
 
 
@@ -433,7 +614,6 @@ __ompc_scheduler_init_8 (omp_int32 global_tid, omp_sched_t schedtype,
   if (p_team->loop_count >= p_vthread->loop_count) {
     /* We assume that the initialization has already OK */
     __ompc_unlock_spinlock(&(p_team->schedule_lock));
-    return;
   } else {
     /* The first one call schedule_init do the initialization work */
     /* Initializing */
@@ -445,13 +625,16 @@ __ompc_scheduler_init_8 (omp_int32 global_tid, omp_sched_t schedtype,
     p_team->schedule_count = 0;
     if (__ompc_is_ordered(schedtype))
       p_team->ordered_count = 0;
+    __ompc_dispatch_init(p_team, schedtype, lower, upper, stride);
     /* Initialization finished */
     p_team->loop_count++;
 
     __ompc_unlock_spinlock(&(p_team->schedule_lock));
-
-    return;
   }
+
+  if (__ompc_dispatch_steal(schedtype))
+    __ompc_dispatch_slice_init(p_team, p_vthread, global_tid,
+			       lower, upper, stride);
 }                              
 
 
@@ -484,6 +667,7 @@ omp_int32 __ompc_schedule_next_4 (omp_int32 global_tid,
   omp_int32	my_lower, my_upper;
   omp_int32	global_lower, global_upper;
   omp_int32	my_trip, schedule_count;
+  omp_uint64	first_iter, last_iter;
   float		trip_flag;
 
   __ompc_set_state(THR_OVHD_STATE);
@@ -614,66 +798,18 @@ omp_int32 __ompc_schedule_next_4 (omp_int32 global_tid,
     return 1;
     break;
   case OMP_SCHED_GUIDED:
-    __ompc_lock_spinlock(&(p_team->schedule_lock));
-
-    global_lower = p_team->loop_lower_bound;
-    global_upper = p_team->loop_upper_bound;
-    incr = p_team->loop_increament;
-    trip_flag = (global_upper - global_lower) * 1.0 / (float)incr;
-    trip_count = (global_upper - global_lower) / incr ;
-
-    if ( trip_flag < 0) {
-      __ompc_unlock_spinlock(&(p_team->schedule_lock));
+  case OMP_SCHED_DYNAMIC:
+    if (!__ompc_dispatch_next(p_team, p_vthread, global_tid,
+			      &first_iter, &last_iter)) {
       /* No more iterations */
       __ompc_set_state(THR_WORK_STATE);
       return 0;
     }
-
-    trip_count += 1;
-    my_lower = global_lower;
-    block_size = trip_count / (2 * team_size);
-    chunk = p_team->chunk_size;
-    if (block_size > chunk) 
-      chunk = block_size;
-    my_upper = my_lower + (chunk - 1) * incr;
-    p_team->loop_lower_bound = my_lower + chunk * incr;
-			
-    __ompc_unlock_spinlock(&(p_team->schedule_lock));
-
-    *plower = my_lower;
-    *pupper = my_upper;
-    *pstride = incr;
-    __ompc_set_state(THR_WORK_STATE);
-    return 1;
-    break;
-
-  case OMP_SCHED_DYNAMIC:
-    __ompc_lock_spinlock(&(p_team->schedule_lock));
-
     global_lower = p_team->loop_lower_bound;
-    global_upper = p_team->loop_upper_bound;
     incr = p_team->loop_increament;
-    trip_flag = (global_upper - global_lower) * 1.0 / (float)incr;
-    trip_count = (global_upper - global_lower) / incr;
-    /* Need to fix the trip_count for trip_count = 1 case */
-
-    if ( trip_flag < 0) {
-      __ompc_unlock_spinlock(&(p_team->schedule_lock));
-      /* No more iterations */
-      __ompc_set_state(THR_WORK_STATE);
-      return 0;
-    }
 
-    trip_count += 1;
-    my_lower = global_lower;
-    chunk = p_team->chunk_size;
-    my_upper = my_lower + (chunk - 1) * incr;
-    p_team->loop_lower_bound = my_lower + chunk * incr;
-			
-    __ompc_unlock_spinlock(&(p_team->schedule_lock));
-
-    *plower = my_lower;
-    *pupper = my_upper;
+    *plower = (omp_uint64)global_lower + first_iter * (omp_uint64)incr;
+    *pupper = (omp_uint64)global_lower + last_iter * (omp_uint64)incr;
     *pstride = incr;
     __ompc_set_state(THR_WORK_STATE);
     return 1;
@@ -860,6 +996,7 @@ omp_int32 __ompc_schedule_next_8 (omp_int32 global_tid,
   omp_int64	my_lower, my_upper;
   omp_int64	global_lower, global_upper;
   omp_int64	my_trip, schedule_count;
+  omp_uint64	first_iter, last_iter;
   float		  trip_flag;
 
   __ompc_set_state(THR_OVHD_STATE);
@@ -993,67 +1130,21 @@ omp_int32 __ompc_schedule_next_8 (omp_int32 global_tid,
     return 1;
     break;
   case OMP_SCHED_GUIDED:
-    __ompc_lock_spinlock(&(p_team->schedule_lock));
-
-    global_lower = p_team->loop_lower_bound;
-    global_upper = p_team->loop_upper_bound;
-    incr = p_team->loop_increament;
-    trip_flag = (global_upper - global_lower) * 1.0 / (float)incr;
-    trip_count = (global_upper - global_lower) / incr ;
-
-    if ( trip_flag < 0) {
-      __ompc_unlock_spinlock(&(p_team->schedule_lock));
+  case OMP_SCHED_DYNAMIC:
+    if (!__ompc_dispatch_next(p_team, p_vthread, global_tid,
+			      &first_iter, &last_iter)) {
       /* No more iterations */
       __ompc_set_state(THR_WORK_STATE);
       return 0;
     }
-    trip_count += 1;
-    my_lower = global_lower;
-    block_size = trip_count / (2 * team_size);
-    chunk = p_team->chunk_size;
-    if (block_size > chunk) 
-      chunk = block_size;
-    my_upper = my_lower + (chunk - 1) * incr;
-    p_team->loop_lower_bound = my_lower + chunk * incr;
-			
-    __ompc_unlock_spinlock(&(p_team->schedule_lock));
-
-    *plower = my_lower;
-    *pupper = my_upper;
-    *pstride = incr;
-    __ompc_set_state(THR_WORK_STATE);
-    return 1;
-
-    break;
-  case OMP_SCHED_DYNAMIC:
-    __ompc_lock_spinlock(&(p_team->schedule_lock));
-
     global_lower = p_team->loop_lower_bound;
-    global_upper = p_team->loop_upper_bound;
     incr = p_team->loop_increament;
-    trip_flag = (global_upper - global_lower) * 1.0 / (float)incr;
-    trip_count = (global_upper - global_lower) / incr;
 
-    if ( trip_flag < 0) {
-      __ompc_unlock_spinlock(&(p_team->schedule_lock));
-      /* No more iterations */
-      __ompc_set_state(THR_WORK_STATE);
-      return 0;
-    }
-    trip_count += 1;
-    my_lower = global_lower;
-    chunk = p_team->chunk_size;
-    my_upper = my_lower + (chunk - 1) * incr;
-    p_team->loop_lower_bound = my_lower + chunk * incr;
-			
-    __ompc_unlock_spinlock(&(p_team->schedule_lock));
-
-    *plower = my_lower;
-    *pupper = my_upper;
+    *plower = (omp_uint64)global_lower + first_iter * (omp_uint64)incr;
+    *pupper = (omp_uint64)global_lower + last_iter * (omp_uint64)incr;
     *pstride = incr;
     __ompc_set_state(THR_WORK_STATE);
     return 1;
-
     break;
   case OMP_SCHED_ORDERED_STATIC_EVEN:
     /* specified by OMP_SCHEDULE */
@@ -1750,8 +1841,10 @@ __ompc_single (omp_int32 global_tid)
   omp_v_thread_t *p_vthread;
   int	is_first = 0;
 
-  if (__omp_exe_mode & OMP_EXE_MODE_SEQUENTIAL)
+  if (__omp_exe_mode & OMP_EXE_MODE_SEQUENTIAL) {
+    __ompc_set_state(THR_WORK_STATE);
     return 1;
+  }
   if (__omp_exe_mode & OMP_EXE_MODE_NORMAL) {
     p_team = &__omp_level_1_team_manager;
     p_vthread = &__omp_level_1_team[global_tid];
@@ -1762,6 +1855,7 @@ __ompc_single (omp_int32 global_tid)
 
   if (p_team->team_size == 1) {
     /* Single member team*/
+    __ompc_set_state(THR_WORK_STATE);
     return 1;
   }
 
@@ -1796,8 +1890,10 @@ __ompc_workshare (omp_int32 global_tid)
   omp_v_thread_t *p_vthread;
   int	is_first = 0;
 
-  if (__omp_exe_mode & OMP_EXE_MODE_SEQUENTIAL)
+  if (__omp_exe_mode & OMP_EXE_MODE_SEQUENTIAL) {
+    __ompc_set_state(THR_WORK_STATE);
     return 1;
+  }
   if (__omp_exe_mode & OMP_EXE_MODE_NORMAL) {
     p_team = &__omp_level_1_team_manager;
     p_vthread = &__omp_level_1_team[global_tid];
@@ -1808,6 +1904,7 @@ __ompc_workshare (omp_int32 global_tid)
 
   if (p_team->team_size == 1) {
     /* Single member team*/
+    __ompc_set_state(THR_WORK_STATE);
     return 1;
   }
 
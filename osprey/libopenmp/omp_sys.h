@@ -69,6 +69,75 @@ static inline void __ompc_mfence()
 
 #endif
 
+/* Keep earlier stores ahead of later stores, and earlier loads ahead of
+ * later loads. x86 already orders them, so only the compiler needs to be
+ * stopped there. */
+#if defined(TARG_X8664) || defined(TARG_IA32)
+static inline void __ompc_store_fence()
+{
+  __asm__ __volatile__("":: : "memory");
+}
+
+static inline void __ompc_load_fence()
+{
+  __asm__ __volatile__("":: : "memory");
+}
+
+#else
+
+static inline void __ompc_store_fence()
+{
+  __sync_synchronize();
+}
+
+static inline void __ompc_load_fence()
+{
+  __sync_synchronize();
+}
+
+#endif
+
+/* Body of a spin-wait loop. On x86 the pause hint saves power and lets the
+ * other hyperthread run, and avoids the pipeline flush on leaving the loop. */
+#if defined(TARG_X8664) || defined(TARG_IA32)
+static inline void __ompc_cpu_relax()
+{
+  __asm__ __volatile__("pause":: : "memory");
+}
+
+#else
+
+static inline void __ompc_cpu_relax()
+{
+  __asm__ __volatile__("":: : "memory");
+}
+
+#endif
+
+/* A cheap, monotonic tick count. On x86 this is the time stamp counter,
+ * whose rate has to be measured against the clock; elsewhere it is the
+ * clock itself, in nanoseconds. */
+#if defined(TARG_X8664) || defined(TARG_IA32)
+static inline unsigned long long __ompc_ticks()
+{
+  unsigned int lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((unsigned long long) hi << 32) | lo;
+}
+
+#else
+
+#include <time.h>
+
+static inline unsigned long long __ompc_ticks()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#endif
+
 static inline int __ompc_cas(volatile int *ptr, int ag, int x)
 {
   return __sync_bool_compare_and_swap(ptr, ag, x);
@@ -54,6 +54,16 @@
  * When a task is cut off, it will execute immediately in a work-first manner
  * (that is, any of its descendants will also be "cut off").
  *
+ * A taskgroup counts the deferred tasks created in it, together with their
+ * descendants, and its end runs tasks from the pool until they have all
+ * exited. A taskloop is a single task which splits its chunks recursively,
+ * see "taskloops" below.
+ *
+ * Tasks created with a depend clause (__ompc_task_create_deps) are ordered
+ * against their earlier siblings through a dependence table owned by the
+ * parent, see "task dependences" below. Such a task is only put into the
+ * task pool once its last predecessor has exited.
+ *
  * Note: Current implementation does not make use of PCL (Portable Coroutine
  * Library). Once a task starts to execute, it will not be placed back into
  * the task pool or resume execution on another thread. This constrains what
@@ -81,6 +91,26 @@ int __omp_task_cutoff_switch_max        = 100;
 int __omp_task_cutoff_depth_max         = 100;
 int __omp_task_cutoff_num_children_max  = 100;
 
+/* the chunks of a taskloop between __ompc_taskloop_begin and the creation
+ * of its task, and those of the cut off taskloop the thread is running */
+static __thread omp_taskloop_t __omp_taskloop_pending;
+static __thread int __omp_taskloop_is_pending = 0;
+static __thread omp_taskloop_t *__omp_taskloop_current = NULL;
+
+/* a deferred task counts in the innermost taskgroup around its creation */
+static inline void __ompc_task_join_group(omp_task_t *task,
+                                          omp_taskgroup_t *group)
+{
+  task->group = group;
+  if (group != NULL)
+    __ompc_atomic_inc(&group->num_tasks);
+}
+
+static inline omp_taskgroup_t *__ompc_task_current_group(omp_task_t *task)
+{
+  return task->taskgroup != NULL ? task->taskgroup : task->group;
+}
+
 /* implementation for external API */
 
 int __ompc_task_will_defer(int may_delay)
@@ -102,7 +132,16 @@ void __ompc_task_create(omp_task_func taskfunc, void *frame_pointer,
     //__omp_task_cutoffs++;
     orig_task = current_task;
     __omp_current_task = NULL;
-    taskfunc(firstprivates, frame_pointer);
+    if (__omp_taskloop_is_pending) {
+      omp_taskloop_t loop = __omp_taskloop_pending;
+      omp_taskloop_t *orig_loop = __omp_taskloop_current;
+      __omp_taskloop_is_pending = 0;
+      __omp_taskloop_current = &loop;
+      taskfunc(firstprivates, frame_pointer);
+      __omp_taskloop_current = orig_loop;
+    } else {
+      taskfunc(firstprivates, frame_pointer);
+    }
     __omp_current_task = orig_task;
     return;
     /* not reached */
@@ -120,6 +159,12 @@ void __ompc_task_create(omp_task_func taskfunc, void *frame_pointer,
     new_task->creating_thread_id = myid;
     new_task->parent = current_task;
     new_task->depth = current_task->depth + 1;
+    __ompc_task_join_group(new_task, __ompc_task_current_group(current_task));
+
+    if (__omp_taskloop_is_pending) {
+      new_task->taskloop = __omp_taskloop_pending;
+      __omp_taskloop_is_pending = 0;
+    }
 
     __ompc_task_set_flags(new_task, OMP_TASK_IS_DEFERRED);
 
@@ -153,6 +198,13 @@ void __ompc_task_create(omp_task_func taskfunc, void *frame_pointer,
     new_task->creating_thread_id = myid;
     new_task->parent = current_task;
     new_task->depth = current_task->depth + 1;
+    /* runs to completion here, so it is in the group without counting */
+    new_task->group = __ompc_task_current_group(current_task);
+
+    if (__omp_taskloop_is_pending) {
+      new_task->taskloop = __omp_taskloop_pending;
+      __omp_taskloop_is_pending = 0;
+    }
 
     if (is_tied)
       __ompc_task_set_flags(new_task, OMP_TASK_IS_TIED);
@@ -179,6 +231,344 @@ void __ompc_task_create(omp_task_func taskfunc, void *frame_pointer,
 
 }
 
+/* task dependences
+ *
+ * The parent's table maps an address to the node of the last task with an
+ * out or inout item on it, and the nodes of the tasks with in items since
+ * then. A new task becomes a successor of the last writer of each of its
+ * items, and, for out and inout items, of the readers as well. A node counts
+ * its unfinished predecessors; whoever drops the count to zero, the creating
+ * thread or the thread which runs the last predecessor to its exit, puts the
+ * task into its own task queue.
+ *
+ * A table, and the references it holds, is only dropped once all the
+ * children of its owner have exited, so it never points at a live node the
+ * owner cannot see.
+ */
+
+static omp_task_dep_node_t *__ompc_task_dep_node_new(void)
+{
+  omp_task_dep_node_t *node;
+
+  node = (omp_task_dep_node_t *) aligned_malloc(sizeof(omp_task_dep_node_t),
+                                                CACHE_LINE_SIZE);
+  Is_True(node != NULL, ("couldn't create task dependence node"));
+
+  node->task = NULL;
+  node->num_predecessors = 1;
+  node->ref_count = 1;
+  node->done = 0;
+  node->successors = NULL;
+  __ompc_init_spinlock(&node->lock);
+
+  return node;
+}
+
+static inline void __ompc_task_dep_node_ref(omp_task_dep_node_t *node)
+{
+  __ompc_atomic_inc(&node->ref_count);
+}
+
+static inline void __ompc_task_dep_node_unref(omp_task_dep_node_t *node)
+{
+  if (__ompc_atomic_dec(&node->ref_count) == 0) {
+    __ompc_destroy_spinlock(&node->lock);
+    aligned_free(node);
+  }
+}
+
+/* make node wait for pred, unless pred has already exited */
+static void __ompc_task_dep_add_predecessor(omp_task_dep_node_t *node,
+                                            omp_task_dep_node_t *pred)
+{
+  omp_task_dep_link_t *link;
+
+  if (pred == NULL || pred == node || pred->done)
+    return;
+
+  __ompc_lock_spinlock(&pred->lock);
+  if (!pred->done) {
+    link = (omp_task_dep_link_t *) malloc(sizeof(omp_task_dep_link_t));
+    Is_True(link != NULL, ("couldn't create task dependence link"));
+    link->node = node;
+    link->next = pred->successors;
+    pred->successors = link;
+    __ompc_atomic_inc(&node->num_predecessors);
+  }
+  __ompc_unlock_spinlock(&pred->lock);
+}
+
+static omp_task_dep_table_t *__ompc_task_dep_table_new(void)
+{
+  omp_task_dep_table_t *table;
+
+  table = (omp_task_dep_table_t *) malloc(sizeof(omp_task_dep_table_t));
+  Is_True(table != NULL, ("couldn't create task dependence table"));
+
+  table->num_buckets = OMP_TASK_DEP_TABLE_SIZE;
+  table->num_entries = 0;
+  table->buckets = (omp_task_dep_entry_t **)
+      calloc(table->num_buckets, sizeof(omp_task_dep_entry_t *));
+  Is_True(table->buckets != NULL, ("couldn't create task dependence table"));
+
+  return table;
+}
+
+static inline int __ompc_task_dep_hash(void *addr, int num_buckets)
+{
+  unsigned long a = (unsigned long) addr;
+
+  /* blocks of a matrix tend to lie at a large power of two apart */
+  return (int) ((a ^ (a >> 7) ^ (a >> 17)) & (num_buckets - 1));
+}
+
+static void __ompc_task_dep_table_grow(omp_task_dep_table_t *table)
+{
+  omp_task_dep_entry_t **buckets, *entry, *next;
+  int num_buckets, i, b;
+
+  num_buckets = table->num_buckets * 2;
+  buckets = (omp_task_dep_entry_t **)
+      calloc(num_buckets, sizeof(omp_task_dep_entry_t *));
+  Is_True(buckets != NULL, ("couldn't grow task dependence table"));
+
+  for (i = 0; i < table->num_buckets; i++) {
+    for (entry = table->buckets[i]; entry != NULL; entry = next) {
+      next = entry->next;
+      b = __ompc_task_dep_hash(entry->addr, num_buckets);
+      entry->next = buckets[b];
+      buckets[b] = entry;
+    }
+  }
+
+  free(table->buckets);
+  table->buckets = buckets;
+  table->num_buckets = num_buckets;
+}
+
+static omp_task_dep_entry_t *
+__ompc_task_dep_lookup(omp_task_dep_table_t *table, void *addr)
+{
+  omp_task_dep_entry_t *entry;
+  int b;
+
+  b = __ompc_task_dep_hash(addr, table->num_buckets);
+  for (entry = table->buckets[b]; entry != NULL; entry = entry->next)
+    if (entry->addr == addr)
+      return entry;
+
+  if (table->num_entries >= table->num_buckets * 2) {
+    __ompc_task_dep_table_grow(table);
+    b = __ompc_task_dep_hash(addr, table->num_buckets);
+  }
+
+  entry = (omp_task_dep_entry_t *) malloc(sizeof(omp_task_dep_entry_t));
+  Is_True(entry != NULL, ("couldn't create task dependence entry"));
+  entry->addr = addr;
+  entry->last_out = NULL;
+  entry->readers = NULL;
+  entry->num_readers = 0;
+  entry->max_readers = 0;
+  entry->next = table->buckets[b];
+  table->buckets[b] = entry;
+  table->num_entries++;
+
+  return entry;
+}
+
+static void __ompc_task_dep_table_clear(omp_task_dep_table_t *table)
+{
+  omp_task_dep_entry_t *entry, *next;
+  int i, r;
+
+  for (i = 0; i < table->num_buckets; i++) {
+    for (entry = table->buckets[i]; entry != NULL; entry = next) {
+      next = entry->next;
+      if (entry->last_out != NULL)
+        __ompc_task_dep_node_unref(entry->last_out);
+      for (r = 0; r < entry->num_readers; r++)
+        __ompc_task_dep_node_unref(entry->readers[r]);
+      free(entry->readers);
+      free(entry);
+    }
+    table->buckets[i] = NULL;
+  }
+  table->num_entries = 0;
+}
+
+void __ompc_task_dep_table_free(omp_task_t *task)
+{
+  omp_task_dep_table_t *table = task->dep_table;
+
+  __ompc_task_dep_table_clear(table);
+  free(table->buckets);
+  free(table);
+  task->dep_table = NULL;
+}
+
+/* enter the items of a new child of parent into parent's table */
+static void __ompc_task_dep_register(omp_task_t *parent,
+                                     omp_task_dep_node_t *node,
+                                     omp_task_dep_t *deps, int num_deps)
+{
+  omp_task_dep_table_t *table;
+  omp_task_dep_entry_t *entry;
+  int i, r;
+
+  table = parent->dep_table;
+  if (table == NULL) {
+    table = __ompc_task_dep_table_new();
+    parent->dep_table = table;
+  } else if (parent->num_children == 0 && table->num_entries > 0) {
+    /* every earlier child has exited, nothing left to wait for */
+    __ompc_task_dep_table_clear(table);
+  }
+
+  for (i = 0; i < num_deps; i++) {
+    entry = __ompc_task_dep_lookup(table, deps[i].addr);
+
+    __ompc_task_dep_add_predecessor(node, entry->last_out);
+
+    if (deps[i].kind & OMP_TASK_DEP_OUT) {
+      for (r = 0; r < entry->num_readers; r++) {
+        __ompc_task_dep_add_predecessor(node, entry->readers[r]);
+        __ompc_task_dep_node_unref(entry->readers[r]);
+      }
+      entry->num_readers = 0;
+
+      if (entry->last_out != NULL)
+        __ompc_task_dep_node_unref(entry->last_out);
+      __ompc_task_dep_node_ref(node);
+      entry->last_out = node;
+    } else {
+      if (entry->num_readers == entry->max_readers) {
+        entry->max_readers = entry->max_readers ? entry->max_readers * 2 : 4;
+        entry->readers = (omp_task_dep_node_t **)
+            realloc(entry->readers,
+                    entry->max_readers * sizeof(omp_task_dep_node_t *));
+        Is_True(entry->readers != NULL,
+                ("couldn't grow task dependence readers"));
+      }
+      __ompc_task_dep_node_ref(node);
+      entry->readers[entry->num_readers++] = node;
+    }
+  }
+}
+
+/* put a task whose predecessors have all exited into the current thread's
+ * queue, or run it now if the queue is full */
+static void __ompc_task_dep_schedule(omp_task_t *task)
+{
+  omp_team_t *team = __omp_current_v_thread->team;
+
+  if (__ompc_add_task_to_pool(team->task_pool, task) == 0)
+    __ompc_task_switch(task);
+}
+
+/* the task of node has exited, release its successors */
+static void __ompc_task_dep_release(omp_task_dep_node_t *node)
+{
+  omp_task_dep_link_t *link, *next;
+  omp_task_dep_node_t *succ;
+
+  __ompc_lock_spinlock(&node->lock);
+  node->done = 1;
+  link = node->successors;
+  node->successors = NULL;
+  __ompc_unlock_spinlock(&node->lock);
+
+  for ( ; link != NULL; link = next) {
+    next = link->next;
+    succ = link->node;
+    free(link);
+    /* an undeferred task has no task object yet, its creator is waiting
+     * for the count to drop */
+    if (__ompc_atomic_dec(&succ->num_predecessors) == 0 && succ->task != NULL)
+      __ompc_task_dep_schedule(succ->task);
+  }
+
+  __ompc_task_dep_node_unref(node);
+}
+
+void __ompc_task_create_deps(omp_task_func taskfunc, void *frame_pointer,
+        void *firstprivates, int may_delay, int is_tied, int blocks_parent,
+        omp_task_dep_t *deps, int num_deps)
+{
+  omp_team_t *team;
+  omp_task_t *current_task, *new_task, *orig_task;
+  omp_task_dep_node_t *node;
+
+  current_task = __omp_current_task;
+
+  /* with no task object, the siblings run in program order anyway */
+  if (current_task == NULL || num_deps == 0) {
+    __ompc_task_create(taskfunc, frame_pointer, firstprivates, may_delay,
+                       is_tied, blocks_parent);
+    return;
+  }
+
+  team = __omp_current_v_thread->team;
+  node = __ompc_task_dep_node_new();
+  __ompc_task_dep_register(current_task, node, deps, num_deps);
+
+  if (may_delay && !__ompc_task_cutoff()) {
+    new_task = __ompc_task_new();
+    __ompc_task_set_function(new_task, taskfunc);
+    __ompc_task_set_frame_pointer(new_task, frame_pointer);
+    __ompc_task_set_firstprivates(new_task, firstprivates);
+    new_task->creating_thread_id = __omp_myid;
+    new_task->parent = current_task;
+    new_task->depth = current_task->depth + 1;
+    new_task->dep_node = node;
+    node->task = new_task;
+    __ompc_task_join_group(new_task, __ompc_task_current_group(current_task));
+
+    __ompc_task_set_flags(new_task, OMP_TASK_IS_DEFERRED);
+
+    if (is_tied)
+      __ompc_task_set_flags(new_task, OMP_TASK_IS_TIED);
+
+    __ompc_atomic_inc(&current_task->num_children);
+
+    if (blocks_parent) {
+      __ompc_task_set_flags(new_task, OMP_TASK_BLOCKS_PARENT);
+      __ompc_atomic_inc(&current_task->num_blocking_children);
+    }
+
+    /* drop the set-up count, the last predecessor schedules it otherwise */
+    if (__ompc_atomic_dec(&node->num_predecessors) == 0) {
+      __ompc_task_set_state(current_task, OMP_TASK_READY);
+      __ompc_task_dep_schedule(new_task);
+      __ompc_task_set_state(current_task, OMP_TASK_RUNNING);
+    }
+    return;
+  }
+
+  /* undeferred: run other tasks until the predecessors have exited */
+  if (__ompc_atomic_dec(&node->num_predecessors) != 0) {
+    __ompc_task_set_state(current_task, OMP_TASK_WAITING);
+    while (node->num_predecessors) {
+      new_task = __ompc_remove_task_from_pool(team->task_pool);
+      if (new_task != NULL)
+        __ompc_task_switch(new_task);
+    }
+    __ompc_task_set_state(current_task, OMP_TASK_RUNNING);
+  }
+
+  if (may_delay) {
+    /* cut off, see __ompc_task_create */
+    orig_task = current_task;
+    __omp_current_task = NULL;
+    taskfunc(firstprivates, frame_pointer);
+    __omp_current_task = orig_task;
+  } else {
+    __ompc_task_create(taskfunc, frame_pointer, firstprivates, 0,
+                       is_tied, blocks_parent);
+  }
+
+  __ompc_task_dep_release(node);
+}
+
 void __ompc_task_wait()
 {
   int myid;
@@ -208,6 +598,186 @@ void __ompc_task_wait()
   __ompc_task_set_state(current_task, OMP_TASK_RUNNING);
 }
 
+/* taskgroups */
+
+void __ompc_taskgroup_begin(void)
+{
+  omp_task_t *current_task = __omp_current_task;
+  omp_taskgroup_t *group;
+
+  /* without a task object, the descendants all run work-first */
+  if (current_task == NULL) return;
+
+  group = (omp_taskgroup_t *) aligned_malloc(sizeof(omp_taskgroup_t),
+                                             CACHE_LINE_SIZE);
+  Is_True(group != NULL, ("couldn't create taskgroup"));
+  group->num_tasks = 0;
+  group->prev = current_task->taskgroup;
+  current_task->taskgroup = group;
+}
+
+void __ompc_taskgroup_end(void)
+{
+  omp_team_t *team;
+  omp_task_t *current_task, *next_task;
+  omp_taskgroup_t *group;
+
+  current_task = __omp_current_task;
+  if (current_task == NULL) return;
+
+  group = current_task->taskgroup;
+  Is_True(group != NULL, ("__ompc_taskgroup_end: no taskgroup to end"));
+
+  if (group->num_tasks) {
+    team = __omp_current_v_thread->team;
+    __ompc_task_set_state(current_task, OMP_TASK_WAITING);
+    while (group->num_tasks) {
+      next_task = __ompc_remove_task_from_pool(team->task_pool);
+      if (next_task != NULL)
+        __ompc_task_switch(next_task);
+    }
+    __ompc_task_set_state(current_task, OMP_TASK_RUNNING);
+  }
+
+  current_task->taskgroup = group->prev;
+  aligned_free(group);
+}
+
+/* taskloops
+ *
+ * The compiler turns a taskloop into a single task, announced by
+ * __ompc_taskloop_begin, whose body runs
+ *
+ *    while (__ompc_taskloop_next(&lo, &hi))
+ *      for (; lo < hi; ++lo) ...
+ *
+ * over the iteration numbers of the loop. The first call in a deferred task
+ * hands the upper half of the task's chunks to a copy of the task, with its
+ * own copy of the firstprivates, and repeats on the lower half until one
+ * chunk is left. The copies do the same with their halves, so the tasks are
+ * created in a tree rather than one after another by the encountering
+ * thread. The copies are siblings of the first task, and count in the same
+ * taskgroup. A task which is not deferred runs all of its chunks itself.
+ */
+
+static inline long __ompc_taskloop_chunk_start(omp_taskloop_t *loop, long i)
+{
+  return i * loop->size + (i < loop->rest ? i : loop->rest);
+}
+
+static void __ompc_taskloop_split(omp_task_t *task)
+{
+  omp_task_t *parent = task->parent;
+  omp_task_t *new_task;
+  omp_taskloop_t *loop = &task->taskloop;
+  omp_task_flags_t flags;
+  void *firstprivates;
+  long mid;
+
+  /* the size of a frame is only known if it came from
+   * __ompc_task_firstprivates_alloc */
+  if (task->firstprivates != NULL && loop->firstprivates_size == 0)
+    return;
+
+  flags = __ompc_task_get_flags(task, OMP_TASK_IS_TIED |
+                                      OMP_TASK_BLOCKS_PARENT);
+
+  while (loop->end - loop->first > 1) {
+    mid = loop->first + (loop->end - loop->first) / 2;
+
+    firstprivates = NULL;
+    if (task->firstprivates != NULL) {
+      firstprivates = __ompc_task_alloc_frame(loop->firstprivates_size);
+      memcpy(firstprivates, task->firstprivates, loop->firstprivates_size);
+    }
+
+    new_task = __ompc_task_new();
+    __ompc_task_set_function(new_task, task->t.func);
+    __ompc_task_set_frame_pointer(new_task, task->frame_pointer);
+    __ompc_task_set_firstprivates(new_task, firstprivates);
+    new_task->creating_thread_id = __omp_myid;
+    new_task->parent = parent;
+    new_task->depth = task->depth;
+    __ompc_task_join_group(new_task, task->group);
+
+    new_task->taskloop = *loop;
+    new_task->taskloop.first = mid;
+    loop->end = mid;
+
+    __ompc_task_set_flags(new_task, OMP_TASK_IS_DEFERRED | flags);
+
+    __ompc_atomic_inc(&parent->num_children);
+    if (flags & OMP_TASK_BLOCKS_PARENT)
+      __ompc_atomic_inc(&parent->num_blocking_children);
+
+    if (__ompc_add_task_to_pool(__omp_current_v_thread->team->task_pool,
+                                new_task) == 0) {
+      __ompc_task_set_state(task, OMP_TASK_READY);
+      __ompc_task_switch(new_task);
+      __ompc_task_set_state(task, OMP_TASK_RUNNING);
+    }
+  }
+}
+
+/* Announce the taskloop whose task the thread creates next. The loop runs
+ * from lb to the inclusive ub by step, and its iterations are numbered from
+ * 0. They are split into chunks of grainsize to 2*grainsize iterations
+ * each, or into num_tasks chunks, or by default into
+ * OMP_TASKLOOP_TASKS_PER_THREAD chunks per thread of the team. The first
+ * n % chunks chunks get one iteration more than the others. */
+void __ompc_taskloop_begin(long lb, long ub, long step, long grainsize,
+                           long num_tasks)
+{
+  omp_taskloop_t *loop = &__omp_taskloop_pending;
+  long n, tasks;
+
+  if (step > 0)
+    n = ub < lb ? 0 : (ub - lb) / step + 1;
+  else
+    n = ub > lb ? 0 : (lb - ub) / -step + 1;
+
+  if (grainsize > 0) {
+    tasks = n / grainsize;
+    if (tasks < 1)
+      tasks = 1;
+  } else if (num_tasks > 0) {
+    tasks = num_tasks;
+  } else {
+    tasks = (long) __ompc_get_num_threads() * OMP_TASKLOOP_TASKS_PER_THREAD;
+  }
+  if (tasks > n)
+    tasks = n;
+
+  loop->first = 0;
+  loop->end = tasks;
+  loop->size = tasks > 0 ? n / tasks : 0;
+  loop->rest = tasks > 0 ? n % tasks : 0;
+  loop->firstprivates_size = 0;
+  __omp_taskloop_is_pending = 1;
+}
+
+/* Hand out the iteration numbers [*lo, *hi) left to the current taskloop
+ * task, splitting them first if the task is deferred. Returns 0 when there
+ * are none left. */
+int __ompc_taskloop_next(long *lo, long *hi)
+{
+  omp_task_t *current_task = __omp_current_task;
+  omp_taskloop_t *loop;
+
+  loop = current_task != NULL ? &current_task->taskloop
+                              : __omp_taskloop_current;
+  if (loop == NULL || loop->first >= loop->end)
+    return 0;
+
+  if (current_task != NULL && __ompc_task_is_deferred(current_task))
+    __ompc_taskloop_split(current_task);
+
+  *lo = __ompc_taskloop_chunk_start(loop, loop->first);
+  *hi = __ompc_taskloop_chunk_start(loop, loop->end);
+  loop->first = loop->end;
+  return 1;
+}
+
 void __ompc_task_exit()
 {
   omp_task_flag_t flags;
@@ -228,6 +798,13 @@ void __ompc_task_exit()
 
   __ompc_task_set_state(current_task, OMP_TASK_EXITING);
 
+  /* release the successors before the task stops counting as pending, so
+   * that a barrier can't see the pool drained in between */
+  if (current_task->dep_node != NULL) {
+    __ompc_task_dep_release(current_task->dep_node);
+    current_task->dep_node = NULL;
+  }
+
   if (__ompc_task_is_deferred(current_task)) {
     Is_True(current_task->parent != NULL,
             ("deferred task should has a NULL parent"));
@@ -261,16 +838,23 @@ void __ompc_task_exit()
   flags = OMP_TASK_IS_DEFERRED | OMP_TASK_BLOCKS_PARENT;
   if (__ompc_task_get_flags(current_task, flags) == flags)
     __ompc_atomic_dec(&current_task->parent->num_blocking_children);
+
+  /* last, as the end of the taskgroup frees it */
+  if (__ompc_task_is_deferred(current_task) && current_task->group != NULL)
+    __ompc_atomic_dec(&current_task->group->num_tasks);
 }
 
 void __ompc_task_firstprivates_alloc(void **firstprivates, int size)
 {
-  *firstprivates = aligned_malloc(size, CACHE_LINE_SIZE);
+  *firstprivates = __ompc_task_alloc_frame(size);
+  /* a taskloop task copies its frame when it splits */
+  if (__omp_taskloop_is_pending)
+    __omp_taskloop_pending.firstprivates_size = size;
 }
 
 void __ompc_task_firstprivates_free(void *firstprivates)
 {
-  aligned_free(firstprivates);
+  __ompc_task_alloc_free_frame(firstprivates);
 }
 
 
@@ -280,6 +864,12 @@ void __ompc_task_switch(omp_task_t *new_task)
 {
   omp_v_thread_t *current_thread = __omp_current_v_thread;
   omp_task_t *orig_task = __omp_current_task;
+  int stats_counter = 0;
+  /* read once, so that the end matches the begin if it changes meanwhile */
+  int region_stats = __omp_region_stats;
+
+  if (region_stats)
+    stats_counter = __ompc_region_stats_task_begin();
 
   __ompc_task_set_state(new_task, OMP_TASK_RUNNING);
   __omp_current_task = new_task;
@@ -305,6 +895,9 @@ void __ompc_task_switch(omp_task_t *new_task)
   }
 
   __omp_current_task = orig_task;
+
+  if (region_stats)
+    __ompc_region_stats_task_end(stats_counter);
 }
 
 static inline int __ompc_task_cutoff_num_threads()
@@ -33,6 +33,7 @@
 #include <string.h>
 #include "omp_sys.h"
 #include "omp_lock.h"
+#include "omp_task_alloc.h"
 #include "pcl.h"
 
 #define OMP_TASK_STACK_SIZE_DEFAULT     0x010000L /* 64 KB */
@@ -43,6 +44,9 @@
 #define OMP_TASK_MOD_LEVEL_DEFAULT 3
 #define OMP_TASK_CREATE_COND_DEFAULT &__ompc_task_true_cond
 
+/* default number of taskloop tasks per thread of the team */
+#define OMP_TASKLOOP_TASKS_PER_THREAD 4
+
 typedef enum {
   OMP_TASK_UNSCHEDULED,
   OMP_TASK_READY,
@@ -64,6 +68,85 @@ typedef enum {
 
 typedef unsigned int omp_task_flags_t;
 
+/* kinds of a depend clause item */
+typedef enum {
+  OMP_TASK_DEP_IN    = 0x1,
+  OMP_TASK_DEP_OUT   = 0x2,
+  OMP_TASK_DEP_INOUT = 0x3
+} omp_task_dep_kind_t;
+
+/* one item of a depend clause, as passed by the compiler */
+struct omp_task_dep {
+  void *addr;
+  long kind;
+};
+typedef struct omp_task_dep omp_task_dep_t;
+
+struct omp_task;
+
+/* The dependence state of a task created with a depend clause. It outlives
+ * the task for as long as the dependence table of the parent refers to it.
+ */
+struct omp_task_dep_node {
+  struct omp_task *task;        /* NULL while an undeferred task waits */
+  /* unfinished predecessors, plus one while the node is being set up */
+  volatile int num_predecessors;
+  volatile int ref_count;
+  volatile int done;
+  struct omp_task_dep_link *successors;
+  ompc_spinlock_t lock;
+};
+typedef struct omp_task_dep_node omp_task_dep_node_t;
+
+struct omp_task_dep_link {
+  omp_task_dep_node_t *node;
+  struct omp_task_dep_link *next;
+};
+typedef struct omp_task_dep_link omp_task_dep_link_t;
+
+/* last writer and the readers since, of one address */
+struct omp_task_dep_entry {
+  void *addr;
+  omp_task_dep_node_t *last_out;
+  omp_task_dep_node_t **readers;
+  int num_readers;
+  int max_readers;
+  struct omp_task_dep_entry *next;
+};
+typedef struct omp_task_dep_entry omp_task_dep_entry_t;
+
+#define OMP_TASK_DEP_TABLE_SIZE 64
+
+/* The dependences among the children of a task, hashed by address. Only the
+ * task which owns it touches the table, so it needs no lock. */
+struct omp_task_dep_table {
+  omp_task_dep_entry_t **buckets;
+  int num_buckets;
+  int num_entries;
+};
+typedef struct omp_task_dep_table omp_task_dep_table_t;
+
+/* A taskgroup counts the tasks created in it and their descendants, and
+ * its end waits until they have all exited. */
+struct omp_taskgroup {
+  volatile int num_tasks;
+  struct omp_taskgroup *prev;   /* enclosing taskgroup of the same task */
+};
+typedef struct omp_taskgroup omp_taskgroup_t;
+
+/* The part of a taskloop a task runs: chunks [first, end) of the loop,
+ * where chunk i starts at iteration i * size + min(i, rest). A task with
+ * more than one chunk hands the upper half to a copy of itself, see
+ * __ompc_taskloop_next. */
+struct omp_taskloop {
+  long first;
+  long end;
+  long size;
+  long rest;
+  unsigned long firstprivates_size;
+};
+typedef struct omp_taskloop omp_taskloop_t;
+
 /* function pointer declarations*/
 typedef void (*omp_task_func)(void *, void *);
 typedef int (*cond_func)();
@@ -101,6 +184,18 @@ struct omp_task {
   ompc_lock_t lock;
 
   omp_task_flags_t flags;
+
+  /* for the depend clause: the task's own node, and the table of its
+   * children's dependences */
+  omp_task_dep_node_t *dep_node;
+  omp_task_dep_table_t *dep_table;
+
+  /* the taskgroup the task counts in, and the innermost one it opened */
+  omp_taskgroup_t *group;
+  omp_taskgroup_t *taskgroup;
+
+  /* chunks left to the task if it runs a taskloop */
+  omp_taskloop_t taskloop;
 } __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
 typedef struct omp_task omp_task_t;
 
@@ -242,7 +337,7 @@ static inline omp_task_t *__ompc_task_new_implicit(void)
 static inline omp_task_t *__ompc_task_new(void)
 {
   omp_task_t *new_task =
-      (omp_task_t*)aligned_malloc(sizeof(omp_task_t),CACHE_LINE_SIZE);
+      (omp_task_t*)__ompc_task_alloc(OMP_TASK_ALLOC_TASK);
 
   Is_True(new_task != NULL, ("couldn't create new task object"));
   memset(new_task, 0, sizeof(omp_task_t));
@@ -252,11 +347,19 @@ static inline omp_task_t *__ompc_task_new(void)
   return new_task;
 }
 
+extern void __ompc_task_dep_table_free(omp_task_t *task);
+
 static inline void __ompc_task_delete(omp_task_t *task)
 {
   Is_True(task != NULL, ("tried to delete a NULL task"));
 
-  aligned_free(task);
+  if (task->dep_table != NULL)
+    __ompc_task_dep_table_free(task);
+  /* implicit tasks don't come from the task allocator */
+  if (__ompc_task_is_implicit(task))
+    aligned_free(task);
+  else
+    __ompc_task_alloc_free(task);
 }
 
 static inline void
@@ -298,8 +401,17 @@ extern int __omp_task_cutoff_num_children_max;
 extern int __ompc_task_will_defer(int may_delay);
 extern void __ompc_task_create(omp_task_func taskfunc, void *frame_pointer,
               void *firstprivates, int may_delay, int is_tied, int blocks_parent);
+extern void __ompc_task_create_deps(omp_task_func taskfunc,
+              void *frame_pointer, void *firstprivates, int may_delay,
+              int is_tied, int blocks_parent, omp_task_dep_t *deps,
+              int num_deps);
 extern void __ompc_task_wait();
 extern void __ompc_task_exit();
+extern void __ompc_taskgroup_begin(void);
+extern void __ompc_taskgroup_end(void);
+extern void __ompc_taskloop_begin(long lb, long ub, long step,
+              long grainsize, long num_tasks);
+extern int __ompc_taskloop_next(long *lo, long *hi);
 
 extern void __ompc_task_firstprivates_alloc(void **firstprivates, int size);
 extern void __ompc_task_firstprivates_free(void *firstprivates);
@@ -0,0 +1,347 @@
+/*
+ Task Memory Allocator for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#include <pthread.h>
+#include "omp_rtl.h"
+#include "omp_task.h"
+#include "omp_task_alloc.h"
+
+/* Description: every thread owns a pool of slabs from which it hands out
+ * task descriptors and firstprivate frames, one free list per size class.
+ * Only the owner touches the free lists, so allocation and a free by the
+ * owner take no lock and no atomic operation.
+ *
+ * A task is often freed by another thread than the one which created it.
+ * Such a thread collects the blocks of one owner in a private chain and
+ * pushes the whole chain onto the owner's remote_free list when it holds
+ * OMP_TASK_ALLOC_BATCH blocks, when a block of another owner comes along,
+ * or when the thread waits in a barrier. The owner takes the remote_free
+ * list at once when one of its free lists runs dry. Since remote_free is
+ * only ever pushed to and taken as a whole, a compare-and-swap push and an
+ * exchange pop are enough.
+ *
+ * Slabs are not returned to the system. When a thread exits, its pool is
+ * marked unused and adopted by the next thread which needs one, so that
+ * short lived nested threads don't leave a pool each behind.
+ *
+ * With O64_OMP_TASK_ALLOC=MALLOC, tasks and frames come from aligned_malloc
+ * as before.
+ */
+
+omp_task_alloc_mode_t __omp_task_alloc_mode = OMP_TASK_ALLOC_SLAB;
+
+static __thread omp_task_alloc_pool_t *__omp_task_alloc_pool;
+static omp_task_alloc_pool_t * volatile __omp_task_alloc_pools;
+static pthread_key_t __omp_task_alloc_key;
+
+static inline unsigned long __ompc_task_alloc_round(unsigned long size)
+{
+  return (size + CACHE_LINE_SIZE - 1) & ~((unsigned long)CACHE_LINE_SIZE - 1);
+}
+
+static inline omp_task_slab_t *__ompc_task_slab_of(void *p)
+{
+  return (omp_task_slab_t *)
+      ((unsigned long)p & ~((unsigned long)OMP_TASK_SLAB_SIZE - 1));
+}
+
+static void __ompc_task_alloc_flush_batch(omp_task_alloc_pool_t *pool)
+{
+  omp_task_alloc_pool_t *owner = pool->batch_owner;
+  omp_task_free_block_t *old_head;
+
+  if (pool->batch_head == NULL)
+    return;
+
+  do {
+    old_head = owner->remote_free;
+    pool->batch_tail->next = old_head;
+  } while (!__sync_bool_compare_and_swap(&owner->remote_free, old_head,
+                                         pool->batch_head));
+
+  pool->stats.remote_batches++;
+  pool->batch_owner = NULL;
+  pool->batch_head = NULL;
+  pool->batch_tail = NULL;
+  pool->batch_count = 0;
+}
+
+/* called by pthreads when a thread which used its pool exits */
+static void __ompc_task_alloc_release(void *arg)
+{
+  omp_task_alloc_pool_t *pool = (omp_task_alloc_pool_t *) arg;
+
+  __ompc_task_alloc_flush_batch(pool);
+  __ompc_mfence();
+  pool->in_use = 0;
+}
+
+static omp_task_alloc_pool_t *__ompc_task_alloc_pool_new(void)
+{
+  omp_task_alloc_pool_t *pool;
+  omp_task_alloc_pool_t *old_head;
+  int i;
+
+  /* adopt the pool of a thread which has exited */
+  for (pool = __omp_task_alloc_pools; pool != NULL; pool = pool->next) {
+    if (pool->in_use == 0 && __ompc_cas(&pool->in_use, 0, 1))
+      return pool;
+  }
+
+  pool = (omp_task_alloc_pool_t *)
+      aligned_malloc(sizeof(omp_task_alloc_pool_t), CACHE_LINE_SIZE);
+  Is_True(pool != NULL, ("couldn't create task allocator pool"));
+  memset(pool, 0, sizeof(omp_task_alloc_pool_t));
+
+  pool->bins[OMP_TASK_ALLOC_TASK].size =
+      __ompc_task_alloc_round(sizeof(omp_task_t));
+  for (i = OMP_TASK_ALLOC_FRAME_64; i < OMP_TASK_ALLOC_NUM_CLASSES; i++)
+    pool->bins[i].size = 64UL << (i - OMP_TASK_ALLOC_FRAME_64);
+  pool->in_use = 1;
+
+  do {
+    old_head = __omp_task_alloc_pools;
+    pool->next = old_head;
+  } while (!__sync_bool_compare_and_swap(&__omp_task_alloc_pools, old_head,
+                                         pool));
+
+  return pool;
+}
+
+static inline omp_task_alloc_pool_t *__ompc_task_alloc_get_pool(void)
+{
+  omp_task_alloc_pool_t *pool = __omp_task_alloc_pool;
+
+  if (pool == NULL) {
+    pool = __ompc_task_alloc_pool_new();
+    pthread_setspecific(__omp_task_alloc_key, pool);
+    __omp_task_alloc_pool = pool;
+  }
+  return pool;
+}
+
+/* sort the blocks freed by other threads into their free lists */
+static void __ompc_task_alloc_reclaim(omp_task_alloc_pool_t *pool)
+{
+  omp_task_free_block_t *block, *next;
+  omp_task_alloc_bin_t *bin;
+
+  block = __sync_lock_test_and_set(&pool->remote_free, NULL);
+  for (; block != NULL; block = next) {
+    next = block->next;
+    bin = &pool->bins[__ompc_task_slab_of(block)->size_class];
+    block->next = bin->free_list;
+    bin->free_list = block;
+  }
+}
+
+static void __ompc_task_alloc_new_slab(omp_task_alloc_pool_t *pool,
+                                       omp_task_alloc_class_t size_class)
+{
+  omp_task_alloc_bin_t *bin = &pool->bins[size_class];
+  omp_task_slab_t *slab;
+
+  slab = (omp_task_slab_t *) aligned_malloc(OMP_TASK_SLAB_SIZE,
+                                            OMP_TASK_SLAB_SIZE);
+  Is_True(slab != NULL, ("couldn't allocate task slab"));
+  slab->owner = pool;
+  slab->size_class = size_class;
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  pool->stats.slabs++;
+
+  bin->bump = (char *) slab + sizeof(omp_task_slab_t);
+  bin->bump_end = (char *) slab + OMP_TASK_SLAB_SIZE;
+}
+
+void __ompc_task_alloc_init(void)
+{
+  pthread_key_create(&__omp_task_alloc_key, __ompc_task_alloc_release);
+}
+
+void *__ompc_task_alloc(omp_task_alloc_class_t size_class)
+{
+  omp_task_alloc_pool_t *pool;
+  omp_task_alloc_bin_t *bin;
+  omp_task_free_block_t *block;
+  void *p;
+
+  if (__omp_task_alloc_mode == OMP_TASK_ALLOC_MALLOC) {
+    unsigned long size = size_class == OMP_TASK_ALLOC_TASK ?
+        sizeof(omp_task_t) : 64UL << (size_class - OMP_TASK_ALLOC_FRAME_64);
+    return aligned_malloc(size, CACHE_LINE_SIZE);
+  }
+
+  pool = __ompc_task_alloc_get_pool();
+  bin = &pool->bins[size_class];
+
+  if (bin->free_list == NULL && pool->remote_free != NULL)
+    __ompc_task_alloc_reclaim(pool);
+
+  block = bin->free_list;
+  if (block != NULL) {
+    bin->free_list = block->next;
+    p = block;
+  } else {
+    if (bin->bump + bin->size > bin->bump_end)
+      __ompc_task_alloc_new_slab(pool, size_class);
+    p = bin->bump;
+    bin->bump += bin->size;
+  }
+
+  if (size_class == OMP_TASK_ALLOC_TASK)
+    pool->stats.task_allocs++;
+  else
+    pool->stats.frame_allocs++;
+
+  return p;
+}
+
+void *__ompc_task_alloc_frame(unsigned long size)
+{
+  omp_task_alloc_pool_t *pool;
+  omp_task_frame_header_t *header;
+  int size_class;
+
+  if (__omp_task_alloc_mode == OMP_TASK_ALLOC_MALLOC)
+    return aligned_malloc(size, CACHE_LINE_SIZE);
+
+  size += sizeof(omp_task_frame_header_t);
+  if (size <= OMP_TASK_ALLOC_MAX_FRAME) {
+    for (size_class = OMP_TASK_ALLOC_FRAME_64;
+         (64UL << (size_class - OMP_TASK_ALLOC_FRAME_64)) < size;
+         size_class++)
+      ;
+    header = (omp_task_frame_header_t *)
+        __ompc_task_alloc((omp_task_alloc_class_t) size_class);
+    header->size_class = (omp_task_alloc_class_t) size_class;
+    return header + 1;
+  }
+
+  /* too big for a slab, it needs no more than the alignment of a small
+   * frame since the free does not look at its address */
+  pool = __ompc_task_alloc_get_pool();
+  header = (omp_task_frame_header_t *) aligned_malloc(size, CACHE_LINE_SIZE);
+  Is_True(header != NULL, ("couldn't allocate firstprivate frame"));
+  header->owner = pool;
+  header->size_class = OMP_TASK_ALLOC_LARGE;
+  pool->stats.large_allocs++;
+
+  return header + 1;
+}
+
+void __ompc_task_alloc_free(void *p)
+{
+  omp_task_alloc_pool_t *pool;
+  omp_task_slab_t *slab;
+  omp_task_free_block_t *block;
+
+  if (p == NULL)
+    return;
+
+  if (__omp_task_alloc_mode == OMP_TASK_ALLOC_MALLOC) {
+    aligned_free(p);
+    return;
+  }
+
+  pool = __ompc_task_alloc_get_pool();
+  slab = __ompc_task_slab_of(p);
+  block = (omp_task_free_block_t *) p;
+
+  if (slab->owner == pool) {
+    omp_task_alloc_bin_t *bin = &pool->bins[slab->size_class];
+    block->next = bin->free_list;
+    bin->free_list = block;
+    pool->stats.local_frees++;
+    return;
+  }
+
+  pool->stats.remote_frees++;
+  if (pool->batch_owner != slab->owner) {
+    __ompc_task_alloc_flush_batch(pool);
+    pool->batch_owner = slab->owner;
+    pool->batch_tail = block;
+  }
+  block->next = pool->batch_head;
+  pool->batch_head = block;
+  if (++pool->batch_count == OMP_TASK_ALLOC_BATCH)
+    __ompc_task_alloc_flush_batch(pool);
+}
+
+void __ompc_task_alloc_free_frame(void *p)
+{
+  omp_task_alloc_pool_t *pool;
+  omp_task_frame_header_t *header;
+
+  if (p == NULL)
+    return;
+
+  if (__omp_task_alloc_mode == OMP_TASK_ALLOC_MALLOC) {
+    aligned_free(p);
+    return;
+  }
+
+  header = (omp_task_frame_header_t *) p - 1;
+  if (header->size_class != OMP_TASK_ALLOC_LARGE) {
+    __ompc_task_alloc_free(header);
+    return;
+  }
+
+  pool = __ompc_task_alloc_get_pool();
+  if (header->owner == pool)
+    pool->stats.local_frees++;
+  else
+    pool->stats.remote_frees++;
+  aligned_free(header);
+}
+
+/* hand back the blocks of other threads which the calling thread still
+ * holds; called when it has run out of tasks in a barrier */
+void __ompc_task_alloc_flush(void)
+{
+  omp_task_alloc_pool_t *pool = __omp_task_alloc_pool;
+
+  if (pool != NULL)
+    __ompc_task_alloc_flush_batch(pool);
+}
+
+void __ompc_task_alloc_get_stats(omp_task_alloc_stats_t *stats)
+{
+  omp_task_alloc_pool_t *pool;
+
+  memset(stats, 0, sizeof(omp_task_alloc_stats_t));
+  for (pool = __omp_task_alloc_pools; pool != NULL; pool = pool->next) {
+    stats->task_allocs    += pool->stats.task_allocs;
+    stats->frame_allocs   += pool->stats.frame_allocs;
+    stats->large_allocs   += pool->stats.large_allocs;
+    stats->local_frees    += pool->stats.local_frees;
+    stats->remote_frees   += pool->stats.remote_frees;
+    stats->remote_batches += pool->stats.remote_batches;
+    stats->slabs          += pool->stats.slabs;
+  }
+}
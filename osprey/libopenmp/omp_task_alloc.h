@@ -0,0 +1,121 @@
+/*
+ Task Memory Allocator for Open64's OpenMP runtime library
+
+ Copyright (C) 2011 University of Houston.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of version 2 of the GNU General Public License as
+ published by the Free Software Foundation.
+
+ This program is distributed in the hope that it would be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Further, this software is distributed without any warranty that it is
+ free of the rightful claim of any third person regarding infringement
+ or the like.  Any license provided herein, whether implied or
+ otherwise, applies only to this software file.  Patent licenses, if
+ any, provided herein do not apply to combinations of this program with
+ other software, or any other product whatsoever.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston MA 02111-1307, USA.
+
+ Contact information:
+ http://www.cs.uh.edu/~hpctools
+*/
+
+#ifndef __omp_task_alloc_included
+#define __omp_task_alloc_included
+
+#include "omp_sys.h"
+#include "omp_collector_api.h"
+
+/* Each thread carves task descriptors and small firstprivate frames out of
+ * its own slabs. A slab is OMP_TASK_SLAB_SIZE bytes, aligned on its size,
+ * so the header of the slab holding any block is found by masking the
+ * block's address. Large frames are allocated one by one. Every frame is
+ * preceded by a frame header, which tells the free which kind it is. */
+#define OMP_TASK_SLAB_SIZE        (64*1024)
+#define OMP_TASK_ALLOC_MAX_FRAME  512
+
+/* blocks freed by a thread other than the owner are handed back in chains
+ * of at most this many */
+#define OMP_TASK_ALLOC_BATCH      32
+
+typedef enum {
+  OMP_TASK_ALLOC_TASK = 0,     /* omp_task_t */
+  OMP_TASK_ALLOC_FRAME_64,
+  OMP_TASK_ALLOC_FRAME_128,
+  OMP_TASK_ALLOC_FRAME_256,
+  OMP_TASK_ALLOC_FRAME_512,
+  OMP_TASK_ALLOC_NUM_CLASSES,
+  OMP_TASK_ALLOC_LARGE = OMP_TASK_ALLOC_NUM_CLASSES
+} omp_task_alloc_class_t;
+
+typedef enum {
+  OMP_TASK_ALLOC_SLAB,
+  OMP_TASK_ALLOC_MALLOC
+} omp_task_alloc_mode_t;
+
+struct omp_task_alloc_pool;
+
+struct omp_task_slab {
+  struct omp_task_alloc_pool *owner;
+  omp_task_alloc_class_t size_class;
+  struct omp_task_slab *next;
+} __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
+typedef struct omp_task_slab omp_task_slab_t;
+
+struct omp_task_frame_header {
+  struct omp_task_alloc_pool *owner;   /* of a large frame */
+  omp_task_alloc_class_t size_class;
+} __attribute__ ((__aligned__(16)));
+typedef struct omp_task_frame_header omp_task_frame_header_t;
+
+struct omp_task_free_block {
+  struct omp_task_free_block *next;
+};
+typedef struct omp_task_free_block omp_task_free_block_t;
+
+struct omp_task_alloc_bin {
+  omp_task_free_block_t *free_list;
+  char *bump;             /* unused tail of the newest slab of this class */
+  char *bump_end;
+  unsigned long size;
+};
+typedef struct omp_task_alloc_bin omp_task_alloc_bin_t;
+
+struct omp_task_alloc_pool {
+  /* owner-only state */
+  omp_task_alloc_bin_t bins[OMP_TASK_ALLOC_NUM_CLASSES];
+  omp_task_slab_t *slabs;
+
+  /* blocks of another pool waiting to be handed back in one batch */
+  struct omp_task_alloc_pool *batch_owner;
+  omp_task_free_block_t *batch_head;
+  omp_task_free_block_t *batch_tail;
+  int batch_count;
+
+  omp_task_alloc_stats_t stats;
+  struct omp_task_alloc_pool *next;   /* all pools, never freed */
+  volatile int in_use;                /* 0 once its thread has exited */
+
+  /* chains pushed by other threads, taken all at once by the owner */
+  omp_task_free_block_t * volatile remote_free
+      __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
+} __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
+typedef struct omp_task_alloc_pool omp_task_alloc_pool_t;
+
+extern omp_task_alloc_mode_t __omp_task_alloc_mode;
+
+extern void __ompc_task_alloc_init(void);
+extern void *__ompc_task_alloc(omp_task_alloc_class_t size_class);
+extern void *__ompc_task_alloc_frame(unsigned long size);
+extern void __ompc_task_alloc_free(void *p);
+extern void __ompc_task_alloc_free_frame(void *p);
+extern void __ompc_task_alloc_flush(void);
+extern void __ompc_task_alloc_get_stats(omp_task_alloc_stats_t *stats);
+
+#endif /* __omp_task_alloc_included */
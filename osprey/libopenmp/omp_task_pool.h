@@ -31,6 +31,7 @@
 
 #include "omp_sys.h"
 #include "omp_queue.h"
+#include "omp_futex.h"
 
 #define TASK_QUEUE_DEFAULT_NUM_SLOTS 128
 
@@ -47,8 +48,12 @@ struct omp_task_pool {
 
   /* Number of deferred tasks that are pending (i.e. have not yet exited) */
   volatile int num_pending_tasks;
-  pthread_mutex_t pool_lock;
-  pthread_cond_t pool_cond;
+
+  /* Threads out of tasks in a barrier sleep on idle_seq. It is bumped when
+   * num_pending_tasks goes from 0 to 1 and when the last thread arrives at
+   * the barrier, the two events which end their idling. */
+  volatile int idle_seq;
+  volatile int idle_waiters;
 
   int num_levels;
   int team_size;
@@ -62,6 +67,25 @@ static inline int __ompc_task_pool_num_pending_tasks(omp_task_pool_t *pool)
   return pool->num_pending_tasks;
 }
 
+static inline int __ompc_task_pool_idle_seq(omp_task_pool_t *pool)
+{
+  return pool->idle_seq;
+}
+
+/* sleep until idle_seq moves on from seq, or for at most __omp_wait_time */
+static inline void __ompc_task_pool_idle_wait(omp_task_pool_t *pool, int seq)
+{
+  extern long int __omp_wait_time;
+  __ompc_futex_wait(&pool->idle_seq, seq, &pool->idle_waiters,
+                    __omp_wait_time);
+}
+
+static inline void __ompc_task_pool_idle_wake(omp_task_pool_t *pool)
+{
+  __ompc_atomic_inc(&pool->idle_seq);
+  __ompc_futex_wake_all(&pool->idle_seq, &pool->idle_waiters);
+}
+
 static inline void __ompc_task_pool_set_team_size(omp_task_pool_t *pool,
                                                   int team_size)
 {
@@ -53,7 +53,7 @@
 #include "omp_xbarrier.h"
 
 #define SPIN_COUNT_DEFAULT 20000
-#define WAIT_TIME_DEFAULT 5000
+#define WAIT_TIME_DEFAULT 1000000
 #include "pcl.h"
 #include "omp_collector_util.h"
 #include "omp_collector_validation.h"
@@ -89,6 +89,7 @@ int * __omp_list_processors;
 /* default schedule type and chunk size of runtime schedule*/
 omp_sched_t  __omp_rt_sched_type = OMP_SCHED_DEFAULT;
 int  __omp_rt_sched_size = OMP_CHUNK_SIZE_DEFAULT;
+int  __omp_sched_steal = 0;
 
 volatile unsigned long int __omp_stack_size = OMP_STACK_SIZE_DEFAULT;
 volatile unsigned long int __omp_task_stack_size = OMP_TASK_STACK_SIZE_DEFAULT;
@@ -112,6 +113,8 @@ __thread omp_v_thread_t *__omp_current_v_thread;
 volatile int __attribute__ ((__aligned__(CACHE_LINE_SIZE)))__omp_level_1_pthread_count = 1;
 /* use for level_1 team end microtask synchronization */
 volatile int __attribute__ ((__aligned__(CACHE_LINE_SIZE)))__omp_level_1_exit_count = 0;
+/* the master sleeping on __omp_level_1_exit_count */
+static volatile int __omp_level_1_exit_waiters = 0;
 
 int __attribute__ ((__aligned__(CACHE_LINE_SIZE)))__omp_spin_user_lock = 0;
 
@@ -140,12 +143,6 @@ static pthread_attr_t	__omp_pthread_attr;
 //static pthread_barrierattr_t __omp_pthread_barrierattr;
 //static volatile int  __omp_exit_now = 0;
 
-static pthread_mutex_t __omp_level_1_mutex;
-static pthread_cond_t __omp_level_1_cond;
-
-static pthread_mutex_t __omp_level_1_barrier_mutex;
-static pthread_cond_t __omp_level_1_barrier_cond;
-
 pthread_mutex_t __omp_hash_table_lock;
 int ompc_req_start = 0;
 
@@ -163,12 +160,14 @@ void __ompc_fini_rtl();
 int  __ompc_init_rtl(int num_threads);
 void __ompc_expand_level_1_team(int new_num_threads);
 void *__ompc_level_1_slave(void *_u_thread_id);
-void *__ompc_nested_slave(void *_v_thread); 
+void *__ompc_nested_slave(void *_worker);
 
 
 void __ompc_set_state(OMP_COLLECTOR_API_THR_STATE state)
 {
   omp_v_thread_t *p_vthread = __ompc_get_v_thread_by_num( __omp_myid);
+  if (__omp_region_stats)
+    __ompc_region_stats_set_state(state);
   p_vthread->state = state;
 
   // omp_v_thread_t *p_vthread =  __ompc_get_current_v_thread();
@@ -369,6 +368,26 @@ __ompc_environment_variables()
     }
   }
 
+  /* OMP_PLACES and OMP_PROC_BIND take over from O64_OMP_SET_AFFINITY */
+  if (__ompc_affinity_init() >= 0)
+    __omp_set_affinity = 0;
+
+  env_var_str = getenv("O64_OMP_SCHEDULE_STEAL");
+  if (env_var_str != NULL) {
+    env_var_val = strncasecmp(env_var_str, "true", 4);
+
+    if (env_var_val == 0) {
+      __omp_sched_steal = 1;
+    } else {
+      env_var_val = strncasecmp(env_var_str, "false", 4);
+      if (env_var_val == 0) {
+        __omp_sched_steal = 0;
+      } else {
+        Not_Valid("O64_OMP_SCHEDULE_STEAL should be set to: true/false");
+      }
+    }
+  }
+
   env_var_str = getenv("O64_OMP_XBARRIER_TYPE");
   if (env_var_str != NULL) {
     if (strncasecmp(env_var_str, "dissem", 6) == 0) {
@@ -400,6 +419,21 @@ __ompc_environment_variables()
 
   __ompc_task_configure();
 
+  /* after the task pool, whose remove function it wraps */
+  env_var_str = getenv("O64_OMP_REGION_STATS");
+  if (env_var_str != NULL) {
+    if (strncasecmp(env_var_str, "table", 5) == 0 ||
+        strncasecmp(env_var_str, "true", 4) == 0) {
+      __ompc_region_stats_init(OMP_REGION_STATS_TABLE,
+                               getenv("O64_OMP_REGION_STATS_FILE"));
+    } else if (strncasecmp(env_var_str, "json", 4) == 0) {
+      __ompc_region_stats_init(OMP_REGION_STATS_JSON,
+                               getenv("O64_OMP_REGION_STATS_FILE"));
+    } else if (strncasecmp(env_var_str, "false", 5) != 0) {
+      Not_Valid("O64_OMP_REGION_STATS should be set to: table/json/false");
+    }
+  }
+
   if (__omp_verbose == 1) __ompc_print_environment();
 }
 
@@ -439,6 +473,10 @@ void __ompc_print_environment()
           __omp_rt_sched_type == OMP_SCHED_STATIC ? "static" :
           __omp_rt_sched_type == OMP_SCHED_STATIC_EVEN ? "static_even" : "unknown",
           __omp_rt_sched_type == OMP_SCHED_STATIC_EVEN ? "" : chunk_size_str);
+  /* O64_OMP_SCHEDULE_STEAL */
+  __ompc_print_env_tag("O64_OMP_SCHEDULE_STEAL");
+  fprintf(stderr, "__omp_sched_steal = %d\n",
+          __omp_sched_steal);
   /* OMP_STACKSIZE */
   __ompc_print_env_tag("OMP_STACKSIZE");
   fprintf(stderr, "__omp_stack_size = %ld\n",
@@ -459,6 +497,15 @@ void __ompc_print_environment()
   __ompc_print_env_tag("O64_OMP_SET_AFFINITY");
   fprintf(stderr, "__omp_set_affinity = %d\n",
           __omp_set_affinity);
+  /* O64_OMP_REGION_STATS */
+  __ompc_print_env_tag("O64_OMP_REGION_STATS");
+  __ompc_region_stats_print_env();
+  /* OMP_PROC_BIND */
+  __ompc_print_env_tag("OMP_PROC_BIND");
+  __ompc_affinity_print_proc_bind();
+  /* OMP_PLACES */
+  __ompc_print_env_tag("OMP_PLACES");
+  __ompc_affinity_print_places();
   /* O64_OMP_XBARRIER_TYPE */
   __ompc_print_env_tag("O64_OMP_XBARRIER_TYPE");
   fprintf(stderr, "__omp_xbarrier_type = %s\n",
@@ -473,7 +520,9 @@ void __ompc_print_environment()
           __omp_queue_storage == LIST_QUEUE_STORAGE ? "list" :
           __omp_queue_storage == DYN_ARRAY_QUEUE_STORAGE ? "dyn_array" :
           __omp_queue_storage == ARRAY_QUEUE_STORAGE ? "array" :
-          __omp_queue_storage == LOCKLESS_QUEUE_STORAGE ? "lockless" : "unknown");
+          __omp_queue_storage == LOCKLESS_QUEUE_STORAGE ? "lockless" :
+          __omp_queue_storage == CHASE_LEV_QUEUE_STORAGE ? "chase_lev" :
+          "unknown");
   /* O64_OMP_TASK_QUEUE */
   __ompc_print_env_tag("O64_OMP_TASK_QUEUE");
   fprintf(stderr, "__omp_task_queue = %s\n",
@@ -494,6 +543,10 @@ void __ompc_print_environment()
   __ompc_print_env_tag("O64_OMP_TASK_POOL");
   fprintf(stderr, "__omp_task_pool = %s\n",
           __omp_task_pool);
+  /* O64_OMP_TASK_ALLOC */
+  __ompc_print_env_tag("O64_OMP_TASK_ALLOC");
+  fprintf(stderr, "__omp_task_alloc_mode = %s\n",
+          __omp_task_alloc_mode == OMP_TASK_ALLOC_SLAB ? "slab" : "malloc");
   /* O64_OMP_TASK_CUTOFF */
   char cutoff_settings[128];
   sprintf(cutoff_settings, "num_threads:%d,switch:%d,depth:%d,num_children:%d",
@@ -517,6 +570,7 @@ __ompc_task_configure()
   char *queue_storage_str, *task_queue_str;
   int using_queue_list = 0;
   int using_queue_lockless = 0;
+  int using_queue_chase_lev = 0;
 
   /* not currently used */
   /*
@@ -550,6 +604,19 @@ __ompc_task_configure()
   }
   */
 
+  /* control where task descriptors and firstprivate frames come from */
+  env_var_str = getenv("O64_OMP_TASK_ALLOC");
+  if (env_var_str != NULL) {
+    if (strncasecmp(env_var_str, "SLAB", 4) == 0) {
+      __omp_task_alloc_mode = OMP_TASK_ALLOC_SLAB;
+    } else if (strncasecmp(env_var_str, "MALLOC", 6) == 0) {
+      __omp_task_alloc_mode = OMP_TASK_ALLOC_MALLOC;
+    } else {
+      Not_Valid("O64_OMP_TASK_ALLOC should be SLAB|MALLOC or unset");
+    }
+  }
+  __ompc_task_alloc_init();
+
   /* control the implementation of the queue storage */
   queue_storage_str = getenv("O64_OMP_QUEUE_STORAGE");
   if (queue_storage_str != NULL) {
@@ -647,9 +714,33 @@ __ompc_task_configure()
       __ompc_queue_cfifo_put = &__ompc_queue_lockless_put_tail;
       __ompc_queue_cfifo_get = &__ompc_queue_lockless_get_head;
       __ompc_queue_cfifo_transfer_chunk = NULL;
+    } else if (strncasecmp(queue_storage_str, "CHASE_LEV", 9) == 0) {
+      /* only the owner of a queue may use its tail, and the queue never
+       * fills up */
+      __omp_queue_storage = CHASE_LEV_QUEUE_STORAGE;
+      using_queue_chase_lev = 1;
+      __ompc_queue_is_empty = &__ompc_queue_cl_is_empty;
+      __ompc_queue_init = &__ompc_queue_cl_init;
+      __ompc_queue_free_slots = &__ompc_queue_cl_free_slots;
+      __ompc_queue_is_full = &__ompc_queue_cl_is_full;
+      __ompc_queue_num_used_slots = &__ompc_queue_cl_num_used_slots;
+      __ompc_queue_steal_head = &__ompc_queue_cl_steal_head;
+      __ompc_queue_steal_tail= NULL;
+      __ompc_queue_get_head = &__ompc_queue_cl_steal_head;
+      __ompc_queue_get_tail= &__ompc_queue_cl_get_tail;
+      __ompc_queue_put_tail = &__ompc_queue_cl_put_tail;
+      __ompc_queue_put_head = NULL;
+      __ompc_queue_transfer_chunk_from_head =
+                 &__ompc_queue_cl_transfer_chunk_from_head;
+      __ompc_queue_cfifo_is_full = &__ompc_queue_cl_is_full;
+      __ompc_queue_cfifo_num_used_slots = &__ompc_queue_cl_num_used_slots;
+      __ompc_queue_cfifo_put = &__ompc_queue_cl_put_tail;
+      __ompc_queue_cfifo_get = &__ompc_queue_cl_steal_head;
+      __ompc_queue_cfifo_transfer_chunk =
+                 &__ompc_queue_cl_transfer_chunk_from_head;
     }  else  {
       Not_Valid("O64_OMP_QUEUE_STORAGE should be "
-                "ARRAY|LIST|DYN_ARRAY or unset");
+                "ARRAY|LIST|DYN_ARRAY|LOCKLESS|CHASE_LEV or unset");
     }
   } else {
     /* ARRAY */
@@ -713,6 +804,10 @@ __ompc_task_configure()
         Not_Valid("O64_OMP_TASK_QUEUE=LIFO not supported if "
             "O64_OMP_QUEUE_STORAGE=LOCKLESS.");
       }
+      if (using_queue_chase_lev) {
+        Not_Valid("O64_OMP_TASK_QUEUE=LIFO not supported if "
+            "O64_OMP_QUEUE_STORAGE=CHASE_LEV.");
+      }
       strcpy(__omp_task_queue, "lifo");
       __ompc_task_queue_get    = __ompc_queue_get_tail;
       __ompc_task_queue_put    = __ompc_queue_put_tail;
@@ -723,6 +818,10 @@ __ompc_task_configure()
         Not_Valid("O64_OMP_TASK_QUEUE=INV_DEQUE not supported if "
             "O64_OMP_QUEUE_STORAGE=LOCKLESS.");
       }
+      if (using_queue_chase_lev) {
+        Not_Valid("O64_OMP_TASK_QUEUE=INV_DEQUE not supported if "
+            "O64_OMP_QUEUE_STORAGE=CHASE_LEV.");
+      }
       strcpy(__omp_task_queue, "inv_deque");
       __ompc_task_queue_get    = __ompc_queue_get_head;
       __ompc_task_queue_put    = __ompc_queue_put_tail;
@@ -828,6 +927,12 @@ __ompc_task_configure()
                   "O64_OMP_QUEUE_STORAGE=LIST");
         /* not reached */
       }
+      if (using_queue_chase_lev) {
+        /* all threads put to the community queue */
+        Not_Valid("O64_OMP_TASK_POOL=SIMPLE_2LEVEL not supported if "
+                  "O64_OMP_QUEUE_STORAGE=CHASE_LEV");
+        /* not reached */
+      }
       strcpy(__omp_task_pool, "simple_2level");
       /* each thread gets a queue, plus a global "community" queue */
       __ompc_create_task_pool    = &__ompc_create_task_pool_simple_2level;
@@ -985,14 +1090,12 @@ void
 __ompc_level_1_barrier(const int vthread_id)
 {
   int *bar_count;
-  long int counter;
   omp_v_thread_t *p_vthread;
   int myrank, team_size;
-  long int max_count;
+  int seq;
   omp_task_t *next, *current_task;
   omp_task_pool_t *pool;
 
-  max_count = __omp_spin_count;
   p_vthread = __ompc_get_v_thread_by_num(__omp_myid);
   team_size = __omp_level_1_team_size;
   pool = __omp_level_1_team_manager.task_pool;
@@ -1005,30 +1108,25 @@ __ompc_level_1_barrier(const int vthread_id)
   __ompc_event_callback(OMP_EVENT_THR_BEGIN_IBAR);
 
   bar_count = &__omp_level_1_team_manager.barrier_count;
-  __ompc_atomic_inc(bar_count);
+  if (__ompc_atomic_inc(bar_count) == team_size)
+    __ompc_task_pool_idle_wake(pool);
 
-  for (counter = 0; (*bar_count < team_size) ||
-          __ompc_task_pool_num_pending_tasks(pool); counter++) {
+  for (;;) {
+      seq = __ompc_task_pool_idle_seq(pool);
+      if (*bar_count >= team_size &&
+          __ompc_task_pool_num_pending_tasks(pool) == 0)
+          break;
 
       while (__ompc_task_pool_num_pending_tasks(pool) &&
              (next = __ompc_remove_task_from_pool(pool))) {
           if (next != NULL)
               __ompc_task_switch(next);
       }
-      if (counter > max_count) {
-          pthread_mutex_lock(&pool->pool_lock);
-          if (__ompc_task_pool_num_pending_tasks(pool) == 0 &&
-                  *bar_count < team_size) {
-              struct timespec ts;
-              clock_gettime(CLOCK_REALTIME, &ts);
-              ts.tv_nsec += __omp_wait_time;
-              pthread_cond_timedwait(&pool->pool_cond,
-                                     &pool->pool_lock,
-                                     &ts);
-          }
-          pthread_mutex_unlock(&pool->pool_lock);
-      }
+      if (__ompc_task_pool_num_pending_tasks(pool) == 0 &&
+              *bar_count < team_size)
+          __ompc_task_pool_idle_wait(pool, seq);
   }
+  __ompc_task_alloc_flush();
 
   /* delete implicit task and reset task state for level-1 user thread */
   __ompc_task_delete(__omp_level_1_team[vthread_id].implicit_task);
@@ -1038,26 +1136,14 @@ __ompc_level_1_barrier(const int vthread_id)
   myrank = __ompc_atomic_inc(&__omp_level_1_exit_count);
 
   if (vthread_id == 0) {
-    if (myrank != team_size)
-    {
-      for( counter = 0; __omp_level_1_exit_count != team_size; counter++) {
-        if (counter > max_count) {
-          pthread_mutex_lock(&__omp_level_1_barrier_mutex);
-          while (__omp_level_1_exit_count != team_size) {
-            pthread_cond_wait(&__omp_level_1_barrier_cond, &__omp_level_1_barrier_mutex);
-          }
-          pthread_mutex_unlock(&__omp_level_1_barrier_mutex);
-        }
-      }
-    }
+    while ((myrank = __omp_level_1_exit_count) != team_size)
+      __ompc_futex_wait(&__omp_level_1_exit_count, myrank,
+                        &__omp_level_1_exit_waiters, 0);
     __omp_level_1_exit_count = 0;
     *bar_count = 0;
-  } else if (myrank == team_size ) {
-    // here we do need the mutex lock! otherwise,
-    // Otherwise, it's possible that cond_signal may fail to wake up the master thread.
-    pthread_mutex_lock(&__omp_level_1_barrier_mutex);
-    pthread_cond_signal(&__omp_level_1_barrier_cond);
-    pthread_mutex_unlock(&__omp_level_1_barrier_mutex);
+  } else if (myrank == team_size) {
+    __ompc_futex_wake_all(&__omp_level_1_exit_count,
+                          &__omp_level_1_exit_waiters);
   }
 
   __ompc_event_callback(OMP_EVENT_THR_END_IBAR);
@@ -1069,11 +1155,10 @@ __ompc_level_1_barrier(const int vthread_id)
 void
 __ompc_exit_barrier(omp_v_thread_t * vthread)
 {
-  long int counter;
   int *bar_count;
-  int *exit_count;
+  volatile int *exit_count;
   int myrank;
-  long int max_count;
+  int seq;
   omp_task_pool_t *pool;
   omp_task_t *next, *current_task;
   int team_size = vthread->team->team_size;
@@ -1082,7 +1167,6 @@ __ompc_exit_barrier(omp_v_thread_t * vthread)
   Is_True((vthread != NULL) && (vthread->team != NULL),
 	  ("bad vthread or vthread->team in nested groups"));
 
-  max_count = __omp_spin_count;
   vthread->thr_ibar_state_id++;
   __ompc_set_state(THR_IBAR_STATE);
   __ompc_event_callback(OMP_EVENT_THR_BEGIN_IBAR);
@@ -1093,30 +1177,25 @@ __ompc_exit_barrier(omp_v_thread_t * vthread)
   __ompc_task_set_state(current_task, OMP_TASK_IN_BARRIER);
 
   bar_count = &vthread->team->barrier_count;
-  __ompc_atomic_inc(bar_count);
+  if (__ompc_atomic_inc(bar_count) == team_size)
+    __ompc_task_pool_idle_wake(pool);
 
-  for (counter = 0; (*bar_count < team_size) ||
-          __ompc_task_pool_num_pending_tasks(pool); counter++) {
+  for (;;) {
+      seq = __ompc_task_pool_idle_seq(pool);
+      if (*bar_count >= team_size &&
+          __ompc_task_pool_num_pending_tasks(pool) == 0)
+          break;
 
       while (__ompc_task_pool_num_pending_tasks(pool) &&
              (next = __ompc_remove_task_from_pool(pool))) {
           if (next != NULL)
               __ompc_task_switch(next);
       }
-      if (counter > max_count) {
-          pthread_mutex_lock(&pool->pool_lock);
-          if (__ompc_task_pool_num_pending_tasks(pool) == 0 &&
-                  *bar_count < team_size) {
-              struct timespec ts;
-              clock_gettime(CLOCK_REALTIME, &ts);
-              ts.tv_nsec += __omp_wait_time;
-              pthread_cond_timedwait(&pool->pool_cond,
-                                     &pool->pool_lock,
-                                     &ts);
-          }
-          pthread_mutex_unlock(&pool->pool_lock);
-      }
+      if (__ompc_task_pool_num_pending_tasks(pool) == 0 &&
+              *bar_count < team_size)
+          __ompc_task_pool_idle_wait(pool, seq);
   }
+  __ompc_task_alloc_flush();
 
 
   __ompc_task_delete(vthread->implicit_task);
@@ -1125,24 +1204,10 @@ __ompc_exit_barrier(omp_v_thread_t * vthread)
   myrank = __ompc_atomic_inc(exit_count);
 
   if (__omp_myid == 0) {
-    if (myrank != team_size)
-    {
-      for( counter = 0; *exit_count != team_size; counter++) {
-        if (counter > max_count) {
-          pthread_mutex_lock(&vthread->team->barrier_lock);
-          while (*exit_count != team_size)
-            pthread_cond_wait(&vthread->team->barrier_cond,
-                              &vthread->team->barrier_lock);
-          pthread_mutex_unlock(&vthread->team->barrier_lock);
-        }
-      }
-    }
-  } else if (myrank == team_size ) {
-    // here we do need the mutex lock! otherwise,
-    // Otherwise, it's possible that cond_signal may fail to wake up the master thread.
-    pthread_mutex_lock(&vthread->team->barrier_lock);
-    pthread_cond_signal(&vthread->team->barrier_cond);
-    pthread_mutex_unlock(&vthread->team->barrier_lock);
+    while ((myrank = *exit_count) != team_size)
+      __ompc_futex_wait(exit_count, myrank, &vthread->team->exit_waiters, 0);
+  } else if (myrank == team_size) {
+    __ompc_futex_wake_all(exit_count, &vthread->team->exit_waiters);
   }
 
   __ompc_event_callback(OMP_EVENT_THR_END_IBAR);
@@ -1153,7 +1218,6 @@ void*
 __ompc_level_1_slave(void * _uthread_index)
 {
   long uthread_index;
-  long int counter;
   int new_tasks = __omp_level_1_team_manager.new_task;
   __omp_seed = uthread_index;
   uthread_index = (long) _uthread_index;
@@ -1165,16 +1229,9 @@ __ompc_level_1_slave(void * _uthread_index)
   __ompc_atomic_inc(&__omp_level_1_pthread_count);
 
   for(;;) {
-    for( counter = 0; __omp_level_1_team_manager.new_task == new_tasks;
-         counter++) {
-      if (counter > __omp_spin_count) {
-        pthread_mutex_lock(&__omp_level_1_mutex);
-        while (__omp_level_1_team_manager.new_task == new_tasks) {
-          pthread_cond_wait(&__omp_level_1_cond, &__omp_level_1_mutex);
-        }
-        pthread_mutex_unlock(&__omp_level_1_mutex);
-      }
-    }
+    while (__omp_level_1_team_manager.new_task == new_tasks)
+      __ompc_futex_wait(&__omp_level_1_team_manager.new_task, new_tasks,
+                        &__omp_level_1_team_manager.new_task_waiters, 0);
 
     /* update new_tasks with current count */
     new_tasks = __omp_level_1_team_manager.new_task;
@@ -1193,6 +1250,10 @@ __ompc_level_1_slave(void * _uthread_index)
     /* exe micro_task now */
     if ( __omp_level_1_team[uthread_index].entry_func != NULL) {
 
+      /* bind before the implicit task is touched, so that it is allocated
+       * near the place */
+      __ompc_affinity_bind(&__omp_level_1_team[uthread_index].place_info);
+
       /* initialize implicit task for slave thread */
       if (__omp_level_1_team[uthread_index].implicit_task == NULL) {
         __omp_level_1_team[uthread_index].implicit_task =
@@ -1200,6 +1261,9 @@ __ompc_level_1_slave(void * _uthread_index)
       }
       __omp_current_task = __omp_level_1_team[uthread_index].implicit_task;
 
+      if (__omp_region_stats)
+        __ompc_region_stats_enter((void *)
+              __omp_level_1_team[uthread_index].entry_func);
       __ompc_event_callback(OMP_EVENT_THR_END_IDLE);
       __ompc_set_state(THR_WORK_STATE);
       __omp_level_1_team[uthread_index].entry_func(
@@ -1208,6 +1272,8 @@ __ompc_level_1_slave(void * _uthread_index)
 
       __omp_level_1_team[uthread_index].entry_func = NULL;
       __ompc_level_1_barrier(uthread_index);
+      if (__omp_region_stats)
+        __ompc_region_stats_leave();
 
       __ompc_set_state(THR_IDLE_STATE);
       __ompc_event_callback(OMP_EVENT_THR_BEGIN_IDLE);
@@ -1218,62 +1284,173 @@ __ompc_level_1_slave(void * _uthread_index)
   return NULL;
 }
 
+/* Threads of nested teams are not created per team. A nested fork takes
+ * parked workers from a pool and only creates those missing; they are
+ * put back when the team joins, and wait for their next v_thread. Only
+ * the threads which are created count against __omp_max_num_threads.
+ */
+typedef struct omp_nested_worker omp_nested_worker_t;
+struct omp_nested_worker {
+  omp_nested_worker_t *next;
+  pthread_t uthread_id;
+  omp_v_thread_t * volatile v_thread;
+  /* bumped by the forking thread for every team the worker is given */
+  volatile int start;
+  volatile int start_waiters;
+} __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
+
+static omp_nested_worker_t *__omp_nested_pool = NULL;
+static int __omp_nested_pool_idle = 0;
+static volatile int __omp_nested_pool_lock = 0;
+
 /* The thread function for nested slaves*/
 void*
-__ompc_nested_slave(void * _v_thread)
+__ompc_nested_slave(void * _worker)
 {
-  int counter;
-  omp_v_thread_t * my_vthread = (omp_v_thread_t *) _v_thread;
-  /* need to wait for others ready? */
+  omp_nested_worker_t *worker = (omp_nested_worker_t *) _worker;
+  omp_v_thread_t * my_vthread;
+  int start = 0;
 
-  __omp_current_v_thread = _v_thread;
+  for (;;) {
+    while (worker->start == start)
+      __ompc_futex_wait(&worker->start, start, &worker->start_waiters, 0);
+    start = worker->start;
+    __ompc_load_fence();
+    my_vthread = worker->v_thread;
 
-  __omp_exe_mode = OMP_EXE_MODE_NESTED;
+    __omp_current_v_thread = my_vthread;
 
-  __omp_myid = my_vthread->vthread_id;
+    __omp_exe_mode = OMP_EXE_MODE_NESTED;
 
-  /* initialize implicit task for nested slave */
-  if (my_vthread->implicit_task == NULL) {
-    my_vthread->implicit_task = __ompc_task_new_implicit();
-  }
+    __omp_myid = my_vthread->vthread_id;
 
-  __omp_current_task = my_vthread->implicit_task;
+    __ompc_affinity_bind(&my_vthread->place_info);
 
-  __ompc_set_state(THR_IDLE_STATE);
-  /* printf("IDLE called from nested\n"); */
-
-  counter = 0;
-  for (counter = 0; my_vthread->team->new_task != 1; counter++) {
-      if (counter > __omp_spin_count) {
-
-          pthread_mutex_lock(&my_vthread->team->barrier_lock);
-          while (my_vthread->team->new_task != 1) {
-              pthread_cond_wait(&my_vthread->team->barrier_cond,
-                      &my_vthread->team->barrier_lock);
-          }
-          pthread_mutex_unlock(&my_vthread->team->barrier_lock);
-      }
+    /* initialize implicit task for nested slave */
+    if (my_vthread->implicit_task == NULL) {
+      my_vthread->implicit_task = __ompc_task_new_implicit();
+    }
+
+    __omp_current_task = my_vthread->implicit_task;
+
+    __ompc_set_state(THR_IDLE_STATE);
+    /* printf("IDLE called from nested\n"); */
+
+    while (my_vthread->team->new_task != 1)
+      __ompc_futex_wait(&my_vthread->team->new_task, 0,
+                        &my_vthread->team->new_task_waiters, 0);
+
+    /* The relationship between vthread, uthread, and team should be OK here*/
+
+    if (__omp_region_stats)
+      __ompc_region_stats_enter((void *) my_vthread->entry_func);
+    __ompc_event_callback(OMP_EVENT_THR_END_IDLE);
+    __ompc_set_state(THR_WORK_STATE);
+
+    my_vthread->entry_func(my_vthread->vthread_id,
+        (char *)my_vthread->frame_pointer);
+
+    /*TODO: fix the barrier call for nested threads*/
+    __ompc_exit_barrier(my_vthread);
+    if (__omp_region_stats) {
+      __ompc_region_stats_leave();
+      /* parked until the next team */
+      __ompc_region_stats_set_state(THR_IDLE_STATE);
+    }
+
+    /* the team, and my_vthread with it, may be gone from here on */
+    __omp_current_v_thread = NULL;
+    __omp_current_task = NULL;
+    __omp_exe_mode = OMP_EXE_MODE_NORMAL;
   }
 
-  /* The relationship between vthread, uthread, and team should be OK here*/
+  return NULL;
+}
 
-  __ompc_event_callback(OMP_EVENT_THR_END_IDLE);
-  __ompc_set_state(THR_WORK_STATE);
+/* Take num workers for a nested team, parked ones first. Returns how many
+ * there are, which is less than num when __omp_max_num_threads does not
+ * allow to create the others. */
+static int
+__ompc_nested_pool_get(omp_nested_worker_t **workers, int num)
+{
+  omp_nested_worker_t *worker;
+  pthread_attr_t nested_pthread_attr;
+  int n = 0, num_to_create, return_value;
+
+  __ompc_futex_lock(&__omp_nested_pool_lock);
+  while (n < num && __omp_nested_pool != NULL) {
+    workers[n++] = __omp_nested_pool;
+    __omp_nested_pool = __omp_nested_pool->next;
+    __omp_nested_pool_idle--;
+  }
+  num_to_create = num - n;
+  if (num_to_create > __omp_max_num_threads)
+    num_to_create = __omp_max_num_threads;
+  __omp_max_num_threads -= num_to_create;
+  __ompc_futex_unlock(&__omp_nested_pool_lock);
+
+  if (num_to_create == 0)
+    return n;
+
+  pthread_attr_init(&nested_pthread_attr);
+  pthread_attr_setscope(&nested_pthread_attr, PTHREAD_SCOPE_SYSTEM);
+  pthread_attr_setdetachstate(&nested_pthread_attr, PTHREAD_CREATE_DETACHED);
+  return_value = pthread_attr_setstacksize(&nested_pthread_attr,
+          __omp_stack_size);
+  Is_True(return_value == 0, ("Cannot set stack size for thread"));
+
+  for (; num_to_create > 0; num_to_create--) {
+    worker = aligned_malloc(sizeof(omp_nested_worker_t), CACHE_LINE_SIZE);
+    Is_True(worker != NULL, ("Cannot allocate nested worker"));
+    worker->next = NULL;
+    worker->v_thread = NULL;
+    worker->start = 0;
+    worker->start_waiters = 0;
+
+    return_value = pthread_create(&worker->uthread_id,
+            &nested_pthread_attr, (pthread_entry) __ompc_nested_slave,
+            (void *) worker);
+    Is_True(return_value == 0, ("Cannot create more pthreads"));
+    workers[n++] = worker;
+  }
+  pthread_attr_destroy(&nested_pthread_attr);
 
-  my_vthread->entry_func(my_vthread->vthread_id,
-      (char *)my_vthread->frame_pointer);
+  return n;
+}
 
-  /*TODO: fix the barrier call for nested threads*/
-  __ompc_exit_barrier(my_vthread);
+/* Park the workers of a team which has joined. A worker may still be on
+ * its way out of the exit barrier; it only looks at its own start count
+ * from there on, so it can be given to the next team already. */
+static void
+__ompc_nested_pool_put(omp_nested_worker_t **workers, int num)
+{
+  int i;
 
-  __omp_exe_mode = OMP_EXE_MODE_NORMAL;
+  __ompc_futex_lock(&__omp_nested_pool_lock);
+  for (i = 0; i < num; i++) {
+    workers[i]->next = __omp_nested_pool;
+    __omp_nested_pool = workers[i];
+  }
+  __omp_nested_pool_idle += num;
+  __ompc_futex_unlock(&__omp_nested_pool_lock);
+}
 
-  pthread_exit(NULL);
+static inline void
+__ompc_nested_worker_start(omp_nested_worker_t *worker,
+                           omp_v_thread_t *v_thread)
+{
+  worker->v_thread = v_thread;
+  __ompc_store_fence();
+  worker->start++;
+  __ompc_futex_wake_all(&worker->start, &worker->start_waiters);
 }
 
 void
 __ompc_fini_rtl(void) 
 {
+  if (__omp_region_stats)
+    __ompc_region_stats_report();
+
   __ompc_destroy_task_pool(__omp_level_1_team_manager.task_pool);
   __ompc_xbarrier_info_destroy(&__omp_level_1_team_manager);
 
@@ -1344,12 +1521,9 @@ __ompc_init_rtl(int num_threads)
   /* need to set up barrier attributes */
 
   /* initial global locks*/
-  pthread_mutex_init(&__omp_level_1_mutex, NULL);
-  pthread_mutex_init(&__omp_level_1_barrier_mutex, NULL);
   pthread_mutex_init(&__omp_hash_table_lock, NULL);
-  pthread_cond_init(&__omp_level_1_cond, NULL);
-  pthread_cond_init(&__omp_level_1_barrier_cond, NULL);
   __ompc_init_spinlock(&_ompc_thread_lock);
+  __ompc_futex_init();
 
   __omp_myid = 0;
   __omp_seed = 0;
@@ -1392,8 +1566,9 @@ __ompc_init_rtl(int num_threads)
   __ompc_init_spinlock(&(__omp_level_1_team_manager.schedule_lock));
   pthread_cond_init(&(__omp_level_1_team_manager.ordered_cond), NULL);
   __ompc_init_lock(&(__omp_level_1_team_manager.single_lock));
-  pthread_mutex_init(&(__omp_level_1_team_manager.barrier_lock), NULL);
-  pthread_cond_init(&(__omp_level_1_team_manager.barrier_cond), NULL);
+  __omp_level_1_team_manager.barrier_waiters = 0;
+  __omp_level_1_team_manager.exit_waiters = 0;
+  __omp_level_1_team_manager.new_task_waiters = 0;
 	
   /* setup the level one team data structure */
   for (i=0; i<threads_to_create; i++) {
@@ -1415,6 +1590,7 @@ __ompc_init_rtl(int num_threads)
 
     __ompc_init_xbarrier_local_info(&__omp_level_1_team[i].xbarrier_local,
          i, &__omp_level_1_team_manager);
+    __ompc_init_spinlock(&__omp_level_1_team[i].loop_slice.lock);
 
     /* the corresponding relationship is fixed*/
     __omp_level_1_team[i].executor = &(__omp_level_1_pthread[i]);
@@ -1457,6 +1633,8 @@ __ompc_init_rtl(int num_threads)
     __ompc_bind_pthread_to_cpu(__omp_root_thread_id);
   }
 #endif //TARG_LOONGSON
+  __omp_root_v_thread.place_info = __omp_root_place_info;
+  __ompc_affinity_bind(&__omp_root_v_thread.place_info);
   __ompc_event_callback(OMP_EVENT_FORK);
 
   /* why twice? */
@@ -1632,6 +1810,7 @@ __ompc_expand_level_1_team(int new_num_threads)
 
     __ompc_init_xbarrier_local_info(&__omp_level_1_team[i].xbarrier_local,
                                     i, &__omp_level_1_team_manager);
+    __ompc_init_spinlock(&__omp_level_1_team[i].loop_slice.lock);
 
     /* for u_thread */
     return_value = pthread_attr_setstacksize(&__omp_pthread_attr, __omp_stack_size);
@@ -1670,19 +1849,18 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
 	    frame_pointer_t frame_pointer)
 {
   int i;
-  int return_value;
   int k, log2_num_threads;
   int num_threads = _num_threads;
   omp_team_t temp_team;
   omp_v_thread_t temp_v_thread;
   omp_v_thread_t *nest_v_thread_team;
   omp_u_thread_t *nest_u_thread_team;
+  omp_nested_worker_t **nest_workers;
   omp_u_thread_t *current_u_thread;
   omp_v_thread_t *original_v_thread;
   omp_task_t *original_task;
   void * stack_pointer;
   unsigned int region_used = 0; // TODO: make it one-bit.
-  pthread_attr_t nested_pthread_attr;
 
 #if  !(defined TARG_LOONGSON || defined _UH_COARRAYS)
   Is_True(__omp_rtl_initialized != 0,
@@ -1715,6 +1893,8 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     current_region_id++;
     __ompc_set_state(THR_OVHD_STATE);
     __ompc_event_callback(OMP_EVENT_FORK);
+    if (__omp_region_stats)
+      __ompc_region_stats_enter((void *) micro_task);
 
     // Adjust the number of the number of thread in the team
     if (num_threads == 0) {
@@ -1764,6 +1944,12 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
       __omp_level_1_team[i].frame_pointer = frame_pointer;
       __omp_level_1_team[i].team_size = __omp_level_1_team_size;
       __omp_level_1_team[i].entry_func = micro_task;
+      /* threads left out of earlier, smaller teams have missed their
+       * loops, they must not take the next loop as initialized already */
+      __omp_level_1_team[i].loop_count = __omp_level_1_team_manager.loop_count;
+      __ompc_affinity_place_thread(&__omp_root_v_thread.place_info,
+                                   __omp_level_1_team_size, 1, i,
+                                   &__omp_level_1_team[i].place_info);
     }
     
     /* TODO: the current team size is incorrect, fix it*/
@@ -1771,16 +1957,16 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
 
     if (__omp_level_1_team_size > 1) {
       /* Before signal, should make sure that all slaves are ready*/
-      pthread_mutex_lock(&__omp_level_1_mutex);
       (__omp_level_1_team_manager.new_task)++;
-      pthread_cond_broadcast(&__omp_level_1_cond);
-      pthread_mutex_unlock(&__omp_level_1_mutex);
+      __ompc_futex_wake_all(&__omp_level_1_team_manager.new_task,
+                            &__omp_level_1_team_manager.new_task_waiters);
     }
 
 
     __omp_level_1_pthread[0].task = &(__omp_level_1_team[0]);
 
     __omp_current_v_thread = &__omp_level_1_team[0];
+    __ompc_affinity_bind(&__omp_level_1_team[0].place_info);
 
     /* initialize implicit task for master thread of level 1 team */
     if (__omp_level_1_team[0].implicit_task == NULL) {
@@ -1802,6 +1988,8 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
      __ompc_set_state(THR_OVHD_STATE);
      
     __ompc_event_callback(OMP_EVENT_JOIN);
+    if (__omp_region_stats)
+      __ompc_region_stats_leave();
     __ompc_set_state(THR_SERIAL_STATE);
     __omp_root_v_thread.state=THR_SERIAL_STATE;
 
@@ -1826,6 +2014,11 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
 
     if (num_threads == 0) num_threads = __omp_nthreads_var;
 
+    nest_workers = malloc(sizeof(omp_nested_worker_t *) * num_threads);
+    Is_True(nest_workers != NULL,
+            ("Cannot allocate nested team workers"));
+    num_threads = __ompc_nested_pool_get(nest_workers, num_threads - 1) + 1;
+
     log2_num_threads = 0;
     for(k = 1; k < num_threads; log2_num_threads++, k <<= 1);
 
@@ -1853,30 +2046,26 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     __ompc_init_spinlock(&(temp_team.schedule_lock));
     pthread_cond_init(&(__omp_level_1_team_manager.ordered_cond), NULL);
     __ompc_init_lock(&(temp_team.single_lock));
-    pthread_mutex_init(&(temp_team.barrier_lock), NULL);
-    pthread_cond_init(&(temp_team.barrier_cond), NULL);
+    temp_team.barrier_waiters = 0;
+    temp_team.exit_waiters = 0;
+    temp_team.new_task_waiters = 0;
 
     nest_v_thread_team = aligned_malloc(sizeof(omp_v_thread_t) * num_threads, CACHE_LINE_SIZE); 
     Is_True(nest_v_thread_team != NULL, 
 	    ("Cannot allocate nested v_thread team"));
+    /* reduction nodes must start out not ready, as for the level-1 team */
+    memset(nest_v_thread_team, 0, sizeof(omp_v_thread_t) * num_threads);
 
     /* nest_u_thread_team[0] is of no use currently*/
     nest_u_thread_team = aligned_malloc(sizeof(omp_u_thread_t) * num_threads, CACHE_LINE_SIZE);
     Is_True(nest_u_thread_team != NULL,
 	    ("Cannot allocate nested u_thread team"));
 
-    /* A lock is needed to protect global variables */
-    /* TODO: need a global lock*/
-    __omp_max_num_threads -= num_threads - 1;
-
     __ompc_set_state(THR_OVHD_STATE);
     __ompc_event_callback(OMP_EVENT_FORK);
+    if (__omp_region_stats)
+      __ompc_region_stats_enter((void *) micro_task);
 
-    pthread_attr_init(&nested_pthread_attr);
-    pthread_attr_setscope(&nested_pthread_attr, PTHREAD_SCOPE_SYSTEM);
-    return_value = pthread_attr_setstacksize(&nested_pthread_attr,
-            __omp_stack_size);
-    Is_True(return_value == 0, ("Cannot set stack size for thread"));
     for (i=1; i<num_threads; i++) {
       nest_v_thread_team[i].vthread_id = i;
       nest_v_thread_team[i].single_count = 0;
@@ -1886,6 +2075,10 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
       nest_v_thread_team[i].entry_func = micro_task;
       nest_v_thread_team[i].frame_pointer = frame_pointer;
       nest_v_thread_team[i].executor = &(nest_u_thread_team[i]);
+      /* the slave binds itself to its place when it starts */
+      __ompc_affinity_place_thread(&original_v_thread->place_info,
+                                   num_threads, temp_team.team_level, i,
+                                   &nest_v_thread_team[i].place_info);
 
       nest_u_thread_team[i].hash_next = NULL;
       nest_u_thread_team[i].task = &(nest_v_thread_team[i]);
@@ -1897,14 +2090,10 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
       __ompc_init_xbarrier_local_info(&nest_v_thread_team[i].xbarrier_local,
                                      i, &temp_team);
 
-      return_value = pthread_create(&(nest_u_thread_team[i].uthread_id),
-				    &nested_pthread_attr, (pthread_entry) __ompc_nested_slave,
-				    (void *)(&(nest_v_thread_team[i])));
-      Is_True(return_value == 0, ("Cannot create more pthreads"));
-
+      nest_u_thread_team[i].uthread_id = nest_workers[i - 1]->uthread_id;
       nest_u_thread_team[i].stack_pointer = (char *)0;
 
-      // TODO: may need to bind pthread to a specific cpu for nested threads
+      __ompc_nested_worker_start(nest_workers[i - 1], &nest_v_thread_team[i]);
 
       /* hash table isn't really necessary if storing current v_thread in
        * __omp_current_v_thread.  */
@@ -1912,10 +2101,8 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
 
     }
 
-    pthread_mutex_lock(&temp_team.barrier_lock);
     temp_team.new_task = 1;
-    pthread_cond_broadcast(&temp_team.barrier_cond);
-    pthread_mutex_unlock(&temp_team.barrier_lock);
+    __ompc_futex_wake_all(&temp_team.new_task, &temp_team.new_task_waiters);
 
     nest_v_thread_team[0].vthread_id = 0;
     nest_v_thread_team[0].single_count = 0;
@@ -1926,6 +2113,9 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     nest_v_thread_team[0].entry_func = micro_task;
     nest_v_thread_team[0].frame_pointer = frame_pointer;
     nest_v_thread_team[0].executor = current_u_thread;
+    __ompc_affinity_place_thread(&original_v_thread->place_info,
+                                 num_threads, temp_team.team_level, 0,
+                                 &nest_v_thread_team[0].place_info);
 
     nest_v_thread_team[0].implicit_task = NULL;
     nest_v_thread_team[0].num_suspended_tied_tasks = 0;
@@ -1936,6 +2126,7 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     current_u_thread->task = &(nest_v_thread_team[0]);
 
     __omp_current_v_thread = &nest_v_thread_team[0];
+    __ompc_affinity_bind(&nest_v_thread_team[0].place_info);
 
     /* initialize implicit task for master thread of nested team */
     if (nest_v_thread_team[0].implicit_task == NULL) {
@@ -1961,13 +2152,11 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     __ompc_set_state(THR_OVHD_STATE);
 
 
-    for (i=1; i<num_threads; i++) {
-      /* hash table isn't really necessary if storing current v_thread in
-       * __omp_current_v_thread.  */
-      //__ompc_remove_from_hash_table(nest_u_thread_team[i].uthread_id);
-      return_value = pthread_detach(nest_u_thread_team[i].uthread_id);
-      Is_True(return_value == 0, ("Could not detach pthread"));
-    }
+    /* hash table isn't really necessary if storing current v_thread in
+     * __omp_current_v_thread.  */
+    //__ompc_remove_from_hash_table(nest_u_thread_team[i].uthread_id);
+    __ompc_nested_pool_put(nest_workers, num_threads - 1);
+    free(nest_workers);
 
     __ompc_destroy_task_pool(temp_team.task_pool);
 
@@ -1980,8 +2169,11 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     current_u_thread->task = original_v_thread;
     __omp_current_v_thread  = original_v_thread;
     __omp_current_task = original_task;
+    __ompc_affinity_bind(&original_v_thread->place_info);
 
 	__ompc_event_callback(OMP_EVENT_JOIN);
+    if (__omp_region_stats)
+      __ompc_region_stats_leave();
 	__ompc_set_state(THR_WORK_STATE);
     __omp_exe_mode = OMP_EXE_MODE_NORMAL;
 
@@ -2007,6 +2199,7 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     temp_v_thread.frame_pointer = frame_pointer;
     temp_v_thread.implicit_task = NULL;
     temp_v_thread.num_suspended_tied_tasks = 0;
+    temp_v_thread.place_info = original_v_thread->place_info;
 
     __ompc_init_xbarrier_local_info(&temp_v_thread.xbarrier_local,
                                    0, &temp_team);
@@ -2034,9 +2227,13 @@ __ompc_fork(const int _num_threads, omp_micro micro_task,
     /* a lock should be added here */
     __omp_exe_mode = OMP_EXE_MODE_NESTED_SEQUENTIAL;
     /* execute the task */
+    if (__omp_region_stats)
+      __ompc_region_stats_enter((void *) micro_task);
     __ompc_set_state(THR_WORK_STATE);
     __ompc_set_state(THR_WORK_STATE);
     micro_task(0, frame_pointer);
+    if (__omp_region_stats)
+      __ompc_region_stats_leave();
 
     /* lock should be added here */
     /* The exe_mode switch is abandoned for this case.*/
@@ -2075,10 +2272,12 @@ __ompc_check_num_threads(const int _num_threads)
       num_threads = __omp_level_1_team_alloc_size + __omp_max_num_threads;
     }
   } else {/* Request for nest team*/
-    if ((num_threads - 1) > __omp_max_num_threads) {
+    /* parked nested workers are there already */
+    int available = __omp_max_num_threads + __omp_nested_pool_idle;
+    if ((num_threads - 1) > available) {
       /* Exceed current limit*/
       /* The master is already there, need not to be allocated*/
-      num_threads = __omp_max_num_threads + 1; 
+      num_threads = available + 1; 
       Warning(" Exceed the thread number limit: Reduce to Max");
     } else {
       /* OK. we can fulfill your request*/
@@ -321,18 +321,14 @@ extern __thread int total_tasks;
 /* Should not be called directly, use __ompc_barrier instead*/
 void __ompc_barrier_wait(omp_team_t *team)
 {
-  /*Warning: This implementation may cause cache problems*/
-  long int counter;
   int *bar_count;
   int barrier_flag;
   int new_count;
-  int i,j,k;
+  int seq;
   volatile int *barrier_flag_p;
   omp_task_t *next, *current_task;
   omp_task_pool_t *pool;
 
-  j = 0;
-  k = 0;
   barrier_flag_p = &(team->barrier_flag);
   barrier_flag = *barrier_flag_p;
 
@@ -343,30 +339,28 @@ void __ompc_barrier_wait(omp_team_t *team)
 
   bar_count = &team->barrier_count;
   new_count = __ompc_atomic_inc(bar_count);
+  if (new_count == team->team_size)
+    __ompc_task_pool_idle_wake(pool);
 
-  for (counter = 0; (*bar_count < team->team_size) ||
-          __ompc_task_pool_num_pending_tasks(pool); counter++ ) {
+  for (;;) {
+      seq = __ompc_task_pool_idle_seq(pool);
+      if (*bar_count >= team->team_size &&
+          __ompc_task_pool_num_pending_tasks(pool) == 0)
+          break;
 
       while (__ompc_task_pool_num_pending_tasks(pool) &&
              (next = __ompc_remove_task_from_pool(pool))) {
           if (next != NULL)
               __ompc_task_switch(next);
       }
-      if (counter > __omp_spin_count) {
-          pthread_mutex_lock(&pool->pool_lock);
-          if (__ompc_task_pool_num_pending_tasks(pool) == 0 &&
-                  *bar_count <  team->team_size) {
-              struct timespec ts;
-              clock_gettime(CLOCK_REALTIME, &ts);
-              ts.tv_nsec += __omp_wait_time;
-              pthread_cond_timedwait(&pool->pool_cond,
-                                &pool->pool_lock,
-                                &ts);
-          }
-          pthread_mutex_unlock(&pool->pool_lock);
-      }
+      if (__ompc_task_pool_num_pending_tasks(pool) == 0 &&
+              *bar_count < team->team_size)
+          __ompc_task_pool_idle_wait(pool, seq);
   }
 
+  /* no more tasks to free until the next region */
+  __ompc_task_alloc_flush();
+
   new_count = __ompc_atomic_inc(&team->barrier_count2);
 
   if (new_count == team->team_size) {
@@ -374,25 +368,12 @@ void __ompc_barrier_wait(omp_team_t *team)
     team->barrier_count = 0;
     team->barrier_count2 = 0;
     team->barrier_flag = barrier_flag ^ 1; /* Xor: toggle*/
-
-    pthread_mutex_lock(&(team->barrier_lock));
-    pthread_cond_broadcast(&(team->barrier_cond));
-    pthread_mutex_unlock(&(team->barrier_lock));
-
+    __ompc_futex_wake_all(barrier_flag_p, &team->barrier_waiters);
   } else {
-    /* Wait for the last to reset te barrier*/
-    /* We must make sure that every waiting thread get this
-     * signal */
-    for (i = 0; i < __omp_spin_count; i++)
-      if ((*barrier_flag_p) != barrier_flag) {
-        __ompc_task_set_state(current_task, OMP_TASK_RUNNING);
-        return;
-      }
-    pthread_mutex_lock(&(team->barrier_lock));
-    while (team->barrier_flag == barrier_flag) {
-      pthread_cond_wait(&(team->barrier_cond), &(team->barrier_lock));
-    }
-    pthread_mutex_unlock(&(team->barrier_lock));
+    /* Wait for the last to reset the barrier */
+    while (*barrier_flag_p == barrier_flag)
+      __ompc_futex_wait(barrier_flag_p, barrier_flag,
+                        &team->barrier_waiters, 0);
   }
 
   __ompc_task_set_state(current_task, OMP_TASK_RUNNING);
@@ -50,6 +50,7 @@ typedef int       omp_int_t;
 typedef double    omp_wtime_t;
 typedef void     *omp_lock_t; 
 typedef void     *omp_nest_lock_t; 
+typedef int       omp_proc_bind_t;
 
 #define TRUE	1
 #define FALSE	0
@@ -29,6 +29,7 @@
 
 #include "omp_rtl.h"
 #include "omp_xbarrier.h"
+#include <sched.h>
 
 omp_xbarrier_t __omp_xbarrier_type;
 void (*__ompc_xbarrier_wait)(omp_team_t *team);
@@ -102,6 +103,7 @@ void __ompc_xbarrier_info_init(omp_team_t *team)
           for (j = 0; j < log2_team_size; j++) {
             info->nodes[i][j].flag[0] = False;
             info->nodes[i][j].flag[1] = False;
+            info->nodes[i][j].waiters = 0;
             info->nodes[i][j].partner =
               &(info->nodes[(i+d) % team_size][j]);
             d = 2*d;
@@ -164,6 +166,7 @@ void __ompc_xbarrier_info_create(omp_team_t *team)
           for (j = 0; j < log2_team_size; j++) {
             info->nodes[i][j].flag[0] = False;
             info->nodes[i][j].flag[1] = False;
+            info->nodes[i][j].waiters = 0;
             info->nodes[i][j].partner =
               &(info->nodes[(i+d) % team_size][j]);
             d = 2*d;
@@ -242,19 +245,26 @@ void tree_xbarrier_init(int vpid, omp_treenode_t **mynode, omp_team_t *team)
 
   if (vpid == 0) {
     (*mynode)->parentflag = &(*mynode)->dummy;
+    (*mynode)->parent_waiters = &(*mynode)->waiters;
   } else {
     int parentid = (vpid -1)/4;
     int my_index = vpid - (parentid * 4) - 1;
     (*mynode)->parentflag =
       &(team_xbarrier_info.shared_array[parentid].childnotready.parts[my_index]);
+    (*mynode)->parent_waiters =
+      &(team_xbarrier_info.shared_array[parentid].waiters);
   }
 
   for (i = 0, child_id = 2*vpid+1; i < 2; i++, child_id++) {
-    if (team_size > child_id)  /* have child i in wakeup tree */
+    if (team_size > child_id) {  /* have child i in wakeup tree */
       (*mynode)->child_notify[i] =
         &(team_xbarrier_info.shared_array[child_id].wakeup_sense);
-    else  /* don't have child i in wakeup tree */
+      (*mynode)->child_waiters[i] =
+        &(team_xbarrier_info.shared_array[child_id].waiters);
+    } else {  /* don't have child i in wakeup tree */
       (*mynode)->child_notify[i] = &(*mynode)->dummy;
+      (*mynode)->child_waiters[i] = &(*mynode)->waiters;
+    }
   }
   for(i = 0, child_id = 4*vpid+1; i < 4; i++, child_id++) {
          /* have child i in arrival tree */
@@ -288,11 +298,14 @@ void tour_xbarrier_init(int vpid, omp_round_t **myrounds, omp_team_t *team)
         if (partner < team_size) (*myrounds)[k].role = WINNER;
         else (*myrounds)[k].role = NOOP;
         (*myrounds)[k].opponent = (boolean *) NULL;
+        (*myrounds)[k].opponent_waiters = NULL;
      }
      else if (vpid_mod_2_sup_k_plus_1 == (1 << k)) {
         (*myrounds)[k].role = LOSER;
         (*myrounds)[k].opponent =
           &(team_xbarrier_info.rounds[vpid - (1<<k)][k].flag);
+        (*myrounds)[k].opponent_waiters =
+          &(team_xbarrier_info.rounds[vpid - (1<<k)][k].waiters);
          break;
      }
   }
@@ -306,6 +319,22 @@ void tour_xbarrier_init(int vpid, omp_round_t **myrounds, omp_team_t *team)
 
 /* Implementation of different algorithms */
 
+/* wait until the byte flag reads value */
+static inline void
+__ompc_xbarrier_wait_flag(volatile boolean *flag, boolean value,
+                          volatile int *waiters)
+{
+  volatile int *word = __ompc_futex_word(flag);
+  int old;
+
+  for (;;) {
+    old = *word;
+    if (*flag == value)
+      break;
+    __ompc_futex_wait(word, old, waiters, 0);
+  }
+}
+
 void __ompc_xbarrier_simple_wait(omp_team_t *team)
 {
   int barrier_flag;
@@ -321,11 +350,12 @@ void __ompc_xbarrier_simple_wait(omp_team_t *team)
     /* The last one reset flags*/
     team->barrier_count = 0;
     team->barrier_flag = barrier_flag ^ 1; /* Xor: toggle*/
+    __ompc_futex_wake_all(&team->barrier_flag, &team->barrier_waiters);
   }
   else {
-    while (team->barrier_flag == barrier_flag) {
-      /* keep checking */
-    }
+    while (team->barrier_flag == barrier_flag)
+      __ompc_futex_wait(&team->barrier_flag, barrier_flag,
+                        &team->barrier_waiters, 0);
   }
 }
 
@@ -346,12 +376,14 @@ void __ompc_xbarrier_dissem_wait(omp_team_t *team)
   d = 1;
 
   for (r = 0; r < log2_team_size; r++) {
-    nodes[thread_id][r].partner->flag[xbarrier_local->parity] =
-      xbarrier_local->sense;
-    while (nodes[thread_id][r].flag[xbarrier_local->parity] !=
-           xbarrier_local->sense) {
-      /* keep checking */
-    }
+    omp_localnode_t *mynode = &nodes[thread_id][r];
+    omp_localnode_t *partner = mynode->partner;
+
+    partner->flag[xbarrier_local->parity] = xbarrier_local->sense;
+    __ompc_futex_wake_all(__ompc_futex_word(partner->flag),
+                          &partner->waiters);
+    __ompc_xbarrier_wait_flag(&mynode->flag[xbarrier_local->parity],
+                              xbarrier_local->sense, &mynode->waiters);
     d = 2*d;
   }
 
@@ -360,7 +392,9 @@ void __ompc_xbarrier_dissem_wait(omp_team_t *team)
   xbarrier_local->parity = 1 - xbarrier_local->parity;
 }
 
-volatile boolean champion_sense = False;
+/* an int rather than a boolean, so that it is a futex word of its own */
+volatile int champion_sense = False;
+static volatile int champion_waiters = 0;
 
 void __ompc_xbarrier_tour_wait(omp_team_t *team)
 {
@@ -378,21 +412,22 @@ void __ompc_xbarrier_tour_wait(omp_team_t *team)
   for(;;) {
      if(round->role & LOSER) {
        *(round->opponent) = xbarrier_local->sense;
-       while (champion_sense != xbarrier_local->sense) {
-         /* keep checking */
-       }
+       __ompc_futex_wake_all(__ompc_futex_word(round->opponent),
+                             round->opponent_waiters);
+       while (champion_sense != xbarrier_local->sense)
+         __ompc_futex_wait(&champion_sense, xbarrier_local->sense ^ 1,
+                           &champion_waiters, 0);
        break;
      }
      else if(round->role & WINNER) {
-       while (round->flag != xbarrier_local->sense) {
-         /* keep checking */
-       }
+       __ompc_xbarrier_wait_flag(&round->flag, xbarrier_local->sense,
+                                 &round->waiters);
        /* continue */
      } else if (round->role & CHAMPION) {
-       while (round->flag != xbarrier_local->sense) {
-         /* keep checking */
-       }
+       __ompc_xbarrier_wait_flag(&round->flag, xbarrier_local->sense,
+                                 &round->waiters);
        champion_sense = xbarrier_local->sense;
+       __ompc_futex_wake_all(&champion_sense, &champion_waiters);
        break;
      }
      round++;
@@ -413,20 +448,30 @@ void __ompc_xbarrier_tree_wait(omp_team_t *team)
   xbarrier_local = &(__omp_current_v_thread->xbarrier_local);
   mynode_reg = xbarrier_local->u.mynode;
 
-  while (mynode_reg->childnotready.whole) {
-    /* keep checking */
+  /* the four children's flags are the first word of childnotready */
+  for (;;) {
+    int word = *(volatile int *) mynode_reg->childnotready.parts;
+    if (mynode_reg->childnotready.whole == 0)
+      break;
+    __ompc_futex_wait((volatile int *) mynode_reg->childnotready.parts,
+                      word, &mynode_reg->waiters, 0);
   }
 
   mynode_reg->childnotready.whole = mynode_reg->havechild.whole;
   *(mynode_reg->parentflag) = False;
+  __ompc_futex_wake_all(__ompc_futex_word(mynode_reg->parentflag),
+                        mynode_reg->parent_waiters);
 
   if (thread_id != 0)
-      while (mynode_reg->wakeup_sense != xbarrier_local->sense) {
-        /* keep checking */
-      }
+    __ompc_xbarrier_wait_flag(&mynode_reg->wakeup_sense,
+                              xbarrier_local->sense, &mynode_reg->waiters);
 
   *mynode_reg->child_notify[0] = xbarrier_local->sense;
   *mynode_reg->child_notify[1] = xbarrier_local->sense;
+  __ompc_futex_wake_all(__ompc_futex_word(mynode_reg->child_notify[0]),
+                        mynode_reg->child_waiters[0]);
+  __ompc_futex_wake_all(__ompc_futex_word(mynode_reg->child_notify[1]),
+                        mynode_reg->child_waiters[1]);
   xbarrier_local->sense ^= True;
 }
 
@@ -447,3 +492,132 @@ void __ompc_barrier_wait_select(omp_team_t *team, int needevent)
   }
 }
 #endif
+
+
+/* Tree-combining reductions */
+
+#define OMP_REDUCE_ARITH(T, d, s, op)                           \
+  case OMP_REDUCTION_ADD: *(T *)(d) += *(T *)(s); break;        \
+  case OMP_REDUCTION_MPY: *(T *)(d) *= *(T *)(s); break;        \
+  case OMP_REDUCTION_MAX:                                       \
+    if (*(T *)(s) > *(T *)(d)) *(T *)(d) = *(T *)(s);           \
+    break;                                                      \
+  case OMP_REDUCTION_MIN:                                       \
+    if (*(T *)(s) < *(T *)(d)) *(T *)(d) = *(T *)(s);           \
+    break;                                                      \
+  case OMP_REDUCTION_LAND:                                      \
+    *(T *)(d) = (*(T *)(d) != 0) && (*(T *)(s) != 0); break;    \
+  case OMP_REDUCTION_LIOR:                                      \
+    *(T *)(d) = (*(T *)(d) != 0) || (*(T *)(s) != 0); break;    \
+  case OMP_REDUCTION_EQV:                                       \
+    *(T *)(d) = (*(T *)(d) == *(T *)(s)); break;                \
+  case OMP_REDUCTION_NEQV:                                      \
+    *(T *)(d) = (*(T *)(d) != *(T *)(s)); break;
+
+#define OMP_REDUCE_INT(T, d, s, op)                             \
+  switch (op) {                                                 \
+  OMP_REDUCE_ARITH(T, d, s, op)                                 \
+  case OMP_REDUCTION_BAND: *(T *)(d) &= *(T *)(s); break;       \
+  case OMP_REDUCTION_BIOR: *(T *)(d) |= *(T *)(s); break;       \
+  case OMP_REDUCTION_BXOR: *(T *)(d) ^= *(T *)(s); break;       \
+  default: Not_Valid("unknown reduction operator");             \
+  }
+
+#define OMP_REDUCE_FLOAT(T, d, s, op)                           \
+  switch (op) {                                                 \
+  OMP_REDUCE_ARITH(T, d, s, op)                                 \
+  default: Not_Valid("unknown reduction operator");             \
+  }
+
+/* dst = dst op src */
+static void
+__ompc_reduce_combine(void *dst, void *src, long kind)
+{
+  int op = kind & ((1 << OMP_REDUCTION_TYPE_SHIFT) - 1);
+
+  switch (kind >> OMP_REDUCTION_TYPE_SHIFT) {
+  case OMP_REDUCTION_I4:
+    OMP_REDUCE_INT(omp_int32, dst, src, op);
+    break;
+  case OMP_REDUCTION_I8:
+    OMP_REDUCE_INT(omp_int64, dst, src, op);
+    break;
+  case OMP_REDUCTION_U4:
+    OMP_REDUCE_INT(omp_uint32, dst, src, op);
+    break;
+  case OMP_REDUCTION_U8:
+    OMP_REDUCE_INT(omp_uint64, dst, src, op);
+    break;
+  case OMP_REDUCTION_F4:
+    OMP_REDUCE_FLOAT(float, dst, src, op);
+    break;
+  case OMP_REDUCTION_F8:
+    OMP_REDUCE_FLOAT(double, dst, src, op);
+    break;
+  default:
+    Not_Valid("unknown reduction type");
+  }
+}
+
+/* Final combine of the scalar reductions of a parallel region, replacing
+ * the __ompc_reduction lock. Partial results are combined pairwise in
+ * log2(team_size) rounds: in round s a thread whose id has bit s set
+ * hands its privates to thread id - s and drops out, every other thread
+ * waits for id + s and folds that thread's privates into its own. Thread
+ * 0 then stores the result into the shared variables and the team meets
+ * at the usual barrier, which also keeps the privates of the other
+ * threads alive until thread 0 has read them.
+ */
+void
+__ompc_reduce(int gtid, omp_reduction_var_t *vars, int num_vars)
+{
+  omp_v_thread_t *p_vthread, *p_partner;
+  omp_reduction_node_t *node;
+  long counter;
+  int team_size, id, s, i;
+
+  __ompc_set_state(THR_REDUC_STATE);
+
+  p_vthread = __ompc_get_v_thread_by_num(__omp_myid);
+  if (__omp_exe_mode & OMP_EXE_MODE_SEQUENTIAL) {
+    team_size = 1;
+    id = 0;
+  } else {
+    team_size = p_vthread->team->team_size;
+    id = p_vthread->vthread_id;
+  }
+
+  for (s = 1; s < team_size; s <<= 1) {
+    if (id & s) {
+      node = &p_vthread->reduction_node;
+      node->vars = vars;
+      __ompc_mfence();
+      node->ready = 1;
+      break;
+    }
+    if (id + s >= team_size)
+      continue;
+
+    /* members of a team are contiguous, see __ompc_fork */
+    p_partner = p_vthread + s;
+    node = &p_partner->reduction_node;
+    for (counter = 0; !node->ready; counter++) {
+      if (counter > __omp_spin_count)
+        sched_yield();
+    }
+    __ompc_mfence();
+    for (i = 0; i < num_vars; i++)
+      __ompc_reduce_combine(vars[i].private_addr, node->vars[i].private_addr,
+                            vars[i].kind);
+    node->ready = 0;
+  }
+
+  if (id == 0) {
+    for (i = 0; i < num_vars; i++)
+      __ompc_reduce_combine(vars[i].shared_addr, vars[i].private_addr,
+                            vars[i].kind);
+  }
+
+  __ompc_set_state(THR_WORK_STATE);
+  __ompc_barrier();
+}
@@ -33,6 +33,7 @@
 #include <string.h>
 #include "omp_sys.h"
 #include "omp_lock.h"
+#include "omp_futex.h"
 
 /* Global structures for barrier */ 
 typedef unsigned char boolean;
@@ -53,9 +54,14 @@ typedef enum {
   DISSEM_XBARRIER
 } omp_xbarrier_t;
 
+/* Threads wait for the flags below with __ompc_futex_wait on the word
+ * holding the flag, and count themselves in the waiters of the node which
+ * holds it. */
+
 /* dissemination barrier */
 struct localnode {
   volatile boolean flag[2];
+  volatile int waiters;
   struct localnode *partner;
 } __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
 typedef struct localnode omp_localnode_t;
@@ -73,7 +79,9 @@ struct treenode {
   whole_and_parts childnotready;
   volatile boolean wakeup_sense;
   boolean dummy;
-  int pad[4];
+  volatile int waiters;
+  volatile int *parent_waiters;
+  volatile int *child_waiters[2];
 } __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
 typedef struct treenode omp_treenode_t;
 
@@ -82,6 +90,8 @@ struct round_t {
   volatile boolean *opponent;
   role_enum role;
   volatile boolean flag;
+  volatile int waiters;
+  volatile int *opponent_waiters;
 } __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
 typedef struct round_t omp_round_t;
 
@@ -102,6 +112,13 @@ struct omp_xbarrier_local_info {
 }; // __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
 typedef struct omp_xbarrier_local_info omp_xbarrier_local_info_t;
 
+/* combining tree of __ompc_reduce, one node per thread */
+struct omp_reduction_node {
+  volatile int ready;           /* the partial results in vars are final */
+  struct omp_reduction_var *vars;
+} __attribute__ ((__aligned__(CACHE_LINE_SIZE)));
+typedef struct omp_reduction_node omp_reduction_node_t;
+
 /* global variables extern declarations */
 extern omp_xbarrier_t __omp_xbarrier_type;
 extern long int __omp_spin_count; // defined in omp_thread.c
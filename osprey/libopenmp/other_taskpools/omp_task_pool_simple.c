@@ -53,8 +53,8 @@ omp_task_pool_t * __ompc_create_task_pool_simple(int team_size)
   new_pool->num_pending_tasks = 0;
   new_pool->level = aligned_malloc(sizeof(omp_task_queue_level_t),
                                    CACHE_LINE_SIZE);
-  pthread_mutex_init(&(new_pool->pool_lock), NULL);
-  pthread_cond_init(&(new_pool->pool_cond), NULL);
+  new_pool->idle_seq = 0;
+  new_pool->idle_waiters = 0;
 
   Is_True(new_pool->level != NULL,
       ("__ompc_create_task_pool: couldn't malloc level"));
@@ -124,11 +124,8 @@ int __ompc_add_task_to_pool_simple(omp_task_pool_t *pool, omp_task_t *task)
   /* num_pending_tasks track not just tasks entered into the task pool, but
    * also tasks marked as deferred that could not fit into the task pool
    */
-  if (__ompc_atomic_inc(&pool->num_pending_tasks) == 1) {
-    pthread_mutex_lock(&pool->pool_lock);
-    pthread_cond_broadcast(&pool->pool_cond);
-    pthread_mutex_unlock(&pool->pool_lock);
-  }
+  if (__ompc_atomic_inc(&pool->num_pending_tasks) == 1)
+    __ompc_task_pool_idle_wake(pool);
 
   success = __ompc_task_queue_put(&pool->level[PER_THREAD].task_queue[myid],
                                   task);
@@ -232,8 +229,6 @@ void __ompc_destroy_task_pool_simple(omp_task_pool_t *pool)
     __ompc_queue_free_slots(&per_thread->task_queue[i]);
   }
 
-  pthread_mutex_destroy(&pool->pool_lock);
-
   aligned_free(per_thread->task_queue); /* free queues in level 0 */
   aligned_free(pool->level); /* free the level array */
   aligned_free(pool); /* free the pool itself */
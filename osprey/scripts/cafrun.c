@@ -136,6 +136,24 @@ help_and_bail (void)
   fprintf (helpfh, "\n");
   fprintf (helpfh, "   UHCAF_GETCACHE_LINE_SIZE   Specifies the size (in bytes) of the cache line used by\n");
   fprintf (helpfh, "                              getcache optimizer. By default it is 64KB.\n");
+  fprintf (helpfh, "\n");
+  fprintf (helpfh, "   UHCAF_GETCACHE_SETS        Specifies the number of sets of the getcache for each\n");
+  fprintf (helpfh, "                              remote image. By default it is 1.\n");
+  fprintf (helpfh, "\n");
+  fprintf (helpfh, "   UHCAF_GETCACHE_WAYS        Specifies the number of cache lines in each set of the\n");
+  fprintf (helpfh, "                              getcache, replaced in LRU order. By default it is 4.\n");
+  fprintf (helpfh, "\n");
+  fprintf (helpfh, "   UHCAF_GETCACHE_PREFETCH    Set to 1 to prefetch the next line of reads that miss\n");
+  fprintf (helpfh, "                              the getcache with a constant stride.\n");
+  fprintf (helpfh, "\n");
+  fprintf (helpfh, "   UHCAF_GETCACHE_STATS       Set to 1 to print getcache hits and misses at exit.\n");
+  fprintf (helpfh, "\n");
+  fprintf (helpfh, "   UHCAF_PUT_COMBINE          Set to 1 to combine small PUTs to the same image into\n");
+  fprintf (helpfh, "                              one message.\n");
+  fprintf (helpfh, "\n");
+  fprintf (helpfh, "   UHCAF_PUT_COMBINE_BUFFER_SIZE\n");
+  fprintf (helpfh, "                              Specifies the size (in bytes) of the buffer in which\n");
+  fprintf (helpfh, "                              PUTs to each image are combined. By default it is 4KB.\n");
 
   exit (1);
 }
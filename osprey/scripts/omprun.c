@@ -49,6 +49,7 @@ static struct option long_opts[] = {
   {"task-queue", required_argument, NULL, 0},
   {"task-queue-num-slots", required_argument, NULL, 0},
   {"task-chunk-size", required_argument, NULL, 0},
+  {"task-alloc", required_argument, NULL, 0},
   {"queue-storage", required_argument, NULL, 0},
 
   {"nested", optional_argument, NULL, 'N'},
@@ -108,9 +109,13 @@ help_and_bail (void)
   fprintf (helpfh, "\n");
   fprintf (helpfh, "--task-chunk-size=CS         CS is 1 - task-queue-num-slots\n");
   fprintf (helpfh, "\n");
+  fprintf (helpfh, "--task-alloc=TA              TA is one of\n");
+  fprintf (helpfh, "                               slab | malloc\n");
+  fprintf (helpfh, "\n");
   fprintf (helpfh, "--queue-storage=QS           QS is one of\n");
   printf
-    ("                               array | dyn_array | list | lockless\n");
+    ("                               array | dyn_array | list | lockless |\n");
+  fprintf (helpfh, "                                 chase_lev\n");
   fprintf (helpfh, "\n");
   fprintf (helpfh, "--help, -h                   This message\n");
   fprintf (helpfh, "\n");
@@ -171,6 +176,10 @@ handle_long_option (const char *opt, const char *val)
     {
       set_env ("O64_OMP_TASK_CHUNK_SIZE", val);
     }
+  else if (strcmp (opt, "task-alloc") == 0)
+    {
+      set_env ("O64_OMP_TASK_ALLOC", val);
+    }
   else if (strcmp (opt, "queue-storage") == 0)
     {
       set_env ("O64_OMP_QUEUE_STORAGE", val);
@@ -875,6 +875,15 @@ static void WGEN_process_omp_clause (gs_t clauses, WN * region = 0)
       WN_kid0(wn) = WGEN_Expand_Expr (gs_omp_clause_collapse_level(clauses));
       break;
 
+    case GS_OMP_CLAUSE_DEPEND:
+      // depend(inout:) orders against both readers and writers, exactly
+      // like depend(out:), so both lower to an OUT pragma.
+      wn = WN_CreateXpragma(gs_omp_clause_depend_kind(clauses) ==
+                            GS_OMP_CLAUSE_DEPEND_IN ?
+                            WN_PRAGMA_IN : WN_PRAGMA_OUT, (ST_IDX) NULL, 1);
+      WN_kid0(wn) = WGEN_Expand_Expr (gs_omp_clause_decl(clauses));
+      break;
+
     default:
       DevWarn ("WGEN_process_omp_clause: unhandled OpenMP clause");
   }